@@ -36,17 +36,37 @@ else:  # linux or mac
     extra_compile_args.append('-fopenmp')
 
 ext_modules = [cpp.CppExtension(name='_impl',
-                                sources=['src/logsignature.cpp',
+                                sources=['src/accumulator.cpp',
+                                         'src/bch.cpp',
+                                         'src/intervals.cpp',
+                                         'src/jvp.cpp',
+                                         'src/kernel.cpp',
+                                         'src/logsignature.cpp',
                                          'src/lyndon.cpp',
                                          'src/misc.cpp',
+                                         'src/path.cpp',
                                          'src/pytorchbind.cpp',
+                                         'src/ragged.cpp',
                                          'src/signature.cpp',
-                                         'src/tensor_algebra_ops.cpp'],
-                                depends=['src/logsignature.hpp',
+                                         'src/sketch.cpp',
+                                         'src/tensor_algebra_ops.cpp',
+                                         'src/tree.cpp',
+                                         'src/words.cpp'],
+                                depends=['src/accumulator.hpp',
+                                         'src/bch.hpp',
+                                         'src/intervals.hpp',
+                                         'src/jvp.hpp',
+                                         'src/kernel.hpp',
+                                         'src/logsignature.hpp',
                                          'src/lyndon.hpp',
                                          'src/misc.hpp',
+                                         'src/path.hpp',
+                                         'src/ragged.hpp',
                                          'src/signature.hpp',
-                                         'src/tensor_algebra_ops.hpp'],
+                                         'src/sketch.hpp',
+                                         'src/tensor_algebra_ops.hpp',
+                                         'src/tree.hpp',
+                                         'src/words.hpp'],
                                 extra_compile_args=extra_compile_args)]
 
 
@@ -0,0 +1,186 @@
+/* Copyright 2019 Patrick Kidger. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ========================================================================= */
+
+
+#include <torch/extension.h>
+#include <cstdint>    // int64_t
+#include <stdexcept>  // std::invalid_argument
+#include <tuple>      // std::get
+#include <vector>     // std::vector
+
+#include "accumulator.hpp"
+#include "logsignature.hpp"
+#include "misc.hpp"
+#include "pycapsule.hpp"
+#include "tensor_algebra_ops.hpp"
+
+
+namespace signatory {
+    namespace accumulator {
+        namespace detail {
+            // This struct will be wrapped into a PyCapsule. It holds the signature of a path, and the final point of
+            // that path, so that the path may be extended one point at a time.
+            // Everything needed to process a point is allocated up front, so that doing so involves no allocation of
+            // tensors on the CPU.
+            struct AccumulatorInfo {
+                AccumulatorInfo(torch::Tensor point, s_size_type depth) :
+                    batch_size{point.size(batch_dim)},
+                    input_channel_size{point.size(channel_dim)},
+                    depth{depth},
+                    opts{misc::make_opts(point)},
+                    reciprocals{misc::make_reciprocals(depth, opts)},
+                    last_point{point.clone()},
+                    increment{torch::empty_like(point)},
+                    // The signature of a single point has no nonscalar terms
+                    signature{torch::zeros({batch_size, signature_channels(input_channel_size, depth)}, opts)}
+                {
+                    misc::slice_by_term(signature, signature_by_term, input_channel_size, depth);
+                };
+
+                int64_t batch_size;
+                int64_t input_channel_size;
+                s_size_type depth;
+                torch::TensorOptions opts;
+                torch::Tensor reciprocals;
+
+                // The final point of the path, of shape (batch, channel)
+                torch::Tensor last_point;
+                // Scratch space for the increment from last_point to the next point, of shape (batch, channel)
+                torch::Tensor increment;
+                // The signature of the path, of shape (batch, signature_channels)
+                torch::Tensor signature;
+                std::vector<torch::Tensor> signature_by_term;
+
+                constexpr static auto capsule_name = "signatory.AccumulatorInfoCapsule";
+            };
+
+            // Handles a single point on the CPU, by working directly with the memory of the tensors involved.
+            template<typename scalar_t>
+            void push_point_cpu_inner(AccumulatorInfo& accumulator_info, torch::Tensor point) {
+                auto point_a = point.accessor<scalar_t, 2>();
+                auto last_point_a = accumulator_info.last_point.accessor<scalar_t, 2>();
+                auto increment_a = accumulator_info.increment.accessor<scalar_t, 2>();
+                auto reciprocals_a = accumulator_info.reciprocals.accessor<scalar_t, 1>();
+
+                std::vector<torch::TensorAccessor<scalar_t, 2>> signature_by_term_a;
+                signature_by_term_a.reserve(accumulator_info.depth);
+                for (auto elem : accumulator_info.signature_by_term) {
+                    signature_by_term_a.push_back(elem.accessor<scalar_t, 2>());
+                }
+
+                std::vector<torch::TensorAccessor<scalar_t, 1>> signature_by_term_a_at_batch;
+                signature_by_term_a_at_batch.reserve(accumulator_info.depth);
+                for (int64_t batch_index = 0; batch_index < accumulator_info.batch_size; ++batch_index) {
+                    for (int64_t channel_index = 0; channel_index < accumulator_info.input_channel_size;
+                         ++channel_index) {
+                        increment_a[batch_index][channel_index] = point_a[batch_index][channel_index] -
+                                                                  last_point_a[batch_index][channel_index];
+                        last_point_a[batch_index][channel_index] = point_a[batch_index][channel_index];
+                    }
+                    signature_by_term_a_at_batch.clear();
+                    for (auto elem : signature_by_term_a) {
+                        signature_by_term_a_at_batch.push_back(elem[batch_index]);
+                    }
+                    ta_ops::mult_fused_restricted_exp_single_cpu<scalar_t, /*inverse=*/false>
+                            (increment_a[batch_index], signature_by_term_a_at_batch, reciprocals_a);
+                }
+            }
+
+            // Extends the path by a single point, of shape (batch, channel).
+            void push_point(AccumulatorInfo& accumulator_info, torch::Tensor point) {
+                if (point.is_cuda()) {
+                    torch::sub_out(accumulator_info.increment, point, accumulator_info.last_point);
+                    accumulator_info.last_point.copy_(point);
+                    ta_ops::mult_fused_restricted_exp(accumulator_info.increment, accumulator_info.signature_by_term,
+                                                      /*inverse=*/false, accumulator_info.reciprocals);
+                }
+                else {
+                    AT_DISPATCH_FLOATING_TYPES(point.type(), "accumulator::detail::push_point", ([&] {
+                        push_point_cpu_inner<scalar_t>(accumulator_info, point);
+                    }));
+                }
+            }
+
+            void push_checkargs(const AccumulatorInfo& accumulator_info, torch::Tensor points) {
+                if (points.ndimension() != 2 && points.ndimension() != 3) {
+                    throw std::invalid_argument("Argument 'points' must be a 2-dimensional tensor, corresponding to "
+                                                "(batch, channel), or a 3-dimensional tensor, corresponding to "
+                                                "(batch, stream, channel).");
+                }
+                if (points.size(batch_dim) != accumulator_info.batch_size ||
+                    points.size(channel_dim) != accumulator_info.input_channel_size) {
+                    throw std::invalid_argument("Argument 'points' must have the same batch and channel dimensions as "
+                                                "the accumulator.");
+                }
+                if (misc::make_opts(points) != accumulator_info.opts) {
+                    throw std::invalid_argument("Argument 'points' must have the same dtype and device as the "
+                                                "accumulator.");
+                }
+            }
+        }  // namespace signatory::accumulator::detail
+    }  // namespace signatory::accumulator
+
+    py::object make_accumulator_info(torch::Tensor point, s_size_type depth) {
+        if (point.ndimension() != 2) {
+            throw std::invalid_argument("Argument 'point' must be a 2-dimensional tensor, corresponding to "
+                                        "(batch, channel) respectively.");
+        }
+        if (point.size(batch_dim) == 0 || point.size(channel_dim) == 0) {
+            throw std::invalid_argument("Argument 'point' cannot have dimensions of size zero.");
+        }
+        if (!point.is_floating_point()) {
+            throw std::invalid_argument("Argument 'point' must be of floating point type.");
+        }
+        misc::checkargs_channels_depth(point.size(channel_dim), depth);
+
+        // Gradients are not tracked through the accumulator
+        return misc::wrap_capsule<accumulator::detail::AccumulatorInfo>(point.detach(), depth);
+    }
+
+    void accumulator_push(py::object accumulator_info_capsule, torch::Tensor points) {
+        accumulator::detail::AccumulatorInfo* accumulator_info =
+                misc::unwrap_capsule<accumulator::detail::AccumulatorInfo>(accumulator_info_capsule);
+        accumulator::detail::push_checkargs(*accumulator_info, points);
+        points = points.detach();
+
+        if (points.ndimension() == 2) {
+            accumulator::detail::push_point(*accumulator_info, points);
+        }
+        else {
+            for (int64_t stream_index = 0; stream_index < points.size(stream_dim); ++stream_index) {
+                accumulator::detail::push_point(*accumulator_info, points[stream_index]);
+            }
+        }
+    }
+
+    torch::Tensor accumulator_signature(py::object accumulator_info_capsule) {
+        accumulator::detail::AccumulatorInfo* accumulator_info =
+                misc::unwrap_capsule<accumulator::detail::AccumulatorInfo>(accumulator_info_capsule);
+        // Clone so that the result isn't changed by later pushes
+        return accumulator_info->signature.clone();
+    }
+
+    torch::Tensor accumulator_logsignature(py::object accumulator_info_capsule, LogSignatureMode mode,
+                                           py::object lyndon_info_capsule) {
+        accumulator::detail::AccumulatorInfo* accumulator_info =
+                misc::unwrap_capsule<accumulator::detail::AccumulatorInfo>(accumulator_info_capsule);
+        return std::get<0>(signature_to_logsignature_forward(accumulator_info->signature,
+                                                             accumulator_info->input_channel_size,
+                                                             accumulator_info->depth,
+                                                             /*stream=*/false,
+                                                             mode,
+                                                             lyndon_info_capsule));
+    }
+}  // namespace signatory
@@ -0,0 +1,44 @@
+/* Copyright 2019 Patrick Kidger. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ========================================================================= */
+ // Here we handle keeping track of the signature of a stream of data that arrives one point at a time, with as little
+ // overhead per point as possible. See signatory.SignatureAccumulator.
+
+
+#ifndef SIGNATORY_ACCUMULATOR_HPP
+#define SIGNATORY_ACCUMULATOR_HPP
+
+#include <torch/extension.h>
+
+#include "logsignature.hpp"
+#include "misc.hpp"
+
+namespace signatory {
+    // Makes an AccumulatorInfo PyCapsule, holding the signature of the path consisting of just 'point', which should be
+    // of shape (batch, channel).
+    py::object make_accumulator_info(torch::Tensor point, s_size_type depth);
+
+    // Extends the path held in the capsule by the given points, which should be of shape either (batch, channel) for a
+    // single point, or (stream, batch, channel) for several, and updates its signature in-place.
+    void accumulator_push(py::object accumulator_info_capsule, torch::Tensor points);
+
+    // Returns the signature of the path held in the capsule, of shape (batch, signature_channels).
+    torch::Tensor accumulator_signature(py::object accumulator_info_capsule);
+
+    // Returns the logsignature of the path held in the capsule, of shape (batch, logsignature_channels).
+    torch::Tensor accumulator_logsignature(py::object accumulator_info_capsule, LogSignatureMode mode,
+                                           py::object lyndon_info_capsule);
+}  // namespace signatory
+
+#endif //SIGNATORY_ACCUMULATOR_HPP
@@ -0,0 +1,624 @@
+/* Copyright 2019 Patrick Kidger. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ========================================================================= */
+
+
+#include <torch/extension.h>
+#include <algorithm>      // std::max, std::merge
+#include <cmath>          // std::abs
+#include <cstdint>        // int64_t
+#include <iterator>       // std::back_inserter
+#include <map>            // std::map
+#include <omp.h>
+#include <stdexcept>      // std::invalid_argument
+#include <tuple>          // std::tie, std::tuple
+#include <unordered_map>  // std::unordered_map
+#include <utility>        // std::pair
+#include <vector>         // std::vector
+
+#include "bch.hpp"
+#include "lyndon.hpp"
+#include "misc.hpp"
+#include "pycapsule.hpp"
+#include "signature.hpp"
+
+
+namespace signatory {
+    namespace bch {
+        namespace detail {
+            // This struct will be wrapped into a PyCapsule. It holds a compiled representation of the truncated
+            // Baker-Campbell-Hausdorff formula log(exp(x) exp(y)), where x is a member of the free Lie algebra,
+            // represented in the same basis as the logsignature with mode="words", and y is a member of the lowest
+            // nonscalar part of the tensor algebra, i.e. a path increment.
+            //
+            // Each output coefficient is a polynomial in the coefficients of x and y. We call the coefficients of x
+            // variables 0, ..., logsignature_channel_size - 1, and the coefficients of y variables
+            // logsignature_channel_size, ..., logsignature_channel_size + input_channel_size - 1.
+            // Then the i-th term of the polynomial contributes
+            //     term_coefficients[i] * prod_j variables[term_variables[j]]
+            // for term_offsets[i] <= j < term_offsets[i + 1], to the output coefficient term_targets[i].
+            struct BCHInfo {
+                BCHInfo(int64_t input_channel_size, s_size_type depth, int64_t logsignature_channel_size,
+                        std::vector<int64_t>&& term_targets, std::vector<double>&& term_coefficients,
+                        std::vector<int64_t>&& term_offsets, std::vector<int64_t>&& term_variables) :
+                    input_channel_size{input_channel_size},
+                    depth{depth},
+                    logsignature_channel_size{logsignature_channel_size},
+                    term_targets{term_targets},
+                    term_coefficients{term_coefficients},
+                    term_offsets{term_offsets},
+                    term_variables{term_variables}
+                {};
+
+                int64_t input_channel_size;
+                s_size_type depth;
+                int64_t logsignature_channel_size;
+
+                std::vector<int64_t> term_targets;
+                std::vector<double> term_coefficients;
+                std::vector<int64_t> term_offsets;
+                std::vector<int64_t> term_variables;
+
+                constexpr static auto capsule_name = "signatory.BCHInfoCapsule";
+            };
+
+            // Everything from here until make_bch_info is about computing the BCH formula symbolically. This only
+            // happens once for each choice of channels and depth, so we value simplicity over speed.
+
+            // Sorted list of the variables in a monomial (with repetition)
+            using Monomial = std::vector<int64_t>;
+            using Polynomial = std::map<Monomial, double>;
+            // Maps compressed index to coefficient
+            using LieElement = std::map<int64_t, Polynomial>;
+            // structure_constants[u][v] is a list of (w, c) such that [e_u, e_v] = sum c e_w, where e_u denotes the
+            // basis element of the free Lie algebra corresponding to the Lyndon word with compressed index u.
+            using StructureConstants = std::vector<std::map<int64_t, std::vector<std::pair<int64_t, int64_t>>>>;
+
+            // Coefficients are all rational numbers with small denominators, so anything smaller than this is just
+            // floating point error from terms that should have cancelled out.
+            constexpr double zero_tolerance = 1e-12;
+
+            StructureConstants structure_constants(const lyndon::LyndonWords& lyndon_words) {
+                std::vector<std::map<int64_t, int64_t>> expansions;
+                lyndon_words.to_words_basis(expansions);
+
+                // For each word, which basis elements have a nonzero coefficient for it in their expansion.
+                std::unordered_map<int64_t, std::vector<std::pair<int64_t, int64_t>>> word_to_basis;
+                for (int64_t compressed_index = 0; compressed_index < lyndon_words.amount; ++compressed_index) {
+                    for (const auto& word_coeff : expansions[compressed_index]) {
+                        word_to_basis[word_coeff.first].emplace_back(compressed_index, word_coeff.second);
+                    }
+                }
+
+                std::vector<int64_t> tensor_algebra_offsets;
+                std::vector<int64_t> num_words_at_depth;
+                tensor_algebra_offsets.reserve(lyndon_words.depth);
+                num_words_at_depth.reserve(lyndon_words.depth);
+                int64_t tensor_algebra_offset = 0;
+                int64_t num_words = lyndon_words.input_channel_size;
+                for (s_size_type depth_index = 0; depth_index < lyndon_words.depth; ++depth_index) {
+                    tensor_algebra_offsets.push_back(tensor_algebra_offset);
+                    num_words_at_depth.push_back(num_words);
+                    tensor_algebra_offset += num_words;
+                    num_words *= lyndon_words.input_channel_size;
+                }
+
+                // The coefficient of the Lyndon word w in [e_u, e_v] = e_u e_v - e_v e_u is the sum over every way of
+                // splitting w = pq of (coefficient of p in e_u)(coefficient of q in e_v) minus the same with u and v
+                // swapped. Conveniently the coefficient of a Lyndon word w in any Lie element is precisely its
+                // coefficient with respect to the e_w, so this is exactly the structure constant we're after.
+                std::vector<std::map<int64_t, std::map<int64_t, int64_t>>> accumulator(lyndon_words.amount);
+                for (s_size_type depth_index = 1; depth_index < lyndon_words.depth; ++depth_index) {
+                    for (const auto& lyndon_word : lyndon_words[depth_index]) {
+                        int64_t index = lyndon_word.tensor_algebra_index - tensor_algebra_offsets[depth_index];
+                        for (s_size_type suffix_depth_index = 0;
+                             suffix_depth_index < depth_index;
+                             ++suffix_depth_index) {
+                            s_size_type prefix_depth_index = depth_index - suffix_depth_index - 1;
+                            int64_t stride = num_words_at_depth[suffix_depth_index];
+                            auto prefix = word_to_basis.find(index / stride + tensor_algebra_offsets[prefix_depth_index]);
+                            auto suffix = word_to_basis.find(index % stride + tensor_algebra_offsets[suffix_depth_index]);
+                            if (prefix == word_to_basis.end() || suffix == word_to_basis.end()) {
+                                continue;
+                            }
+                            for (const auto& u_coeff : prefix->second) {
+                                for (const auto& v_coeff : suffix->second) {
+                                    int64_t product = u_coeff.second * v_coeff.second;
+                                    accumulator[u_coeff.first][v_coeff.first][lyndon_word.compressed_index] += product;
+                                    accumulator[v_coeff.first][u_coeff.first][lyndon_word.compressed_index] -= product;
+                                }
+                            }
+                        }
+                    }
+                }
+
+                StructureConstants out(lyndon_words.amount);
+                for (int64_t u = 0; u < lyndon_words.amount; ++u) {
+                    for (const auto& v_constants : accumulator[u]) {
+                        std::vector<std::pair<int64_t, int64_t>> constants;
+                        for (const auto& w_coeff : v_constants.second) {
+                            if (w_coeff.second != 0) {
+                                constants.push_back(w_coeff);
+                            }
+                        }
+                        if (!constants.empty()) {
+                            out[u][v_constants.first] = std::move(constants);
+                        }
+                    }
+                }
+                return out;
+            }
+
+            Polynomial multiply(const Polynomial& first, const Polynomial& second) {
+                Polynomial out;
+                for (const auto& first_term : first) {
+                    for (const auto& second_term : second) {
+                        Monomial monomial;
+                        monomial.reserve(first_term.first.size() + second_term.first.size());
+                        std::merge(first_term.first.begin(), first_term.first.end(),
+                                   second_term.first.begin(), second_term.first.end(),
+                                   std::back_inserter(monomial));
+                        out[monomial] += first_term.second * second_term.second;
+                    }
+                }
+                return out;
+            }
+
+            // target += scalar * source
+            void add(LieElement& target, const LieElement& source, double scalar) {
+                for (const auto& w_polynomial : source) {
+                    Polynomial& target_polynomial = target[w_polynomial.first];
+                    for (const auto& term : w_polynomial.second) {
+                        target_polynomial[term.first] += scalar * term.second;
+                    }
+                }
+            }
+
+            void prune(LieElement& element) {
+                for (auto w_iter = element.begin(); w_iter != element.end();) {
+                    Polynomial& polynomial = w_iter->second;
+                    for (auto term_iter = polynomial.begin(); term_iter != polynomial.end();) {
+                        if (std::abs(term_iter->second) < zero_tolerance) {
+                            term_iter = polynomial.erase(term_iter);
+                        }
+                        else {
+                            ++term_iter;
+                        }
+                    }
+                    if (polynomial.empty()) {
+                        w_iter = element.erase(w_iter);
+                    }
+                    else {
+                        ++w_iter;
+                    }
+                }
+            }
+
+            LieElement bracket(const LieElement& first, const LieElement& second,
+                               const StructureConstants& constants) {
+                LieElement out;
+                for (const auto& u_polynomial : first) {
+                    const auto& u_constants = constants[u_polynomial.first];
+                    if (u_constants.empty()) {
+                        continue;
+                    }
+                    for (const auto& v_polynomial : second) {
+                        auto uv_constants = u_constants.find(v_polynomial.first);
+                        if (uv_constants == u_constants.end()) {
+                            continue;
+                        }
+                        Polynomial product = multiply(u_polynomial.second, v_polynomial.second);
+                        for (const auto& w_coeff : uv_constants->second) {
+                            Polynomial& target = out[w_coeff.first];
+                            for (const auto& term : product) {
+                                target[term.first] += w_coeff.second * term.second;
+                            }
+                        }
+                    }
+                }
+                prune(out);
+                return out;
+            }
+
+            // The coefficients of psi(z) = z / (1 - exp(-z)), found by inverting the power series of
+            // (1 - exp(-z)) / z = sum_k (-1)^k z^k / (k + 1)!
+            std::vector<double> psi_coefficients(s_size_type depth) {
+                std::vector<double> reciprocal_series;
+                reciprocal_series.reserve(depth);
+                double factorial = 1;
+                for (s_size_type index = 0; index < depth; ++index) {
+                    factorial *= index + 1;
+                    reciprocal_series.push_back(((index % 2 == 0) ? 1 : -1) / factorial);
+                }
+                std::vector<double> out(depth, 0);
+                out[0] = 1;
+                for (s_size_type index = 1; index < depth; ++index) {
+                    if (index > 1 && index % 2 == 1) {
+                        // These are precisely zero. (They are Bernoulli numbers.)
+                        continue;
+                    }
+                    double total = 0;
+                    for (s_size_type inner = 1; inner <= index; ++inner) {
+                        total += reciprocal_series[inner] * out[index - inner];
+                    }
+                    out[index] = -total;
+                }
+                return out;
+            }
+
+            /* Computes z = log(exp(x) exp(y)) symbolically, as a polynomial in the coefficients of x and y.
+             * The idea is to consider z(t) = log(exp(x) exp(ty)), which satisfies
+             *     dz/dt = psi(ad_z)(y),    z(0) = x,
+             * and then to solve for z(t) as a power series in t: z(t) = sum_k z_k t^k. Matching coefficients of t^k
+             * gives
+             *     (k + 1) z_{k + 1} = sum_j psi_j W_{j, k},
+             * where W_{j, k} is the coefficient of t^k in ad_z^j (y), which in turn satisfies
+             *     W_{0, 0} = y,    W_{0, k} = 0 for k > 0,    W_{j, k} = sum_{i = 0}^k [z_i, W_{j - 1, k - i}].
+             * Each z_k is of degree at least k (and z_k for k >= 2 of degree at least k + 1), so truncating at the
+             * given depth this is a finite computation. Then z = z(1) = sum_k z_k.
+             */
+            LieElement bch_formula(const lyndon::LyndonWords& lyndon_words) {
+                StructureConstants constants = structure_constants(lyndon_words);
+                s_size_type depth = lyndon_words.depth;
+                std::vector<double> psi = psi_coefficients(depth);
+
+                LieElement x;
+                for (int64_t compressed_index = 0; compressed_index < lyndon_words.amount; ++compressed_index) {
+                    x[compressed_index][Monomial {compressed_index}] = 1;
+                }
+                LieElement y;
+                for (int64_t channel_index = 0; channel_index < lyndon_words.input_channel_size; ++channel_index) {
+                    // Lyndon words of length one have compressed indices equal to their letter
+                    y[channel_index][Monomial {lyndon_words.amount + channel_index}] = 1;
+                }
+
+                std::vector<LieElement> z;
+                z.reserve(depth + 1);
+                z.push_back(std::move(x));
+                // W[j][k] as in the description above
+                std::vector<std::vector<LieElement>> W(depth, std::vector<LieElement>(depth));
+                W[0][0] = std::move(y);
+
+                for (s_size_type k = 0; k < depth; ++k) {
+                    for (s_size_type j = 1; j < depth; ++j) {
+                        for (s_size_type i = 0; i <= k; ++i) {
+                            if (z[i].empty() || W[j - 1][k - i].empty()) {
+                                continue;
+                            }
+                            add(W[j][k], bracket(z[i], W[j - 1][k - i], constants), 1);
+                        }
+                        prune(W[j][k]);
+                    }
+                    LieElement next;
+                    for (s_size_type j = 0; j < depth; ++j) {
+                        if (psi[j] != 0) {
+                            add(next, W[j][k], psi[j] / (k + 1));
+                        }
+                    }
+                    prune(next);
+                    z.push_back(std::move(next));
+                }
+
+                LieElement out;
+                for (const auto& z_k : z) {
+                    add(out, z_k, 1);
+                }
+                prune(out);
+                return out;
+            }
+
+            // Evaluates the compiled BCH formula.
+            // 'variables' should be the concatenation of x and y.
+            // If inverse==true then instead computes log(exp(y) exp(x)) = -log(exp(-x) exp(-y)). This just involves
+            // flipping the sign of every monomial of even degree.
+            template <typename scalar_t, bool inverse>
+            void bch_step(const BCHInfo& bch_info, const std::vector<scalar_t>& variables, std::vector<scalar_t>& out) {
+                std::fill(out.begin(), out.end(), 0);
+                for (u_size_type term_index = 0; term_index < bch_info.term_targets.size(); ++term_index) {
+                    int64_t start = bch_info.term_offsets[term_index];
+                    int64_t end = bch_info.term_offsets[term_index + 1];
+                    scalar_t product = bch_info.term_coefficients[term_index];
+                    for (int64_t variable_index = start; variable_index < end; ++variable_index) {
+                        product *= variables[bch_info.term_variables[variable_index]];
+                    }
+                    if (inverse && ((end - start) % 2 == 0)) {
+                        product = -product;
+                    }
+                    out[bch_info.term_targets[term_index]] += product;
+                }
+            }
+
+            // The backward pass through bch_step. Accumulates the gradient with respect to 'variables' into
+            // 'grad_variables'.
+            template <typename scalar_t, bool inverse>
+            void bch_step_backward(const BCHInfo& bch_info, const std::vector<scalar_t>& variables,
+                                   const std::vector<scalar_t>& grad_out, std::vector<scalar_t>& grad_variables) {
+                for (u_size_type term_index = 0; term_index < bch_info.term_targets.size(); ++term_index) {
+                    int64_t start = bch_info.term_offsets[term_index];
+                    int64_t end = bch_info.term_offsets[term_index + 1];
+                    scalar_t grad_product = grad_out[bch_info.term_targets[term_index]] *
+                                            bch_info.term_coefficients[term_index];
+                    if (grad_product == 0) {
+                        continue;
+                    }
+                    if (inverse && ((end - start) % 2 == 0)) {
+                        grad_product = -grad_product;
+                    }
+                    for (int64_t variable_index = start; variable_index < end; ++variable_index) {
+                        scalar_t grad = grad_product;
+                        for (int64_t other_index = start; other_index < end; ++other_index) {
+                            if (other_index != variable_index) {
+                                grad *= variables[bch_info.term_variables[other_index]];
+                            }
+                        }
+                        grad_variables[bch_info.term_variables[variable_index]] += grad;
+                    }
+                }
+            }
+
+            template <typename scalar_t>
+            void bch_step(const BCHInfo& bch_info, const std::vector<scalar_t>& variables, std::vector<scalar_t>& out,
+                          bool inverse) {
+                if (inverse) {
+                    bch_step<scalar_t, /*inverse=*/true>(bch_info, variables, out);
+                }
+                else {
+                    bch_step<scalar_t, /*inverse=*/false>(bch_info, variables, out);
+                }
+            }
+
+            template <typename scalar_t>
+            void bch_step_backward(const BCHInfo& bch_info, const std::vector<scalar_t>& variables,
+                                   const std::vector<scalar_t>& grad_out, std::vector<scalar_t>& grad_variables,
+                                   bool inverse) {
+                if (inverse) {
+                    bch_step_backward<scalar_t, /*inverse=*/true>(bch_info, variables, grad_out, grad_variables);
+                }
+                else {
+                    bch_step_backward<scalar_t, /*inverse=*/false>(bch_info, variables, grad_out, grad_variables);
+                }
+            }
+
+            // 'logsignature' is of shape (stream, batch, channel) if stream==true, and of shape (1, batch, channel) if
+            // stream==false.
+            template <typename scalar_t>
+            void logsignature_bch_forward_cpu(const BCHInfo& bch_info, torch::Tensor path_increments,
+                                              torch::Tensor logsignature, bool stream, bool inverse) {
+                auto path_increments_a = path_increments.accessor<scalar_t, 3>();
+                auto logsignature_a = logsignature.accessor<scalar_t, 3>();
+                int64_t num_increments = path_increments.size(stream_dim);
+                int64_t batch_size = path_increments.size(batch_dim);
+                int64_t input_channel_size = bch_info.input_channel_size;
+                int64_t logsignature_channel_size = bch_info.logsignature_channel_size;
+
+                #pragma omp parallel for default(none) \
+                                     if(batch_size > 1) \
+                                     shared(bch_info, path_increments_a, logsignature_a, num_increments, batch_size, \
+                                            input_channel_size, logsignature_channel_size, stream, inverse)
+                for (int64_t batch_index = 0; batch_index < batch_size; ++batch_index) {
+                    // The first logsignature_channel_size variables hold the current value of the logsignature; the
+                    // remaining input_channel_size variables hold the next increment.
+                    std::vector<scalar_t> variables(logsignature_channel_size + input_channel_size, 0);
+                    std::vector<scalar_t> result(logsignature_channel_size);
+
+                    // The logsignature of a single increment is just that increment
+                    for (int64_t channel_index = 0; channel_index < input_channel_size; ++channel_index) {
+                        variables[channel_index] = path_increments_a[0][batch_index][channel_index];
+                    }
+                    if (stream) {
+                        for (int64_t channel_index = 0; channel_index < logsignature_channel_size; ++channel_index) {
+                            logsignature_a[0][batch_index][channel_index] = variables[channel_index];
+                        }
+                    }
+
+                    for (int64_t stream_index = 1; stream_index < num_increments; ++stream_index) {
+                        for (int64_t channel_index = 0; channel_index < input_channel_size; ++channel_index) {
+                            variables[logsignature_channel_size + channel_index] =
+                                    path_increments_a[stream_index][batch_index][channel_index];
+                        }
+                        bch_step(bch_info, variables, result, inverse);
+                        std::copy(result.begin(), result.end(), variables.begin());
+                        if (stream) {
+                            for (int64_t channel_index = 0; channel_index < logsignature_channel_size; ++channel_index) {
+                                logsignature_a[stream_index][batch_index][channel_index] = result[channel_index];
+                            }
+                        }
+                    }
+
+                    if (!stream) {
+                        for (int64_t channel_index = 0; channel_index < logsignature_channel_size; ++channel_index) {
+                            logsignature_a[0][batch_index][channel_index] = variables[channel_index];
+                        }
+                    }
+                }
+            }
+
+            // 'grad_logsignature' and 'logsignature' are as in logsignature_bch_forward_cpu.
+            template <typename scalar_t>
+            void logsignature_bch_backward_cpu(const BCHInfo& bch_info, torch::Tensor grad_logsignature,
+                                               torch::Tensor logsignature, torch::Tensor path_increments,
+                                               torch::Tensor grad_path_increments, bool stream, bool inverse) {
+                auto grad_logsignature_a = grad_logsignature.accessor<scalar_t, 3>();
+                auto logsignature_a = logsignature.accessor<scalar_t, 3>();
+                auto path_increments_a = path_increments.accessor<scalar_t, 3>();
+                auto grad_path_increments_a = grad_path_increments.accessor<scalar_t, 3>();
+                int64_t num_increments = path_increments.size(stream_dim);
+                int64_t batch_size = path_increments.size(batch_dim);
+                int64_t input_channel_size = bch_info.input_channel_size;
+                int64_t logsignature_channel_size = bch_info.logsignature_channel_size;
+
+                #pragma omp parallel for default(none) \
+                                     if(batch_size > 1) \
+                                     shared(bch_info, grad_logsignature_a, logsignature_a, path_increments_a, \
+                                            grad_path_increments_a, num_increments, batch_size, input_channel_size, \
+                                            logsignature_channel_size, stream, inverse)
+                for (int64_t batch_index = 0; batch_index < batch_size; ++batch_index) {
+                    int64_t last_index = stream ? num_increments - 1 : 0;
+                    std::vector<scalar_t> logsignature_at_stream(logsignature_channel_size);
+                    std::vector<scalar_t> grad_logsignature_at_stream(logsignature_channel_size);
+                    for (int64_t channel_index = 0; channel_index < logsignature_channel_size; ++channel_index) {
+                        logsignature_at_stream[channel_index] = logsignature_a[last_index][batch_index][channel_index];
+                        grad_logsignature_at_stream[channel_index] =
+                                grad_logsignature_a[last_index][batch_index][channel_index];
+                    }
+                    std::vector<scalar_t> variables(logsignature_channel_size + input_channel_size);
+                    std::vector<scalar_t> grad_variables(logsignature_channel_size + input_channel_size);
+                    std::vector<scalar_t> prev_logsignature_at_stream(logsignature_channel_size);
+
+                    for (int64_t stream_index = num_increments - 1; stream_index >= 1; --stream_index) {
+                        // Find the logsignature prior to this increment
+                        if (stream) {
+                            // Just look it up because we saved it for output
+                            for (int64_t channel_index = 0; channel_index < logsignature_channel_size; ++channel_index) {
+                                prev_logsignature_at_stream[channel_index] =
+                                        logsignature_a[stream_index - 1][batch_index][channel_index];
+                            }
+                        }
+                        else {
+                            // Recompute it by removing the increment again: log(exp(z) exp(-y)).
+                            std::copy(logsignature_at_stream.begin(), logsignature_at_stream.end(), variables.begin());
+                            for (int64_t channel_index = 0; channel_index < input_channel_size; ++channel_index) {
+                                variables[logsignature_channel_size + channel_index] =
+                                        -path_increments_a[stream_index][batch_index][channel_index];
+                            }
+                            bch_step(bch_info, variables, prev_logsignature_at_stream, inverse);
+                        }
+
+                        std::copy(prev_logsignature_at_stream.begin(), prev_logsignature_at_stream.end(),
+                                  variables.begin());
+                        for (int64_t channel_index = 0; channel_index < input_channel_size; ++channel_index) {
+                            variables[logsignature_channel_size + channel_index] =
+                                    path_increments_a[stream_index][batch_index][channel_index];
+                        }
+                        std::fill(grad_variables.begin(), grad_variables.end(), 0);
+                        bch_step_backward(bch_info, variables, grad_logsignature_at_stream, grad_variables, inverse);
+
+                        for (int64_t channel_index = 0; channel_index < input_channel_size; ++channel_index) {
+                            grad_path_increments_a[stream_index][batch_index][channel_index] =
+                                    grad_variables[logsignature_channel_size + channel_index];
+                        }
+                        for (int64_t channel_index = 0; channel_index < logsignature_channel_size; ++channel_index) {
+                            grad_logsignature_at_stream[channel_index] = grad_variables[channel_index];
+                            if (stream) {
+                                // If stream then gradients may well have accumulated on the logsignatures of the
+                                // partial paths, so add those on here.
+                                grad_logsignature_at_stream[channel_index] +=
+                                        grad_logsignature_a[stream_index - 1][batch_index][channel_index];
+                            }
+                        }
+                        std::swap(logsignature_at_stream, prev_logsignature_at_stream);
+                    }
+
+                    for (int64_t channel_index = 0; channel_index < input_channel_size; ++channel_index) {
+                        grad_path_increments_a[0][batch_index][channel_index] =
+                                grad_logsignature_at_stream[channel_index];
+                    }
+                }
+            }
+
+            void check_channels(const BCHInfo& bch_info, torch::Tensor path) {
+                if (bch_info.input_channel_size != path.size(channel_dim)) {
+                    throw std::invalid_argument("Argument 'path' does not have the number of channels that the "
+                                                "Baker-Campbell-Hausdorff formula was compiled for.");
+                }
+            }
+        }  // namespace signatory::bch::detail
+    }  // namespace signatory::bch
+
+    py::object make_bch_info(int64_t channels, s_size_type depth) {
+        misc::checkargs_channels_depth(channels, depth);
+        lyndon::LyndonWords lyndon_words(channels, depth, lyndon::LyndonWords::bracket_tag);
+        bch::detail::LieElement formula = bch::detail::bch_formula(lyndon_words);
+
+        std::vector<int64_t> term_targets;
+        std::vector<double> term_coefficients;
+        std::vector<int64_t> term_offsets {0};
+        std::vector<int64_t> term_variables;
+        for (const auto& w_polynomial : formula) {
+            for (const auto& term : w_polynomial.second) {
+                term_targets.push_back(w_polynomial.first);
+                term_coefficients.push_back(term.second);
+                term_variables.insert(term_variables.end(), term.first.begin(), term.first.end());
+                term_offsets.push_back(term_variables.size());
+            }
+        }
+
+        return misc::wrap_capsule<bch::detail::BCHInfo>(channels, depth, lyndon_words.amount,
+                                                        std::move(term_targets),
+                                                        std::move(term_coefficients),
+                                                        std::move(term_offsets),
+                                                        std::move(term_variables));
+    }
+
+    std::tuple<torch::Tensor, torch::Tensor>
+    logsignature_bch_forward(torch::Tensor path, bool stream, bool basepoint, torch::Tensor basepoint_value,
+                             bool inverse, py::object bch_info_capsule) {
+        // Don't need to track gradients when we have a custom backward
+        path = path.detach();
+        basepoint_value = basepoint_value.detach();
+        bch::detail::BCHInfo* bch_info = misc::unwrap_capsule<bch::detail::BCHInfo>(bch_info_capsule);
+        signature_checkargs(path, bch_info->depth, basepoint, basepoint_value, /*initial=*/false,
+                            /*initial_value=*/torch::Tensor(), /*time_channel=*/false, /*lead_lag=*/false);
+        bch::detail::check_channels(*bch_info, path);
+        if (path.is_cuda()) {
+            throw std::invalid_argument("The Baker-Campbell-Hausdorff logsignature is only available on the CPU.");
+        }
+
+        torch::Tensor path_increments = signature::detail::compute_path_increments(path, basepoint, basepoint_value,
+                                                                                   inverse);
+        int64_t num_increments = path_increments.size(stream_dim);
+        int64_t batch_size = path_increments.size(batch_dim);
+        torch::TensorOptions opts = misc::make_opts(path);
+
+        torch::Tensor logsignature = torch::empty({stream ? num_increments : 1,
+                                                   batch_size,
+                                                   bch_info->logsignature_channel_size}, opts);
+
+        AT_DISPATCH_FLOATING_TYPES(path.type(), "logsignature_bch_forward", ([&] {
+            bch::detail::logsignature_bch_forward_cpu<scalar_t>(*bch_info, path_increments, logsignature, stream,
+                                                                inverse);
+        }));
+
+        if (!stream) {
+            logsignature = logsignature[0];
+        }
+        return std::tuple<torch::Tensor, torch::Tensor> {logsignature, path_increments};
+    }
+
+    std::tuple<torch::Tensor, torch::Tensor>
+    logsignature_bch_backward(torch::Tensor grad_logsignature, torch::Tensor logsignature,
+                              torch::Tensor path_increments, bool stream, bool basepoint, bool inverse,
+                              py::object bch_info_capsule) {
+        grad_logsignature = grad_logsignature.detach();
+        logsignature = logsignature.detach();
+        path_increments = path_increments.detach();
+        bch::detail::BCHInfo* bch_info = misc::unwrap_capsule<bch::detail::BCHInfo>(bch_info_capsule);
+        bch::detail::check_channels(*bch_info, path_increments);
+        torch::TensorOptions opts = misc::make_opts(path_increments);
+
+        if (!stream) {
+            grad_logsignature = grad_logsignature.unsqueeze(0);
+            logsignature = logsignature.unsqueeze(0);
+        }
+        torch::Tensor grad_path_increments = torch::empty_like(path_increments);
+
+        AT_DISPATCH_FLOATING_TYPES(path_increments.type(), "logsignature_bch_backward", ([&] {
+            bch::detail::logsignature_bch_backward_cpu<scalar_t>(*bch_info, grad_logsignature, logsignature,
+                                                                 path_increments, grad_path_increments, stream,
+                                                                 inverse);
+        }));
+
+        return signature::detail::compute_path_increments_backward(grad_path_increments, basepoint, inverse, opts);
+    }
+}  // namespace signatory
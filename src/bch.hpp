@@ -0,0 +1,44 @@
+/* Copyright 2019 Patrick Kidger. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ========================================================================= */
+ // Here we compute the logsignature directly from the path, via the Baker-Campbell-Hausdorff formula, without ever
+ // computing the signature.
+
+
+#ifndef SIGNATORY_BCH_HPP
+#define SIGNATORY_BCH_HPP
+
+#include <torch/extension.h>
+#include <cstdint>    // int64_t
+#include <tuple>      // std::tuple
+
+#include "misc.hpp"
+
+namespace signatory {
+    // Makes a BCHInfo PyCapsule
+    py::object make_bch_info(int64_t channels, s_size_type depth);
+
+    // See signatory.unstable.logsignature_bch for documentation
+    std::tuple<torch::Tensor, torch::Tensor>
+    logsignature_bch_forward(torch::Tensor path, bool stream, bool basepoint, torch::Tensor basepoint_value,
+                             bool inverse, py::object bch_info_capsule);
+
+    // See signatory.unstable.logsignature_bch for documentation
+    std::tuple<torch::Tensor, torch::Tensor>
+    logsignature_bch_backward(torch::Tensor grad_logsignature, torch::Tensor logsignature,
+                              torch::Tensor path_increments, bool stream, bool basepoint, bool inverse,
+                              py::object bch_info_capsule);
+}  // namespace signatory
+
+#endif //SIGNATORY_BCH_HPP
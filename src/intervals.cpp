@@ -0,0 +1,661 @@
+/* Copyright 2019 Patrick Kidger. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ========================================================================= */
+
+
+#include <torch/extension.h>
+#include <algorithm>  // std::max, std::min
+#include <cstdint>    // int64_t
+#include <omp.h>
+#include <stdexcept>  // std::invalid_argument
+#include <tuple>      // std::ignore, std::tie
+#include <vector>     // std::vector
+
+#include "intervals.hpp"
+#include "misc.hpp"
+#include "signature.hpp"
+#include "tensor_algebra_ops.hpp"
+
+
+namespace signatory {
+    namespace intervals {
+        namespace detail {
+            // The number of channels in the given levels of the signature.
+            int64_t level_channels(int64_t input_channel_size, const std::vector<int64_t>& levels) {
+                int64_t channels = 0;
+                for (auto level : levels) {
+                    int64_t level_size = 1;
+                    for (int64_t i = 0; i < level; ++i) {
+                        level_size *= input_channel_size;
+                    }
+                    channels += level_size;
+                }
+                return channels;
+            }
+
+            // Takes a signature with channels along its final dimension and returns only the given levels of it.
+            // If 'levels' is empty then every level is returned.
+            torch::Tensor select_levels(torch::Tensor signature, int64_t input_channel_size, s_size_type depth,
+                                        const std::vector<int64_t>& levels) {
+                if (levels.empty()) {
+                    return signature;
+                }
+                std::vector<torch::Tensor> signature_by_term;
+                misc::slice_by_term(signature, signature_by_term, input_channel_size, depth);
+                std::vector<torch::Tensor> selected;
+                selected.reserve(levels.size());
+                for (auto level : levels) {
+                    selected.push_back(signature_by_term[level - 1]);
+                }
+                return torch::cat(selected, /*dim=*/channel_dim);
+            }
+
+            // Backwards through select_levels, for 'grad_selected' of shape (stream, batch, channels). The levels which
+            // weren't selected get zero gradient.
+            torch::Tensor select_levels_backward(torch::Tensor grad_selected, int64_t input_channel_size,
+                                                 s_size_type depth, const std::vector<int64_t>& levels) {
+                if (levels.empty()) {
+                    return grad_selected;
+                }
+                torch::Tensor grad_signature = torch::zeros({grad_selected.size(stream_dim),
+                                                             grad_selected.size(batch_dim),
+                                                             signature_channels(input_channel_size, depth)},
+                                                            misc::make_opts(grad_selected));
+                std::vector<torch::Tensor> grad_signature_by_term;
+                misc::slice_by_term(grad_signature, grad_signature_by_term, input_channel_size, depth);
+                int64_t current_memory_pos = 0;
+                for (auto level : levels) {
+                    torch::Tensor grad_term = grad_signature_by_term[level - 1];
+                    int64_t current_memory_length = grad_term.size(channel_dim);
+                    grad_term.copy_(grad_selected.narrow(/*dim=*/channel_dim,
+                                                         /*start=*/current_memory_pos,
+                                                         /*len=*/current_memory_length));
+                    current_memory_pos += current_memory_length;
+                }
+                return grad_signature;
+            }
+
+            // Returns the part of the table holding the signatures of path[row:row + 2], ..., path[row:], as a tensor
+            // of shape (stream - 1 - row, batch, channels).
+            torch::Tensor table_row(torch::Tensor table, int64_t stream_size, int64_t row, bool packed) {
+                int64_t row_length = stream_size - 1 - row;
+                if (packed) {
+                    // The rows before this one have lengths stream_size - 1, ..., stream_size - row.
+                    int64_t offset = (row * (2 * stream_size - row - 1)) / 2;
+                    return table.narrow(/*dim=*/0, /*start=*/offset, /*len=*/row_length);
+                }
+                else {
+                    return table[row].narrow(/*dim=*/0, /*start=*/row + 1, /*len=*/row_length);
+                }
+            }
+
+            // Computes the signatures of path[row:row + 2], ..., path[row:], to depth 'depth'.
+            // This is the dynamic programme sig[row, j + 1] = sig[row, j] \otimes exp(x_{j + 1} - x_j), which we
+            // express as the stream signature of path[row + 1:] with basepoint path[row].
+            torch::Tensor row_signatures(torch::Tensor path, int64_t row, s_size_type depth) {
+                torch::Tensor row_signature;
+                std::tie(row_signature, std::ignore) = signature_forward(path.narrow(/*dim=*/stream_dim,
+                                                                                     /*start=*/row + 1,
+                                                                                     /*len=*/path.size(stream_dim) -
+                                                                                             1 - row),
+                                                                         depth,
+                                                                         /*stream=*/true,
+                                                                         /*basepoint=*/true,
+                                                                         path[row],
+                                                                         /*inverse=*/false,
+                                                                         /*initial=*/false,
+                                                                         torch::empty({0}, misc::make_opts(path)),
+                                                                         /*time_channel=*/false,
+                                                                         /*lead_lag=*/false);
+                return row_signature;
+            }
+
+            // The number of threads to parallelise over the rows of the table with.
+            int64_t table_threads(torch::Tensor path) {
+                if (path.is_cuda()) {
+                    return 1;
+                }
+                // Every thread holds the signatures of one row at a time, so this uses extra memory.
+                int64_t num_threads = std::min({static_cast<int64_t>(omp_get_max_threads()), get_max_parallelism(),
+                                                path.size(stream_dim) - 1});
+                return std::max(num_threads, static_cast<int64_t>(1));
+            }
+
+            void table_checkargs(torch::Tensor path, s_size_type depth, const std::vector<int64_t>& levels) {
+                signature_checkargs(path, depth, /*basepoint=*/false, /*basepoint_value=*/torch::Tensor{},
+                                    /*initial=*/false, /*initial_value=*/torch::Tensor{},
+                                    /*time_channel=*/false, /*lead_lag=*/false);
+                int64_t previous_level = 0;
+                for (auto level : levels) {
+                    if (level <= previous_level || level > depth) {
+                        throw std::invalid_argument("Argument 'levels' must be a strictly increasing sequence of "
+                                                    "integers between one and 'depth' inclusive.");
+                    }
+                    previous_level = level;
+                }
+            }
+
+            // The number of windows of length 'window' fitting into 'stream_size' points, moving 'stride' points at a
+            // time.
+            int64_t num_windows(int64_t stream_size, int64_t window, int64_t stride) {
+                return (stream_size - window) / stride + 1;
+            }
+
+            // Advancing a window by one point costs two fused multiply-exponentiates, whilst computing a window afresh
+            // costs window - 2 of them. So we only use the recurrence between windows when it is cheaper.
+            bool use_recurrence(int64_t window, int64_t stride) {
+                return 2 * stride < window - 2;
+            }
+
+            // Concatenates every window of the path along the batch dimension, giving a tensor of shape
+            // (window, windows * batch, channel).
+            torch::Tensor stack_windows(torch::Tensor path, int64_t window, int64_t stride) {
+                int64_t amount = num_windows(path.size(stream_dim), window, stride);
+                std::vector<torch::Tensor> windows;
+                windows.reserve(amount);
+                for (int64_t window_index = 0; window_index < amount; ++window_index) {
+                    windows.push_back(path.narrow(/*dim=*/stream_dim, /*start=*/window_index * stride,
+                                                  /*len=*/window));
+                }
+                return torch::cat(windows, /*dim=*/batch_dim);
+            }
+
+            void window_checkargs(torch::Tensor path, s_size_type depth, int64_t window, int64_t stride) {
+                signature_checkargs(path, depth, /*basepoint=*/false, /*basepoint_value=*/torch::Tensor{},
+                                    /*initial=*/false, /*initial_value=*/torch::Tensor{},
+                                    /*time_channel=*/false, /*lead_lag=*/false);
+                if (window < 2) {
+                    throw std::invalid_argument("Argument 'window' must be an integer greater than or equal to two. "
+                                                "(Need at least this many points to define a path.)");
+                }
+                if (window > path.size(stream_dim)) {
+                    throw std::invalid_argument("Argument 'window' cannot be longer than the path.");
+                }
+                if (stride < 1) {
+                    throw std::invalid_argument("Argument 'stride' must be an integer greater than or equal to one.");
+                }
+            }
+
+            // The finest scale of the pyramid splits the increments of the path into 'num_segments' pieces, the j-th of
+            // which starts at the point returned by this function. (Coarser scales use every other boundary of the
+            // scale beneath them.)
+            int64_t segment_boundary(int64_t segment_index, int64_t num_segments, int64_t num_increments) {
+                return (segment_index * num_increments) / num_segments;
+            }
+
+            // Concatenates every segment of the finest scale of the pyramid along the batch dimension, giving a tensor
+            // of shape (max_segment_length, segments * batch, channel). Segments shorter than the longest are padded by
+            // repeating their final point, which doesn't change their signature.
+            torch::Tensor stack_segments(torch::Tensor path, int64_t num_segments) {
+                int64_t num_increments = path.size(stream_dim) - 1;
+                // The longest segment has ceil(num_increments / num_segments) increments, and so one more point than
+                // that.
+                int64_t max_segment_length = (num_increments + num_segments - 1) / num_segments + 1;
+                std::vector<torch::Tensor> segments;
+                segments.reserve(num_segments);
+                for (int64_t segment_index = 0; segment_index < num_segments; ++segment_index) {
+                    int64_t start = segment_boundary(segment_index, num_segments, num_increments);
+                    int64_t end = segment_boundary(segment_index + 1, num_segments, num_increments);
+                    torch::Tensor segment = path.narrow(/*dim=*/stream_dim, /*start=*/start, /*len=*/end - start + 1);
+                    int64_t padding = max_segment_length - (end - start + 1);
+                    if (padding > 0) {
+                        segment = torch::cat({segment, path[end].unsqueeze(/*dim=*/0).expand({padding,
+                                                                                             path.size(batch_dim),
+                                                                                             path.size(channel_dim)})},
+                                             /*dim=*/stream_dim);
+                    }
+                    segments.push_back(segment);
+                }
+                return torch::cat(segments, /*dim=*/batch_dim);
+            }
+
+            void pyramid_checkargs(torch::Tensor path, s_size_type depth, int64_t scales) {
+                signature_checkargs(path, depth, /*basepoint=*/false, /*basepoint_value=*/torch::Tensor{},
+                                    /*initial=*/false, /*initial_value=*/torch::Tensor{},
+                                    /*time_channel=*/false, /*lead_lag=*/false);
+                if (scales < 1) {
+                    throw std::invalid_argument("Argument 'scales' must be an integer greater than or equal to one.");
+                }
+                // Also guards against overflow in the shift below
+                if (scales > 62 || path.size(stream_dim) - 1 < (static_cast<int64_t>(1) << (scales - 1))) {
+                    throw std::invalid_argument("Argument 'path' is too short for this many scales: the finest scale "
+                                                "must have at least one increment of the path in every segment.");
+                }
+            }
+        }  // namespace signatory::intervals::detail
+    }  // namespace signatory::intervals
+
+    torch::Tensor signature_table_forward(torch::Tensor path, s_size_type depth, bool packed,
+                                          std::vector<int64_t> levels) {
+        intervals::detail::table_checkargs(path, depth, levels);
+        path = path.detach();
+
+        int64_t stream_size = path.size(stream_dim);
+        int64_t batch_size = path.size(batch_dim);
+        int64_t input_channel_size = path.size(channel_dim);
+        // Lower levels of the signature don't depend on higher levels, so we need only compute as far as the highest
+        // level we're asked for.
+        s_size_type compute_depth = levels.empty() ? depth : levels.back();
+        int64_t output_channel_size = levels.empty() ? signature_channels(input_channel_size, depth) :
+                                                       intervals::detail::level_channels(input_channel_size, levels);
+        torch::TensorOptions opts = misc::make_opts(path);
+
+        torch::Tensor table;
+        if (packed) {
+            table = torch::empty({(stream_size * (stream_size - 1)) / 2, batch_size, output_channel_size}, opts);
+        }
+        else {
+            // Everything not in the strict upper triangle is left as zero.
+            table = torch::zeros({stream_size, stream_size, batch_size, output_channel_size}, opts);
+        }
+
+        // The rows are independent of one another, so we parallelise over them. They get shorter as we go down the
+        // table, hence the dynamic schedule.
+        int64_t num_threads = intervals::detail::table_threads(path);
+        #pragma omp parallel for default(none) \
+                                 if(num_threads > 1) \
+                                 num_threads(num_threads) \
+                                 schedule(dynamic, 1) \
+                                 shared(stream_size, path, compute_depth, table, packed, input_channel_size, levels)
+        for (int64_t row = 0; row < stream_size - 1; ++row) {
+            torch::Tensor row_signature = intervals::detail::row_signatures(path, row, compute_depth);
+            intervals::detail::table_row(table, stream_size, row, packed).copy_(
+                    intervals::detail::select_levels(row_signature, input_channel_size, compute_depth, levels));
+        }
+
+        return table;
+    }
+
+    torch::Tensor signature_table_backward(torch::Tensor grad_table, torch::Tensor path, torch::Tensor table,
+                                           s_size_type depth, bool packed, std::vector<int64_t> levels) {
+        grad_table = grad_table.detach();
+        path = path.detach();
+        table = table.detach();
+
+        int64_t stream_size = path.size(stream_dim);
+        int64_t input_channel_size = path.size(channel_dim);
+        s_size_type compute_depth = levels.empty() ? depth : levels.back();
+
+        torch::Tensor grad_path = torch::zeros_like(path);
+
+        // As the rows overlap, every thread gets its own tensor to accumulate gradients in; these are then summed at
+        // the end.
+        int64_t num_threads = intervals::detail::table_threads(path);
+        std::vector<torch::Tensor> grad_path_by_thread(num_threads);
+        grad_path_by_thread[0] = grad_path;
+
+        #pragma omp parallel for default(none) \
+                                 if(num_threads > 1) \
+                                 num_threads(num_threads) \
+                                 schedule(dynamic, 1) \
+                                 shared(stream_size, path, compute_depth, table, grad_table, packed, \
+                                        input_channel_size, levels, grad_path_by_thread, grad_path)
+        for (int64_t row = 0; row < stream_size - 1; ++row) {
+            torch::Tensor& grad_path_at_thread = grad_path_by_thread[omp_get_thread_num()];
+            if (!grad_path_at_thread.defined()) {
+                grad_path_at_thread = torch::zeros_like(grad_path);
+            }
+
+            int64_t row_length = stream_size - 1 - row;
+            torch::Tensor points = path.narrow(/*dim=*/stream_dim, /*start=*/row + 1, /*len=*/row_length);
+            torch::Tensor path_increments = signature::detail::compute_path_increments(points,
+                                                                                       /*basepoint=*/true,
+                                                                                       path[row],
+                                                                                       /*inverse=*/false);
+            // If every level was returned then the table holds everything we need for the backward pass. Else the
+            // signatures of this row must be recomputed.
+            torch::Tensor row_signature;
+            if (levels.empty()) {
+                row_signature = intervals::detail::table_row(table, stream_size, row, packed);
+            }
+            else {
+                row_signature = intervals::detail::row_signatures(path, row, compute_depth);
+            }
+            torch::Tensor grad_row_signature = intervals::detail::select_levels_backward(
+                    intervals::detail::table_row(grad_table, stream_size, row, packed), input_channel_size,
+                    compute_depth, levels);
+
+            torch::Tensor grad_points;
+            torch::Tensor grad_basepoint;
+            std::tie(grad_points, grad_basepoint, std::ignore) = signature_backward(grad_row_signature,
+                                                                                    row_signature,
+                                                                                    path_increments,
+                                                                                    compute_depth,
+                                                                                    /*stream=*/true,
+                                                                                    /*basepoint=*/true,
+                                                                                    /*inverse=*/false,
+                                                                                    /*initial=*/false,
+                                                                                    /*time_channel=*/false,
+                                                                                    /*lead_lag=*/false);
+            grad_path_at_thread.narrow(/*dim=*/stream_dim, /*start=*/row + 1, /*len=*/row_length) += grad_points;
+            grad_path_at_thread[row] += grad_basepoint;
+        }
+
+        for (int64_t thread_index = 1; thread_index < num_threads; ++thread_index) {
+            if (grad_path_by_thread[thread_index].defined()) {
+                grad_path += grad_path_by_thread[thread_index];
+            }
+        }
+
+        return grad_path;
+    }
+
+    torch::Tensor signature_window_forward(torch::Tensor path, s_size_type depth, int64_t window, int64_t stride) {
+        intervals::detail::window_checkargs(path, depth, window, stride);
+        path = path.detach();
+
+        int64_t stream_size = path.size(stream_dim);
+        int64_t batch_size = path.size(batch_dim);
+        int64_t input_channel_size = path.size(channel_dim);
+        int64_t output_channel_size = signature_channels(input_channel_size, depth);
+        int64_t num_windows = intervals::detail::num_windows(stream_size, window, stride);
+        torch::TensorOptions opts = misc::make_opts(path);
+
+        if (!intervals::detail::use_recurrence(window, stride)) {
+            // The windows barely overlap, so just compute each of them as one big batch.
+            torch::Tensor signature;
+            std::tie(signature, std::ignore) = signature_forward(intervals::detail::stack_windows(path, window, stride),
+                                                                 depth,
+                                                                 /*stream=*/false,
+                                                                 /*basepoint=*/false,
+                                                                 torch::empty({0}, opts),
+                                                                 /*inverse=*/false,
+                                                                 /*initial=*/false,
+                                                                 torch::empty({0}, opts),
+                                                                 /*time_channel=*/false,
+                                                                 /*lead_lag=*/false);
+            return signature.view({num_windows, batch_size, output_channel_size});
+        }
+
+        torch::Tensor reciprocals = misc::make_reciprocals(depth, opts);
+        torch::Tensor path_increments = signature::detail::compute_path_increments(path, /*basepoint=*/false,
+                                                                                   torch::empty({0}, opts),
+                                                                                   /*inverse=*/false);
+        torch::Tensor signature = torch::empty({num_windows, batch_size, output_channel_size}, opts);
+
+        // Compute the first window directly
+        torch::Tensor current_signature;
+        std::tie(current_signature, std::ignore) = signature_forward(path.narrow(/*dim=*/stream_dim, /*start=*/0,
+                                                                                 /*len=*/window),
+                                                                     depth,
+                                                                     /*stream=*/false,
+                                                                     /*basepoint=*/false,
+                                                                     torch::empty({0}, opts),
+                                                                     /*inverse=*/false,
+                                                                     /*initial=*/false,
+                                                                     torch::empty({0}, opts),
+                                                                     /*time_channel=*/false,
+                                                                     /*lead_lag=*/false);
+        signature[0].copy_(current_signature);
+        std::vector<torch::Tensor> current_signature_by_term;
+        misc::slice_by_term(current_signature, current_signature_by_term, input_channel_size, depth);
+
+        // Then advance it one point at a time: with the window covering increments [start, start + window - 1), we
+        // compute exp(-increment[start]) \otimes current \otimes exp(increment[start + window - 1]).
+        for (int64_t window_index = 1; window_index < num_windows; ++window_index) {
+            for (int64_t step = 0; step < stride; ++step) {
+                int64_t old_index = (window_index - 1) * stride + step;
+                ta_ops::mult_fused_restricted_exp(-path_increments[old_index], current_signature_by_term,
+                                                  /*inverse=*/true, reciprocals);
+                ta_ops::mult_fused_restricted_exp(path_increments[old_index + window - 1], current_signature_by_term,
+                                                  /*inverse=*/false, reciprocals);
+            }
+            signature[window_index].copy_(current_signature);
+        }
+
+        return signature;
+    }
+
+    torch::Tensor signature_window_backward(torch::Tensor grad_signature, torch::Tensor path, torch::Tensor signature,
+                                            s_size_type depth, int64_t window, int64_t stride) {
+        grad_signature = grad_signature.detach();
+        path = path.detach();
+        signature = signature.detach();
+
+        int64_t stream_size = path.size(stream_dim);
+        int64_t batch_size = path.size(batch_dim);
+        int64_t input_channel_size = path.size(channel_dim);
+        int64_t output_channel_size = signature_channels(input_channel_size, depth);
+        int64_t num_windows = intervals::detail::num_windows(stream_size, window, stride);
+        torch::TensorOptions opts = misc::make_opts(path);
+
+        if (!intervals::detail::use_recurrence(window, stride)) {
+            torch::Tensor windows = intervals::detail::stack_windows(path, window, stride);
+            torch::Tensor path_increments = signature::detail::compute_path_increments(windows, /*basepoint=*/false,
+                                                                                       torch::empty({0}, opts),
+                                                                                       /*inverse=*/false);
+            torch::Tensor grad_windows;
+            std::tie(grad_windows, std::ignore, std::ignore) = signature_backward(
+                    grad_signature.reshape({num_windows * batch_size, output_channel_size}),
+                    signature.reshape({num_windows * batch_size, output_channel_size}),
+                    path_increments,
+                    depth,
+                    /*stream=*/false,
+                    /*basepoint=*/false,
+                    /*inverse=*/false,
+                    /*initial=*/false,
+                    /*time_channel=*/false,
+                    /*lead_lag=*/false);
+
+            torch::Tensor grad_path = torch::zeros_like(path);
+            for (int64_t window_index = 0; window_index < num_windows; ++window_index) {
+                grad_path.narrow(/*dim=*/stream_dim, /*start=*/window_index * stride, /*len=*/window) +=
+                        grad_windows.narrow(/*dim=*/batch_dim, /*start=*/window_index * batch_size, /*len=*/batch_size);
+            }
+            return grad_path;
+        }
+
+        torch::Tensor reciprocals = misc::make_reciprocals(depth, opts);
+        torch::Tensor path_increments = signature::detail::compute_path_increments(path, /*basepoint=*/false,
+                                                                                   torch::empty({0}, opts),
+                                                                                   /*inverse=*/false);
+        torch::Tensor grad_path_increments = torch::zeros_like(path_increments);
+        torch::Tensor grad_increment = torch::empty({batch_size, input_channel_size}, opts);
+
+        // We run the recurrence backwards, recovering each intermediate signature from the one after it by multiplying
+        // by the inverse exponentials, as in signature_backward. We clone as these are modified in-place.
+        torch::Tensor current_signature = signature[-1].clone();
+        torch::Tensor grad_current_signature = grad_signature[-1].clone();
+        std::vector<torch::Tensor> current_signature_by_term;
+        std::vector<torch::Tensor> grad_current_signature_by_term;
+        misc::slice_by_term(current_signature, current_signature_by_term, input_channel_size, depth);
+        misc::slice_by_term(grad_current_signature, grad_current_signature_by_term, input_channel_size, depth);
+
+        for (int64_t window_index = num_windows - 1; window_index >= 1; --window_index) {
+            for (int64_t step = stride - 1; step >= 0; --step) {
+                int64_t old_index = (window_index - 1) * stride + step;
+                torch::Tensor new_increment = path_increments[old_index + window - 1];
+                torch::Tensor old_increment = -path_increments[old_index];
+
+                // Backwards through the right multiplication by exp(new_increment)
+                ta_ops::mult_fused_restricted_exp(-new_increment, current_signature_by_term, /*inverse=*/false,
+                                                  reciprocals);
+                ta_ops::mult_fused_restricted_exp_backward(grad_increment, grad_current_signature_by_term,
+                                                           new_increment, current_signature_by_term,
+                                                           /*inverse=*/false, reciprocals);
+                grad_path_increments[old_index + window - 1] += grad_increment;
+
+                // Backwards through the left multiplication by exp(old_increment)
+                ta_ops::mult_fused_restricted_exp(-old_increment, current_signature_by_term, /*inverse=*/true,
+                                                  reciprocals);
+                ta_ops::mult_fused_restricted_exp_backward(grad_increment, grad_current_signature_by_term,
+                                                           old_increment, current_signature_by_term,
+                                                           /*inverse=*/true, reciprocals);
+                grad_path_increments[old_index] -= grad_increment;
+            }
+            grad_current_signature += grad_signature[window_index - 1];
+        }
+
+        torch::Tensor grad_path;
+        std::tie(grad_path, std::ignore) = signature::detail::compute_path_increments_backward(grad_path_increments,
+                                                                                               /*basepoint=*/false,
+                                                                                               /*inverse=*/false,
+                                                                                               opts);
+
+        // Finally backwards through the computation of the first window
+        torch::Tensor grad_first_window;
+        std::tie(grad_first_window, std::ignore, std::ignore) = signature_backward(grad_current_signature,
+                                                                                   signature[0],
+                                                                                   path_increments.narrow(
+                                                                                           /*dim=*/stream_dim,
+                                                                                           /*start=*/0,
+                                                                                           /*len=*/window - 1),
+                                                                                   depth,
+                                                                                   /*stream=*/false,
+                                                                                   /*basepoint=*/false,
+                                                                                   /*inverse=*/false,
+                                                                                   /*initial=*/false,
+                                                                                   /*time_channel=*/false,
+                                                                                   /*lead_lag=*/false);
+        grad_path.narrow(/*dim=*/stream_dim, /*start=*/0, /*len=*/window) += grad_first_window;
+
+        return grad_path;
+    }
+
+    torch::Tensor signature_pyramid_forward(torch::Tensor path, s_size_type depth, int64_t scales) {
+        intervals::detail::pyramid_checkargs(path, depth, scales);
+        path = path.detach();
+
+        int64_t batch_size = path.size(batch_dim);
+        int64_t input_channel_size = path.size(channel_dim);
+        int64_t output_channel_size = signature_channels(input_channel_size, depth);
+        int64_t num_segments = static_cast<int64_t>(1) << (scales - 1);
+        torch::TensorOptions opts = misc::make_opts(path);
+
+        torch::Tensor pyramid = torch::empty({2 * num_segments - 1, batch_size, output_channel_size}, opts);
+
+        // Compute the finest scale all at once.
+        torch::Tensor finest;
+        std::tie(finest, std::ignore) = signature_forward(intervals::detail::stack_segments(path, num_segments),
+                                                          depth,
+                                                          /*stream=*/false,
+                                                          /*basepoint=*/false,
+                                                          torch::empty({0}, opts),
+                                                          /*inverse=*/false,
+                                                          /*initial=*/false,
+                                                          torch::empty({0}, opts),
+                                                          /*time_channel=*/false,
+                                                          /*lead_lag=*/false);
+        pyramid.narrow(/*dim=*/0, /*start=*/num_segments - 1, /*len=*/num_segments).copy_(
+                finest.view({num_segments, batch_size, output_channel_size}));
+
+        // Then every coarser scale by multiplying together adjacent pairs of the scale beneath it. With the pyramid
+        // stored as a binary heap, the children of the nodes of one scale are precisely the nodes of the next scale.
+        for (int64_t num_nodes = num_segments / 2; num_nodes >= 1; num_nodes /= 2) {
+            torch::Tensor nodes = pyramid.narrow(/*dim=*/0, /*start=*/num_nodes - 1, /*len=*/num_nodes);
+            torch::Tensor children = pyramid.narrow(/*dim=*/0, /*start=*/2 * num_nodes - 1, /*len=*/2 * num_nodes);
+            children = children.view({num_nodes, 2, batch_size, output_channel_size});
+            nodes.copy_(children.select(/*dim=*/1, /*index=*/0));
+            torch::Tensor right_children = children.select(/*dim=*/1, /*index=*/1)
+                                                   .reshape({num_nodes * batch_size, output_channel_size});
+
+            std::vector<torch::Tensor> nodes_vector;
+            std::vector<torch::Tensor> right_children_vector;
+            misc::slice_by_term(nodes.view({num_nodes * batch_size, output_channel_size}), nodes_vector,
+                                input_channel_size, depth);
+            misc::slice_by_term(right_children, right_children_vector, input_channel_size, depth);
+            ta_ops::mult(nodes_vector, right_children_vector, /*inverse=*/false);
+        }
+
+        return pyramid;
+    }
+
+    torch::Tensor signature_pyramid_backward(torch::Tensor grad_pyramid, torch::Tensor path, torch::Tensor pyramid,
+                                             s_size_type depth, int64_t scales) {
+        grad_pyramid = grad_pyramid.detach();
+        path = path.detach();
+        pyramid = pyramid.detach();
+
+        int64_t batch_size = path.size(batch_dim);
+        int64_t input_channel_size = path.size(channel_dim);
+        int64_t num_increments = path.size(stream_dim) - 1;
+        int64_t output_channel_size = signature_channels(input_channel_size, depth);
+        int64_t num_segments = static_cast<int64_t>(1) << (scales - 1);
+        torch::TensorOptions opts = misc::make_opts(path);
+
+        // We accumulate gradients from the coarser scales on to the finer scales, so we clone to avoid leaking changes.
+        grad_pyramid = grad_pyramid.clone();
+
+        for (int64_t num_nodes = 1; num_nodes < num_segments; num_nodes *= 2) {
+            torch::Tensor grad_nodes = grad_pyramid.narrow(/*dim=*/0, /*start=*/num_nodes - 1, /*len=*/num_nodes)
+                                                   .view({num_nodes * batch_size, output_channel_size});
+            torch::Tensor grad_children = grad_pyramid.narrow(/*dim=*/0, /*start=*/2 * num_nodes - 1,
+                                                              /*len=*/2 * num_nodes)
+                                                      .view({num_nodes, 2, batch_size, output_channel_size});
+            torch::Tensor children = pyramid.narrow(/*dim=*/0, /*start=*/2 * num_nodes - 1, /*len=*/2 * num_nodes)
+                                            .view({num_nodes, 2, batch_size, output_channel_size});
+            torch::Tensor left_children = children.select(/*dim=*/1, /*index=*/0)
+                                                  .reshape({num_nodes * batch_size, output_channel_size});
+            torch::Tensor right_children = children.select(/*dim=*/1, /*index=*/1)
+                                                   .reshape({num_nodes * batch_size, output_channel_size});
+            torch::Tensor grad_right_children = torch::empty_like(right_children);
+
+            std::vector<torch::Tensor> grad_nodes_vector;
+            std::vector<torch::Tensor> grad_right_children_vector;
+            std::vector<torch::Tensor> left_children_vector;
+            std::vector<torch::Tensor> right_children_vector;
+            misc::slice_by_term(grad_nodes, grad_nodes_vector, input_channel_size, depth);
+            misc::slice_by_term(grad_right_children, grad_right_children_vector, input_channel_size, depth);
+            misc::slice_by_term(left_children, left_children_vector, input_channel_size, depth);
+            misc::slice_by_term(right_children, right_children_vector, input_channel_size, depth);
+            // grad_nodes is modified in-place to hold the gradient with respect to the left children
+            ta_ops::mult_backward</*add_not_copy=*/false>(grad_nodes_vector, grad_right_children_vector,
+                                                          left_children_vector, right_children_vector);
+
+            grad_children.select(/*dim=*/1, /*index=*/0) += grad_nodes.view({num_nodes, batch_size,
+                                                                             output_channel_size});
+            grad_children.select(/*dim=*/1, /*index=*/1) += grad_right_children.view({num_nodes, batch_size,
+                                                                                      output_channel_size});
+        }
+
+        // Then backwards through the finest scale
+        torch::Tensor segments = intervals::detail::stack_segments(path, num_segments);
+        torch::Tensor path_increments = signature::detail::compute_path_increments(segments, /*basepoint=*/false,
+                                                                                   torch::empty({0}, opts),
+                                                                                   /*inverse=*/false);
+        torch::Tensor grad_segments;
+        std::tie(grad_segments, std::ignore, std::ignore) = signature_backward(
+                grad_pyramid.narrow(/*dim=*/0, /*start=*/num_segments - 1, /*len=*/num_segments)
+                            .reshape({num_segments * batch_size, output_channel_size}),
+                pyramid.narrow(/*dim=*/0, /*start=*/num_segments - 1, /*len=*/num_segments)
+                       .reshape({num_segments * batch_size, output_channel_size}),
+                path_increments,
+                depth,
+                /*stream=*/false,
+                /*basepoint=*/false,
+                /*inverse=*/false,
+                /*initial=*/false,
+                /*time_channel=*/false,
+                /*lead_lag=*/false);
+
+        torch::Tensor grad_path = torch::zeros_like(path);
+        for (int64_t segment_index = 0; segment_index < num_segments; ++segment_index) {
+            int64_t start = intervals::detail::segment_boundary(segment_index, num_segments, num_increments);
+            int64_t end = intervals::detail::segment_boundary(segment_index + 1, num_segments, num_increments);
+            torch::Tensor grad_segment = grad_segments.narrow(/*dim=*/batch_dim,
+                                                              /*start=*/segment_index * batch_size,
+                                                              /*len=*/batch_size);
+            grad_path.narrow(/*dim=*/stream_dim, /*start=*/start, /*len=*/end - start + 1) +=
+                    grad_segment.narrow(/*dim=*/stream_dim, /*start=*/0, /*len=*/end - start + 1);
+            // The padding was copies of the final point
+            int64_t padding = grad_segment.size(stream_dim) - (end - start + 1);
+            if (padding > 0) {
+                grad_path[end] += grad_segment.narrow(/*dim=*/stream_dim, /*start=*/end - start + 1, /*len=*/padding)
+                                              .sum(/*dim=*/stream_dim);
+            }
+        }
+
+        return grad_path;
+    }
+}  // namespace signatory
@@ -0,0 +1,62 @@
+/* Copyright 2019 Patrick Kidger. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ========================================================================= */
+ // Here we handle computing the signatures over many intervals of a single path at once.
+
+
+#ifndef SIGNATORY_INTERVALS_HPP
+#define SIGNATORY_INTERVALS_HPP
+
+#include <torch/extension.h>
+#include <cstdint>    // int64_t
+#include <vector>     // std::vector
+
+#include "misc.hpp"
+
+namespace signatory {
+    // See signatory.signature_table for documentation.
+    // 'path' should be of shape (stream, batch, channel). 'levels' should be a strictly increasing list of the levels
+    // of the signature to return; if it is empty then every level is returned.
+    // If packed==false then returns a tensor of shape (stream, stream, batch, channels), else returns a tensor of shape
+    // (stream * (stream - 1) / 2, batch, channels), in which the rows of the upper triangle are concatenated together.
+    torch::Tensor signature_table_forward(torch::Tensor path, s_size_type depth, bool packed,
+                                          std::vector<int64_t> levels);
+
+    // See signatory.signature_table for documentation.
+    // 'table' should be as returned by signature_table_forward.
+    torch::Tensor signature_table_backward(torch::Tensor grad_table, torch::Tensor path, torch::Tensor table,
+                                           s_size_type depth, bool packed, std::vector<int64_t> levels);
+
+    // See signatory.signature_window for documentation.
+    // 'path' should be of shape (stream, batch, channel). Returns a tensor of shape (windows, batch, channels).
+    torch::Tensor signature_window_forward(torch::Tensor path, s_size_type depth, int64_t window, int64_t stride);
+
+    // See signatory.signature_window for documentation.
+    // 'signature' should be as returned by signature_window_forward.
+    torch::Tensor signature_window_backward(torch::Tensor grad_signature, torch::Tensor path, torch::Tensor signature,
+                                            s_size_type depth, int64_t window, int64_t stride);
+
+    // See signatory.signature_pyramid for documentation.
+    // 'path' should be of shape (stream, batch, channel). Returns a tensor of shape (2^scales - 1, batch, channels),
+    // holding every scale of the pyramid in the order of a binary heap: the whole path, then its two halves, then its
+    // four quarters, and so on.
+    torch::Tensor signature_pyramid_forward(torch::Tensor path, s_size_type depth, int64_t scales);
+
+    // See signatory.signature_pyramid for documentation.
+    // 'pyramid' should be as returned by signature_pyramid_forward.
+    torch::Tensor signature_pyramid_backward(torch::Tensor grad_pyramid, torch::Tensor path, torch::Tensor pyramid,
+                                             s_size_type depth, int64_t scales);
+}  // namespace signatory
+
+#endif //SIGNATORY_INTERVALS_HPP
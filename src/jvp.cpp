@@ -0,0 +1,233 @@
+/* Copyright 2019 Patrick Kidger. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ========================================================================= */
+ // Here we handle computing Jacobian-vector products of the signature, by forward-mode differentiation.
+
+
+#include <torch/extension.h>
+#include <algorithm>  // std::copy, std::fill, std::max, std::min
+#include <cstdint>    // int64_t
+#include <omp.h>
+#include <stdexcept>  // std::invalid_argument
+#include <tuple>      // std::tuple
+#include <vector>     // std::vector
+
+#include "jvp.hpp"
+#include "misc.hpp"
+#include "signature.hpp"
+
+
+namespace signatory {
+    namespace jvp {
+        namespace detail {
+            // Multiplying the signature S by the exponential of an increment x gives, at level k,
+            // (S \otimes exp(x))_k = S_k + (S_{k - 1} + ( ... (S_1 + x / k) \otimes x / (k - 1) ... ) \otimes x / 2)
+            //                                                                                            \otimes x
+            // which is the Horner-style scheme of mult_fused_restricted_exp. Here we perform the same computation over
+            // the dual numbers: every intermediate quantity carries its derivative alongside it, which is updated via
+            // the product rule. This costs about twice as much as computing the signature alone, regardless of the
+            // number of outputs; in contrast every Jacobian-vector product by reverse-mode differentiation would cost a
+            // backward pass of its own.
+
+            void jvp_checkargs(torch::Tensor path, torch::Tensor path_tangent, s_size_type depth, bool basepoint,
+                               torch::Tensor basepoint_value, torch::Tensor basepoint_tangent) {
+                signature_checkargs(path, depth, basepoint, basepoint_value, /*initial=*/false, torch::Tensor{},
+                                    /*time_channel=*/false, /*lead_lag=*/false);
+                if (path.is_cuda()) {
+                    throw std::invalid_argument("signature_jvp is only supported on the CPU.");
+                }
+                if (path_tangent.ndimension() != 3 || path_tangent.size(stream_dim) != path.size(stream_dim) ||
+                    path_tangent.size(batch_dim) != path.size(batch_dim) ||
+                    path_tangent.size(channel_dim) != path.size(channel_dim)) {
+                    throw std::invalid_argument("Argument 'path_tangent' must have the same shape as 'path'.");
+                }
+                if (misc::make_opts(path_tangent) != misc::make_opts(path)) {
+                    throw std::invalid_argument("Argument 'path_tangent' does not have the same dtype or device as "
+                                                "'path'.");
+                }
+                if (basepoint) {
+                    if (basepoint_tangent.ndimension() != 2 ||
+                        basepoint_tangent.size(batch_dim) != basepoint_value.size(batch_dim) ||
+                        basepoint_tangent.size(channel_dim) != basepoint_value.size(channel_dim)) {
+                        throw std::invalid_argument("Argument 'basepoint_tangent' must have the same shape as "
+                                                    "'basepoint'.");
+                    }
+                    if (misc::make_opts(basepoint_tangent) != misc::make_opts(path)) {
+                        throw std::invalid_argument("Argument 'basepoint_tangent' does not have the same dtype or "
+                                                    "device as 'path'.");
+                    }
+                }
+            }
+
+            // Working memory for jvp_step, so that it need not be allocated for every step.
+            template <typename scalar_t>
+            struct JvpScratch {
+                std::vector<scalar_t> scratch;
+                std::vector<scalar_t> new_scratch;
+                std::vector<scalar_t> tangent_scratch;
+                std::vector<scalar_t> new_tangent_scratch;
+            };
+
+            // Modifies 'signature' to hold signature \otimes exp(next), and 'tangent' to hold its derivative, given the
+            // derivative 'tangent_next' of 'next'. Both 'signature' and 'tangent' are laid out as the output of
+            // signatory.signature, starting at level one. 'reciprocals[k]' should be 1 / (k + 1).
+            template <typename scalar_t>
+            void jvp_step(const scalar_t* next, const scalar_t* tangent_next, int64_t input_channel_size,
+                          s_size_type depth, const std::vector<int64_t>& term_offsets,
+                          const std::vector<scalar_t>& reciprocals, scalar_t* signature, scalar_t* tangent,
+                          JvpScratch<scalar_t>& scratch) {
+                std::vector<scalar_t>& value = scratch.scratch;
+                std::vector<scalar_t>& new_value = scratch.new_scratch;
+                std::vector<scalar_t>& tangent_value = scratch.tangent_scratch;
+                std::vector<scalar_t>& new_tangent_value = scratch.new_tangent_scratch;
+
+                // Work from the top level down, so that the lower levels are still those of the old signature when
+                // they are needed.
+                for (s_size_type level = depth; level >= 1; --level) {
+                    scalar_t reciprocal = reciprocals[level - 1];
+                    value.resize(input_channel_size);
+                    tangent_value.resize(input_channel_size);
+                    for (int64_t channel_index = 0; channel_index < input_channel_size; ++channel_index) {
+                        value[channel_index] = signature[channel_index] + next[channel_index] * reciprocal;
+                        tangent_value[channel_index] = tangent[channel_index] +
+                                                       tangent_next[channel_index] * reciprocal;
+                    }
+                    for (s_size_type term = 1; term < level; ++term) {
+                        reciprocal = reciprocals[level - term - 1];
+                        const scalar_t* signature_at_term = signature + term_offsets[term];
+                        const scalar_t* tangent_at_term = tangent + term_offsets[term];
+                        int64_t old_size = value.size();
+                        new_value.resize(old_size * input_channel_size);
+                        new_tangent_value.resize(old_size * input_channel_size);
+                        for (int64_t old_index = 0; old_index < old_size; ++old_index) {
+                            scalar_t value_divided = value[old_index] * reciprocal;
+                            scalar_t tangent_value_divided = tangent_value[old_index] * reciprocal;
+                            int64_t offset = old_index * input_channel_size;
+                            for (int64_t channel_index = 0; channel_index < input_channel_size; ++channel_index) {
+                                new_value[offset + channel_index] = signature_at_term[offset + channel_index] +
+                                                                    value_divided * next[channel_index];
+                                new_tangent_value[offset + channel_index] =
+                                        tangent_at_term[offset + channel_index] +
+                                        tangent_value_divided * next[channel_index] +
+                                        value_divided * tangent_next[channel_index];
+                            }
+                        }
+                        value.swap(new_value);
+                        tangent_value.swap(new_tangent_value);
+                    }
+                    std::copy(value.begin(), value.end(), signature + term_offsets[level - 1]);
+                    std::copy(tangent_value.begin(), tangent_value.end(), tangent + term_offsets[level - 1]);
+                }
+            }
+
+            template <typename scalar_t>
+            void jvp_cpu(torch::Tensor path_increments, torch::Tensor tangent_increments, s_size_type depth,
+                         bool stream, torch::Tensor signature, torch::Tensor tangent) {
+                int64_t output_stream_size = path_increments.size(stream_dim);
+                int64_t batch_size = path_increments.size(batch_dim);
+                int64_t input_channel_size = path_increments.size(channel_dim);
+                int64_t output_channel_size = signature.size(channel_dim);
+
+                std::vector<int64_t> term_offsets;
+                int64_t term_size = 1;
+                int64_t term_offset = 0;
+                for (s_size_type level = 0; level < depth; ++level) {
+                    term_offsets.push_back(term_offset);
+                    term_size *= input_channel_size;
+                    term_offset += term_size;
+                }
+                std::vector<scalar_t> reciprocals;
+                for (s_size_type level = 1; level <= depth; ++level) {
+                    reciprocals.push_back(static_cast<scalar_t>(1) / static_cast<scalar_t>(level));
+                }
+
+                const scalar_t* path_increments_data = path_increments.data<scalar_t>();
+                const scalar_t* tangent_increments_data = tangent_increments.data<scalar_t>();
+                scalar_t* signature_data = signature.data<scalar_t>();
+                scalar_t* tangent_data = tangent.data<scalar_t>();
+
+                int64_t num_threads = std::min({static_cast<int64_t>(omp_get_max_threads()), get_max_parallelism(),
+                                                batch_size});
+                num_threads = std::max(num_threads, static_cast<int64_t>(1));
+                std::vector<JvpScratch<scalar_t>> scratch_by_thread(num_threads);
+
+                #pragma omp parallel for default(none) \
+                                         if(num_threads > 1) \
+                                         num_threads(num_threads) \
+                                         schedule(static) \
+                                         shared(output_stream_size, batch_size, input_channel_size, \
+                                                output_channel_size, depth, stream, term_offsets, reciprocals, \
+                                                path_increments_data, tangent_increments_data, signature_data, \
+                                                tangent_data, scratch_by_thread)
+                for (int64_t batch_index = 0; batch_index < batch_size; ++batch_index) {
+                    JvpScratch<scalar_t>& scratch = scratch_by_thread[omp_get_thread_num()];
+                    scalar_t* signature_at_batch = signature_data + batch_index * output_channel_size;
+                    scalar_t* tangent_at_batch = tangent_data + batch_index * output_channel_size;
+                    // Start from the identity, whose nonscalar terms (and their derivatives) are all zero.
+                    std::fill(signature_at_batch, signature_at_batch + output_channel_size, 0);
+                    std::fill(tangent_at_batch, tangent_at_batch + output_channel_size, 0);
+                    for (int64_t stream_index = 0; stream_index < output_stream_size; ++stream_index) {
+                        if (stream && stream_index > 0) {
+                            scalar_t* next_signature_at_batch = signature_at_batch + batch_size * output_channel_size;
+                            scalar_t* next_tangent_at_batch = tangent_at_batch + batch_size * output_channel_size;
+                            std::copy(signature_at_batch, signature_at_batch + output_channel_size,
+                                      next_signature_at_batch);
+                            std::copy(tangent_at_batch, tangent_at_batch + output_channel_size, next_tangent_at_batch);
+                            signature_at_batch = next_signature_at_batch;
+                            tangent_at_batch = next_tangent_at_batch;
+                        }
+                        int64_t increment_offset = (stream_index * batch_size + batch_index) * input_channel_size;
+                        jvp_step<scalar_t>(path_increments_data + increment_offset,
+                                           tangent_increments_data + increment_offset, input_channel_size, depth,
+                                           term_offsets, reciprocals, signature_at_batch, tangent_at_batch, scratch);
+                    }
+                }
+            }
+        }  // namespace signatory::jvp::detail
+    }  // namespace signatory::jvp
+
+    std::tuple<torch::Tensor, torch::Tensor>
+    signature_jvp(torch::Tensor path, torch::Tensor path_tangent, s_size_type depth, bool stream, bool basepoint,
+                  torch::Tensor basepoint_value, torch::Tensor basepoint_tangent) {
+        jvp::detail::jvp_checkargs(path, path_tangent, depth, basepoint, basepoint_value, basepoint_tangent);
+
+        path = path.detach();
+        path_tangent = path_tangent.detach();
+        basepoint_value = basepoint_value.detach();
+        basepoint_tangent = basepoint_tangent.detach();
+
+        // Taking increments is linear, so the tangents of the increments are just the increments of the tangents.
+        torch::Tensor path_increments = signature::detail::compute_path_increments(path, basepoint, basepoint_value,
+                                                                                   /*inverse=*/false).contiguous();
+        torch::Tensor tangent_increments = signature::detail::compute_path_increments(path_tangent, basepoint,
+                                                                                      basepoint_tangent,
+                                                                                      /*inverse=*/false).contiguous();
+        int64_t output_stream_size = path_increments.size(stream_dim);
+        int64_t batch_size = path_increments.size(batch_dim);
+        int64_t output_channel_size = signature_channels(path_increments.size(channel_dim), depth);
+
+        torch::Tensor signature;
+        if (stream) {
+            signature = torch::empty({output_stream_size, batch_size, output_channel_size}, misc::make_opts(path));
+        }
+        else {
+            signature = torch::empty({batch_size, output_channel_size}, misc::make_opts(path));
+        }
+        torch::Tensor tangent = torch::empty_like(signature);
+        AT_DISPATCH_FLOATING_TYPES(path.type(), "signature_jvp", ([&] {
+            jvp::detail::jvp_cpu<scalar_t>(path_increments, tangent_increments, depth, stream, signature, tangent);
+        }));
+        return std::tuple<torch::Tensor, torch::Tensor> {signature, tangent};
+    }
+}  // namespace signatory
@@ -0,0 +1,37 @@
+/* Copyright 2019 Patrick Kidger. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ========================================================================= */
+ // Here we handle computing Jacobian-vector products of the signature, by forward-mode differentiation.
+
+
+#ifndef SIGNATORY_JVP_HPP
+#define SIGNATORY_JVP_HPP
+
+#include <torch/extension.h>
+#include <tuple>      // std::tuple
+
+#include "misc.hpp"
+
+namespace signatory {
+    // See signatory.signature_jvp for documentation. Only supported on the CPU.
+    // 'path' and 'path_tangent' should be of shape (stream, batch, channel); 'basepoint_value' and 'basepoint_tangent'
+    // should be of shape (batch, channel) if basepoint==true.
+    // Returns the signature and its derivative in the direction of the tangents, both of shape
+    // (batch, signature_channels), or (stream, batch, signature_channels) if stream==true.
+    std::tuple<torch::Tensor, torch::Tensor>
+    signature_jvp(torch::Tensor path, torch::Tensor path_tangent, s_size_type depth, bool stream, bool basepoint,
+                  torch::Tensor basepoint_value, torch::Tensor basepoint_tangent);
+}  // namespace signatory
+
+#endif //SIGNATORY_JVP_HPP
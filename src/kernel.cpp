@@ -0,0 +1,973 @@
+/* Copyright 2019 Patrick Kidger. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ========================================================================= */
+ // Here we handle computing signature kernels: inner products between the signatures of two paths, computed without
+ // ever computing the signatures themselves.
+
+
+#include <torch/extension.h>
+#include <algorithm>  // std::fill, std::max, std::min
+#include <cmath>      // std::ldexp
+#include <cstdint>    // int64_t
+#include <omp.h>
+#include <stdexcept>  // std::invalid_argument
+#include <string>     // std::string
+#include <tuple>      // std::ignore, std::tie, std::tuple
+#include <utility>    // std::pair
+#include <vector>     // std::vector
+
+#include "kernel.hpp"
+#include "misc.hpp"
+#include "signature.hpp"
+
+
+namespace signatory {
+    namespace kernel {
+        namespace detail {
+            // The Gram matrix is split up into square blocks with this many pairs of paths along each side, and the
+            // blocks are distributed between threads. Every pair in a block involves the same few paths, so these stay
+            // in cache.
+            constexpr int64_t gram_block_size = 16;
+
+            void gram_checkpath(torch::Tensor path, const std::string& name) {
+                if (path.ndimension() != 3) {
+                    throw std::invalid_argument("Argument '" + name + "' must be a 3-dimensional tensor, with "
+                                                "dimensions corresponding to (batch, stream, channel) respectively.");
+                }
+                if (path.size(batch_dim) == 0 || path.size(stream_dim) == 0 || path.size(channel_dim) == 0) {
+                    throw std::invalid_argument("Argument '" + name + "' cannot have dimensions of size zero.");
+                }
+                if (path.size(stream_dim) == 1) {
+                    throw std::invalid_argument("Argument '" + name + "' must have stream dimension of size at least "
+                                                "2. (Need at least this many points to define a path.)");
+                }
+                if (!path.is_floating_point()) {
+                    throw std::invalid_argument("Argument '" + name + "' must be of floating point type.");
+                }
+                if (path.is_cuda()) {
+                    throw std::invalid_argument("Signature kernels are only supported on the CPU.");
+                }
+            }
+
+            void kernel_checkargs(torch::Tensor x, torch::Tensor y, bool symmetric) {
+                gram_checkpath(x, "x");
+                if (!symmetric) {
+                    gram_checkpath(y, "y");
+                    if (x.size(channel_dim) != y.size(channel_dim)) {
+                        throw std::invalid_argument("Arguments 'x' and 'y' must have the same number of channels.");
+                    }
+                    if (misc::make_opts(x) != misc::make_opts(y)) {
+                        throw std::invalid_argument("Arguments 'x' and 'y' must have the same dtype and device.");
+                    }
+                }
+            }
+
+            void gram_checkargs(torch::Tensor x, torch::Tensor y, s_size_type depth, bool symmetric) {
+                if (depth < 1) {
+                    throw std::invalid_argument("Argument 'depth' must be an integer greater than or equal to one.");
+                }
+                kernel_checkargs(x, y, symmetric);
+            }
+
+            // Returns the increments of the path in the shape (batch, stream, channel), and contiguous, so that the
+            // increments of each batch element sit together in memory.
+            torch::Tensor batch_major_increments(torch::Tensor path) {
+                return signature::detail::compute_path_increments(path, /*basepoint=*/false,
+                                                                  torch::empty({0}, misc::make_opts(path)),
+                                                                  /*inverse=*/false).transpose(0, 1).contiguous();
+            }
+
+            // The blocks of the Gram matrix that need computing. If the Gram matrix is symmetric then only those blocks
+            // on or above the diagonal are computed.
+            std::vector<std::pair<int64_t, int64_t>> gram_blocks(int64_t batch_x, int64_t batch_y, bool symmetric) {
+                int64_t blocks_x = (batch_x + gram_block_size - 1) / gram_block_size;
+                int64_t blocks_y = (batch_y + gram_block_size - 1) / gram_block_size;
+                std::vector<std::pair<int64_t, int64_t>> blocks;
+                for (int64_t block_x = 0; block_x < blocks_x; ++block_x) {
+                    for (int64_t block_y = symmetric ? block_x : 0; block_y < blocks_y; ++block_y) {
+                        blocks.emplace_back(block_x, block_y);
+                    }
+                }
+                return blocks;
+            }
+
+            int64_t gram_threads(int64_t num_blocks) {
+                int64_t num_threads = std::min({static_cast<int64_t>(omp_get_max_threads()), get_max_parallelism(),
+                                                num_blocks});
+                return std::max(num_threads, static_cast<int64_t>(1));
+            }
+
+            // The signature of a piecewise linear path is exp(dx_1) \otimes ... \otimes exp(dx_I), where dx_i are its
+            // increments. Expanding this out, the inner product between the level k terms of the signatures of x and y
+            // is a sum over pairs of nondecreasing sequences i_1 <= ... <= i_k and j_1 <= ... <= j_k of
+            // \prod_m <dx_{i_m}, dy_{j_m}>, divided by r! for every run of r repeated indices in either sequence.
+            //
+            // That is, it is a sum over walks of k steps through the grid of inner products <dx_i, dy_j>, which only
+            // ever move rightwards and downwards (or stay still). We sum over these walks with a dynamic programme, one
+            // level at a time: the state of a walk is its current cell (i, j), together with the number of steps a and
+            // b that it has so far spent in row i and column j, as these determine the factorial weights. Overall
+            // this costs O(depth^3 I J), and never needs any more memory than that for the states at one level.
+            //
+            // (The usual O(depth I J) Horner scheme for signature kernels doesn't track a and b, and as such computes
+            // the kernel of the discrete-time signature, which isn't the same as the signature of the piecewise linear
+            // path.)
+            //
+            // The states at level k are stored in a flat array, indexed by ((i * J + j) * k + (a - 1)) * k + (b - 1).
+
+            template <typename scalar_t>
+            std::vector<scalar_t> gram_reciprocals(s_size_type depth) {
+                // Index zero is never used
+                std::vector<scalar_t> reciprocals(depth + 2, 0);
+                for (s_size_type index = 1; index < depth + 2; ++index) {
+                    reciprocals[index] = static_cast<scalar_t>(1) / static_cast<scalar_t>(index);
+                }
+                return reciprocals;
+            }
+
+            template <typename scalar_t>
+            struct GramScratch {
+                GramScratch(int64_t num_x_increments, int64_t num_y_increments, s_size_type depth, bool backward) :
+                    increment_gram(num_x_increments * num_y_increments),
+                    forward(num_x_increments * num_y_increments * depth * depth),
+                    pre(num_x_increments * num_y_increments * depth * depth),
+                    row_a(depth),
+                    col_b(num_y_increments * depth),
+                    col_t(num_y_increments)
+                {
+                    if (backward) {
+                        grad_increment_gram.resize(num_x_increments * num_y_increments);
+                        pre_all.resize(num_x_increments * num_y_increments * (depth * (depth + 1) * (2 * depth + 1))
+                                       / 6);
+                        continuation.resize(num_x_increments * num_y_increments * depth * depth);
+                        continuation_next.resize(num_x_increments * num_y_increments * depth * depth);
+                    }
+                }
+
+                // The inner products <dx_i, dy_j>
+                std::vector<scalar_t> increment_gram;
+                // The sum of the weights of the walks ending in each state
+                std::vector<scalar_t> forward;
+                // As 'forward', except without the factor of <dx_i, dy_j> from the final step
+                std::vector<scalar_t> pre;
+                // Running sums over the rows, columns, and the whole of the grid
+                std::vector<scalar_t> row_a;
+                std::vector<scalar_t> col_b;
+                std::vector<scalar_t> col_t;
+
+                // Only used in the backward pass
+                std::vector<scalar_t> grad_increment_gram;
+                // 'pre' at every level
+                std::vector<scalar_t> pre_all;
+                // The sum of the weights of every way of continuing a walk from each state
+                std::vector<scalar_t> continuation;
+                std::vector<scalar_t> continuation_next;
+            };
+
+            // Computes the inner products <dx_i, dy_j>.
+            template <typename scalar_t>
+            void increment_gram(const scalar_t* x_increments, const scalar_t* y_increments, int64_t num_x_increments,
+                                int64_t num_y_increments, int64_t channels, scalar_t* out) {
+                for (int64_t i = 0; i < num_x_increments; ++i) {
+                    for (int64_t j = 0; j < num_y_increments; ++j) {
+                        scalar_t inner_product = 0;
+                        for (int64_t channel = 0; channel < channels; ++channel) {
+                            inner_product += x_increments[i * channels + channel] *
+                                             y_increments[j * channels + channel];
+                        }
+                        out[i * num_y_increments + j] = inner_product;
+                    }
+                }
+            }
+
+            // Backwards through increment_gram, accumulating the gradients on to 'grad_x_increments' and
+            // 'grad_y_increments' (which may be the same memory), with each entry of 'grad' additionally multiplied by
+            // 'scale'.
+            template <typename scalar_t>
+            void increment_gram_backward(const scalar_t* grad, scalar_t scale, const scalar_t* x_increments,
+                                         const scalar_t* y_increments, int64_t num_x_increments,
+                                         int64_t num_y_increments, int64_t channels, scalar_t* grad_x_increments,
+                                         scalar_t* grad_y_increments) {
+                for (int64_t i = 0; i < num_x_increments; ++i) {
+                    for (int64_t j = 0; j < num_y_increments; ++j) {
+                        scalar_t weight = scale * grad[i * num_y_increments + j];
+                        for (int64_t channel = 0; channel < channels; ++channel) {
+                            grad_x_increments[i * channels + channel] += weight * y_increments[j * channels + channel];
+                            grad_y_increments[j * channels + channel] += weight * x_increments[i * channels + channel];
+                        }
+                    }
+                }
+            }
+
+            // Takes 'forward' at level k and computes 'pre' at level k + 1.
+            template <typename scalar_t>
+            void gram_step_forward(const scalar_t* forward, s_size_type k, int64_t num_x_increments,
+                                   int64_t num_y_increments, const scalar_t* reciprocals, scalar_t* pre,
+                                   GramScratch<scalar_t>& scratch) {
+                s_size_type k_next = k + 1;
+                std::fill(scratch.col_b.begin(), scratch.col_b.begin() + num_y_increments * k, 0);
+                std::fill(scratch.col_t.begin(), scratch.col_t.end(), 0);
+                for (int64_t i = 0; i < num_x_increments; ++i) {
+                    std::fill(scratch.row_a.begin(), scratch.row_a.begin() + k, 0);
+                    // The sum of every state in every cell above and to the left of (i, j)
+                    scalar_t diag = 0;
+                    for (int64_t j = 0; j < num_y_increments; ++j) {
+                        int64_t cell = i * num_y_increments + j;
+                        const scalar_t* forward_at_cell = forward + cell * k * k;
+                        scalar_t* pre_at_cell = pre + cell * k_next * k_next;
+
+                        // Arriving in a new row and a new column
+                        pre_at_cell[0] = diag;
+                        for (s_size_type a = 1; a <= k; ++a) {
+                            // Staying in the same row, arriving in a new column
+                            pre_at_cell[a * k_next] = scratch.row_a[a - 1] * reciprocals[a + 1];
+                        }
+                        for (s_size_type b = 1; b <= k; ++b) {
+                            // Staying in the same column, arriving in a new row
+                            pre_at_cell[b] = scratch.col_b[j * k + b - 1] * reciprocals[b + 1];
+                        }
+                        for (s_size_type a = 1; a <= k; ++a) {
+                            for (s_size_type b = 1; b <= k; ++b) {
+                                // Staying in the same cell
+                                pre_at_cell[a * k_next + b] = forward_at_cell[(a - 1) * k + b - 1] *
+                                                              reciprocals[a + 1] * reciprocals[b + 1];
+                            }
+                        }
+
+                        diag += scratch.col_t[j];
+                        scalar_t total = 0;
+                        for (s_size_type a = 1; a <= k; ++a) {
+                            for (s_size_type b = 1; b <= k; ++b) {
+                                scalar_t weight = forward_at_cell[(a - 1) * k + b - 1];
+                                scratch.row_a[a - 1] += weight;
+                                scratch.col_b[j * k + b - 1] += weight;
+                                total += weight;
+                            }
+                        }
+                        scratch.col_t[j] += total;
+                    }
+                }
+            }
+
+            // Takes 'continuation' at level k + 1 and computes 'continuation' at level k. This is the adjoint of
+            // gram_step_forward.
+            template <typename scalar_t>
+            void gram_step_backward(const scalar_t* continuation, s_size_type k, int64_t num_x_increments,
+                                    int64_t num_y_increments, const scalar_t* increment_gram,
+                                    const scalar_t* reciprocals, scalar_t* continuation_next,
+                                    GramScratch<scalar_t>& scratch) {
+                s_size_type k_next = k + 1;
+                std::fill(scratch.col_b.begin(), scratch.col_b.begin() + num_y_increments * k, 0);
+                std::fill(scratch.col_t.begin(), scratch.col_t.end(), 0);
+                for (int64_t i = num_x_increments - 1; i >= 0; --i) {
+                    std::fill(scratch.row_a.begin(), scratch.row_a.begin() + k, 0);
+                    // The sum over every cell below and to the right of (i, j)
+                    scalar_t diag = 0;
+                    for (int64_t j = num_y_increments - 1; j >= 0; --j) {
+                        int64_t cell = i * num_y_increments + j;
+                        const scalar_t* continuation_at_cell = continuation + cell * k_next * k_next;
+                        scalar_t* continuation_next_at_cell = continuation_next + cell * k * k;
+                        scalar_t gram_at_cell = increment_gram[cell];
+
+                        for (s_size_type a = 1; a <= k; ++a) {
+                            for (s_size_type b = 1; b <= k; ++b) {
+                                // One for stopping here, plus every way of taking another step.
+                                continuation_next_at_cell[(a - 1) * k + b - 1] =
+                                        1 + diag +
+                                        scratch.row_a[a - 1] * reciprocals[a + 1] +
+                                        scratch.col_b[j * k + b - 1] * reciprocals[b + 1] +
+                                        gram_at_cell * continuation_at_cell[a * k_next + b] * reciprocals[a + 1] *
+                                        reciprocals[b + 1];
+                            }
+                        }
+
+                        diag += scratch.col_t[j];
+                        scratch.col_t[j] += gram_at_cell * continuation_at_cell[0];
+                        for (s_size_type a = 1; a <= k; ++a) {
+                            scratch.row_a[a - 1] += gram_at_cell * continuation_at_cell[a * k_next];
+                        }
+                        for (s_size_type b = 1; b <= k; ++b) {
+                            scratch.col_b[j * k + b - 1] += gram_at_cell * continuation_at_cell[b];
+                        }
+                    }
+                }
+            }
+
+            // Computes the inner product of the signatures of one pair of paths, from scratch.increment_gram.
+            template <typename scalar_t>
+            scalar_t gram_pair_forward(int64_t num_x_increments, int64_t num_y_increments, s_size_type depth,
+                                       const scalar_t* reciprocals, GramScratch<scalar_t>& scratch) {
+                int64_t num_cells = num_x_increments * num_y_increments;
+                const scalar_t* increment_gram = scratch.increment_gram.data();
+                scalar_t* forward = scratch.forward.data();
+                scalar_t* pre = scratch.pre.data();
+
+                // Every walk of one step just sits in a single cell
+                scalar_t result = 0;
+                for (int64_t cell = 0; cell < num_cells; ++cell) {
+                    forward[cell] = increment_gram[cell];
+                    result += increment_gram[cell];
+                }
+                for (s_size_type k = 1; k < depth; ++k) {
+                    gram_step_forward(forward, k, num_x_increments, num_y_increments, reciprocals, pre, scratch);
+                    int64_t num_states = (k + 1) * (k + 1);
+                    for (int64_t cell = 0; cell < num_cells; ++cell) {
+                        for (int64_t state = 0; state < num_states; ++state) {
+                            scalar_t weight = pre[cell * num_states + state] * increment_gram[cell];
+                            forward[cell * num_states + state] = weight;
+                            result += weight;
+                        }
+                    }
+                }
+                return result;
+            }
+
+            // Computes the gradient of the inner product of the signatures of one pair of paths with respect to
+            // scratch.increment_gram, and stores it in scratch.grad_increment_gram.
+            template <typename scalar_t>
+            void gram_pair_backward(int64_t num_x_increments, int64_t num_y_increments, s_size_type depth,
+                                    const scalar_t* reciprocals, GramScratch<scalar_t>& scratch) {
+                int64_t num_cells = num_x_increments * num_y_increments;
+                const scalar_t* increment_gram = scratch.increment_gram.data();
+                scalar_t* grad_increment_gram = scratch.grad_increment_gram.data();
+                scalar_t* forward = scratch.forward.data();
+                auto level_offset = [num_cells] (s_size_type k) {
+                    return num_cells * (((k - 1) * k * (2 * k - 1)) / 6);
+                };
+
+                // Recompute the forward pass, this time keeping 'pre' at every level
+                scalar_t* pre_all = scratch.pre_all.data();
+                for (int64_t cell = 0; cell < num_cells; ++cell) {
+                    pre_all[cell] = 1;
+                    forward[cell] = increment_gram[cell];
+                }
+                for (s_size_type k = 1; k < depth; ++k) {
+                    scalar_t* pre = pre_all + level_offset(k + 1);
+                    gram_step_forward(forward, k, num_x_increments, num_y_increments, reciprocals, pre, scratch);
+                    int64_t num_states = (k + 1) * (k + 1);
+                    for (int64_t cell = 0; cell < num_cells; ++cell) {
+                        for (int64_t state = 0; state < num_states; ++state) {
+                            forward[cell * num_states + state] = pre[cell * num_states + state] * increment_gram[cell];
+                        }
+                    }
+                }
+
+                // Every walk that has reached the final level must stop
+                int64_t num_states = depth * depth;
+                scalar_t* pre = pre_all + level_offset(depth);
+                std::fill(scratch.continuation.begin(), scratch.continuation.begin() + num_cells * num_states, 1);
+                for (int64_t cell = 0; cell < num_cells; ++cell) {
+                    scalar_t grad = 0;
+                    for (int64_t state = 0; state < num_states; ++state) {
+                        grad += pre[cell * num_states + state];
+                    }
+                    grad_increment_gram[cell] = grad;
+                }
+
+                // The derivative with respect to <dx_i, dy_j> is the sum over every state in cell (i, j), of the weight
+                // of arriving in that state multiplied by the weight of continuing on from it.
+                for (s_size_type k = depth - 1; k >= 1; --k) {
+                    gram_step_backward(scratch.continuation.data(), k, num_x_increments, num_y_increments,
+                                       increment_gram, reciprocals, scratch.continuation_next.data(), scratch);
+                    num_states = k * k;
+                    pre = pre_all + level_offset(k);
+                    const scalar_t* continuation = scratch.continuation_next.data();
+                    for (int64_t cell = 0; cell < num_cells; ++cell) {
+                        scalar_t grad = 0;
+                        for (int64_t state = 0; state < num_states; ++state) {
+                            grad += pre[cell * num_states + state] * continuation[cell * num_states + state];
+                        }
+                        grad_increment_gram[cell] += grad;
+                    }
+                    scratch.continuation.swap(scratch.continuation_next);
+                }
+            }
+
+            template <typename scalar_t>
+            void gram_forward_cpu(torch::Tensor x_increments, torch::Tensor y_increments, s_size_type depth,
+                                  bool symmetric, torch::Tensor gram) {
+                int64_t batch_x = x_increments.size(0);
+                int64_t batch_y = y_increments.size(0);
+                int64_t num_x_increments = x_increments.size(1);
+                int64_t num_y_increments = y_increments.size(1);
+                int64_t channels = x_increments.size(2);
+                scalar_t* x_data = x_increments.data<scalar_t>();
+                scalar_t* y_data = y_increments.data<scalar_t>();
+                scalar_t* gram_data = gram.data<scalar_t>();
+                std::vector<scalar_t> reciprocals = gram_reciprocals<scalar_t>(depth);
+
+                std::vector<std::pair<int64_t, int64_t>> blocks = gram_blocks(batch_x, batch_y, symmetric);
+                int64_t num_blocks = blocks.size();
+                int64_t num_threads = gram_threads(num_blocks);
+                std::vector<GramScratch<scalar_t>> scratch_by_thread(num_threads,
+                                                                     GramScratch<scalar_t>(num_x_increments,
+                                                                                           num_y_increments,
+                                                                                           depth,
+                                                                                           /*backward=*/false));
+
+                #pragma omp parallel for default(none) \
+                                         if(num_threads > 1) \
+                                         num_threads(num_threads) \
+                                         schedule(dynamic, 1) \
+                                         shared(num_blocks, blocks, batch_x, batch_y, num_x_increments, \
+                                                num_y_increments, channels, x_data, y_data, gram_data, reciprocals, \
+                                                scratch_by_thread, depth, symmetric)
+                for (int64_t block_index = 0; block_index < num_blocks; ++block_index) {
+                    GramScratch<scalar_t>& scratch = scratch_by_thread[omp_get_thread_num()];
+                    int64_t x_start = blocks[block_index].first * gram_block_size;
+                    int64_t x_end = std::min(x_start + gram_block_size, batch_x);
+                    int64_t y_start = blocks[block_index].second * gram_block_size;
+                    int64_t y_end = std::min(y_start + gram_block_size, batch_y);
+                    for (int64_t x_index = x_start; x_index < x_end; ++x_index) {
+                        for (int64_t y_index = symmetric ? std::max(y_start, x_index) : y_start; y_index < y_end;
+                             ++y_index) {
+                            increment_gram(x_data + x_index * num_x_increments * channels,
+                                           y_data + y_index * num_y_increments * channels,
+                                           num_x_increments, num_y_increments, channels,
+                                           scratch.increment_gram.data());
+                            scalar_t value = gram_pair_forward(num_x_increments, num_y_increments, depth,
+                                                               reciprocals.data(), scratch);
+                            gram_data[x_index * batch_y + y_index] = value;
+                            if (symmetric) {
+                                gram_data[y_index * batch_y + x_index] = value;
+                            }
+                        }
+                    }
+                }
+            }
+
+            template <typename scalar_t>
+            void gram_backward_cpu(torch::Tensor grad_gram, torch::Tensor x_increments, torch::Tensor y_increments,
+                                   s_size_type depth, bool symmetric, torch::Tensor grad_x_increments,
+                                   torch::Tensor grad_y_increments) {
+                int64_t batch_x = x_increments.size(0);
+                int64_t batch_y = y_increments.size(0);
+                int64_t num_x_increments = x_increments.size(1);
+                int64_t num_y_increments = y_increments.size(1);
+                int64_t channels = x_increments.size(2);
+                scalar_t* x_data = x_increments.data<scalar_t>();
+                scalar_t* y_data = y_increments.data<scalar_t>();
+                scalar_t* grad_gram_data = grad_gram.data<scalar_t>();
+                std::vector<scalar_t> reciprocals = gram_reciprocals<scalar_t>(depth);
+
+                std::vector<std::pair<int64_t, int64_t>> blocks = gram_blocks(batch_x, batch_y, symmetric);
+                int64_t num_blocks = blocks.size();
+                int64_t num_threads = gram_threads(num_blocks);
+                std::vector<GramScratch<scalar_t>> scratch_by_thread(num_threads,
+                                                                     GramScratch<scalar_t>(num_x_increments,
+                                                                                           num_y_increments,
+                                                                                           depth,
+                                                                                           /*backward=*/true));
+                // The pairs overlap, so every thread gets its own tensors to accumulate gradients in; these are then
+                // summed at the end.
+                std::vector<torch::Tensor> grad_x_by_thread(num_threads);
+                std::vector<torch::Tensor> grad_y_by_thread(num_threads);
+                grad_x_by_thread[0] = grad_x_increments;
+                grad_y_by_thread[0] = grad_y_increments;
+                for (int64_t thread_index = 1; thread_index < num_threads; ++thread_index) {
+                    grad_x_by_thread[thread_index] = torch::zeros_like(grad_x_increments);
+                    if (!symmetric) {
+                        grad_y_by_thread[thread_index] = torch::zeros_like(grad_y_increments);
+                    }
+                }
+
+                #pragma omp parallel for default(none) \
+                                         if(num_threads > 1) \
+                                         num_threads(num_threads) \
+                                         schedule(dynamic, 1) \
+                                         shared(num_blocks, blocks, batch_x, batch_y, num_x_increments, \
+                                                num_y_increments, channels, x_data, y_data, grad_gram_data, \
+                                                reciprocals, scratch_by_thread, grad_x_by_thread, grad_y_by_thread, \
+                                                depth, symmetric)
+                for (int64_t block_index = 0; block_index < num_blocks; ++block_index) {
+                    int64_t thread_index = omp_get_thread_num();
+                    GramScratch<scalar_t>& scratch = scratch_by_thread[thread_index];
+                    scalar_t* grad_x_data = grad_x_by_thread[thread_index].data<scalar_t>();
+                    // If symmetric then y is x
+                    scalar_t* grad_y_data = symmetric ? grad_x_data : grad_y_by_thread[thread_index].data<scalar_t>();
+                    int64_t x_start = blocks[block_index].first * gram_block_size;
+                    int64_t x_end = std::min(x_start + gram_block_size, batch_x);
+                    int64_t y_start = blocks[block_index].second * gram_block_size;
+                    int64_t y_end = std::min(y_start + gram_block_size, batch_y);
+                    for (int64_t x_index = x_start; x_index < x_end; ++x_index) {
+                        for (int64_t y_index = symmetric ? std::max(y_start, x_index) : y_start; y_index < y_end;
+                             ++y_index) {
+                            scalar_t grad = grad_gram_data[x_index * batch_y + y_index];
+                            if (symmetric && x_index != y_index) {
+                                grad += grad_gram_data[y_index * batch_y + x_index];
+                            }
+                            if (grad == 0) {
+                                continue;
+                            }
+
+                            scalar_t* x_increments_at_index = x_data + x_index * num_x_increments * channels;
+                            scalar_t* y_increments_at_index = y_data + y_index * num_y_increments * channels;
+                            increment_gram(x_increments_at_index, y_increments_at_index, num_x_increments,
+                                           num_y_increments, channels, scratch.increment_gram.data());
+                            gram_pair_backward(num_x_increments, num_y_increments, depth, reciprocals.data(),
+                                               scratch);
+
+                            increment_gram_backward(scratch.grad_increment_gram.data(), grad, x_increments_at_index,
+                                                    y_increments_at_index, num_x_increments, num_y_increments,
+                                                    channels, grad_x_data + x_index * num_x_increments * channels,
+                                                    grad_y_data + y_index * num_y_increments * channels);
+                        }
+                    }
+                }
+
+                for (int64_t thread_index = 1; thread_index < num_threads; ++thread_index) {
+                    grad_x_increments += grad_x_by_thread[thread_index];
+                    if (!symmetric) {
+                        grad_y_increments += grad_y_by_thread[thread_index];
+                    }
+                }
+            }
+
+            // The untruncated signature kernel k(s, t) = <Sig(x|[0, s]), Sig(y|[0, t])> (including the scalar term)
+            // solves the Goursat PDE
+            // d^2 k / ds dt = <dx/ds, dy/dt> k,     k(0, .) = k(., 0) = 1.
+            // We solve this with the second-order explicit finite difference scheme of Salvi et al. 2021, "The
+            // signature kernel is the solution of a Goursat PDE", on a grid in which every increment of each path is
+            // split into 2^dyadic_order equal pieces. Cell (p, q) of the grid depends only on cells (p - 1, q),
+            // (p, q - 1) and (p - 1, q - 1), so every anti-diagonal of the grid may be computed in parallel.
+            //
+            // The backward pass is the adjoint of this scheme, which is itself the discretisation of the adjoint PDE,
+            // solved from the opposite corner of the grid. So the gradients computed are exactly those of the
+            // discretised solution.
+            //
+            // The solution is stored row-major on a grid of size (rows + 1, columns + 1), where
+            // rows = num_x_increments * 2^dyadic_order and columns = num_y_increments * 2^dyadic_order.
+
+            void pde_checkargs(torch::Tensor x, torch::Tensor y, int64_t dyadic_order, bool symmetric) {
+                if (dyadic_order < 0) {
+                    throw std::invalid_argument("Argument 'dyadic_order' must be an integer greater than or equal to "
+                                                "zero.");
+                }
+                kernel_checkargs(x, y, symmetric);
+            }
+
+            template <typename scalar_t>
+            struct PDEScratch {
+                PDEScratch(int64_t num_x_increments, int64_t num_y_increments, int64_t dyadic_order, bool backward) :
+                    increment_gram(num_x_increments * num_y_increments),
+                    solution(((num_x_increments << dyadic_order) + 1) * ((num_y_increments << dyadic_order) + 1))
+                {
+                    if (backward) {
+                        adjoint.resize(solution.size());
+                        grad_refined_gram.resize((num_x_increments << dyadic_order) *
+                                                 (num_y_increments << dyadic_order));
+                        grad_increment_gram.resize(num_x_increments * num_y_increments);
+                    }
+                }
+
+                // The inner products <dx_i, dy_j>
+                std::vector<scalar_t> increment_gram;
+                // The solution of the PDE at every point of the grid
+                std::vector<scalar_t> solution;
+
+                // Only used in the backward pass
+                // The solution of the adjoint PDE at every point of the grid
+                std::vector<scalar_t> adjoint;
+                // The gradient with respect to the inner product of the increments in each cell of the grid
+                std::vector<scalar_t> grad_refined_gram;
+                std::vector<scalar_t> grad_increment_gram;
+            };
+
+            // The number of threads to sweep over the anti-diagonals of one grid with.
+            int64_t wavefront_threads(int64_t rows, int64_t columns) {
+                int64_t num_threads = std::min({static_cast<int64_t>(omp_get_max_threads()), get_max_parallelism(),
+                                                std::min(rows, columns)});
+                return std::max(num_threads, static_cast<int64_t>(1));
+            }
+
+            // Solves the PDE for one pair of paths, from scratch.increment_gram, storing the whole solution in
+            // scratch.solution.
+            template <typename scalar_t>
+            scalar_t pde_pair_forward(int64_t num_x_increments, int64_t num_y_increments, int64_t dyadic_order,
+                                      int64_t num_threads, PDEScratch<scalar_t>& scratch) {
+                int64_t rows = num_x_increments << dyadic_order;
+                int64_t columns = num_y_increments << dyadic_order;
+                int64_t width = columns + 1;
+                // Each increment is split into 2^dyadic_order pieces, so the inner product between pieces is scaled by
+                // 4^(-dyadic_order).
+                scalar_t scale = std::ldexp(static_cast<scalar_t>(1), -2 * dyadic_order);
+                const scalar_t* increment_gram = scratch.increment_gram.data();
+                scalar_t* solution = scratch.solution.data();
+
+                auto update = [=] (int64_t p, int64_t q) {
+                    scalar_t inner_product = increment_gram[((p - 1) >> dyadic_order) * num_y_increments +
+                                                            ((q - 1) >> dyadic_order)] * scale;
+                    scalar_t inner_product_squared = inner_product * inner_product / 12;
+                    solution[p * width + q] = (solution[p * width + q - 1] + solution[(p - 1) * width + q]) *
+                                              (1 + inner_product / 2 + inner_product_squared) -
+                                              solution[(p - 1) * width + q - 1] * (1 - inner_product_squared);
+                };
+
+                std::fill(solution, solution + width, 1);
+                for (int64_t p = 1; p <= rows; ++p) {
+                    solution[p * width] = 1;
+                }
+                if (num_threads == 1) {
+                    for (int64_t p = 1; p <= rows; ++p) {
+                        for (int64_t q = 1; q <= columns; ++q) {
+                            update(p, q);
+                        }
+                    }
+                }
+                else {
+                    #pragma omp parallel default(none) num_threads(num_threads) shared(rows, columns, update)
+                    for (int64_t diagonal = 2; diagonal <= rows + columns; ++diagonal) {
+                        int64_t p_start = std::max(static_cast<int64_t>(1), diagonal - columns);
+                        int64_t p_end = std::min(rows, diagonal - 1);
+                        #pragma omp for schedule(static)
+                        for (int64_t p = p_start; p <= p_end; ++p) {
+                            update(p, diagonal - p);
+                        }
+                    }
+                }
+                return solution[rows * width + columns];
+            }
+
+            // Computes the gradient of the solution with respect to scratch.increment_gram, given that scratch.solution
+            // has already been computed by pde_pair_forward, and stores it in scratch.grad_increment_gram.
+            template <typename scalar_t>
+            void pde_pair_backward(int64_t num_x_increments, int64_t num_y_increments, int64_t dyadic_order,
+                                   int64_t num_threads, PDEScratch<scalar_t>& scratch) {
+                int64_t rows = num_x_increments << dyadic_order;
+                int64_t columns = num_y_increments << dyadic_order;
+                int64_t width = columns + 1;
+                scalar_t scale = std::ldexp(static_cast<scalar_t>(1), -2 * dyadic_order);
+                const scalar_t* increment_gram = scratch.increment_gram.data();
+                const scalar_t* solution = scratch.solution.data();
+                scalar_t* adjoint = scratch.adjoint.data();
+                scalar_t* grad_refined_gram = scratch.grad_refined_gram.data();
+
+                auto refined_gram = [=] (int64_t p, int64_t q) {
+                    return increment_gram[(p >> dyadic_order) * num_y_increments + (q >> dyadic_order)] * scale;
+                };
+                // Cell (p, q) of the solution is updated with the factors
+                // alpha = 1 + g / 2 + g^2 / 12 and beta = 1 - g^2 / 12, where g = refined_gram(p - 1, q - 1).
+                auto update = [=] (int64_t p, int64_t q) {
+                    scalar_t adjoint_at_cell = (p == rows && q == columns) ? 1 : 0;
+                    if (q < columns) {
+                        scalar_t inner_product = refined_gram(p - 1, q);
+                        adjoint_at_cell += adjoint[p * width + q + 1] *
+                                           (1 + inner_product / 2 + inner_product * inner_product / 12);
+                    }
+                    if (p < rows) {
+                        scalar_t inner_product = refined_gram(p, q - 1);
+                        adjoint_at_cell += adjoint[(p + 1) * width + q] *
+                                           (1 + inner_product / 2 + inner_product * inner_product / 12);
+                    }
+                    if (p < rows && q < columns) {
+                        scalar_t inner_product = refined_gram(p, q);
+                        adjoint_at_cell -= adjoint[(p + 1) * width + q + 1] *
+                                           (1 - inner_product * inner_product / 12);
+                    }
+                    adjoint[p * width + q] = adjoint_at_cell;
+
+                    // d alpha / dg = 1 / 2 + g / 6 and d beta / dg = -g / 6
+                    scalar_t inner_product = refined_gram(p - 1, q - 1);
+                    grad_refined_gram[(p - 1) * columns + q - 1] =
+                            adjoint_at_cell * ((solution[p * width + q - 1] + solution[(p - 1) * width + q]) *
+                                               (static_cast<scalar_t>(0.5) + inner_product / 6) +
+                                               solution[(p - 1) * width + q - 1] * inner_product / 6);
+                };
+
+                if (num_threads == 1) {
+                    for (int64_t p = rows; p >= 1; --p) {
+                        for (int64_t q = columns; q >= 1; --q) {
+                            update(p, q);
+                        }
+                    }
+                }
+                else {
+                    #pragma omp parallel default(none) num_threads(num_threads) shared(rows, columns, update)
+                    for (int64_t diagonal = rows + columns; diagonal >= 2; --diagonal) {
+                        int64_t p_start = std::max(static_cast<int64_t>(1), diagonal - columns);
+                        int64_t p_end = std::min(rows, diagonal - 1);
+                        #pragma omp for schedule(static)
+                        for (int64_t p = p_start; p <= p_end; ++p) {
+                            update(p, diagonal - p);
+                        }
+                    }
+                }
+
+                // Every piece of the grid derived from the same pair of increments contributes to the same gradient
+                std::fill(scratch.grad_increment_gram.begin(), scratch.grad_increment_gram.end(), 0);
+                for (int64_t p = 0; p < rows; ++p) {
+                    for (int64_t q = 0; q < columns; ++q) {
+                        scratch.grad_increment_gram[(p >> dyadic_order) * num_y_increments + (q >> dyadic_order)] +=
+                                grad_refined_gram[p * columns + q] * scale;
+                    }
+                }
+            }
+
+            // If there are enough pairs of paths to occupy every thread then we parallelise over the pairs. Else we
+            // parallelise over the anti-diagonals of the grid for each pair in turn. Returns the number of threads to
+            // use for each of these.
+            std::pair<int64_t, int64_t> pde_threads(int64_t num_pairs, int64_t num_blocks, int64_t rows,
+                                                    int64_t columns) {
+                int64_t max_threads = std::min(static_cast<int64_t>(omp_get_max_threads()), get_max_parallelism());
+                if (num_pairs >= max_threads) {
+                    return {gram_threads(num_blocks), 1};
+                }
+                return {1, wavefront_threads(rows, columns)};
+            }
+
+            template <typename scalar_t>
+            void pde_forward_cpu(torch::Tensor x_increments, torch::Tensor y_increments, int64_t dyadic_order,
+                                 bool symmetric, torch::Tensor kernel) {
+                int64_t batch_x = x_increments.size(0);
+                int64_t batch_y = y_increments.size(0);
+                int64_t num_x_increments = x_increments.size(1);
+                int64_t num_y_increments = y_increments.size(1);
+                int64_t channels = x_increments.size(2);
+                scalar_t* x_data = x_increments.data<scalar_t>();
+                scalar_t* y_data = y_increments.data<scalar_t>();
+                scalar_t* kernel_data = kernel.data<scalar_t>();
+
+                std::vector<std::pair<int64_t, int64_t>> blocks = gram_blocks(batch_x, batch_y, symmetric);
+                int64_t num_blocks = blocks.size();
+                int64_t num_pairs = symmetric ? (batch_x * (batch_x + 1)) / 2 : batch_x * batch_y;
+                int64_t num_threads;
+                int64_t num_wavefront_threads;
+                std::tie(num_threads, num_wavefront_threads) = pde_threads(num_pairs, num_blocks,
+                                                                           num_x_increments << dyadic_order,
+                                                                           num_y_increments << dyadic_order);
+                std::vector<PDEScratch<scalar_t>> scratch_by_thread(num_threads,
+                                                                    PDEScratch<scalar_t>(num_x_increments,
+                                                                                         num_y_increments,
+                                                                                         dyadic_order,
+                                                                                         /*backward=*/false));
+
+                #pragma omp parallel for default(none) \
+                                         if(num_threads > 1) \
+                                         num_threads(num_threads) \
+                                         schedule(dynamic, 1) \
+                                         shared(num_blocks, blocks, batch_x, batch_y, num_x_increments, \
+                                                num_y_increments, channels, x_data, y_data, kernel_data, \
+                                                scratch_by_thread, dyadic_order, symmetric, num_wavefront_threads)
+                for (int64_t block_index = 0; block_index < num_blocks; ++block_index) {
+                    PDEScratch<scalar_t>& scratch = scratch_by_thread[omp_get_thread_num()];
+                    int64_t x_start = blocks[block_index].first * gram_block_size;
+                    int64_t x_end = std::min(x_start + gram_block_size, batch_x);
+                    int64_t y_start = blocks[block_index].second * gram_block_size;
+                    int64_t y_end = std::min(y_start + gram_block_size, batch_y);
+                    for (int64_t x_index = x_start; x_index < x_end; ++x_index) {
+                        for (int64_t y_index = symmetric ? std::max(y_start, x_index) : y_start; y_index < y_end;
+                             ++y_index) {
+                            increment_gram(x_data + x_index * num_x_increments * channels,
+                                           y_data + y_index * num_y_increments * channels,
+                                           num_x_increments, num_y_increments, channels,
+                                           scratch.increment_gram.data());
+                            scalar_t value = pde_pair_forward(num_x_increments, num_y_increments, dyadic_order,
+                                                              num_wavefront_threads, scratch);
+                            kernel_data[x_index * batch_y + y_index] = value;
+                            if (symmetric) {
+                                kernel_data[y_index * batch_y + x_index] = value;
+                            }
+                        }
+                    }
+                }
+            }
+
+            template <typename scalar_t>
+            void pde_backward_cpu(torch::Tensor grad_kernel, torch::Tensor x_increments, torch::Tensor y_increments,
+                                  int64_t dyadic_order, bool symmetric, torch::Tensor grad_x_increments,
+                                  torch::Tensor grad_y_increments) {
+                int64_t batch_x = x_increments.size(0);
+                int64_t batch_y = y_increments.size(0);
+                int64_t num_x_increments = x_increments.size(1);
+                int64_t num_y_increments = y_increments.size(1);
+                int64_t channels = x_increments.size(2);
+                scalar_t* x_data = x_increments.data<scalar_t>();
+                scalar_t* y_data = y_increments.data<scalar_t>();
+                scalar_t* grad_kernel_data = grad_kernel.data<scalar_t>();
+
+                std::vector<std::pair<int64_t, int64_t>> blocks = gram_blocks(batch_x, batch_y, symmetric);
+                int64_t num_blocks = blocks.size();
+                int64_t num_pairs = symmetric ? (batch_x * (batch_x + 1)) / 2 : batch_x * batch_y;
+                int64_t num_threads;
+                int64_t num_wavefront_threads;
+                std::tie(num_threads, num_wavefront_threads) = pde_threads(num_pairs, num_blocks,
+                                                                           num_x_increments << dyadic_order,
+                                                                           num_y_increments << dyadic_order);
+                std::vector<PDEScratch<scalar_t>> scratch_by_thread(num_threads,
+                                                                    PDEScratch<scalar_t>(num_x_increments,
+                                                                                         num_y_increments,
+                                                                                         dyadic_order,
+                                                                                         /*backward=*/true));
+                // The pairs overlap, so every thread gets its own tensors to accumulate gradients in; these are then
+                // summed at the end.
+                std::vector<torch::Tensor> grad_x_by_thread(num_threads);
+                std::vector<torch::Tensor> grad_y_by_thread(num_threads);
+                grad_x_by_thread[0] = grad_x_increments;
+                grad_y_by_thread[0] = grad_y_increments;
+                for (int64_t thread_index = 1; thread_index < num_threads; ++thread_index) {
+                    grad_x_by_thread[thread_index] = torch::zeros_like(grad_x_increments);
+                    if (!symmetric) {
+                        grad_y_by_thread[thread_index] = torch::zeros_like(grad_y_increments);
+                    }
+                }
+
+                #pragma omp parallel for default(none) \
+                                         if(num_threads > 1) \
+                                         num_threads(num_threads) \
+                                         schedule(dynamic, 1) \
+                                         shared(num_blocks, blocks, batch_x, batch_y, num_x_increments, \
+                                                num_y_increments, channels, x_data, y_data, grad_kernel_data, \
+                                                scratch_by_thread, grad_x_by_thread, grad_y_by_thread, dyadic_order, \
+                                                symmetric, num_wavefront_threads)
+                for (int64_t block_index = 0; block_index < num_blocks; ++block_index) {
+                    int64_t thread_index = omp_get_thread_num();
+                    PDEScratch<scalar_t>& scratch = scratch_by_thread[thread_index];
+                    scalar_t* grad_x_data = grad_x_by_thread[thread_index].data<scalar_t>();
+                    // If symmetric then y is x
+                    scalar_t* grad_y_data = symmetric ? grad_x_data : grad_y_by_thread[thread_index].data<scalar_t>();
+                    int64_t x_start = blocks[block_index].first * gram_block_size;
+                    int64_t x_end = std::min(x_start + gram_block_size, batch_x);
+                    int64_t y_start = blocks[block_index].second * gram_block_size;
+                    int64_t y_end = std::min(y_start + gram_block_size, batch_y);
+                    for (int64_t x_index = x_start; x_index < x_end; ++x_index) {
+                        for (int64_t y_index = symmetric ? std::max(y_start, x_index) : y_start; y_index < y_end;
+                             ++y_index) {
+                            scalar_t grad = grad_kernel_data[x_index * batch_y + y_index];
+                            if (symmetric && x_index != y_index) {
+                                grad += grad_kernel_data[y_index * batch_y + x_index];
+                            }
+                            if (grad == 0) {
+                                continue;
+                            }
+
+                            scalar_t* x_increments_at_index = x_data + x_index * num_x_increments * channels;
+                            scalar_t* y_increments_at_index = y_data + y_index * num_y_increments * channels;
+                            increment_gram(x_increments_at_index, y_increments_at_index, num_x_increments,
+                                           num_y_increments, channels, scratch.increment_gram.data());
+                            // The backward pass needs the solution over the whole grid, which we don't keep between
+                            // the forward and backward passes, as that would need a grid's worth of memory for every
+                            // pair.
+                            pde_pair_forward(num_x_increments, num_y_increments, dyadic_order, num_wavefront_threads,
+                                             scratch);
+                            pde_pair_backward(num_x_increments, num_y_increments, dyadic_order, num_wavefront_threads,
+                                              scratch);
+                            increment_gram_backward(scratch.grad_increment_gram.data(), grad, x_increments_at_index,
+                                                    y_increments_at_index, num_x_increments, num_y_increments,
+                                                    channels, grad_x_data + x_index * num_x_increments * channels,
+                                                    grad_y_data + y_index * num_y_increments * channels);
+                        }
+                    }
+                }
+
+                for (int64_t thread_index = 1; thread_index < num_threads; ++thread_index) {
+                    grad_x_increments += grad_x_by_thread[thread_index];
+                    if (!symmetric) {
+                        grad_y_increments += grad_y_by_thread[thread_index];
+                    }
+                }
+            }
+        }  // namespace signatory::kernel::detail
+    }  // namespace signatory::kernel
+
+    torch::Tensor signature_gram_forward(torch::Tensor x, torch::Tensor y, s_size_type depth, bool symmetric) {
+        kernel::detail::gram_checkargs(x, y, depth, symmetric);
+
+        x = x.detach();
+        torch::Tensor x_increments = kernel::detail::batch_major_increments(x);
+        torch::Tensor y_increments = symmetric ? x_increments : kernel::detail::batch_major_increments(y.detach());
+
+        torch::Tensor gram = torch::empty({x_increments.size(0), y_increments.size(0)}, misc::make_opts(x));
+        AT_DISPATCH_FLOATING_TYPES(x.type(), "signature_gram_forward", ([&] {
+            kernel::detail::gram_forward_cpu<scalar_t>(x_increments, y_increments, depth, symmetric, gram);
+        }));
+        return gram;
+    }
+
+    std::tuple<torch::Tensor, torch::Tensor>
+    signature_gram_backward(torch::Tensor grad_gram, torch::Tensor x, torch::Tensor y, s_size_type depth,
+                            bool symmetric) {
+        grad_gram = grad_gram.detach().contiguous();
+        x = x.detach();
+        torch::TensorOptions opts = misc::make_opts(x);
+
+        torch::Tensor x_increments = kernel::detail::batch_major_increments(x);
+        torch::Tensor y_increments = symmetric ? x_increments : kernel::detail::batch_major_increments(y.detach());
+        torch::Tensor grad_x_increments = torch::zeros_like(x_increments);
+        torch::Tensor grad_y_increments = symmetric ? torch::empty({0}, opts) : torch::zeros_like(y_increments);
+
+        AT_DISPATCH_FLOATING_TYPES(x.type(), "signature_gram_backward", ([&] {
+            kernel::detail::gram_backward_cpu<scalar_t>(grad_gram, x_increments, y_increments, depth, symmetric,
+                                                        grad_x_increments, grad_y_increments);
+        }));
+
+        // (batch, stream, channel) back to (stream, batch, channel), then backwards through the increments
+        torch::Tensor grad_x;
+        std::tie(grad_x, std::ignore) = signature::detail::compute_path_increments_backward(
+                grad_x_increments.transpose(0, 1), /*basepoint=*/false, /*inverse=*/false, opts);
+        torch::Tensor grad_y;
+        if (symmetric) {
+            grad_y = torch::empty({0}, opts);
+        }
+        else {
+            std::tie(grad_y, std::ignore) = signature::detail::compute_path_increments_backward(
+                    grad_y_increments.transpose(0, 1), /*basepoint=*/false, /*inverse=*/false, opts);
+        }
+        return std::tuple<torch::Tensor, torch::Tensor> {grad_x, grad_y};
+    }
+
+    torch::Tensor signature_kernel_forward(torch::Tensor x, torch::Tensor y, int64_t dyadic_order, bool symmetric) {
+        kernel::detail::pde_checkargs(x, y, dyadic_order, symmetric);
+
+        x = x.detach();
+        torch::Tensor x_increments = kernel::detail::batch_major_increments(x);
+        torch::Tensor y_increments = symmetric ? x_increments : kernel::detail::batch_major_increments(y.detach());
+
+        torch::Tensor kernel = torch::empty({x_increments.size(0), y_increments.size(0)}, misc::make_opts(x));
+        AT_DISPATCH_FLOATING_TYPES(x.type(), "signature_kernel_forward", ([&] {
+            kernel::detail::pde_forward_cpu<scalar_t>(x_increments, y_increments, dyadic_order, symmetric, kernel);
+        }));
+        return kernel;
+    }
+
+    std::tuple<torch::Tensor, torch::Tensor>
+    signature_kernel_backward(torch::Tensor grad_kernel, torch::Tensor x, torch::Tensor y, int64_t dyadic_order,
+                              bool symmetric) {
+        grad_kernel = grad_kernel.detach().contiguous();
+        x = x.detach();
+        torch::TensorOptions opts = misc::make_opts(x);
+
+        torch::Tensor x_increments = kernel::detail::batch_major_increments(x);
+        torch::Tensor y_increments = symmetric ? x_increments : kernel::detail::batch_major_increments(y.detach());
+        torch::Tensor grad_x_increments = torch::zeros_like(x_increments);
+        torch::Tensor grad_y_increments = symmetric ? torch::empty({0}, opts) : torch::zeros_like(y_increments);
+
+        AT_DISPATCH_FLOATING_TYPES(x.type(), "signature_kernel_backward", ([&] {
+            kernel::detail::pde_backward_cpu<scalar_t>(grad_kernel, x_increments, y_increments, dyadic_order,
+                                                       symmetric, grad_x_increments, grad_y_increments);
+        }));
+
+        // (batch, stream, channel) back to (stream, batch, channel), then backwards through the increments
+        torch::Tensor grad_x;
+        std::tie(grad_x, std::ignore) = signature::detail::compute_path_increments_backward(
+                grad_x_increments.transpose(0, 1), /*basepoint=*/false, /*inverse=*/false, opts);
+        torch::Tensor grad_y;
+        if (symmetric) {
+            grad_y = torch::empty({0}, opts);
+        }
+        else {
+            std::tie(grad_y, std::ignore) = signature::detail::compute_path_increments_backward(
+                    grad_y_increments.transpose(0, 1), /*basepoint=*/false, /*inverse=*/false, opts);
+        }
+        return std::tuple<torch::Tensor, torch::Tensor> {grad_x, grad_y};
+    }
+}  // namespace signatory
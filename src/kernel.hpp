@@ -0,0 +1,52 @@
+/* Copyright 2019 Patrick Kidger. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ========================================================================= */
+ // Here we handle computing signature kernels: inner products between the signatures of two paths, computed without
+ // ever computing the signatures themselves.
+
+
+#ifndef SIGNATORY_KERNEL_HPP
+#define SIGNATORY_KERNEL_HPP
+
+#include <torch/extension.h>
+#include <cstdint>    // int64_t
+#include <tuple>      // std::tuple
+
+#include "misc.hpp"
+
+namespace signatory {
+    // See signatory.signature_gram for documentation.
+    // 'x' and 'y' should be of shape (stream, batch, channel), with possibly different stream and batch sizes. If
+    // symmetric==true then 'y' is ignored and is taken to be 'x', and only half of the Gram matrix is computed.
+    // Returns a tensor of shape (batch_x, batch_y).
+    torch::Tensor signature_gram_forward(torch::Tensor x, torch::Tensor y, s_size_type depth, bool symmetric);
+
+    // See signatory.signature_gram for documentation.
+    // Returns the gradients with respect to 'x' and 'y'. (The latter being an empty tensor if symmetric==true.)
+    std::tuple<torch::Tensor, torch::Tensor>
+    signature_gram_backward(torch::Tensor grad_gram, torch::Tensor x, torch::Tensor y, s_size_type depth,
+                            bool symmetric);
+
+    // See signatory.signature_kernel for documentation.
+    // 'x', 'y' and 'symmetric' are as signature_gram_forward. Returns a tensor of shape (batch_x, batch_y).
+    torch::Tensor signature_kernel_forward(torch::Tensor x, torch::Tensor y, int64_t dyadic_order, bool symmetric);
+
+    // See signatory.signature_kernel for documentation.
+    // Returns the gradients with respect to 'x' and 'y'. (The latter being an empty tensor if symmetric==true.)
+    std::tuple<torch::Tensor, torch::Tensor>
+    signature_kernel_backward(torch::Tensor grad_kernel, torch::Tensor x, torch::Tensor y, int64_t dyadic_order,
+                              bool symmetric);
+}  // namespace signatory
+
+#endif //SIGNATORY_KERNEL_HPP
@@ -15,6 +15,7 @@
  
 
 #include <torch/extension.h>
+#include <algorithm>  // std::copy
 #include <cstdint>    // int64_t
 #include <memory>     // std::unique_ptr
 #include <omp.h>
@@ -118,6 +119,182 @@ namespace signatory {
                 return grad_expanded.scatter_(channel_dim, indices, grad_compressed);
             }
 
+            // Converts the compressed (Words or Brackets mode) representation of a logsignature into the Lyndon basis,
+            // in-place. The tensor must be on the CPU.
+            // We rely on the triangularity property of the Lyndon basis for this to work.
+            void lyndon_transforms(const LyndonInfo& lyndon_info, torch::Tensor logsignature) {
+                #pragma omp parallel for default(none) \
+                                         shared(lyndon_info, logsignature) schedule(dynamic,1)
+                for (s_size_type transform_class_index = 0;
+                     transform_class_index < static_cast<s_size_type>(lyndon_info.transforms.size());
+                     ++transform_class_index) {
+                    // Note that it is very important that this inner loop operate serially!
+                    for (const auto& transform : lyndon_info.transforms[transform_class_index]) {
+                        int64_t source_index = std::get<0>(transform);
+                        int64_t target_index = std::get<1>(transform);
+                        int64_t coefficient = std::get<2>(transform);
+                        torch::Tensor source = logsignature.narrow(/*dim=*/channel_dim,
+                                                                   /*start=*/source_index,
+                                                                   /*length=*/1);
+                        torch::Tensor target = logsignature.narrow(/*dim=*/channel_dim,
+                                                                   /*start=*/target_index,
+                                                                   /*length=*/1);
+                        target.sub_(source, coefficient);
+                    }
+                }
+            }
+
+            // The backwards operation corresponding to lyndon_transforms. Also operates in-place, in the compressed
+            // representation, and must be on the CPU.
+            void lyndon_transforms_backward(const LyndonInfo& lyndon_info, torch::Tensor grad_logsignature) {
+                #pragma omp parallel for default(none) \
+                                         shared(lyndon_info, grad_logsignature) schedule(dynamic,1)
+                for (s_size_type transform_class_index = 0;
+                     transform_class_index < static_cast<s_size_type>(lyndon_info.transforms.size());
+                     ++transform_class_index) {
+                    for (auto tptr = lyndon_info.transforms[transform_class_index].rbegin();
+                         tptr != lyndon_info.transforms[transform_class_index].rend();
+                         ++tptr) {
+                        int64_t source_index = std::get<0>(*tptr);
+                        int64_t target_index = std::get<1>(*tptr);
+                        int64_t coefficient = std::get<2>(*tptr);
+                        torch::Tensor grad_source = grad_logsignature.narrow(/*dim=*/channel_dim,
+                                                                             /*start=*/source_index,
+                                                                             /*length=*/1);
+                        torch::Tensor grad_target = grad_logsignature.narrow(/*dim=*/channel_dim,
+                                                                             /*start=*/target_index,
+                                                                             /*length=*/1);
+                        grad_source.sub_(grad_target, coefficient);
+                    }
+                }
+            }
+
+            // Returns the index in the tensor algebra of every channel of the (compressed or not) logsignature.
+            std::vector<int64_t> logsignature_indices(const LyndonInfo& lyndon_info, LogSignatureMode mode,
+                                                      int64_t signature_channel_size) {
+                std::vector<int64_t> indices;
+                if (mode == LogSignatureMode::Expand) {
+                    indices.reserve(signature_channel_size);
+                    for (int64_t index = 0; index < signature_channel_size; ++index) {
+                        indices.push_back(index);
+                    }
+                }
+                else {
+                    const lyndon::LyndonWords& lyndon_words = *lyndon_info.lyndon_words;
+                    indices.resize(lyndon_words.amount);
+                    for (s_size_type depth_index = 0; depth_index < lyndon_words.depth; ++depth_index){
+                        for (auto& lyndon_word : lyndon_words[depth_index]) {
+                            indices[lyndon_word.compressed_index] = lyndon_word.tensor_algebra_index;
+                        }
+                    }
+                }
+                return indices;
+            }
+
+            // Computes the logsignature of the path, for every prefix if stream==true, without ever storing more than
+            // one signature per batch element. Each batch element is handled by a single thread, which updates its
+            // signature in-place and then immediately takes its logarithm and writes out the compressed result; in
+            // particular the signature of each batch element is only ever touched by one core and is small enough to
+            // stay in its cache.
+            // 'signature' and 'log_scratch' should both be of shape (batch, signature_channels), and 'signature' will
+            // hold the signature of the whole path afterwards. 'logsignature' should be of shape
+            // (output_stream, batch, logsignature_channels), where output_stream is one if stream==false.
+            // 'path_increments' should be the increments of the original path; the increments of the augmented path
+            // (if time_channel or lead_lag) are generated from them by each thread as it goes.
+            template <typename scalar_t, bool inverse>
+            void logsignature_forward_cpu(torch::Tensor path_increments,
+                                          bool time_channel,
+                                          bool lead_lag,
+                                          torch::Tensor signature,
+                                          torch::Tensor log_scratch,
+                                          torch::Tensor logsignature,
+                                          torch::Tensor reciprocals,
+                                          const std::vector<int64_t>& indices,
+                                          bool stream,
+                                          int64_t input_channel_size,
+                                          s_size_type depth) {
+                int64_t output_stream_size = signature::detail::augmented_stream_size(path_increments, lead_lag);
+                int64_t batch_size = path_increments.size(batch_dim);
+                int64_t logsignature_channel_size = indices.size();
+
+                torch::Tensor increment_scratch = signature::detail::make_increment_scratch(path_increments,
+                                                                                            omp_get_max_threads(),
+                                                                                            time_channel,
+                                                                                            lead_lag);
+                auto increment_scratch_a = increment_scratch.accessor<scalar_t, 2>();
+                auto time_increment = static_cast<scalar_t>(signature::detail::augmented_time_increment(path_increments,
+                                                                                                        inverse,
+                                                                                                        lead_lag));
+
+                auto path_increments_a = path_increments.accessor<scalar_t, 3>();
+                auto reciprocals_a = reciprocals.accessor<scalar_t, 1>();
+                auto log_scratch_a = log_scratch.accessor<scalar_t, 2>();
+                auto logsignature_a = logsignature.accessor<scalar_t, 3>();
+
+                std::vector<torch::Tensor> signature_by_term;
+                std::vector<torch::Tensor> log_scratch_by_term;
+                misc::slice_by_term(signature, signature_by_term, input_channel_size, depth);
+                misc::slice_by_term(log_scratch, log_scratch_by_term, input_channel_size, depth);
+                std::vector<torch::TensorAccessor<scalar_t, 2>> signature_by_term_a;
+                std::vector<torch::TensorAccessor<scalar_t, 2>> log_scratch_by_term_a;
+                signature_by_term_a.reserve(depth);
+                log_scratch_by_term_a.reserve(depth);
+                for (s_size_type depth_index = 0; depth_index < depth; ++depth_index) {
+                    signature_by_term_a.push_back(signature_by_term[depth_index].accessor<scalar_t, 2>());
+                    log_scratch_by_term_a.push_back(log_scratch_by_term[depth_index].accessor<scalar_t, 2>());
+                }
+
+                #pragma omp parallel for default(none) \
+                                         if(batch_size > 1) \
+                                         shared(batch_size, output_stream_size, logsignature_channel_size, \
+                                                path_increments_a, reciprocals_a, log_scratch_a, logsignature_a, \
+                                                signature_by_term_a, log_scratch_by_term_a, indices, stream, \
+                                                increment_scratch_a, time_increment, time_channel, lead_lag)
+                for (int64_t batch_index = 0; batch_index < batch_size; ++batch_index) {
+                    std::vector<torch::TensorAccessor<scalar_t, 1>> signature_at_batch_a;
+                    std::vector<torch::TensorAccessor<scalar_t, 1>> log_scratch_at_batch_a;
+                    signature_at_batch_a.reserve(signature_by_term_a.size());
+                    log_scratch_at_batch_a.reserve(log_scratch_by_term_a.size());
+                    for (auto elem : signature_by_term_a) {
+                        signature_at_batch_a.push_back(elem[batch_index]);
+                    }
+                    for (auto elem : log_scratch_by_term_a) {
+                        log_scratch_at_batch_a.push_back(elem[batch_index]);
+                    }
+
+                    // The first increment. Multiplying the identity by exp(increment) is just the restricted
+                    // exponential.
+                    for (auto elem : signature_at_batch_a) {
+                        for (int64_t channel_index = 0; channel_index < elem.size(0); ++channel_index) {
+                            elem[channel_index] = 0;
+                        }
+                    }
+                    torch::TensorAccessor<scalar_t, 1> increment_scratch_at_thread_a =
+                            increment_scratch_a[omp_get_thread_num()];
+                    for (int64_t stream_index = 0; stream_index < output_stream_size; ++stream_index) {
+                        ta_ops::mult_fused_restricted_exp_single_cpu<scalar_t, inverse>
+                                (signature::detail::augmented_increment_single_cpu<scalar_t>(
+                                        path_increments_a, stream_index, batch_index, time_channel, lead_lag,
+                                        time_increment, increment_scratch_at_thread_a),
+                                 signature_at_batch_a,
+                                 reciprocals_a);
+
+                        if (stream || stream_index == output_stream_size - 1) {
+                            ta_ops::log_single_cpu<scalar_t>(log_scratch_at_batch_a,
+                                                             signature_at_batch_a,
+                                                             reciprocals_a);
+                            auto logsignature_at_stream_a = logsignature_a[stream ? stream_index : 0][batch_index];
+                            for (int64_t channel_index = 0;
+                                 channel_index < logsignature_channel_size;
+                                 ++channel_index) {
+                                logsignature_at_stream_a[channel_index] =
+                                        log_scratch_a[batch_index][indices[channel_index]];
+                            }
+                        }
+                    }
+                }
+            }
+
             void logsignature_checkargs(torch::Tensor signature, int64_t input_channel_size, s_size_type depth,
                                         bool stream)
             {
@@ -237,26 +414,7 @@ namespace signatory {
             if (cuda) {
                 logsignature = logsignature.cpu();
             }
-            // Then apply the transforms. We rely on the triangularity property of the Lyndon basis for this to work.
-            #pragma omp parallel for default(none) \
-                                     shared(lyndon_info, logsignature) schedule(dynamic,1)
-            for (s_size_type transform_class_index = 0;
-                 transform_class_index < static_cast<s_size_type>(lyndon_info->transforms.size());
-                 ++transform_class_index) {
-                // Note that it is very important that this inner loop operate serially!
-                for (const auto& transform : lyndon_info->transforms[transform_class_index]) {
-                    int64_t source_index = std::get<0>(transform);
-                    int64_t target_index = std::get<1>(transform);
-                    int64_t coefficient = std::get<2>(transform);
-                    torch::Tensor source = logsignature.narrow(/*dim=*/channel_dim,
-                                                               /*start=*/source_index,
-                                                               /*length=*/1);
-                    torch::Tensor target = logsignature.narrow(/*dim=*/channel_dim,
-                                                               /*start=*/target_index,
-                                                               /*length=*/1);
-                    target.sub_(source, coefficient);
-                }
-            }
+            logsignature::detail::lyndon_transforms(*lyndon_info, logsignature);
             if (cuda) {
                 logsignature = logsignature.cuda();
             }
@@ -382,4 +540,175 @@ namespace signatory {
 
         return grad_signature;
     }
-}  // namespace signatory
\ No newline at end of file
+    std::tuple<torch::Tensor, torch::Tensor, torch::Tensor>
+    logsignature_forward(torch::Tensor path, s_size_type depth, bool stream, bool basepoint,
+                         torch::Tensor basepoint_value, bool inverse, LogSignatureMode mode,
+                         py::object lyndon_info_capsule, bool time_channel, bool lead_lag) {
+        signature_checkargs(path, depth, basepoint, basepoint_value, /*initial=*/false,
+                            /*initial_value=*/torch::Tensor{}, time_channel, lead_lag);
+        if (path.is_cuda()) {
+            throw std::invalid_argument("The fused logsignature computation is only supported on the CPU.");
+        }
+
+        // No sense keeping track of gradients when we have a dedicated backwards function
+        path = path.detach();
+        basepoint_value = basepoint_value.detach();
+
+        // As in signature_forward, the increments of the augmented path are generated one at a time from these.
+        torch::Tensor path_increments = signature::detail::compute_path_increments(path, basepoint, basepoint_value,
+                                                                                   inverse);
+
+        int64_t batch_size = path.size(batch_dim);
+        int64_t input_channel_size = signature::detail::augmented_channels(path_increments.size(channel_dim),
+                                                                           time_channel, lead_lag);
+        int64_t output_stream_size = signature::detail::augmented_stream_size(path_increments, lead_lag);
+
+        if (lyndon_info_capsule.is_none()) {
+            lyndon_info_capsule = make_lyndon_info(input_channel_size, depth, mode);
+        }
+        logsignature::detail::LyndonInfo* lyndon_info =
+                misc::unwrap_capsule<logsignature::detail::LyndonInfo>(lyndon_info_capsule);
+
+        int64_t signature_channel_size = signature_channels(input_channel_size, depth);
+        torch::TensorOptions opts = misc::make_opts(path);
+        torch::Tensor reciprocals = misc::make_reciprocals(depth, opts);
+        std::vector<int64_t> indices = logsignature::detail::logsignature_indices(*lyndon_info, mode,
+                                                                                  signature_channel_size);
+
+        // Only the signature of the whole path is ever stored; the signature of each prefix of the path is never
+        // written out, as its logarithm is taken straight away.
+        torch::Tensor signature = torch::empty({batch_size, signature_channel_size}, opts);
+        torch::Tensor log_scratch = torch::empty({batch_size, signature_channel_size}, opts);
+        torch::Tensor logsignature = torch::empty({stream ? output_stream_size : 1,
+                                                   batch_size,
+                                                   static_cast<int64_t>(indices.size())}, opts);
+
+        AT_DISPATCH_FLOATING_TYPES(path.type(), "logsignature_forward_cpu", ([&] {
+            if (inverse) {
+                logsignature::detail::logsignature_forward_cpu<scalar_t, /*inverse=*/true>(path_increments,
+                                                                                          time_channel,
+                                                                                          lead_lag,
+                                                                                          signature,
+                                                                                          log_scratch,
+                                                                                          logsignature,
+                                                                                          reciprocals,
+                                                                                          indices,
+                                                                                          stream,
+                                                                                          input_channel_size,
+                                                                                          depth);
+            }
+            else {
+                logsignature::detail::logsignature_forward_cpu<scalar_t, /*inverse=*/false>(path_increments,
+                                                                                           time_channel,
+                                                                                           lead_lag,
+                                                                                           signature,
+                                                                                           log_scratch,
+                                                                                           logsignature,
+                                                                                           reciprocals,
+                                                                                           indices,
+                                                                                           stream,
+                                                                                           input_channel_size,
+                                                                                           depth);
+            }
+        }));
+
+        if (mode == LogSignatureMode::Brackets) {
+            logsignature::detail::lyndon_transforms(*lyndon_info, logsignature);
+        }
+        if (!stream) {
+            logsignature = logsignature[0];
+        }
+
+        return std::tuple<torch::Tensor, torch::Tensor, torch::Tensor> {logsignature, signature, path_increments};
+    }
+
+    std::tuple<torch::Tensor, torch::Tensor>
+    logsignature_backward(torch::Tensor grad_logsignature, torch::Tensor signature, torch::Tensor path_increments,
+                          s_size_type depth, bool stream, bool basepoint, bool inverse, LogSignatureMode mode,
+                          py::object lyndon_info_capsule, bool time_channel, bool lead_lag) {
+        grad_logsignature = grad_logsignature.detach();
+        signature = signature.detach();
+        path_increments = path_increments.detach();
+
+        logsignature::detail::LyndonInfo* lyndon_info =
+                misc::unwrap_capsule<logsignature::detail::LyndonInfo>(lyndon_info_capsule);
+        torch::TensorOptions opts = misc::make_opts(signature);
+        torch::Tensor reciprocals = misc::make_reciprocals(depth, opts);
+        int64_t batch_size = path_increments.size(batch_dim);
+        int64_t output_stream_size = signature::detail::augmented_stream_size(path_increments, lead_lag);
+        int64_t input_channel_size = signature::detail::augmented_channels(path_increments.size(channel_dim),
+                                                                           time_channel, lead_lag);
+        int64_t signature_channel_size = signature.size(channel_dim);
+
+        if (!stream) {
+            grad_logsignature = grad_logsignature.unsqueeze(0);
+        }
+        if (mode == LogSignatureMode::Brackets) {
+            // Clone so we don't leak changes through grad_logsignature.
+            grad_logsignature = grad_logsignature.clone();
+            logsignature::detail::lyndon_transforms_backward(*lyndon_info, grad_logsignature);
+        }
+        std::vector<int64_t> indices_vector = logsignature::detail::logsignature_indices(*lyndon_info, mode,
+                                                                                         signature_channel_size);
+        torch::Tensor indices = torch::empty({static_cast<int64_t>(indices_vector.size())},
+                                             torch::dtype(torch::kInt64));
+        std::copy(indices_vector.begin(), indices_vector.end(), indices.data<int64_t>());
+
+        // We recompute the signature of every prefix of the path backwards, via the reversibility property of the
+        // signature, exactly as in signature_backward. The difference is that instead of having gradients with respect
+        // to the signature of each prefix, we have gradients with respect to its logarithm, which we backpropagate
+        // through the logarithm as we reach each prefix.
+        std::vector<torch::Tensor> signature_by_term_at_stream;
+        misc::slice_by_term(signature.clone(), signature_by_term_at_stream, input_channel_size, depth);
+
+        torch::Tensor grad_signature_at_stream = torch::zeros_like(signature);
+        std::vector<torch::Tensor> grad_signature_by_term_at_stream;
+        misc::slice_by_term(grad_signature_at_stream, grad_signature_by_term_at_stream, input_channel_size, depth);
+
+        // Scratch space for the (decompressed) gradient with respect to the logarithm
+        torch::Tensor grad_log_at_stream = torch::empty_like(signature);
+        std::vector<torch::Tensor> grad_log_by_term_at_stream;
+        misc::slice_by_term(grad_log_at_stream, grad_log_by_term_at_stream, input_channel_size, depth);
+
+        auto backward_through_log = [&] (int64_t stream_index) {
+            if (stream || stream_index == output_stream_size - 1) {
+                grad_log_at_stream.zero_();
+                grad_log_at_stream.index_copy_(/*dim=*/channel_dim, indices,
+                                               grad_logsignature[stream ? stream_index : 0]);
+                ta_ops::log_backward(grad_log_by_term_at_stream, grad_signature_by_term_at_stream,
+                                     signature_by_term_at_stream, reciprocals);
+            }
+        };
+
+        // As in signature_backward, the increments of the augmented path are regenerated one at a time.
+        torch::Tensor grad_path_increments = lead_lag ? torch::zeros_like(path_increments)
+                                                      : torch::empty_like(path_increments);
+        torch::Tensor increment_scratch = signature::detail::make_increment_scratch(path_increments, batch_size,
+                                                                                    time_channel, lead_lag);
+        torch::Tensor grad_increment_scratch = torch::empty_like(increment_scratch);
+
+        backward_through_log(output_stream_size - 1);
+        for (int64_t stream_index = output_stream_size - 1; stream_index >= 1; --stream_index) {
+            torch::Tensor grad_next = signature::detail::grad_augmented_increment(grad_path_increments, stream_index,
+                                                                                  time_channel, lead_lag,
+                                                                                  grad_increment_scratch);
+            torch::Tensor next = signature::detail::augmented_increment(path_increments, stream_index, inverse,
+                                                                        time_channel, lead_lag, increment_scratch);
+            ta_ops::mult_fused_restricted_exp(-next, signature_by_term_at_stream, inverse, reciprocals);
+            ta_ops::mult_fused_restricted_exp_backward(grad_next, grad_signature_by_term_at_stream, next,
+                                                       signature_by_term_at_stream, inverse, reciprocals);
+            signature::detail::augmented_increment_backward(grad_next, grad_path_increments, stream_index,
+                                                            time_channel, lead_lag);
+            backward_through_log(stream_index - 1);
+        }
+        torch::Tensor grad_next = signature::detail::grad_augmented_increment(grad_path_increments, 0, time_channel,
+                                                                              lead_lag, grad_increment_scratch);
+        torch::Tensor next = signature::detail::augmented_increment(path_increments, 0, inverse, time_channel,
+                                                                    lead_lag, increment_scratch);
+        ta_ops::restricted_exp_backward(grad_next, grad_signature_by_term_at_stream, next,
+                                        signature_by_term_at_stream, reciprocals);
+        signature::detail::augmented_increment_backward(grad_next, grad_path_increments, 0, time_channel, lead_lag);
+
+        return signature::detail::compute_path_increments_backward(grad_path_increments, basepoint, inverse, opts);
+    }
+}  // namespace signatory
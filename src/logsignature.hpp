@@ -45,6 +45,20 @@ namespace signatory {
                                                      bool stream,
                                                      LogSignatureMode mode,
                                                      py::object lyndon_info_capsule);
+
+    // See signatory.logsignature for documentation. Computes the logsignature directly from the path, never storing the
+    // signature of more than one prefix of the path. Only supported on the CPU.
+    // Returns the logsignature, the signature of the whole path, and the path increments.
+    std::tuple<torch::Tensor, torch::Tensor, torch::Tensor>
+    logsignature_forward(torch::Tensor path, s_size_type depth, bool stream, bool basepoint,
+                         torch::Tensor basepoint_value, bool inverse, LogSignatureMode mode,
+                         py::object lyndon_info_capsule, bool time_channel, bool lead_lag);
+
+    // See signatory.logsignature for documentation
+    std::tuple<torch::Tensor, torch::Tensor>
+    logsignature_backward(torch::Tensor grad_logsignature, torch::Tensor signature, torch::Tensor path_increments,
+                          s_size_type depth, bool stream, bool basepoint, bool inverse, LogSignatureMode mode,
+                          py::object lyndon_info_capsule, bool time_channel, bool lead_lag);
 }  // namespace signatory
 
 #endif //SIGNATORY_LOGSIGNATURE_HPP
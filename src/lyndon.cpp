@@ -15,7 +15,10 @@
 
 
 #include <cstdint>    // int64_t
+#include <map>        // std::map
+#include <set>        // std::multiset
 #include <stdexcept>  // std::invalid_argument
+#include <tuple>      // std::tuple
 #include <utility>    // std::pair
 #include <vector>     // std::vector
 
@@ -269,6 +272,110 @@ namespace signatory {
             }
         }
 
+        void LyndonWords::to_words_basis(std::vector<std::map<int64_t, int64_t>>& expansions) const {
+            // The expansion of every Lyndon bracket, indexed by the position of each word within its depth class (rather
+            // than by tensor_algebra_index), as that makes concatenation of words straightforward.
+            std::vector<std::map<int64_t, int64_t>> bracket_expansions(amount);
+            std::vector<int64_t> num_words_at_depth;
+            num_words_at_depth.reserve(depth);
+            int64_t num_words = input_channel_size;
+            for (s_size_type depth_index = 0; depth_index < depth; ++depth_index) {
+                num_words_at_depth.push_back(num_words);
+                num_words *= input_channel_size;
+            }
+
+            for (const auto& depth_class : *this) {
+                for (const auto& lyndon_word : depth_class) {
+                    auto& bracket_expansion = bracket_expansions[lyndon_word.compressed_index];
+                    const LyndonWord* first_child = lyndon_word.extra->first_child;
+                    const LyndonWord* second_child = lyndon_word.extra->second_child;
+                    if (first_child == nullptr) {
+                        bracket_expansion[lyndon_word.extra->word.back()] = 1;
+                        continue;
+                    }
+                    int64_t first_stride = num_words_at_depth[first_child->extra->word.size() - 1];
+                    int64_t second_stride = num_words_at_depth[second_child->extra->word.size() - 1];
+                    for (const auto& first_word_coeff : bracket_expansions[first_child->compressed_index]) {
+                        for (const auto& second_word_coeff : bracket_expansions[second_child->compressed_index]) {
+                            int64_t product = first_word_coeff.second * second_word_coeff.second;
+                            bracket_expansion[first_word_coeff.first * second_stride + second_word_coeff.first]
+                                    += product;
+                            bracket_expansion[second_word_coeff.first * first_stride + first_word_coeff.first]
+                                    -= product;
+                        }
+                    }
+                    for (auto iter = bracket_expansion.begin(); iter != bracket_expansion.end();) {
+                        if (iter->second == 0) {
+                            iter = bracket_expansion.erase(iter);
+                        }
+                        else {
+                            ++iter;
+                        }
+                    }
+                }
+            }
+
+            // Each Lyndon bracket expands to its Lyndon word plus lexicographically larger anagrams. So within each
+            // anagram class the matrix of coefficients of Lyndon words in Lyndon brackets is unitriangular, and the
+            // basis we want is obtained by inverting it. Unitriangular integer matrices have integer inverses, so this
+            // is all exact.
+            expansions.clear();
+            expansions.resize(amount);
+            int64_t tensor_algebra_offset = 0;
+            for (s_size_type depth_index = 0; depth_index < depth; ++depth_index) {
+                std::map<std::multiset<int64_t>, std::vector<const LyndonWord*>> anagram_classes;
+                for (const auto& lyndon_word : (*this)[depth_index]) {
+                    const auto& word = lyndon_word.extra->word;
+                    // Iterating in order of compressed_index, so each anagram class is ordered lexicographically
+                    anagram_classes[std::multiset<int64_t> (word.begin(), word.end())].push_back(&lyndon_word);
+                }
+
+                for (const auto& key_value : anagram_classes) {
+                    const std::vector<const LyndonWord*>& anagram_class = key_value.second;
+                    s_size_type class_size = anagram_class.size();
+                    std::vector<std::vector<int64_t>> inverse(class_size, std::vector<int64_t>(class_size, 0));
+                    for (s_size_type row = class_size - 1; row >= 0; --row) {
+                        const auto& bracket_expansion = bracket_expansions[anagram_class[row]->compressed_index];
+                        inverse[row][row] = 1;
+                        for (s_size_type column = row + 1; column < class_size; ++column) {
+                            int64_t total = 0;
+                            for (s_size_type inner = row + 1; inner <= column; ++inner) {
+                                auto found = bracket_expansion.find(anagram_class[inner]->tensor_algebra_index -
+                                                                    tensor_algebra_offset);
+                                if (found != bracket_expansion.end()) {
+                                    total += found->second * inverse[inner][column];
+                                }
+                            }
+                            inverse[row][column] = -total;
+                        }
+                    }
+
+                    for (s_size_type row = 0; row < class_size; ++row) {
+                        auto& expansion = expansions[anagram_class[row]->compressed_index];
+                        for (s_size_type column = row; column < class_size; ++column) {
+                            int64_t coefficient = inverse[row][column];
+                            if (coefficient == 0) {
+                                continue;
+                            }
+                            for (const auto& word_coeff :
+                                 bracket_expansions[anagram_class[column]->compressed_index]) {
+                                expansion[word_coeff.first + tensor_algebra_offset] += coefficient * word_coeff.second;
+                            }
+                        }
+                        for (auto iter = expansion.begin(); iter != expansion.end();) {
+                            if (iter->second == 0) {
+                                iter = expansion.erase(iter);
+                            }
+                            else {
+                                ++iter;
+                            }
+                        }
+                    }
+                }
+                tensor_algebra_offset += num_words_at_depth[depth_index];
+            }
+        }
+
         void LyndonWords::delete_extra() {
             for (auto& depth_class : (*this)) {
                 for (auto& lyndon_word : depth_class) {
@@ -418,4 +525,155 @@ namespace signatory {
         lyndon_words.to_lyndon_basis(transforms, transforms_backward);
         return transforms;
     }
-}  // namespace signatory
\ No newline at end of file
+
+    std::tuple<torch::Tensor, torch::Tensor> lyndon_words_tensor(int64_t channels, int64_t depth) {
+        misc::checkargs_channels_depth(channels, depth);
+        // Duval's algorithm is cheaper than generating brackets, and the words themselves can be recovered from the
+        // tensor_algebra_index of each Lyndon word.
+        lyndon::LyndonWords lyndon_words(channels, depth, lyndon::LyndonWords::word_tag);
+
+        torch::Tensor words = torch::full({lyndon_words.amount, depth}, -1, torch::dtype(torch::kInt64));
+        torch::Tensor lengths = torch::empty({lyndon_words.amount}, torch::dtype(torch::kInt64));
+        auto words_a = words.accessor<int64_t, 2>();
+        auto lengths_a = lengths.accessor<int64_t, 1>();
+
+        int64_t tensor_algebra_offset = 0;
+        int64_t num_words = channels;
+        for (s_size_type depth_index = 0; depth_index < depth; ++depth_index) {
+            for (const auto& lyndon_word : lyndon_words[depth_index]) {
+                int64_t index = lyndon_word.tensor_algebra_index - tensor_algebra_offset;
+                for (s_size_type letter_index = depth_index; letter_index >= 0; --letter_index) {
+                    words_a[lyndon_word.compressed_index][letter_index] = index % channels;
+                    index /= channels;
+                }
+                lengths_a[lyndon_word.compressed_index] = depth_index + 1;
+            }
+            tensor_algebra_offset += num_words;
+            num_words *= channels;
+        }
+
+        return std::tuple<torch::Tensor, torch::Tensor> {words, lengths};
+    }
+
+    std::tuple<torch::Tensor, torch::Tensor, torch::Tensor> lyndon_brackets_tensor(int64_t channels, int64_t depth) {
+        misc::checkargs_channels_depth(channels, depth);
+        lyndon::LyndonWords lyndon_words(channels, depth, lyndon::LyndonWords::bracket_tag);
+
+        torch::Tensor words = torch::full({lyndon_words.amount, depth}, -1, torch::dtype(torch::kInt64));
+        torch::Tensor lengths = torch::empty({lyndon_words.amount}, torch::dtype(torch::kInt64));
+        torch::Tensor children = torch::full({lyndon_words.amount, 2}, -1, torch::dtype(torch::kInt64));
+        auto words_a = words.accessor<int64_t, 2>();
+        auto lengths_a = lengths.accessor<int64_t, 1>();
+        auto children_a = children.accessor<int64_t, 2>();
+
+        for (const auto& depth_class : lyndon_words) {
+            for (const auto& lyndon_word : depth_class) {
+                const auto& word = lyndon_word.extra->word;
+                for (u_size_type letter_index = 0; letter_index < word.size(); ++letter_index) {
+                    words_a[lyndon_word.compressed_index][letter_index] = word[letter_index];
+                }
+                lengths_a[lyndon_word.compressed_index] = word.size();
+                if (lyndon_word.extra->first_child != nullptr) {
+                    children_a[lyndon_word.compressed_index][0] = lyndon_word.extra->first_child->compressed_index;
+                    children_a[lyndon_word.compressed_index][1] = lyndon_word.extra->second_child->compressed_index;
+                }
+            }
+        }
+
+        return std::tuple<torch::Tensor, torch::Tensor, torch::Tensor> {words, lengths, children};
+    }
+
+    std::tuple<torch::Tensor, torch::Tensor> all_words_tensor(int64_t channels, int64_t depth) {
+        misc::checkargs_channels_depth(channels, depth);
+        int64_t amount = signature_channels(channels, depth);
+
+        torch::Tensor words = torch::full({amount, depth}, -1, torch::dtype(torch::kInt64));
+        torch::Tensor lengths = torch::empty({amount}, torch::dtype(torch::kInt64));
+        auto words_a = words.accessor<int64_t, 2>();
+        auto lengths_a = lengths.accessor<int64_t, 1>();
+
+        int64_t word_index = 0;
+        int64_t num_words = channels;
+        for (s_size_type depth_index = 0; depth_index < depth; ++depth_index) {
+            for (int64_t index = 0; index < num_words; ++index, ++word_index) {
+                int64_t remainder = index;
+                for (s_size_type letter_index = depth_index; letter_index >= 0; --letter_index) {
+                    words_a[word_index][letter_index] = remainder % channels;
+                    remainder /= channels;
+                }
+                lengths_a[word_index] = depth_index + 1;
+            }
+            num_words *= channels;
+        }
+
+        return std::tuple<torch::Tensor, torch::Tensor> {words, lengths};
+    }
+
+    std::tuple<torch::Tensor, torch::Tensor, torch::Tensor> lyndon_words_to_basis_transform_tensor(int64_t channels,
+                                                                                                 int64_t depth)
+    {
+        misc::checkargs_channels_depth(channels, depth);
+        lyndon::LyndonWords lyndon_words(channels, depth, lyndon::LyndonWords::bracket_tag);
+        std::vector<std::vector<std::tuple<int64_t, int64_t, int64_t>>> transforms;
+        std::vector<std::vector<std::tuple<int64_t, int64_t, int64_t>>> transforms_backward;
+        lyndon_words.to_lyndon_basis(transforms, transforms_backward);
+
+        int64_t nnz = 0;
+        for (const auto& transform_class : transforms) {
+            nnz += transform_class.size();
+        }
+
+        torch::Tensor indices = torch::empty({2, nnz}, torch::dtype(torch::kInt64));
+        torch::Tensor values = torch::empty({nnz}, torch::dtype(torch::kInt64));
+        // offsets[i]:offsets[i + 1] describes the slice of indices and values corresponding to the i-th anagram class.
+        // The transforms within each anagram class must be applied sequentially, in order.
+        torch::Tensor offsets = torch::empty({static_cast<int64_t>(transforms.size()) + 1},
+                                             torch::dtype(torch::kInt64));
+        auto indices_a = indices.accessor<int64_t, 2>();
+        auto values_a = values.accessor<int64_t, 1>();
+        auto offsets_a = offsets.accessor<int64_t, 1>();
+
+        int64_t counter = 0;
+        offsets_a[0] = 0;
+        for (u_size_type class_index = 0; class_index < transforms.size(); ++class_index) {
+            for (const auto& transform : transforms[class_index]) {
+                indices_a[0][counter] = std::get<0>(transform);
+                indices_a[1][counter] = std::get<1>(transform);
+                values_a[counter] = std::get<2>(transform);
+                ++counter;
+            }
+            offsets_a[class_index + 1] = counter;
+        }
+
+        return std::tuple<torch::Tensor, torch::Tensor, torch::Tensor> {indices, values, offsets};
+    }
+
+    std::tuple<torch::Tensor, torch::Tensor> words_basis_expansion_tensor(int64_t channels, int64_t depth) {
+        misc::checkargs_channels_depth(channels, depth);
+        lyndon::LyndonWords lyndon_words(channels, depth, lyndon::LyndonWords::bracket_tag);
+        std::vector<std::map<int64_t, int64_t>> expansions;
+        lyndon_words.to_words_basis(expansions);
+
+        int64_t nnz = 0;
+        for (const auto& expansion : expansions) {
+            nnz += expansion.size();
+        }
+
+        torch::Tensor indices = torch::empty({2, nnz}, torch::dtype(torch::kInt64));
+        torch::Tensor values = torch::empty({nnz}, torch::dtype(torch::kInt64));
+        auto indices_a = indices.accessor<int64_t, 2>();
+        auto values_a = values.accessor<int64_t, 1>();
+
+        int64_t counter = 0;
+        for (u_size_type compressed_index = 0; compressed_index < expansions.size(); ++compressed_index) {
+            for (const auto& index_coefficient : expansions[compressed_index]) {
+                indices_a[0][counter] = compressed_index;
+                indices_a[1][counter] = index_coefficient.first;
+                values_a[counter] = index_coefficient.second;
+                ++counter;
+            }
+        }
+
+        return std::tuple<torch::Tensor, torch::Tensor> {indices, values};
+    }
+}  // namespace signatory
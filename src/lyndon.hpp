@@ -18,7 +18,9 @@
 #ifndef SIGNATORY_LYNDON_HPP
 #define SIGNATORY_LYNDON_HPP
 
+#include <torch/extension.h>
 #include <cstdint>    // int64_t
+#include <tuple>      // std::tuple
 
 
 namespace signatory {
@@ -60,6 +62,16 @@ namespace signatory {
             void to_lyndon_basis(std::vector<std::vector<std::tuple<int64_t, int64_t, int64_t>>>& transforms,
                                  std::vector<std::vector<std::tuple<int64_t, int64_t, int64_t>>>& transforms_backward);
 
+            /* Computes, for each Lyndon word w, the expansion in the tensor algebra of the basis element of the free Lie
+             * algebra corresponding to w in the "words" representation of the logsignature. That is, the unique element
+             * of the free Lie algebra whose coefficient of w is one, and whose coefficients of every other Lyndon word
+             * are zero.
+             * The expansions are returned in the expansions argument, indexed by compressed_index, and each mapping
+             * tensor_algebra_index to coefficient.
+             * Requires that the ExtraLyndonInformation is set, i.e. that the bracket-based constructor was used.
+             */
+            void to_words_basis(std::vector<std::map<int64_t, int64_t>>& expansions) const;
+
             /* Deletes the ExtraLyndonInformation associated with each word, if it is present. This is to reclaim memory
              * when we know we don't need it any more.
              */
@@ -143,6 +155,25 @@ namespace signatory {
     // See signatory.utility.lyndon_words_to_basis_transform for documentation
     std::vector<std::vector<std::tuple<int64_t, int64_t, int64_t>>> lyndon_words_to_basis_transform(int64_t channels,
                                                                                                     int64_t depth);
+
+    // See signatory.lyndon_words_tensor for documentation
+    std::tuple<torch::Tensor, torch::Tensor> lyndon_words_tensor(int64_t channels, int64_t depth);
+
+    // See signatory.lyndon_brackets_tensor for documentation
+    std::tuple<torch::Tensor, torch::Tensor, torch::Tensor> lyndon_brackets_tensor(int64_t channels, int64_t depth);
+
+    // See signatory.all_words_tensor for documentation
+    std::tuple<torch::Tensor, torch::Tensor> all_words_tensor(int64_t channels, int64_t depth);
+
+    // See signatory.unstable.lyndon_words_to_basis_transform_tensor for documentation
+    std::tuple<torch::Tensor, torch::Tensor, torch::Tensor> lyndon_words_to_basis_transform_tensor(int64_t channels,
+                                                                                                 int64_t depth);
+
+    // See signatory.logsignature_to_signature for how this is used.
+    // Returns the expansion of every "words" basis element of the free Lie algebra into the tensor algebra, as in
+    // LyndonWords::to_words_basis, in coordinate format: indices[0] are compressed indices, indices[1] are tensor
+    // algebra indices, and values are the corresponding coefficients.
+    std::tuple<torch::Tensor, torch::Tensor> words_basis_expansion_tensor(int64_t channels, int64_t depth);
 }  // namespace signatory
 
 #endif //SIGNATORY_LYNDON_HPP
@@ -0,0 +1,808 @@
+/* Copyright 2019 Patrick Kidger. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ========================================================================= */
+
+
+#include <torch/extension.h>
+#include <algorithm>  // std::max, std::min
+#include <cstdint>    // int64_t
+#include <omp.h>
+#include <stdexcept>  // std::invalid_argument
+#include <tuple>      // std::ignore, std::tie, std::tuple
+#include <vector>     // std::vector
+
+#include "logsignature.hpp"
+#include "misc.hpp"
+#include "path.hpp"
+#include "pycapsule.hpp"
+#include "signature.hpp"
+#include "tensor_algebra_ops.hpp"
+
+
+namespace signatory {
+    namespace path {
+        namespace detail {
+            // This struct will be wrapped into a PyCapsule. It holds the points of a path, and some signatures of
+            // pieces of the path, from which the signature over any interval of the path may be found quickly.
+            //
+            // With PathStorage::Prefix, it holds the signature of the prefixes of the path ending at every
+            // checkpoint_interval-th point. The signature of any prefix of the path may then be found by recomputing at
+            // most checkpoint_interval - 1 steps from the nearest checkpoint, and the signature over any interval of
+            // the path by then using a single antipode and a single multiplication in the tensor algebra.
+            //
+            // With PathStorage::SegmentTree, it holds a segment tree, in which the leaves are the signatures of each
+            // increment of the path, and every other node is the signature over the union of its children. The
+            // signature over any interval of the path may then be found by multiplying together O(log(length)) nodes.
+            // This doesn't suffer from the catastrophic cancellation that can occur when multiplying the inverse of one
+            // prefix by another, and changing a point of the path only requires recomputing O(log(length)) nodes.
+            //
+            // The buffers are allocated with some spare capacity at the end, so that the path may be efficiently
+            // updated with more points.
+            //
+            // If max_length is nonzero then only the most recent max_length many points of the path are retained, so
+            // that the memory used stays bounded however many times the path is updated. The buffers then never grow
+            // beyond 2 * max_length points: once they are full, the retained points are moved to the start of the
+            // buffers and their signatures recomputed. As this happens only once every max_length or so points, this
+            // is cheap on average.
+            struct PathInfo {
+                PathInfo(int64_t batch_size, int64_t input_channel_size, s_size_type depth,
+                         torch::TensorOptions opts, PathStorage storage, int64_t checkpoint_interval,
+                         int64_t max_length) :
+                    batch_size{batch_size},
+                    input_channel_size{input_channel_size},
+                    depth{depth},
+                    opts{opts},
+                    reciprocals{misc::make_reciprocals(depth, opts)},
+                    storage{storage},
+                    checkpoint_interval{checkpoint_interval},
+                    max_length{max_length},
+                    start{0},
+                    length{0},
+                    capacity{0},
+                    tree_size{0},
+                    version{0}
+                {};
+
+                int64_t batch_size;
+                int64_t input_channel_size;
+                s_size_type depth;
+                torch::TensorOptions opts;
+                torch::Tensor reciprocals;
+                PathStorage storage;
+                // Trades off memory against speed: with PathStorage::Prefix, the signature is stored for only every
+                // checkpoint_interval-th point of the path.
+                int64_t checkpoint_interval;
+                // The maximum number of points of the path to retain, or zero for no maximum.
+                int64_t max_length;
+
+                // The points of the path that are retained are path[start:length]. Everything in the buffers before
+                // 'start' is no longer part of the path, but is kept around until the buffers are next compacted.
+                // (Indices are always with respect to the buffers, except for those used in the public functions,
+                // which are with respect to the retained points.)
+                int64_t start;
+                // The number of points held in the buffers
+                int64_t length;
+                // The number of points that there is space for in the buffers below
+                int64_t capacity;
+
+                // The points of the path, of shape (capacity, batch, channel)
+                torch::Tensor path;
+                // signature[i] is the signature of path[:i * checkpoint_interval + 1], of shape
+                // (num_checkpoints(capacity), batch, signature_channels).
+                // In particular signature[0] is zero, as the signature of a single point has no nonscalar terms.
+                // Only used with PathStorage::Prefix.
+                torch::Tensor signature;
+
+                // The number of leaves of the segment tree; always a power of two.
+                int64_t tree_size;
+                // The segment tree, of shape (2 * tree_size, batch, signature_channels). Node 1 is the root, the
+                // children of node i are nodes 2 * i and 2 * i + 1, and tree[tree_size + i] is the signature of the
+                // increment path[i + 1] - path[i]. Every other entry, including the unused tree[0], is zero, which
+                // represents the identity in the tensor algebra.
+                // Only used with PathStorage::SegmentTree.
+                torch::Tensor tree;
+
+                // Incremented whenever the retained points of the path are changed in a way that invalidates the
+                // indices used by a previous forward pass, so that its backward pass can detect this. (Merely appending
+                // points doesn't, but discarding points does, as that moves 'start', and so does editing a point.)
+                int64_t version;
+
+                constexpr static auto capsule_name = "signatory.PathInfoCapsule";
+            };
+
+            // The number of checkpoints amongst the first 'length' many points of the path.
+            int64_t num_checkpoints(const PathInfo& path_info, int64_t length) {
+                return (length + path_info.checkpoint_interval - 1) / path_info.checkpoint_interval;
+            }
+
+            // Recomputes every node of the segment tree which is an ancestor of one of the leaves
+            // tree[tree_size + first_leaf], ..., tree[tree_size + last_leaf - 1].
+            // Every node at the same level of the tree is computed at once, by treating them as an extra batch
+            // dimension.
+            void update_tree_nodes(PathInfo& path_info, int64_t first_leaf, int64_t last_leaf) {
+                if (first_leaf >= last_leaf) {
+                    return;
+                }
+                int64_t signature_channel_size = signature_channels(path_info.input_channel_size, path_info.depth);
+                int64_t first_node = (path_info.tree_size + first_leaf) / 2;
+                int64_t last_node = (path_info.tree_size + last_leaf - 1) / 2;
+                while (first_node >= 1) {
+                    int64_t num_nodes = last_node - first_node + 1;
+                    torch::Tensor nodes = path_info.tree.narrow(/*dim=*/0, /*start=*/first_node, /*length=*/num_nodes);
+                    torch::Tensor children = path_info.tree.narrow(/*dim=*/0,
+                                                                   /*start=*/2 * first_node,
+                                                                   /*length=*/2 * num_nodes);
+                    children = children.view({num_nodes, 2, path_info.batch_size, signature_channel_size});
+                    nodes.copy_(children.select(/*dim=*/1, /*index=*/0));
+                    torch::Tensor right_children = children.select(/*dim=*/1, /*index=*/1)
+                                                           .reshape({num_nodes * path_info.batch_size,
+                                                                     signature_channel_size});
+
+                    std::vector<torch::Tensor> nodes_vector;
+                    std::vector<torch::Tensor> right_children_vector;
+                    misc::slice_by_term(nodes.view({num_nodes * path_info.batch_size, signature_channel_size}),
+                                        nodes_vector, path_info.input_channel_size, path_info.depth);
+                    misc::slice_by_term(right_children, right_children_vector, path_info.input_channel_size,
+                                        path_info.depth);
+                    ta_ops::mult(nodes_vector, right_children_vector, /*inverse=*/false);
+
+                    first_node /= 2;
+                    last_node /= 2;
+                }
+            }
+
+            // Recomputes the leaves tree[tree_size + first_leaf], ..., tree[tree_size + last_leaf - 1] of the segment
+            // tree from the points of the path, and then every node above them.
+            void update_tree_leaves(PathInfo& path_info, int64_t first_leaf, int64_t last_leaf) {
+                int64_t num_leaves = last_leaf - first_leaf;
+                if (num_leaves <= 0) {
+                    return;
+                }
+                int64_t signature_channel_size = signature_channels(path_info.input_channel_size, path_info.depth);
+                torch::Tensor increments = path_info.path.narrow(/*dim=*/stream_dim,
+                                                                 /*start=*/first_leaf + 1,
+                                                                 /*length=*/num_leaves) -
+                                           path_info.path.narrow(/*dim=*/stream_dim,
+                                                                 /*start=*/first_leaf,
+                                                                 /*length=*/num_leaves);
+                increments = increments.view({num_leaves * path_info.batch_size, path_info.input_channel_size});
+                torch::Tensor leaves = path_info.tree.narrow(/*dim=*/0,
+                                                             /*start=*/path_info.tree_size + first_leaf,
+                                                             /*length=*/num_leaves);
+
+                std::vector<torch::Tensor> leaves_vector;
+                misc::slice_by_term(leaves.view({num_leaves * path_info.batch_size, signature_channel_size}),
+                                    leaves_vector, path_info.input_channel_size, path_info.depth);
+                ta_ops::restricted_exp(increments, leaves_vector, path_info.reciprocals);
+
+                update_tree_nodes(path_info, first_leaf, last_leaf);
+            }
+
+            // Makes sure that the buffers have space for at least 'new_length' many points. The capacity is grown
+            // geometrically, so that repeatedly updating the path with a few points at a time is efficient.
+            void reserve(PathInfo& path_info, int64_t new_length) {
+                if (new_length <= path_info.capacity) {
+                    return;
+                }
+                int64_t new_capacity = std::max(new_length, 2 * path_info.capacity);
+                if (path_info.max_length > 0) {
+                    new_capacity = std::min(new_capacity, 2 * path_info.max_length);
+                }
+                int64_t signature_channel_size = signature_channels(path_info.input_channel_size, path_info.depth);
+
+                torch::Tensor path = torch::empty({new_capacity, path_info.batch_size, path_info.input_channel_size},
+                                                  path_info.opts);
+                if (path_info.length > 0) {
+                    path.narrow(/*dim=*/stream_dim, /*start=*/0, /*length=*/path_info.length)
+                        .copy_(path_info.path.narrow(/*dim=*/stream_dim, /*start=*/0, /*length=*/path_info.length));
+                }
+                path_info.path = path;
+                path_info.capacity = new_capacity;
+
+                if (path_info.storage == PathStorage::Prefix) {
+                    torch::Tensor signature = torch::empty({num_checkpoints(path_info, new_capacity),
+                                                            path_info.batch_size,
+                                                            signature_channel_size}, path_info.opts);
+                    if (path_info.length > 0) {
+                        int64_t checkpoints = num_checkpoints(path_info, path_info.length);
+                        signature.narrow(/*dim=*/stream_dim, /*start=*/0, /*length=*/checkpoints)
+                                 .copy_(path_info.signature.narrow(/*dim=*/stream_dim,
+                                                                   /*start=*/0,
+                                                                   /*length=*/checkpoints));
+                    }
+                    path_info.signature = signature;
+                }
+                else {
+                    // One leaf for every increment
+                    int64_t new_tree_size = 1;
+                    while (new_tree_size < new_capacity - 1) {
+                        new_tree_size *= 2;
+                    }
+                    if (new_tree_size != path_info.tree_size) {
+                        torch::Tensor tree = torch::zeros({2 * new_tree_size, path_info.batch_size,
+                                                           signature_channel_size}, path_info.opts);
+                        int64_t num_leaves = std::max(path_info.length - 1, static_cast<int64_t>(0));
+                        if (num_leaves > 0) {
+                            tree.narrow(/*dim=*/0, /*start=*/new_tree_size, /*length=*/num_leaves)
+                                .copy_(path_info.tree.narrow(/*dim=*/0,
+                                                             /*start=*/path_info.tree_size,
+                                                             /*length=*/num_leaves));
+                        }
+                        path_info.tree = tree;
+                        path_info.tree_size = new_tree_size;
+                        update_tree_nodes(path_info, 0, num_leaves);
+                    }
+                }
+            }
+
+            // Recomputes the stored signatures after the points path[first_point:last_point] have been changed or
+            // added.
+            void recompute(PathInfo& path_info, int64_t first_point, int64_t last_point) {
+                if (path_info.storage == PathStorage::SegmentTree) {
+                    // Only the increments either side of the changed points are affected.
+                    update_tree_leaves(path_info, std::max(first_point - 1, static_cast<int64_t>(0)),
+                                       std::min(last_point, path_info.length - 1));
+                    return;
+                }
+
+                // Every prefix including a changed point is affected.
+                // signature[0] is always zero, so we never need to recompute it.
+                first_point = std::max(first_point, static_cast<int64_t>(1));
+                if (path_info.checkpoint_interval > 1) {
+                    // Only the signatures at the checkpoints are needed. Each one is computed from the one before, so
+                    // that we never need to hold more than one signature beyond those we're storing.
+                    for (int64_t checkpoint = num_checkpoints(path_info, first_point);
+                         checkpoint < num_checkpoints(path_info, path_info.length);
+                         ++checkpoint) {
+                        int64_t previous_point = (checkpoint - 1) * path_info.checkpoint_interval;
+                        torch::Tensor points = path_info.path.narrow(/*dim=*/stream_dim,
+                                                                     /*start=*/previous_point + 1,
+                                                                     /*length=*/path_info.checkpoint_interval);
+                        torch::Tensor new_signature;
+                        std::tie(new_signature, std::ignore) = signature_forward(points,
+                                                                                 path_info.depth,
+                                                                                 /*stream=*/false,
+                                                                                 /*basepoint=*/true,
+                                                                                 path_info.path[previous_point],
+                                                                                 /*inverse=*/false,
+                                                                                 /*initial=*/true,
+                                                                                 path_info.signature[checkpoint - 1],
+                                                                                 /*time_channel=*/false,
+                                                                                 /*lead_lag=*/false);
+                        path_info.signature[checkpoint].copy_(new_signature);
+                    }
+                }
+                else if (first_point < path_info.length) {
+                    int64_t num_new_signatures = path_info.length - first_point;
+                    torch::Tensor new_path = path_info.path.narrow(/*dim=*/stream_dim,
+                                                                   /*start=*/first_point,
+                                                                   /*length=*/num_new_signatures);
+                    torch::Tensor new_signature;
+                    std::tie(new_signature, std::ignore) = signature_forward(new_path,
+                                                                             path_info.depth,
+                                                                             /*stream=*/true,
+                                                                             /*basepoint=*/true,
+                                                                             path_info.path[first_point - 1],
+                                                                             /*inverse=*/false,
+                                                                             /*initial=*/true,
+                                                                             path_info.signature[first_point - 1],
+                                                                             /*time_channel=*/false,
+                                                                             /*lead_lag=*/false);
+                    path_info.signature.narrow(/*dim=*/stream_dim,
+                                               /*start=*/first_point,
+                                               /*length=*/num_new_signatures).copy_(new_signature);
+                }
+            }
+
+            // Appends the points of 'path' onto the path held in 'path_info'.
+            void update(PathInfo& path_info, torch::Tensor path) {
+                int64_t input_stream_size = path.size(stream_dim);
+                int64_t max_length = path_info.max_length;
+                int64_t old_start = path_info.start;
+                bool moved = false;
+                if (max_length > 0) {
+                    if (input_stream_size >= max_length) {
+                        // None of the points currently held will be retained.
+                        path = path.narrow(/*dim=*/stream_dim,
+                                           /*start=*/input_stream_size - max_length,
+                                           /*length=*/max_length);
+                        input_stream_size = max_length;
+                        path_info.start = 0;
+                        path_info.length = 0;
+                        moved = true;
+                    }
+                    else if (path_info.length + input_stream_size > 2 * max_length) {
+                        // Compact the buffers, by moving the points that will be retained to the start of them.
+                        // The source and destination regions don't overlap, as path_info.length > 2 * retain.
+                        int64_t retain = max_length - input_stream_size;
+                        path_info.path.narrow(/*dim=*/stream_dim, /*start=*/0, /*length=*/retain)
+                                      .copy_(path_info.path.narrow(/*dim=*/stream_dim,
+                                                                   /*start=*/path_info.length - retain,
+                                                                   /*length=*/retain));
+                        path_info.start = 0;
+                        path_info.length = retain;
+                        moved = true;
+                        if (path_info.storage == PathStorage::Prefix) {
+                            path_info.signature[0].zero_();
+                        }
+                        recompute(path_info, 0, retain);
+                    }
+                }
+
+                reserve(path_info, path_info.length + input_stream_size);
+
+                path_info.path.narrow(/*dim=*/stream_dim, /*start=*/path_info.length, /*length=*/input_stream_size)
+                              .copy_(path);
+
+                if (path_info.length == 0 && path_info.storage == PathStorage::Prefix) {
+                    // The signature of a single point
+                    path_info.signature[0].zero_();
+                }
+
+                int64_t first_new_point = path_info.length;
+                path_info.length += input_stream_size;
+                recompute(path_info, first_new_point, path_info.length);
+
+                if (max_length > 0) {
+                    path_info.start = std::max(path_info.start, path_info.length - max_length);
+                }
+                if (moved || path_info.start != old_start) {
+                    ++path_info.version;
+                }
+            }
+
+            // Changes the point path[index] to 'value'.
+            void edit(PathInfo& path_info, int64_t index, torch::Tensor value) {
+                path_info.path[index].copy_(value);
+                recompute(path_info, index, index + 1);
+                ++path_info.version;
+            }
+
+            // Interprets 'starts' and 'ends' in the same way as slicing behaviour on the retained points of the path,
+            // and checks that they describe valid intervals. Returns them as nonnegative indices into the buffers, in
+            // tensors on the CPU.
+            std::tuple<torch::Tensor, torch::Tensor> interpret_intervals(const PathInfo& path_info,
+                                                                         torch::Tensor starts,
+                                                                         torch::Tensor ends) {
+                if (starts.ndimension() != 1 || ends.ndimension() != 1) {
+                    throw std::invalid_argument("Arguments 'starts' and 'ends' must be 1-dimensional tensors.");
+                }
+                if (starts.size(0) != ends.size(0)) {
+                    throw std::invalid_argument("Arguments 'starts' and 'ends' must be of the same size.");
+                }
+                if (starts.scalar_type() != torch::kInt64 || ends.scalar_type() != torch::kInt64) {
+                    throw std::invalid_argument("Arguments 'starts' and 'ends' must be of dtype torch.int64.");
+                }
+                // Clone so that we don't modify the tensors we were given
+                starts = starts.to(torch::kCPU).clone();
+                ends = ends.to(torch::kCPU).clone();
+
+                int64_t start = path_info.start;
+                int64_t length = path_info.length - start;
+                auto interpret = [start, length] (int64_t index) {
+                    index = std::min(std::max(index, -length), length);
+                    if (index < 0) {
+                        index += length;
+                    }
+                    return start + index;
+                };
+
+                auto starts_a = starts.accessor<int64_t, 1>();
+                auto ends_a = ends.accessor<int64_t, 1>();
+                for (int64_t interval_index = 0; interval_index < starts.size(0); ++interval_index) {
+                    starts_a[interval_index] = interpret(starts_a[interval_index]);
+                    ends_a[interval_index] = interpret(ends_a[interval_index]);
+                    if (ends_a[interval_index] - starts_a[interval_index] < 2) {
+                        throw std::invalid_argument("Arguments 'starts' and 'ends' must describe intervals containing "
+                                                    "at least two points.");
+                    }
+                }
+                return std::tuple<torch::Tensor, torch::Tensor> {starts, ends};
+            }
+
+            // Computes the signature of every prefix path[:indices[i] + 1] of the path, returning a tensor of shape
+            // (indices, batch, signature_channels). 'indices' should be a one-dimensional tensor on the CPU, whose
+            // entries are all in [0, length).
+            torch::Tensor prefix_signatures(const PathInfo& path_info, torch::Tensor indices) {
+                int64_t num_indices = indices.size(0);
+                int64_t checkpoint_interval = path_info.checkpoint_interval;
+                if (checkpoint_interval == 1) {
+                    return path_info.signature.index_select(/*dim=*/stream_dim,
+                                                            /*index=*/indices.to(path_info.opts.device()));
+                }
+
+                // Each prefix is made up of the prefix up to its nearest preceding checkpoint, followed by some number
+                // of further points, of which there are fewer than checkpoint_interval. So that every prefix can be
+                // handled together, we pad them all out to checkpoint_interval many points by repeating their final
+                // point: repeated points correspond to zero increments, which don't change the signature.
+                torch::Tensor checkpoints = torch::empty({num_indices}, indices.options());
+                torch::Tensor points_indices = torch::empty({num_indices, checkpoint_interval}, indices.options());
+                auto indices_a = indices.accessor<int64_t, 1>();
+                auto checkpoints_a = checkpoints.accessor<int64_t, 1>();
+                auto points_indices_a = points_indices.accessor<int64_t, 2>();
+                for (int64_t index = 0; index < num_indices; ++index) {
+                    int64_t checkpoint = indices_a[index] / checkpoint_interval;
+                    checkpoints_a[index] = checkpoint;
+                    for (int64_t step = 0; step < checkpoint_interval; ++step) {
+                        points_indices_a[index][step] = std::min(checkpoint * checkpoint_interval + step,
+                                                                 indices_a[index]);
+                    }
+                }
+                checkpoints = checkpoints.to(path_info.opts.device());
+                points_indices = points_indices.to(path_info.opts.device());
+
+                int64_t signature_channel_size = signature_channels(path_info.input_channel_size, path_info.depth);
+                torch::Tensor initial = path_info.signature.index_select(/*dim=*/stream_dim, /*index=*/checkpoints);
+                initial = initial.view({num_indices * path_info.batch_size, signature_channel_size});
+                // (indices * checkpoint_interval, batch, channel) to (checkpoint_interval, indices * batch, channel)
+                torch::Tensor points = path_info.path.index_select(/*dim=*/stream_dim,
+                                                                   /*index=*/points_indices.view({-1}));
+                points = points.view({num_indices, checkpoint_interval, path_info.batch_size,
+                                      path_info.input_channel_size})
+                               .transpose(0, 1)
+                               .reshape({checkpoint_interval, num_indices * path_info.batch_size,
+                                         path_info.input_channel_size});
+
+                // The checkpoint itself is the basepoint
+                torch::Tensor signature;
+                std::tie(signature, std::ignore) = signature_forward(points.narrow(/*dim=*/stream_dim,
+                                                                                   /*start=*/1,
+                                                                                   /*length=*/checkpoint_interval - 1),
+                                                                     path_info.depth,
+                                                                     /*stream=*/false,
+                                                                     /*basepoint=*/true,
+                                                                     points[0],
+                                                                     /*inverse=*/false,
+                                                                     /*initial=*/true,
+                                                                     initial,
+                                                                     /*time_channel=*/false,
+                                                                     /*lead_lag=*/false);
+                return signature.view({num_indices, path_info.batch_size, signature_channel_size});
+            }
+
+            // As interval_signatures, for PathStorage::SegmentTree.
+            // This is the usual bottom-up segment tree query, except that every interval is handled at once: at each
+            // level of the tree, each interval picks up at most one node on its left side and at most one node on its
+            // right side. Intervals which don't need a node at a particular level use the (zero) node tree[0] instead,
+            // which represents the identity.
+            torch::Tensor tree_interval_signatures(const PathInfo& path_info, torch::Tensor starts,
+                                                   torch::Tensor ends) {
+                int64_t num_intervals = starts.size(0);
+                int64_t signature_channel_size = signature_channels(path_info.input_channel_size, path_info.depth);
+
+                // The increments over path[start:end] are at leaves [tree_size + start, tree_size + end - 1).
+                torch::Tensor left_nodes = starts + path_info.tree_size;
+                torch::Tensor right_nodes = ends - 1 + path_info.tree_size;
+                torch::Tensor left_index = torch::empty({num_intervals}, starts.options());
+                torch::Tensor right_index = torch::empty({num_intervals}, starts.options());
+                auto left_nodes_a = left_nodes.accessor<int64_t, 1>();
+                auto right_nodes_a = right_nodes.accessor<int64_t, 1>();
+                auto left_index_a = left_index.accessor<int64_t, 1>();
+                auto right_index_a = right_index.accessor<int64_t, 1>();
+
+                // 'left' accumulates the nodes on the left side of the intervals, from left to right. 'right'
+                // accumulates the nodes on the right side of the intervals, from right to left.
+                torch::Tensor left = torch::zeros({num_intervals * path_info.batch_size, signature_channel_size},
+                                                  path_info.opts);
+                torch::Tensor right = torch::zeros({num_intervals * path_info.batch_size, signature_channel_size},
+                                                   path_info.opts);
+                std::vector<torch::Tensor> left_vector;
+                std::vector<torch::Tensor> right_vector;
+                misc::slice_by_term(left, left_vector, path_info.input_channel_size, path_info.depth);
+                misc::slice_by_term(right, right_vector, path_info.input_channel_size, path_info.depth);
+
+                while (true) {
+                    bool finished = true;
+                    for (int64_t interval_index = 0; interval_index < num_intervals; ++interval_index) {
+                        int64_t left_node = left_nodes_a[interval_index];
+                        int64_t right_node = right_nodes_a[interval_index];
+                        left_index_a[interval_index] = 0;
+                        right_index_a[interval_index] = 0;
+                        if (left_node < right_node) {
+                            finished = false;
+                            if (left_node % 2 == 1) {
+                                left_index_a[interval_index] = left_node;
+                                ++left_node;
+                            }
+                            if (right_node % 2 == 1) {
+                                --right_node;
+                                right_index_a[interval_index] = right_node;
+                            }
+                            left_nodes_a[interval_index] = left_node / 2;
+                            right_nodes_a[interval_index] = right_node / 2;
+                        }
+                    }
+                    if (finished) {
+                        break;
+                    }
+
+                    torch::Tensor left_node_signatures =
+                            path_info.tree.index_select(/*dim=*/0, /*index=*/left_index.to(path_info.opts.device()));
+                    torch::Tensor right_node_signatures =
+                            path_info.tree.index_select(/*dim=*/0, /*index=*/right_index.to(path_info.opts.device()));
+                    std::vector<torch::Tensor> left_node_signatures_vector;
+                    std::vector<torch::Tensor> right_node_signatures_vector;
+                    misc::slice_by_term(left_node_signatures.view({num_intervals * path_info.batch_size,
+                                                                   signature_channel_size}),
+                                        left_node_signatures_vector, path_info.input_channel_size, path_info.depth);
+                    misc::slice_by_term(right_node_signatures.view({num_intervals * path_info.batch_size,
+                                                                    signature_channel_size}),
+                                        right_node_signatures_vector, path_info.input_channel_size, path_info.depth);
+                    ta_ops::mult(left_vector, left_node_signatures_vector, /*inverse=*/false);
+                    ta_ops::mult(right_vector, right_node_signatures_vector, /*inverse=*/true);
+                }
+
+                ta_ops::mult(left_vector, right_vector, /*inverse=*/false);
+                return left.view({num_intervals, path_info.batch_size, signature_channel_size});
+            }
+
+            // Computes the signature over every interval [starts[i]:ends[i]] of the path, which are assumed to have
+            // already been through interpret_intervals.
+            // All of the intervals are computed at once, by treating them as an extra batch dimension.
+            torch::Tensor interval_signatures(const PathInfo& path_info, torch::Tensor starts, torch::Tensor ends) {
+                if (path_info.storage == PathStorage::SegmentTree) {
+                    return tree_interval_signatures(path_info, starts, ends);
+                }
+
+                int64_t num_intervals = starts.size(0);
+                int64_t signature_channel_size = signature_channels(path_info.input_channel_size, path_info.depth);
+
+                // The signature over path[start:end] is the inverse of the signature over path[:start + 1],
+                // multiplied by the signature over path[:end]. The inverse is given by the antipode, which is much
+                // cheaper to compute here, for just the start points asked for, than it would be to store the inverse
+                // signature of every prefix of the path.
+                torch::Tensor start_signature = prefix_signatures(path_info, starts);
+                torch::Tensor end_signature = prefix_signatures(path_info, ends - 1);
+                start_signature = start_signature.view({num_intervals * path_info.batch_size, signature_channel_size});
+                end_signature = end_signature.view({num_intervals * path_info.batch_size, signature_channel_size});
+                torch::Tensor signature = torch::empty_like(start_signature);
+
+                std::vector<torch::Tensor> signature_vector;
+                std::vector<torch::Tensor> start_signature_vector;
+                std::vector<torch::Tensor> end_signature_vector;
+                misc::slice_by_term(signature, signature_vector, path_info.input_channel_size, path_info.depth);
+                misc::slice_by_term(start_signature, start_signature_vector, path_info.input_channel_size,
+                                    path_info.depth);
+                misc::slice_by_term(end_signature, end_signature_vector, path_info.input_channel_size,
+                                    path_info.depth);
+                ta_ops::antipode(signature_vector, start_signature_vector);
+                ta_ops::mult(signature_vector, end_signature_vector, /*inverse=*/false);
+
+                return signature.view({num_intervals, path_info.batch_size, signature_channel_size});
+            }
+
+            void update_checkargs(const PathInfo& path_info, torch::Tensor path) {
+                if (path.ndimension() != 3) {
+                    throw std::invalid_argument("Argument 'path' must be a 3-dimensional tensor, with dimensions "
+                                                "corresponding to (batch, stream, channel) respectively.");
+                }
+                if (path.size(stream_dim) == 0) {
+                    throw std::invalid_argument("Argument 'path' cannot have dimensions of size zero.");
+                }
+                if (path.size(batch_dim) != path_info.batch_size) {
+                    throw std::invalid_argument("Cannot append a path with different number of batch elements to what "
+                                                "has already been used.");
+                }
+                if (path.size(channel_dim) != path_info.input_channel_size) {
+                    throw std::invalid_argument("Cannot append a path with different number of channels to what has "
+                                                "already been used.");
+                }
+                if (misc::make_opts(path) != path_info.opts) {
+                    throw std::invalid_argument("Cannot append a path with a different dtype or device to what has "
+                                                "already been used.");
+                }
+            }
+
+            void edit_checkargs(const PathInfo& path_info, int64_t index, torch::Tensor value) {
+                int64_t length = path_info.length - path_info.start;
+                if (index < -length || index >= length) {
+                    throw std::invalid_argument("Argument 'index' is out of range.");
+                }
+                if (value.ndimension() != 2) {
+                    throw std::invalid_argument("Argument 'value' must be a 2-dimensional tensor, corresponding to "
+                                                "(batch, channel) respectively.");
+                }
+                if (value.size(batch_dim) != path_info.batch_size ||
+                    value.size(channel_dim) != path_info.input_channel_size) {
+                    throw std::invalid_argument("Argument 'value' must have the same number of batch elements and "
+                                                "channels as the path.");
+                }
+                if (misc::make_opts(value) != path_info.opts) {
+                    throw std::invalid_argument("Argument 'value' must have the same dtype and device as the path.");
+                }
+            }
+
+            // Backwards through interval_signatures. 'signature' should be as returned from interval_signatures.
+            // Returns the gradient with respect to every retained point of the path.
+            torch::Tensor interval_signatures_backward(torch::Tensor grad_signature, const PathInfo& path_info,
+                                                       torch::Tensor starts, torch::Tensor ends,
+                                                       torch::Tensor signature) {
+                int64_t num_intervals = starts.size(0);
+
+                // Only the retained points of the path get gradients
+                torch::Tensor grad_path = torch::zeros({path_info.length - path_info.start, path_info.batch_size,
+                                                        path_info.input_channel_size}, path_info.opts);
+
+                // We parallelise over intervals. As the intervals may overlap, every thread gets its own tensor to
+                // accumulate gradients in; these are then summed at the end.
+                bool cuda = grad_signature.is_cuda();
+                int64_t num_threads = 1;
+                if (!cuda) {
+                    num_threads = std::min({static_cast<int64_t>(omp_get_max_threads()), get_max_parallelism(),
+                                            num_intervals});
+                    num_threads = std::max(num_threads, static_cast<int64_t>(1));
+                }
+                std::vector<torch::Tensor> grad_path_by_thread(num_threads);
+                grad_path_by_thread[0] = grad_path;
+
+                auto starts_a = starts.accessor<int64_t, 1>();
+                auto ends_a = ends.accessor<int64_t, 1>();
+                #pragma omp parallel for default(none) \
+                                         if(num_threads > 1) \
+                                         num_threads(num_threads) \
+                                         schedule(dynamic, 1) \
+                                         shared(num_intervals, grad_path_by_thread, grad_path, starts_a, ends_a, \
+                                                path_info, grad_signature, signature)
+                for (int64_t interval_index = 0; interval_index < num_intervals; ++interval_index) {
+                    torch::Tensor& grad_path_at_thread = grad_path_by_thread[omp_get_thread_num()];
+                    if (!grad_path_at_thread.defined()) {
+                        grad_path_at_thread = torch::zeros_like(grad_path);
+                    }
+
+                    int64_t start = starts_a[interval_index];
+                    int64_t interval_length = ends_a[interval_index] - start;
+                    torch::Tensor points = path_info.path.narrow(/*dim=*/stream_dim, /*start=*/start,
+                                                                 /*length=*/interval_length);
+                    torch::Tensor path_increments = points.narrow(/*dim=*/stream_dim, /*start=*/1,
+                                                                  /*length=*/interval_length - 1) -
+                                                    points.narrow(/*dim=*/stream_dim, /*start=*/0,
+                                                                  /*length=*/interval_length - 1);
+
+                    torch::Tensor grad_points;
+                    std::tie(grad_points, std::ignore, std::ignore) = signature_backward(grad_signature[interval_index],
+                                                                                         signature[interval_index],
+                                                                                         path_increments,
+                                                                                         path_info.depth,
+                                                                                         /*stream=*/false,
+                                                                                         /*basepoint=*/false,
+                                                                                         /*inverse=*/false,
+                                                                                         /*initial=*/false,
+                                                                                         /*time_channel=*/false,
+                                                                                         /*lead_lag=*/false);
+                    grad_path_at_thread.narrow(/*dim=*/stream_dim,
+                                               /*start=*/start - path_info.start,
+                                               /*length=*/interval_length) += grad_points;
+                }
+
+                for (int64_t thread_index = 1; thread_index < num_threads; ++thread_index) {
+                    if (grad_path_by_thread[thread_index].defined()) {
+                        grad_path += grad_path_by_thread[thread_index];
+                    }
+                }
+
+                return grad_path;
+            }
+        }  // namespace signatory::path::detail
+    }  // namespace signatory::path
+
+    py::object make_path_info(torch::Tensor path, s_size_type depth, bool basepoint, torch::Tensor basepoint_value,
+                              PathStorage storage, int64_t checkpoint_interval, int64_t max_length) {
+        signature_checkargs(path, depth, basepoint, basepoint_value, /*initial=*/false,
+                            /*initial_value=*/torch::Tensor{}, /*time_channel=*/false, /*lead_lag=*/false);
+        if (checkpoint_interval < 1) {
+            throw std::invalid_argument("Argument 'checkpoint_interval' must be an integer greater than or equal to "
+                                        "one.");
+        }
+        if (storage == PathStorage::SegmentTree && checkpoint_interval != 1) {
+            throw std::invalid_argument("Argument 'checkpoint_interval' is only supported with prefix storage.");
+        }
+        if (max_length != 0 && max_length < 2) {
+            throw std::invalid_argument("Argument 'max_length' must be an integer greater than or equal to two. (Need "
+                                        "at least this many points to define a path.)");
+        }
+
+        // No sense keeping track of gradients when we have a dedicated backwards function
+        path = path.detach();
+        basepoint_value = basepoint_value.detach();
+
+        py::object path_info_capsule = misc::wrap_capsule<path::detail::PathInfo>(path.size(batch_dim),
+                                                                                  path.size(channel_dim),
+                                                                                  depth,
+                                                                                  misc::make_opts(path),
+                                                                                  storage,
+                                                                                  checkpoint_interval,
+                                                                                  max_length);
+        path::detail::PathInfo* path_info = misc::unwrap_capsule<path::detail::PathInfo>(path_info_capsule);
+        if (basepoint) {
+            path::detail::update(*path_info, basepoint_value.unsqueeze(stream_dim));
+        }
+        path::detail::update(*path_info, path);
+        return path_info_capsule;
+    }
+
+    void path_update(py::object path_info_capsule, torch::Tensor path) {
+        path::detail::PathInfo* path_info = misc::unwrap_capsule<path::detail::PathInfo>(path_info_capsule);
+        path::detail::update_checkargs(*path_info, path);
+        path::detail::update(*path_info, path.detach());
+    }
+
+    void path_edit(py::object path_info_capsule, int64_t index, torch::Tensor value) {
+        path::detail::PathInfo* path_info = misc::unwrap_capsule<path::detail::PathInfo>(path_info_capsule);
+        path::detail::edit_checkargs(*path_info, index, value);
+        if (index < 0) {
+            index += path_info->length - path_info->start;
+        }
+        path::detail::edit(*path_info, path_info->start + index, value.detach());
+    }
+
+    int64_t path_version(py::object path_info_capsule) {
+        return misc::unwrap_capsule<path::detail::PathInfo>(path_info_capsule)->version;
+    }
+
+    torch::Tensor path_signature_forward(py::object path_info_capsule, torch::Tensor starts, torch::Tensor ends) {
+        path::detail::PathInfo* path_info = misc::unwrap_capsule<path::detail::PathInfo>(path_info_capsule);
+        std::tie(starts, ends) = path::detail::interpret_intervals(*path_info, starts, ends);
+        return path::detail::interval_signatures(*path_info, starts, ends);
+    }
+
+    torch::Tensor path_signature_backward(torch::Tensor grad_signature, py::object path_info_capsule,
+                                          torch::Tensor starts, torch::Tensor ends) {
+        grad_signature = grad_signature.detach();
+
+        path::detail::PathInfo* path_info = misc::unwrap_capsule<path::detail::PathInfo>(path_info_capsule);
+        std::tie(starts, ends) = path::detail::interpret_intervals(*path_info, starts, ends);
+
+        // Recompute the signature over each interval rather than having saved it: there may be a great many intervals,
+        // and this is relatively cheap.
+        torch::Tensor signature = path::detail::interval_signatures(*path_info, starts, ends);
+
+        return path::detail::interval_signatures_backward(grad_signature, *path_info, starts, ends, signature);
+    }
+
+    torch::Tensor path_logsignature_forward(py::object path_info_capsule, torch::Tensor starts, torch::Tensor ends,
+                                            LogSignatureMode mode, py::object lyndon_info_capsule) {
+        path::detail::PathInfo* path_info = misc::unwrap_capsule<path::detail::PathInfo>(path_info_capsule);
+        std::tie(starts, ends) = path::detail::interpret_intervals(*path_info, starts, ends);
+        torch::Tensor signature = path::detail::interval_signatures(*path_info, starts, ends);
+
+        // The intervals are treated as a stream dimension, so that the logarithm is parallelised over them.
+        torch::Tensor logsignature;
+        std::tie(logsignature, std::ignore) = signature_to_logsignature_forward(signature,
+                                                                                path_info->input_channel_size,
+                                                                                path_info->depth,
+                                                                                /*stream=*/true,
+                                                                                mode,
+                                                                                lyndon_info_capsule);
+        return logsignature;
+    }
+
+    torch::Tensor path_logsignature_backward(torch::Tensor grad_logsignature, py::object path_info_capsule,
+                                             torch::Tensor starts, torch::Tensor ends, LogSignatureMode mode,
+                                             py::object lyndon_info_capsule) {
+        path::detail::PathInfo* path_info = misc::unwrap_capsule<path::detail::PathInfo>(path_info_capsule);
+        std::tie(starts, ends) = path::detail::interpret_intervals(*path_info, starts, ends);
+
+        // As in path_signature_backward, we recompute the signature over each interval.
+        torch::Tensor signature = path::detail::interval_signatures(*path_info, starts, ends);
+        torch::Tensor grad_signature = signature_to_logsignature_backward(grad_logsignature,
+                                                                          signature,
+                                                                          path_info->input_channel_size,
+                                                                          path_info->depth,
+                                                                          /*stream=*/true,
+                                                                          mode,
+                                                                          lyndon_info_capsule);
+
+        return path::detail::interval_signatures_backward(grad_signature, *path_info, starts, ends, signature);
+    }
+}  // namespace signatory
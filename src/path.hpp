@@ -0,0 +1,76 @@
+/* Copyright 2019 Patrick Kidger. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ========================================================================= */
+ // Here we handle the storage of a path and its signatures, so that the signature over any interval of it may be
+ // computed quickly. See signatory.Path.
+
+
+#ifndef SIGNATORY_PATH_HPP
+#define SIGNATORY_PATH_HPP
+
+#include <torch/extension.h>
+#include <cstdint>    // int64_t
+
+#include "logsignature.hpp"
+#include "misc.hpp"
+
+namespace signatory {
+    // How the signatures of a path are stored
+    // See signatory.Path for further documentation
+    enum class PathStorage { Prefix, SegmentTree };
+
+    // Makes a PathInfo PyCapsule, holding the given path. Arguments are as signatory.signature, except for 'storage',
+    // 'checkpoint_interval' and 'max_length', which are as signatory.Path. (With max_length == 0 corresponding to
+    // max_length=None.)
+    py::object make_path_info(torch::Tensor path, s_size_type depth, bool basepoint, torch::Tensor basepoint_value,
+                              PathStorage storage, int64_t checkpoint_interval, int64_t max_length);
+
+    // Appends the points of 'path' (of shape (stream, batch, channel)) onto the path held in the capsule, and computes
+    // the signatures corresponding to them. If the capsule has a maximum length then the oldest points are discarded.
+    void path_update(py::object path_info_capsule, torch::Tensor path);
+
+    // Changes the point at 'index' of the path held in the capsule to 'value' (of shape (batch, channel)), and
+    // recomputes the signatures depending on it. See signatory.Path.edit.
+    void path_edit(py::object path_info_capsule, int64_t index, torch::Tensor value);
+
+    // Returns a counter which changes whenever path_update or path_edit change the retained points of the path in a way
+    // that means a previous forward pass can no longer be backpropagated through.
+    int64_t path_version(py::object path_info_capsule);
+
+    // See signatory.Path.signature for documentation.
+    // 'starts' and 'ends' should be one-dimensional int64 tensors of the same size, interpreted as the slices
+    // [starts[i]:ends[i]] of the path. (So in particular they may be negative, as with slicing.) Returns a tensor of
+    // shape (intervals, batch, signature_channels).
+    torch::Tensor path_signature_forward(py::object path_info_capsule, torch::Tensor starts, torch::Tensor ends);
+
+    // See signatory.Path.signature for documentation.
+    // Returns the gradient with respect to every (retained) point held in the capsule, in a tensor of shape
+    // (stream, batch, channel).
+    torch::Tensor path_signature_backward(torch::Tensor grad_signature, py::object path_info_capsule,
+                                          torch::Tensor starts, torch::Tensor ends);
+
+    // See signatory.Path.logsignatures for documentation.
+    // 'starts' and 'ends' are as path_signature_forward. Returns a tensor of shape
+    // (intervals, batch, logsignature_channels).
+    torch::Tensor path_logsignature_forward(py::object path_info_capsule, torch::Tensor starts, torch::Tensor ends,
+                                            LogSignatureMode mode, py::object lyndon_info_capsule);
+
+    // See signatory.Path.logsignatures for documentation.
+    // Returns the gradient with respect to every (retained) point held in the capsule, as path_signature_backward.
+    torch::Tensor path_logsignature_backward(torch::Tensor grad_logsignature, py::object path_info_capsule,
+                                             torch::Tensor starts, torch::Tensor ends, LogSignatureMode mode,
+                                             py::object lyndon_info_capsule);
+}  // namespace signatory
+
+#endif //SIGNATORY_PATH_HPP
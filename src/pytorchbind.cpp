@@ -18,25 +18,85 @@
 #include <torch/extension.h>  // to get the pybind11 stuff
 #include <thread>             // std::thread::hardware_concurrency
 
+#include "accumulator.hpp"   // signatory::make_accumulator_info,
+                             // signatory::accumulator_push,
+                             // signatory::accumulator_signature,
+                             // signatory::accumulator_logsignature
+
+#include "bch.hpp"           // signatory::make_bch_info,
+                             // signatory::logsignature_bch_forward,
+                             // signatory::logsignature_bch_backward
+
+#include "intervals.hpp"     // signatory::signature_table_forward,
+                             // signatory::signature_table_backward,
+                             // signatory::signature_window_forward,
+                             // signatory::signature_window_backward,
+                             // signatory::signature_pyramid_forward,
+                             // signatory::signature_pyramid_backward
+
+#include "jvp.hpp"           // signatory::signature_jvp
+
+#include "kernel.hpp"        // signatory::signature_gram_forward,
+                             // signatory::signature_gram_backward,
+                             // signatory::signature_kernel_forward,
+                             // signatory::signature_kernel_backward
+
 #include "logsignature.hpp"  // signatory::LogSignatureMode,
                              // signatory::signature_to_logsignature_forward,
                              // signatory::signature_to_logsignature_backward,
-                             // signatory::make_lyndon_info
+                             // signatory::make_lyndon_info,
+                             // signatory::logsignature_forward,
+                             // signatory::logsignature_backward
 
 #include "misc.hpp"          // signatory::signature_channels
                              // signatory::set_max_parallelism
                              // signatory::get_max_parallelism
 
+#include "path.hpp"          // signatory::make_path_info,
+                             // signatory::path_update,
+                             // signatory::path_edit,
+                             // signatory::path_version,
+                             // signatory::path_signature_forward,
+                             // signatory::path_signature_backward,
+                             // signatory::path_logsignature_forward,
+                             // signatory::path_logsignature_backward
+
+#include "ragged.hpp"        // signatory::signature_ragged_forward,
+                             // signatory::signature_ragged_backward
+
 #include "signature.hpp"     // signatory::signature_checkargs
                              // signatory::signature_forward,
                              // signatory::signature_backward,
+                             // signatory::signature_indices_forward,
+                             // signatory::signature_indices_backward,
+                             // signatory::expected_signature_forward,
+                             // signatory::expected_signature_backward
+
+#include "sketch.hpp"        // signatory::signature_sketch_forward,
+                             // signatory::signature_sketch_backward
 
 #include "lyndon.hpp"        // signatory::lyndon_words,
                              // signatory::lyndon_brackets,
-                             // signatory::lyndon_words_to_basis_transform
+                             // signatory::lyndon_words_to_basis_transform,
+                             // signatory::lyndon_words_tensor,
+                             // signatory::lyndon_brackets_tensor,
+                             // signatory::all_words_tensor,
+                             // signatory::lyndon_words_to_basis_transform_tensor,
+                             // signatory::words_basis_expansion_tensor
 
 #include "tensor_algebra_ops.hpp"  // signatory::signature_combine_forward,
-                                   // signatory::signature_combine_backward
+                                   // signatory::signature_combine_backward,
+                                   // signatory::tensor_algebra_exp_forward,
+                                   // signatory::tensor_algebra_exp_backward,
+                                   // signatory::tensor_algebra_log_forward,
+                                   // signatory::tensor_algebra_log_backward,
+                                   // signatory::tensor_algebra_antipode
+
+#include "tree.hpp"          // signatory::signature_tree_forward,
+                             // signatory::signature_tree_backward
+
+#include "words.hpp"         // signatory::signature_words_forward,
+                             // signatory::signature_words_backward
 
 #ifndef _OPENMP
     #error OpenMP required
@@ -49,6 +109,43 @@ PYBIND11_MODULE(TORCH_EXTENSION_NAME, m) {
           &signatory::signature_to_logsignature_backward);
     m.def("make_lyndon_info",
           &signatory::make_lyndon_info);
+    m.def("logsignature_forward",
+          &signatory::logsignature_forward);
+    m.def("logsignature_backward",
+          &signatory::logsignature_backward);
+    m.def("make_accumulator_info",
+          &signatory::make_accumulator_info);
+    m.def("accumulator_push",
+          &signatory::accumulator_push);
+    m.def("accumulator_signature",
+          &signatory::accumulator_signature);
+    m.def("accumulator_logsignature",
+          &signatory::accumulator_logsignature);
+    m.def("make_bch_info",
+          &signatory::make_bch_info);
+    m.def("logsignature_bch_forward",
+          &signatory::logsignature_bch_forward);
+    m.def("logsignature_bch_backward",
+          &signatory::logsignature_bch_backward);
+    m.def("make_path_info",
+          &signatory::make_path_info);
+    m.def("path_update",
+          &signatory::path_update);
+    m.def("path_edit",
+          &signatory::path_edit);
+    m.def("path_version",
+          &signatory::path_version);
+    m.def("path_signature_forward",
+          &signatory::path_signature_forward);
+    m.def("path_signature_backward",
+          &signatory::path_signature_backward);
+    m.def("path_logsignature_forward",
+          &signatory::path_logsignature_forward);
+    m.def("path_logsignature_backward",
+          &signatory::path_logsignature_backward);
+    py::enum_<signatory::PathStorage>(m, "PathStorage")
+            .value("Prefix", signatory::PathStorage::Prefix)
+            .value("SegmentTree", signatory::PathStorage::SegmentTree);
     m.def("hardware_concurrency",
           &std::thread::hardware_concurrency);
     py::enum_<signatory::LogSignatureMode>(m, "LogSignatureMode")
@@ -57,10 +154,56 @@ PYBIND11_MODULE(TORCH_EXTENSION_NAME, m) {
             .value("Words", signatory::LogSignatureMode::Words);
     m.def("signature_checkargs",
           &signatory::signature_checkargs);
+    m.def("signature_table_forward",
+          &signatory::signature_table_forward);
+    m.def("signature_table_backward",
+          &signatory::signature_table_backward);
+    m.def("signature_window_forward",
+          &signatory::signature_window_forward);
+    m.def("signature_window_backward",
+          &signatory::signature_window_backward);
+    m.def("signature_pyramid_forward",
+          &signatory::signature_pyramid_forward);
+    m.def("signature_pyramid_backward",
+          &signatory::signature_pyramid_backward);
+    m.def("signature_gram_forward",
+          &signatory::signature_gram_forward);
+    m.def("signature_gram_backward",
+          &signatory::signature_gram_backward);
+    m.def("signature_kernel_forward",
+          &signatory::signature_kernel_forward);
+    m.def("signature_kernel_backward",
+          &signatory::signature_kernel_backward);
     m.def("signature_forward",
           &signatory::signature_forward);
     m.def("signature_backward",
           &signatory::signature_backward);
+    m.def("signature_indices_forward",
+          &signatory::signature_indices_forward);
+    m.def("signature_indices_backward",
+          &signatory::signature_indices_backward);
+    m.def("expected_signature_forward",
+          &signatory::expected_signature_forward);
+    m.def("expected_signature_backward",
+          &signatory::expected_signature_backward);
+    m.def("signature_jvp",
+          &signatory::signature_jvp);
+    m.def("signature_ragged_forward",
+          &signatory::signature_ragged_forward);
+    m.def("signature_ragged_backward",
+          &signatory::signature_ragged_backward);
+    m.def("signature_sketch_forward",
+          &signatory::signature_sketch_forward);
+    m.def("signature_sketch_backward",
+          &signatory::signature_sketch_backward);
+    m.def("signature_tree_forward",
+          &signatory::signature_tree_forward);
+    m.def("signature_tree_backward",
+          &signatory::signature_tree_backward);
+    m.def("signature_words_forward",
+          &signatory::signature_words_forward);
+    m.def("signature_words_backward",
+          &signatory::signature_words_backward);
     m.def("signature_channels",
           &signatory::signature_channels);
     m.def("set_max_parallelism",
@@ -76,8 +219,28 @@ PYBIND11_MODULE(TORCH_EXTENSION_NAME, m) {
     m.def("lyndon_words_to_basis_transform",
           &signatory::lyndon_words_to_basis_transform,
           py::return_value_policy::move);
+    m.def("lyndon_words_tensor",
+          &signatory::lyndon_words_tensor);
+    m.def("lyndon_brackets_tensor",
+          &signatory::lyndon_brackets_tensor);
+    m.def("all_words_tensor",
+          &signatory::all_words_tensor);
+    m.def("lyndon_words_to_basis_transform_tensor",
+          &signatory::lyndon_words_to_basis_transform_tensor);
+    m.def("words_basis_expansion_tensor",
+          &signatory::words_basis_expansion_tensor);
     m.def("signature_combine_forward",
           &signatory::signature_combine_forward);
     m.def("signature_combine_backward",
         &signatory::signature_combine_backward);
+    m.def("tensor_algebra_exp_forward",
+          &signatory::tensor_algebra_exp_forward);
+    m.def("tensor_algebra_exp_backward",
+          &signatory::tensor_algebra_exp_backward);
+    m.def("tensor_algebra_log_forward",
+          &signatory::tensor_algebra_log_forward);
+    m.def("tensor_algebra_log_backward",
+          &signatory::tensor_algebra_log_backward);
+    m.def("tensor_algebra_antipode",
+          &signatory::tensor_algebra_antipode);
 }
\ No newline at end of file
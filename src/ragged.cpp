@@ -0,0 +1,430 @@
+/* Copyright 2019 Patrick Kidger. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ========================================================================= */
+ // Here we handle computing the signatures of a ragged batch of paths, of different lengths, without padding them to a
+ // common length.
+
+
+#include <torch/extension.h>
+#include <algorithm>  // std::fill, std::max, std::min, std::stable_sort
+#include <cstdint>    // int64_t
+#include <functional> // std::greater
+#include <numeric>    // std::iota
+#include <omp.h>
+#include <queue>      // std::priority_queue
+#include <stdexcept>  // std::invalid_argument
+#include <tuple>      // std::tuple
+#include <utility>    // std::pair
+#include <vector>     // std::vector
+
+#include "misc.hpp"
+#include "ragged.hpp"
+#include "tensor_algebra_ops.hpp"
+
+
+namespace signatory {
+    namespace ragged {
+        namespace detail {
+            void ragged_checkargs(torch::Tensor path, torch::Tensor lengths, s_size_type depth, bool basepoint,
+                                  torch::Tensor basepoint_value) {
+                if (path.ndimension() != 2) {
+                    throw std::invalid_argument("Argument 'path' must be a 2-dimensional tensor, with dimensions "
+                                                "corresponding to (point, channel) respectively.");
+                }
+                if (path.size(0) == 0 || path.size(1) == 0) {
+                    throw std::invalid_argument("Argument 'path' cannot have dimensions of size zero.");
+                }
+                if (!path.is_floating_point()) {
+                    throw std::invalid_argument("Argument 'path' must be of floating point type.");
+                }
+                if (depth < 1) {
+                    throw std::invalid_argument("Argument 'depth' must be an integer greater than or equal to one.");
+                }
+                if (lengths.ndimension() != 1 || lengths.scalar_type() != torch::kLong || lengths.is_cuda()) {
+                    throw std::invalid_argument("Argument 'lengths' must be a one-dimensional collection of "
+                                                "integers.");
+                }
+                if (lengths.size(0) == 0) {
+                    throw std::invalid_argument("Argument 'lengths' must have at least one entry.");
+                }
+                auto lengths_a = lengths.accessor<int64_t, 1>();
+                int64_t total_length = 0;
+                for (int64_t path_index = 0; path_index < lengths.size(0); ++path_index) {
+                    if (lengths_a[path_index] < (basepoint ? 1 : 2)) {
+                        throw std::invalid_argument("Every path must have at least two points (or at least one point "
+                                                    "if a basepoint is used). (Need at least this many points to "
+                                                    "define a path.)");
+                    }
+                    total_length += lengths_a[path_index];
+                }
+                if (total_length != path.size(0)) {
+                    throw std::invalid_argument("The entries of argument 'lengths' must sum to the number of points in "
+                                                "'path'.");
+                }
+                if (basepoint) {
+                    if (basepoint_value.ndimension() != 2 || basepoint_value.size(0) != lengths.size(0) ||
+                        basepoint_value.size(1) != path.size(1)) {
+                        throw std::invalid_argument("Argument 'basepoint' must be a 2-dimensional tensor, of shape "
+                                                    "(paths, channel).");
+                    }
+                    if (misc::make_opts(path) != misc::make_opts(basepoint_value)) {
+                        throw std::invalid_argument("Argument 'basepoint' does not have the same dtype or device as "
+                                                    "'path'.");
+                    }
+                }
+            }
+
+            // Describes how the increments of the paths are laid out.
+            // The increments are computed in a flat layout, with the increments of each path one after the other. They
+            // may also be rearranged into a packed layout: the paths are sorted from longest to shortest, and then the
+            // first increment of every path is placed first, followed by the second increment of every path with at
+            // least two increments, and so on. So at every step, the paths that are still going form a contiguous
+            // prefix of the sorted paths, and may be handled as a single batch without any padding.
+            struct RaggedInfo {
+                RaggedInfo(torch::Tensor lengths, bool basepoint, torch::Device device) {
+                    auto lengths_a = lengths.accessor<int64_t, 1>();
+                    num_paths = lengths.size(0);
+                    num_increments.reserve(num_paths);
+                    increment_offsets.reserve(num_paths);
+
+                    // Where each increment is taken from and to, as rows of the path. If there is a basepoint then
+                    // these are rows of the path with the basepoints placed before every other point.
+                    std::vector<int64_t> to;
+                    std::vector<int64_t> from;
+                    int64_t point_offset = basepoint ? num_paths : 0;
+                    total_increments = 0;
+                    for (int64_t path_index = 0; path_index < num_paths; ++path_index) {
+                        int64_t length = lengths_a[path_index];
+                        int64_t path_num_increments = basepoint ? length : length - 1;
+                        num_increments.push_back(path_num_increments);
+                        increment_offsets.push_back(total_increments);
+                        for (int64_t step = 0; step < path_num_increments; ++step) {
+                            if (basepoint) {
+                                to.push_back(point_offset + step);
+                                from.push_back(step == 0 ? path_index : point_offset + step - 1);
+                            }
+                            else {
+                                to.push_back(point_offset + step + 1);
+                                from.push_back(point_offset + step);
+                            }
+                        }
+                        point_offset += length;
+                        total_increments += path_num_increments;
+                    }
+
+                    order.resize(num_paths);
+                    std::iota(order.begin(), order.end(), 0);
+                    std::stable_sort(order.begin(), order.end(), [&] (int64_t path_index, int64_t other_index) {
+                        return num_increments[path_index] > num_increments[other_index];
+                    });
+
+                    std::vector<int64_t> packed;
+                    packed.reserve(total_increments);
+                    int64_t num_active = num_paths;
+                    for (int64_t step = 0; step < num_increments[order[0]]; ++step) {
+                        while (num_increments[order[num_active - 1]] <= step) {
+                            --num_active;
+                        }
+                        step_sizes.push_back(num_active);
+                        step_offsets.push_back(packed.size());
+                        for (int64_t rank = 0; rank < num_active; ++rank) {
+                            packed.push_back(increment_offsets[order[rank]] + step);
+                        }
+                    }
+
+                    std::vector<int64_t> last;
+                    last.reserve(num_paths);
+                    for (int64_t path_index : order) {
+                        last.push_back(increment_offsets[path_index] + num_increments[path_index] - 1);
+                    }
+
+                    to_index = to_tensor(to, device);
+                    from_index = to_tensor(from, device);
+                    packed_index = to_tensor(packed, device);
+                    order_index = to_tensor(order, device);
+                    last_index = to_tensor(last, device);
+                }
+
+                int64_t num_paths;
+                int64_t total_increments;
+                // The number of increments of each path, and where they start in the flat layout.
+                std::vector<int64_t> num_increments;
+                std::vector<int64_t> increment_offsets;
+                // The paths, from longest to shortest.
+                std::vector<int64_t> order;
+                // The number of paths still going at each step, and where that step starts in the packed layout.
+                std::vector<int64_t> step_sizes;
+                std::vector<int64_t> step_offsets;
+
+                // Where to take each increment to and from, as described above. In the flat layout.
+                torch::Tensor to_index;
+                torch::Tensor from_index;
+                // The position in the flat layout of each position in the packed layout.
+                torch::Tensor packed_index;
+                // 'order' as a tensor.
+                torch::Tensor order_index;
+                // The position in the flat layout of the final increment of every path, in the order given by 'order'.
+                torch::Tensor last_index;
+            private:
+                static torch::Tensor to_tensor(const std::vector<int64_t>& indices, torch::Device device) {
+                    torch::Tensor out = torch::empty({static_cast<int64_t>(indices.size())},
+                                                     torch::TensorOptions().dtype(torch::kLong));
+                    std::copy(indices.begin(), indices.end(), out.data<int64_t>());
+                    return out.to(device);
+                }
+            };
+
+            // Returns the increments of the paths in the flat layout
+            torch::Tensor compute_increments(torch::Tensor path, bool basepoint, torch::Tensor basepoint_value,
+                                             const RaggedInfo& info) {
+                torch::Tensor points = basepoint ? torch::cat({basepoint_value, path}, /*dim=*/0) : path;
+                return points.index_select(/*dim=*/0, info.to_index) - points.index_select(/*dim=*/0, info.from_index);
+            }
+
+            // Backwards through compute_increments. Returns the gradients with respect to the path and the basepoint.
+            std::tuple<torch::Tensor, torch::Tensor>
+            compute_increments_backward(torch::Tensor grad_increments, int64_t num_points, bool basepoint,
+                                        const RaggedInfo& info, torch::TensorOptions opts) {
+                int64_t num_rows = num_points + (basepoint ? info.num_paths : 0);
+                torch::Tensor grad_points = torch::zeros({num_rows, grad_increments.size(1)}, opts);
+                grad_points.index_add_(/*dim=*/0, info.to_index, grad_increments);
+                grad_points.index_add_(/*dim=*/0, info.from_index, -grad_increments);
+                if (basepoint) {
+                    return std::tuple<torch::Tensor, torch::Tensor>
+                            {grad_points.narrow(/*dim=*/0, /*start=*/info.num_paths, /*len=*/num_points),
+                             grad_points.narrow(/*dim=*/0, /*start=*/0, /*len=*/info.num_paths)};
+                }
+                else {
+                    // no second return value in this case
+                    return std::tuple<torch::Tensor, torch::Tensor> {grad_points, torch::empty({0}, opts)};
+                }
+            }
+
+            // Assigns the paths to threads, so as to balance the total number of increments handled by each thread.
+            // This is the longest-processing-time-first rule: the paths are taken from longest to shortest, and each
+            // is given to whichever thread currently has the least work.
+            std::vector<std::vector<int64_t>> schedule_paths(const RaggedInfo& info, int64_t num_threads) {
+                std::vector<std::vector<int64_t>> paths_by_thread(num_threads);
+                using load_type = std::pair<int64_t, int64_t>;  // (work, thread_index)
+                std::priority_queue<load_type, std::vector<load_type>, std::greater<load_type>> loads;
+                for (int64_t thread_index = 0; thread_index < num_threads; ++thread_index) {
+                    loads.emplace(0, thread_index);
+                }
+                for (int64_t path_index : info.order) {
+                    load_type load = loads.top();
+                    loads.pop();
+                    paths_by_thread[load.second].push_back(path_index);
+                    load.first += info.num_increments[path_index];
+                    loads.push(load);
+                }
+                return paths_by_thread;
+            }
+
+            // Computes the signature of every path, with each thread handling the paths it has been scheduled, one at
+            // a time. If stream==true then 'signature' is of shape (increments, signature_channels) and in the flat
+            // layout; else it is of shape (paths, signature_channels).
+            template <typename scalar_t>
+            void ragged_forward_cpu(torch::Tensor increments, const RaggedInfo& info, torch::Tensor reciprocals,
+                                    s_size_type depth, bool stream, torch::Tensor signature) {
+                int64_t input_channel_size = increments.size(1);
+                int64_t output_channel_size = signature.size(1);
+                int64_t num_threads = std::min({static_cast<int64_t>(omp_get_max_threads()), get_max_parallelism(),
+                                                info.num_paths});
+                num_threads = std::max(num_threads, static_cast<int64_t>(1));
+                std::vector<std::vector<int64_t>> paths_by_thread = schedule_paths(info, num_threads);
+
+                auto increments_a = increments.accessor<scalar_t, 2>();
+                auto reciprocals_a = reciprocals.accessor<scalar_t, 1>();
+                scalar_t* signature_data = signature.data<scalar_t>();
+
+                // The signature of the path that each thread is currently working on
+                torch::Tensor signature_by_thread = torch::empty({num_threads, output_channel_size},
+                                                                 misc::make_opts(signature));
+                scalar_t* signature_by_thread_data = signature_by_thread.data<scalar_t>();
+                std::vector<std::vector<torch::TensorAccessor<scalar_t, 1>>> signature_by_term_by_thread_a(
+                        num_threads);
+                for (int64_t thread_index = 0; thread_index < num_threads; ++thread_index) {
+                    std::vector<torch::Tensor> signature_by_term;
+                    misc::slice_by_term(signature_by_thread[thread_index], signature_by_term, input_channel_size,
+                                        depth);
+                    for (auto elem : signature_by_term) {
+                        signature_by_term_by_thread_a[thread_index].push_back(elem.accessor<scalar_t, 1>());
+                    }
+                }
+
+                #pragma omp parallel for default(none) \
+                                         if(num_threads > 1) \
+                                         num_threads(num_threads) \
+                                         schedule(static, 1) \
+                                         shared(num_threads, paths_by_thread, info, output_channel_size, stream, \
+                                                increments_a, reciprocals_a, signature_data, \
+                                                signature_by_thread_data, signature_by_term_by_thread_a)
+                for (int64_t thread_index = 0; thread_index < num_threads; ++thread_index) {
+                    scalar_t* thread_signature_data = signature_by_thread_data + thread_index * output_channel_size;
+                    for (int64_t path_index : paths_by_thread[thread_index]) {
+                        int64_t increment_offset = info.increment_offsets[path_index];
+                        // Multiplying the identity (all of whose nonscalar terms are zero) by exp(x) gives exp(x), so
+                        // this also handles the first increment.
+                        std::fill(thread_signature_data, thread_signature_data + output_channel_size, 0);
+                        for (int64_t step = 0; step < info.num_increments[path_index]; ++step) {
+                            ta_ops::mult_fused_restricted_exp_single_cpu<scalar_t, /*inverse=*/false>
+                                    (increments_a[increment_offset + step],
+                                     signature_by_term_by_thread_a[thread_index],
+                                     reciprocals_a);
+                            if (stream) {
+                                std::copy(thread_signature_data, thread_signature_data + output_channel_size,
+                                          signature_data + (increment_offset + step) * output_channel_size);
+                            }
+                        }
+                        if (!stream) {
+                            std::copy(thread_signature_data, thread_signature_data + output_channel_size,
+                                      signature_data + path_index * output_channel_size);
+                        }
+                    }
+                }
+            }
+
+            // As ragged_forward_cpu, except that each step is computed as a single batch over every path still going,
+            // using the packed layout.
+            void ragged_forward_gpu(torch::Tensor increments, const RaggedInfo& info, torch::Tensor reciprocals,
+                                    s_size_type depth, bool stream, torch::Tensor signature) {
+                int64_t input_channel_size = increments.size(1);
+                torch::Tensor packed_increments = increments.index_select(/*dim=*/0, info.packed_index);
+
+                // The signature of every path, in the order given by info.order.
+                torch::Tensor sorted_signature = torch::empty({info.num_paths, signature.size(1)},
+                                                              misc::make_opts(signature));
+                for (s_size_type step = 0; step < static_cast<s_size_type>(info.step_sizes.size()); ++step) {
+                    int64_t step_size = info.step_sizes[step];
+                    int64_t step_offset = info.step_offsets[step];
+                    torch::Tensor next = packed_increments.narrow(/*dim=*/0, /*start=*/step_offset, /*len=*/step_size);
+                    std::vector<torch::Tensor> signature_by_term;
+                    misc::slice_by_term(sorted_signature.narrow(/*dim=*/0, /*start=*/0, /*len=*/step_size),
+                                        signature_by_term, input_channel_size, depth);
+                    if (step == 0) {
+                        ta_ops::restricted_exp(next, signature_by_term, reciprocals);
+                    }
+                    else {
+                        ta_ops::mult_fused_restricted_exp(next, signature_by_term, /*inverse=*/false, reciprocals);
+                    }
+                    if (stream) {
+                        signature.index_copy_(/*dim=*/0,
+                                              info.packed_index.narrow(/*dim=*/0, /*start=*/step_offset,
+                                                                       /*len=*/step_size),
+                                              sorted_signature.narrow(/*dim=*/0, /*start=*/0, /*len=*/step_size));
+                    }
+                }
+                if (!stream) {
+                    signature.index_copy_(/*dim=*/0, info.order_index, sorted_signature);
+                }
+            }
+        }  // namespace signatory::ragged::detail
+    }  // namespace signatory::ragged
+
+    torch::Tensor signature_ragged_forward(torch::Tensor path, torch::Tensor lengths, s_size_type depth, bool stream,
+                                           bool basepoint, torch::Tensor basepoint_value) {
+        ragged::detail::ragged_checkargs(path, lengths, depth, basepoint, basepoint_value);
+
+        path = path.detach();
+        basepoint_value = basepoint_value.detach();
+
+        ragged::detail::RaggedInfo info(lengths, basepoint, path.device());
+        torch::Tensor increments = ragged::detail::compute_increments(path, basepoint, basepoint_value,
+                                                                      info).contiguous();
+        int64_t output_channel_size = signature_channels(increments.size(1), depth);
+        torch::TensorOptions opts = misc::make_opts(path);
+        torch::Tensor reciprocals = misc::make_reciprocals(depth, opts);
+
+        torch::Tensor signature = torch::empty({stream ? info.total_increments : info.num_paths, output_channel_size},
+                                               opts);
+        if (path.is_cuda()) {
+            ragged::detail::ragged_forward_gpu(increments, info, reciprocals, depth, stream, signature);
+        }
+        else {
+            AT_DISPATCH_FLOATING_TYPES(path.type(), "signature_ragged_forward", ([&] {
+                ragged::detail::ragged_forward_cpu<scalar_t>(increments, info, reciprocals, depth, stream, signature);
+            }));
+        }
+        return signature;
+    }
+
+    std::tuple<torch::Tensor, torch::Tensor>
+    signature_ragged_backward(torch::Tensor grad_signature, torch::Tensor signature, torch::Tensor path,
+                              torch::Tensor lengths, s_size_type depth, bool stream, bool basepoint,
+                              torch::Tensor basepoint_value) {
+        grad_signature = grad_signature.detach();
+        signature = signature.detach();
+        path = path.detach();
+        basepoint_value = basepoint_value.detach();
+
+        ragged::detail::RaggedInfo info(lengths, basepoint, path.device());
+        torch::Tensor increments = ragged::detail::compute_increments(path, basepoint, basepoint_value, info);
+        int64_t input_channel_size = increments.size(1);
+        torch::TensorOptions opts = misc::make_opts(path);
+        torch::Tensor reciprocals = misc::make_reciprocals(depth, opts);
+
+        // We work in the packed layout, so that each step is a single batch over every path still going.
+        torch::Tensor packed_increments = increments.index_select(/*dim=*/0, info.packed_index);
+        torch::Tensor grad_packed_increments = torch::empty_like(packed_increments);
+
+        // The signature of every path, and the gradient with respect to it, in the order given by info.order.
+        torch::Tensor sorted_signature;
+        torch::Tensor sorted_grad_signature;
+        if (stream) {
+            sorted_signature = signature.index_select(/*dim=*/0, info.last_index);
+            sorted_grad_signature = torch::zeros_like(sorted_signature);
+        }
+        else {
+            sorted_signature = signature.index_select(/*dim=*/0, info.order_index);
+            sorted_grad_signature = grad_signature.index_select(/*dim=*/0, info.order_index);
+        }
+
+        for (s_size_type step = static_cast<s_size_type>(info.step_sizes.size()) - 1; step >= 0; --step) {
+            int64_t step_size = info.step_sizes[step];
+            int64_t step_offset = info.step_offsets[step];
+            torch::Tensor next = packed_increments.narrow(/*dim=*/0, /*start=*/step_offset, /*len=*/step_size);
+            torch::Tensor grad_next = grad_packed_increments.narrow(/*dim=*/0, /*start=*/step_offset,
+                                                                    /*len=*/step_size);
+            torch::Tensor grad_signature_at_step = sorted_grad_signature.narrow(/*dim=*/0, /*start=*/0,
+                                                                                /*len=*/step_size);
+            if (stream) {
+                grad_signature_at_step += grad_signature.index_select(/*dim=*/0,
+                                                                      info.packed_index.narrow(/*dim=*/0,
+                                                                                               /*start=*/step_offset,
+                                                                                               /*len=*/step_size));
+            }
+
+            std::vector<torch::Tensor> signature_by_term;
+            misc::slice_by_term(sorted_signature.narrow(/*dim=*/0, /*start=*/0, /*len=*/step_size), signature_by_term,
+                                input_channel_size, depth);
+            std::vector<torch::Tensor> grad_signature_by_term;
+            misc::slice_by_term(grad_signature_at_step, grad_signature_by_term, input_channel_size, depth);
+            if (step == 0) {
+                ta_ops::restricted_exp_backward(grad_next, grad_signature_by_term, next, signature_by_term,
+                                                reciprocals);
+            }
+            else {
+                // Recover the signature of each path up to the previous step, via the reversibility property of the
+                // signature.
+                ta_ops::mult_fused_restricted_exp(-next, signature_by_term, /*inverse=*/false, reciprocals);
+                ta_ops::mult_fused_restricted_exp_backward(grad_next, grad_signature_by_term, next, signature_by_term,
+                                                           /*inverse=*/false, reciprocals);
+            }
+        }
+
+        torch::Tensor grad_increments = torch::empty_like(increments);
+        grad_increments.index_copy_(/*dim=*/0, info.packed_index, grad_packed_increments);
+        return ragged::detail::compute_increments_backward(grad_increments, path.size(0), basepoint, info, opts);
+    }
+}  // namespace signatory
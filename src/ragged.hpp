@@ -0,0 +1,45 @@
+/* Copyright 2019 Patrick Kidger. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ========================================================================= */
+ // Here we handle computing the signatures of a ragged batch of paths, of different lengths, without padding them to a
+ // common length.
+
+
+#ifndef SIGNATORY_RAGGED_HPP
+#define SIGNATORY_RAGGED_HPP
+
+#include <torch/extension.h>
+#include <tuple>      // std::tuple
+
+#include "misc.hpp"
+
+namespace signatory {
+    // See signatory.signature_ragged for documentation.
+    // 'path' should be of shape (points, channel), holding every path one after another, and 'lengths' should be a
+    // one-dimensional int64 tensor on the CPU, holding the number of points in each path. 'basepoint_value' should be
+    // of shape (paths, channel).
+    // Returns a tensor of shape (paths, signature_channels), or (increments, signature_channels) if stream==true.
+    torch::Tensor signature_ragged_forward(torch::Tensor path, torch::Tensor lengths, s_size_type depth, bool stream,
+                                           bool basepoint, torch::Tensor basepoint_value);
+
+    // See signatory.signature_ragged for documentation.
+    // 'signature' should be as returned by signature_ragged_forward.
+    // Returns the gradients with respect to the path and the basepoint.
+    std::tuple<torch::Tensor, torch::Tensor>
+    signature_ragged_backward(torch::Tensor grad_signature, torch::Tensor signature, torch::Tensor path,
+                              torch::Tensor lengths, s_size_type depth, bool stream, bool basepoint,
+                              torch::Tensor basepoint_value);
+}  // namespace signatory
+
+#endif //SIGNATORY_RAGGED_HPP
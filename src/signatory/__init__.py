@@ -34,25 +34,48 @@ except ImportError as e:
         raise
 
 
+from .accumulator import SignatureAccumulator
 from .augment import Augment
+from .chunked_module import signature_chunks, signature_file
+from .intervals_module import (signature_table,
+                               signature_window,
+                               signature_pyramid)
+from .kernel_module import signature_gram, signature_kernel
 from .logsignature_module import (signature_to_logsignature,
                                   SignatureToLogSignature,
                                   SignatureToLogsignature,
                                   logsignature,
+                                  logsignature_ragged,
                                   LogSignature,
                                   Logsignature,  # alias for LogSignature
-                                  logsignature_channels)
+                                  logsignature_channels,
+                                  logsignature_to_signature)
 from .path import Path
 from .signature_module import (signature,
                                Signature,
+                               expected_signature,
+                               signature_ragged,
+                               signature_tree,
+                               signature_words,
+                               signature_jvp,
                                signature_channels,
                                extract_signature_term,
                                signature_combine,
                                multi_signature_combine)
+from .sketch_module import (signature_sketch,
+                            sketch_hashes,
+                            SignatureSketch)
+from .tensor_algebra_module import (ta_mult,
+                                    ta_exp,
+                                    ta_log,
+                                    ta_antipode)
 from . import unstable  # make it available as an attribute here, but don't import any unstable objects themselves
 from .utility import (lyndon_words,
                       lyndon_brackets,
                       all_words,
+                      lyndon_words_tensor,
+                      lyndon_brackets_tensor,
+                      all_words_tensor,
                       max_parallelism)
 
 
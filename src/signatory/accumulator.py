@@ -0,0 +1,120 @@
+# Copyright 2019 Patrick Kidger. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# 
+#    http://www.apache.org/licenses/LICENSE-2.0
+# 
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# =========================================================================
+"""Provides the SignatureAccumulator class, for keeping track of the signature of a stream of data with low latency."""
+
+import torch
+import warnings
+
+from . import signature_module as smodule
+from . import logsignature_module as lmodule
+from . import impl
+
+
+class SignatureAccumulator(object):
+    """Keeps track of the signature of a stream of data that arrives a point at a time.
+
+    This is equivalent to repeatedly calling :func:`signatory.signature` with the :attr:`basepoint` and
+    :attr:`initial` arguments, as in :ref:`this example<examples-online>`, but with much less overhead per point. The
+    signature is held in C++, and each new point is incorporated into it in-place by a single fused
+    multiply-exponentiate, without any intermediate tensors being allocated. This makes it suitable for online
+    inference, where the latency of each update matters.
+
+    Gradients are not tracked through this class. If you need gradients, use :class:`signatory.Path` instead.
+
+    Arguments:
+        point (:class:`torch.Tensor`): The first point of the stream, of shape :math:`(N, C)`, where :math:`N` is the
+            batch size and :math:`C` the number of channels.
+
+        depth (int): The depth to truncate the signature at.
+    """
+    def __init__(self, point, depth):
+        # type: (torch.Tensor, int) -> None
+        self._depth = depth
+        self._cuda = point.is_cuda
+        self._channels = point.size(-1)
+        self._signature_channels = smodule.signature_channels(self._channels, self._depth)
+        self._logsignature_channels = lmodule.logsignature_channels(self._channels, self._depth)
+        self._lyndon_info_capsules = {}
+
+        self._accumulator_info = impl.make_accumulator_info(point, depth)
+
+    def push(self, points):
+        # type: (torch.Tensor) -> None
+        """Extends the stream with more points, and updates the signature accordingly.
+
+        Arguments:
+            points (:class:`torch.Tensor`): Either a single point, of shape :math:`(N, C)`, or several points, of shape
+                :math:`(N, L, C)`.
+        """
+        if points.ndimension() == 3:
+            # (batch, stream, channel) to (stream, batch, channel)
+            points = points.transpose(0, 1)
+        impl.accumulator_push(self._accumulator_info, points)
+
+    def signature(self):
+        # type: () -> torch.Tensor
+        r"""Returns the signature of the stream so far.
+
+        Returns:
+            A :class:`torch.Tensor` of shape :math:`(N, C + C^2 + \cdots + C^\text{depth})`. It is a copy, so it is not
+            modified by later calls to :meth:`signatory.SignatureAccumulator.push`.
+        """
+        return impl.accumulator_signature(self._accumulator_info)
+
+    def logsignature(self, mode="words"):
+        # type: (str) -> torch.Tensor
+        r"""Returns the logsignature of the stream so far.
+
+        Arguments:
+            mode (str, optional): As :func:`signatory.logsignature`.
+
+        Returns:
+            A :class:`torch.Tensor` of shape :math:`(N, \text{logsignature_channels})`, as
+            :func:`signatory.logsignature`.
+        """
+        try:
+            lyndon_info_capsule = self._lyndon_info_capsules[mode]
+        except KeyError:
+            lyndon_info_capsule = lmodule.SignatureToLogSignature._get_lyndon_info(self._channels, self._depth, mode)
+            self._lyndon_info_capsules[mode] = lyndon_info_capsule
+        if self._cuda and mode == 'brackets':
+            warnings.warn("The logsignature with mode='brackets' has been requested on the GPU. This mode is quite "
+                          "slow to calculate, and the GPU offers no speedup. Consider mode='words' instead.")
+        return impl.accumulator_logsignature(self._accumulator_info, lmodule._interpret_mode(mode),
+                                             lyndon_info_capsule.item)
+
+    @property
+    def depth(self):
+        # type: () -> int
+        """The depth that the signature is calculated to."""
+        return self._depth
+
+    # Method not property for consistency with signature_channels and logsignature_channels
+    def channels(self):
+        # type: () -> int
+        """The number of channels of the input stream."""
+        return self._channels
+
+    # Method not property for consistency with signatory.signature_channels
+    def signature_channels(self):
+        # type: () -> int
+        """The number of signature channels; as :func:`signatory.signature_channels`."""
+        return self._signature_channels
+
+    # Method not property for consistency with signatory.signature_channels
+    def logsignature_channels(self):
+        # type: () -> int
+        """The number of logsignature channels; as :func:`signatory.logsignature_channels`."""
+        return self._logsignature_channels
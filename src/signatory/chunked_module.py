@@ -0,0 +1,162 @@
+# Copyright 2019 Patrick Kidger. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# 
+#    http://www.apache.org/licenses/LICENSE-2.0
+# 
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# =========================================================================
+"""Provides operations for computing signatures of paths too large to hold in memory at once."""
+
+
+import os
+import torch
+
+from . import signature_module as smodule
+
+# noinspection PyUnreachableCode
+if False:
+    from typing import Iterable, Iterator, Union
+
+
+_storage_types = {torch.float32: torch.FloatStorage,
+                  torch.float64: torch.DoubleStorage}
+
+
+def signature_chunks(chunks, depth, stream=False, basepoint=False):
+    # type: (Iterable[torch.Tensor], int, bool, Union[bool, torch.Tensor]) -> Iterator[torch.Tensor]
+    """Applies the signature transform to a path that is given in pieces, one after another.
+
+    The signature of everything so far is carried from one piece to the next, using the :attr:`initial` argument of
+    :func:`signatory.signature`, and the last point of each piece is used as the :attr:`basepoint` of the next. So only
+    one piece ever needs to be held in memory at once.
+
+    Note that if gradients are being tracked, then the graph will hold every piece; use :code:`torch.no_grad()` if
+    memory usage should stay constant.
+
+    Arguments:
+        chunks (iterable of :class:`torch.Tensor`): The pieces of the path, each of shape :math:`(N, L_i, C)`,
+            corresponding to batch, stream and channel dimensions respectively. They may be of different lengths
+            :math:`L_i`. Concatenating them along the stream dimension would give the whole path. Pieces of length
+            zero are skipped.
+
+        depth (int): As :func:`signatory.signature`.
+
+        stream (bool, optional): As :func:`signatory.signature`.
+
+        basepoint (bool or :class:`torch.Tensor`, optional): As :func:`signatory.signature`. Only used for the first
+            piece.
+
+    Returns:
+        An iterator. If :attr:`stream` is False, then it yields the signature of the path so far after every piece, as a
+        :class:`torch.Tensor` of shape :math:`(N, S)`, where :math:`S` is as :func:`signatory.signature`. (So the final
+        one is the signature of the whole path.) If :attr:`stream` is True, then it yields the part of the output of
+        :func:`signatory.signature` corresponding to each piece, as a :class:`torch.Tensor` of shape
+        :math:`(N, L'_i, S)`. (Where :math:`L'_i = L_i` except possibly for the first piece, which has one fewer
+        entry if no basepoint is used.)
+    """
+    signature = None
+    for chunk in chunks:
+        if chunk.size(-2) == 0:
+            continue
+        if signature is None and basepoint is False and chunk.size(-2) == 1:
+            # Not enough to define a path yet; this single point becomes the basepoint of the next piece.
+            basepoint = chunk[:, -1]
+            continue
+        result = smodule.signature(chunk, depth, stream=stream, basepoint=basepoint, initial=signature)
+        signature = result[:, -1] if stream else result
+        basepoint = chunk[:, -1]
+        yield result
+
+
+def _from_file(filename, dtype, size, shared):
+    # Memory-maps 'size' elements of the file into a one-dimensional tensor
+    tensor = torch.tensor([], dtype=dtype)
+    tensor.set_(_storage_types[dtype].from_file(filename, shared, size))
+    return tensor
+
+
+def signature_file(filename, channels, depth, dtype=torch.float, basepoint=False, chunk_length=65536,
+                   stream_filename=None):
+    # type: (str, int, int, torch.dtype, Union[bool, torch.Tensor], int, Union[None, str]) -> torch.Tensor
+    """Applies the signature transform to a single path stored in a file, without ever loading the whole path into
+    memory.
+
+    The file is memory-mapped, and the path is read and processed in chunks, as with
+    :func:`signatory.signature_chunks`. Optionally the output of :func:`signatory.signature` with :attr:`stream=True`
+    may also be written to a memory-mapped file, so that it also need never be held in memory. Either way, the amount of
+    memory used does not depend on the size of the file.
+
+    Gradients are not tracked.
+
+    Arguments:
+        filename (str): The file to read the path from. It should consist of raw floating point numbers (in the native
+            byte order), holding the channels of each point of the path, one point after another. (For example as
+            written by :code:`numpy.ndarray.tofile`.)
+
+        channels (int): The number of channels of the path.
+
+        depth (int): As :func:`signatory.signature`.
+
+        dtype (:class:`torch.dtype`, optional): The type of the numbers in the file. Either :code:`torch.float` or
+            :code:`torch.double`. Defaults to :code:`torch.float`.
+
+        basepoint (bool or :class:`torch.Tensor`, optional): As :func:`signatory.signature`, except that if it is a
+            tensor then it should be of shape :math:`(C,)`, where :math:`C` is the number of channels.
+
+        chunk_length (int, optional): How many points of the path to process at once. Defaults to 65536.
+
+        stream_filename (None or str, optional): If passed, then the signature of every prefix of the path (as given
+            by :func:`signatory.signature` with :attr:`stream=True`) is written to this file, in the same format as
+            :attr:`filename`. If the file already exists then it is overwritten.
+
+    Returns:
+        The signature of the path, as a :class:`torch.Tensor` of shape :math:`(S,)`, where :math:`S` is as
+        :func:`signatory.signature`.
+    """
+    if dtype not in _storage_types:
+        raise ValueError("Argument 'dtype' must be either torch.float or torch.double.")
+    if channels < 1:
+        raise ValueError("Argument 'channels' must be an integer greater than or equal to one.")
+    if chunk_length < 1:
+        raise ValueError("Argument 'chunk_length' must be an integer greater than or equal to one.")
+    element_size = torch.tensor([], dtype=dtype).element_size()
+    file_size = os.path.getsize(filename)
+    if file_size % (channels * element_size) != 0:
+        raise ValueError("The size of the file '{}' is not a multiple of the size of a point with {} channels."
+                         "".format(filename, channels))
+    num_points = file_size // (channels * element_size)
+    if num_points < (1 if basepoint is not False else 2):
+        raise ValueError("The file '{}' does not hold enough points to define a path.".format(filename))
+    if isinstance(basepoint, torch.Tensor):
+        basepoint = basepoint.unsqueeze(0)
+
+    path = _from_file(filename, dtype, num_points * channels, shared=False).view(num_points, channels)
+    chunks = (path[start:start + chunk_length].unsqueeze(0) for start in range(0, num_points, chunk_length))
+
+    with torch.no_grad():
+        if stream_filename is None:
+            signature = None
+            for signature in signature_chunks(chunks, depth, basepoint=basepoint):
+                pass
+            return signature.squeeze(0)
+        else:
+            signature_channels = smodule.signature_channels(channels, depth)
+            num_outputs = num_points if basepoint is not False else num_points - 1
+            # Create the file at its final size, and then map it in
+            with open(stream_filename, 'wb') as f:
+                f.truncate(num_outputs * signature_channels * element_size)
+            output = _from_file(stream_filename, dtype, num_outputs * signature_channels,
+                                shared=True).view(num_outputs, signature_channels)
+            start = 0
+            for result in signature_chunks(chunks, depth, stream=True, basepoint=basepoint):
+                result = result.squeeze(0)
+                output[start:start + result.size(0)].copy_(result)
+                start += result.size(0)
+            return output[-1].clone()
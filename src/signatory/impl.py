@@ -43,15 +43,66 @@ LogSignatureMode = _impl.LogSignatureMode  # not wrapped because it's not a func
 signature_to_logsignature_forward = _wrap(_impl.signature_to_logsignature_forward)
 signature_to_logsignature_backward = _wrap(_impl.signature_to_logsignature_backward)
 make_lyndon_info = _wrap(_impl.make_lyndon_info)
+logsignature_forward = _wrap(_impl.logsignature_forward)
+logsignature_backward = _wrap(_impl.logsignature_backward)
+logsignature_bch_forward = _wrap(_impl.logsignature_bch_forward)
+logsignature_bch_backward = _wrap(_impl.logsignature_bch_backward)
+make_bch_info = _wrap(_impl.make_bch_info)
+make_accumulator_info = _wrap(_impl.make_accumulator_info)
+accumulator_push = _wrap(_impl.accumulator_push)
+accumulator_signature = _wrap(_impl.accumulator_signature)
+accumulator_logsignature = _wrap(_impl.accumulator_logsignature)
+PathStorage = _impl.PathStorage  # not wrapped because it's not a function
+make_path_info = _wrap(_impl.make_path_info)
+path_update = _wrap(_impl.path_update)
+path_edit = _wrap(_impl.path_edit)
+path_version = _wrap(_impl.path_version)
+path_signature_forward = _wrap(_impl.path_signature_forward)
+path_signature_backward = _wrap(_impl.path_signature_backward)
+path_logsignature_forward = _wrap(_impl.path_logsignature_forward)
+path_logsignature_backward = _wrap(_impl.path_logsignature_backward)
+signature_table_forward = _wrap(_impl.signature_table_forward)
+signature_table_backward = _wrap(_impl.signature_table_backward)
+signature_window_forward = _wrap(_impl.signature_window_forward)
+signature_window_backward = _wrap(_impl.signature_window_backward)
+signature_pyramid_forward = _wrap(_impl.signature_pyramid_forward)
+signature_pyramid_backward = _wrap(_impl.signature_pyramid_backward)
+signature_gram_forward = _wrap(_impl.signature_gram_forward)
+signature_gram_backward = _wrap(_impl.signature_gram_backward)
+signature_kernel_forward = _wrap(_impl.signature_kernel_forward)
+signature_kernel_backward = _wrap(_impl.signature_kernel_backward)
 signature_forward = _wrap(_impl.signature_forward)
 signature_backward = _wrap(_impl.signature_backward)
 signature_checkargs = _wrap(_impl.signature_checkargs)
+signature_indices_forward = _wrap(_impl.signature_indices_forward)
+signature_indices_backward = _wrap(_impl.signature_indices_backward)
+expected_signature_forward = _wrap(_impl.expected_signature_forward)
+expected_signature_backward = _wrap(_impl.expected_signature_backward)
+signature_jvp = _wrap(_impl.signature_jvp)
+signature_ragged_forward = _wrap(_impl.signature_ragged_forward)
+signature_ragged_backward = _wrap(_impl.signature_ragged_backward)
+signature_sketch_forward = _wrap(_impl.signature_sketch_forward)
+signature_sketch_backward = _wrap(_impl.signature_sketch_backward)
+signature_tree_forward = _wrap(_impl.signature_tree_forward)
+signature_tree_backward = _wrap(_impl.signature_tree_backward)
+signature_words_forward = _wrap(_impl.signature_words_forward)
+signature_words_backward = _wrap(_impl.signature_words_backward)
 hardware_concurrency = _wrap(_impl.hardware_concurrency)
 signature_channels = _wrap(_impl.signature_channels)
 signature_combine_forward = _wrap(_impl.signature_combine_forward)
 signature_combine_backward = _wrap(_impl.signature_combine_backward)
+tensor_algebra_exp_forward = _wrap(_impl.tensor_algebra_exp_forward)
+tensor_algebra_exp_backward = _wrap(_impl.tensor_algebra_exp_backward)
+tensor_algebra_log_forward = _wrap(_impl.tensor_algebra_log_forward)
+tensor_algebra_log_backward = _wrap(_impl.tensor_algebra_log_backward)
+tensor_algebra_antipode = _wrap(_impl.tensor_algebra_antipode)
 lyndon_words_to_basis_transform = _wrap(_impl.lyndon_words_to_basis_transform)
 lyndon_words = _wrap(_impl.lyndon_words)
 lyndon_brackets = _wrap(_impl.lyndon_brackets)
+lyndon_words_tensor = _wrap(_impl.lyndon_words_tensor)
+lyndon_brackets_tensor = _wrap(_impl.lyndon_brackets_tensor)
+all_words_tensor = _wrap(_impl.all_words_tensor)
+lyndon_words_to_basis_transform_tensor = _wrap(_impl.lyndon_words_to_basis_transform_tensor)
+words_basis_expansion_tensor = _wrap(_impl.words_basis_expansion_tensor)
 set_max_parallelism = _wrap(_impl.set_max_parallelism)
 get_max_parallelism = _wrap(_impl.get_max_parallelism)
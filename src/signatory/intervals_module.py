@@ -0,0 +1,222 @@
+# Copyright 2019 Patrick Kidger. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# 
+#    http://www.apache.org/licenses/LICENSE-2.0
+# 
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# =========================================================================
+"""Provides operations computing the signatures over many intervals of a path at once."""
+
+
+import torch
+from torch import autograd
+from torch.autograd import function as autograd_function
+
+from . import impl
+
+# noinspection PyUnreachableCode
+if False:
+    from typing import List, Union
+
+
+class _SignatureTableFunction(autograd.Function):
+    @staticmethod
+    def forward(ctx, path, depth, packed, levels):
+        table = impl.signature_table_forward(path, depth, packed, levels)
+        ctx.save_for_backward(path, table)
+        ctx.depth = depth
+        ctx.packed = packed
+        ctx.levels = levels
+        return table
+
+    @staticmethod
+    @autograd_function.once_differentiable  # Our backward function uses in-place operations for memory efficiency
+    def backward(ctx, grad_table):
+        path, table = ctx.saved_tensors
+        grad_path = impl.signature_table_backward(grad_table, path, table, ctx.depth, ctx.packed, ctx.levels)
+        return grad_path, None, None, None
+
+
+def signature_table(path, depth, packed=False, levels=None):
+    # type: (torch.Tensor, int, bool, Union[None, List[int]]) -> torch.Tensor
+    r"""Computes the signature over every interval of a path.
+
+    Given a batch of paths :math:`(x_1, \ldots, x_L)`, as in :func:`signatory.signature`, this computes the signature
+    of :math:`(x_i, \ldots, x_j)` for every :math:`1 \leq i < j \leq L`. This is done via the dynamic programme
+
+    .. math::
+        \mathrm{Sig}(x_i, \ldots, x_{j + 1}) = \mathrm{Sig}(x_i, \ldots, x_j) \otimes \exp(x_{j + 1} - x_j),
+
+    with each value of :math:`i` computed in parallel. This is much faster than calling :func:`signatory.signature`
+    separately for every interval.
+
+    Arguments:
+        path (:class:`torch.Tensor`): The batch of input paths, of shape :math:`(N, L, C)`.
+
+        depth (int): The depth to truncate the signature at.
+
+        packed (bool, optional): Defaults to False. If False then the signatures are returned in a square table,
+            indexed by :math:`i` and :math:`j`. If True then only the upper triangle of this table is returned, with
+            its rows concatenated together. That is, in the order :math:`(1, 2), (1, 3), \ldots, (1, L), (2, 3),
+            \ldots, (L - 1, L)`.
+
+        levels (None or list of int, optional): Defaults to None. If it is a list of integers then only those levels
+            of the signature are returned, which should be given in increasing order and lie between 1 and
+            :attr:`depth` inclusive. For example :attr:`levels=[1, 2]` returns just the first two levels, as
+            :math:`C + C^2` channels. Only the highest requested level is computed to, and only one row of the table
+            at a time is held at the full size, so this may be used to bound memory usage. If None then every level is
+            returned.
+
+    Returns:
+        A :class:`torch.Tensor`. Let :math:`D` be the number of channels in the requested levels of the signature;
+        with :attr:`levels=None` this is :math:`C + C^2 + \cdots + C^\text{depth}`.
+
+        If :attr:`packed` is False then it is of shape :math:`(N, L, L, D)`, whose :math:`[:, i, j]` entry (indexing
+        from zero) is the signature of :attr:`path[:, i:j + 1]` if :math:`i < j`, and zero otherwise.
+
+        If :attr:`packed` is True then it is of shape :math:`(N, L(L - 1)/2, D)`.
+    """
+    if levels is None:
+        levels = []
+    else:
+        levels = list(levels)
+
+    # transpose to go from Python convention of (batch, stream, channel) to autograd/C++ convention of
+    # (stream, batch, channel)
+    # noinspection PyUnresolvedReferences
+    table = _SignatureTableFunction.apply(path.transpose(0, 1), depth, packed, levels)
+
+    # We have to do the transpose outside of autograd.Function.apply to avoid PyTorch bug 24413
+    if packed:
+        # (intervals, batch, channel) to (batch, intervals, channel)
+        return table.transpose(0, 1)
+    else:
+        # (stream, stream, batch, channel) to (batch, stream, stream, channel)
+        return table.permute(2, 0, 1, 3)
+
+
+class _SignatureWindowFunction(autograd.Function):
+    @staticmethod
+    def forward(ctx, path, depth, window, stride):
+        signature = impl.signature_window_forward(path, depth, window, stride)
+        ctx.save_for_backward(path, signature)
+        ctx.depth = depth
+        ctx.window = window
+        ctx.stride = stride
+        return signature
+
+    @staticmethod
+    @autograd_function.once_differentiable  # Our backward function uses in-place operations for memory efficiency
+    def backward(ctx, grad_signature):
+        path, signature = ctx.saved_tensors
+        grad_path = impl.signature_window_backward(grad_signature, path, signature, ctx.depth, ctx.window, ctx.stride)
+        return grad_path, None, None, None
+
+
+def signature_window(path, depth, window, stride=1):
+    # type: (torch.Tensor, int, int, int) -> torch.Tensor
+    r"""Computes the signature over every sliding window of a path.
+
+    Given a batch of paths :math:`(x_1, \ldots, x_L)`, as in :func:`signatory.signature`, this computes the signature
+    of :math:`(x_{1 + ks}, \ldots, x_{w + ks})` for every :math:`k = 0, 1, \ldots` for which this is defined, where
+    :math:`w` is :attr:`window` and :math:`s` is :attr:`stride`.
+
+    Each window is found from the previous one by removing the oldest increment from its start and adding the newest
+    increment on to its end:
+
+    .. math::
+        \mathrm{Sig}(x_{i + 1}, \ldots, x_{j + 1}) = \exp(x_i - x_{i + 1}) \otimes \mathrm{Sig}(x_i, \ldots, x_j)
+        \otimes \exp(x_{j + 1} - x_j),
+
+    so that the cost of each window is proportional to :attr:`stride` rather than to :attr:`window`. (If the windows
+    overlap so little that this would be slower, then every window is instead computed separately.)
+
+    Arguments:
+        path (:class:`torch.Tensor`): The batch of input paths, of shape :math:`(N, L, C)`.
+
+        depth (int): The depth to truncate the signature at.
+
+        window (int): The number of points in each window. Must be at least two and at most :math:`L`.
+
+        stride (int, optional): Defaults to 1. How many points to move along the path between each window.
+
+    Returns:
+        A :class:`torch.Tensor` of shape :math:`(N, W, C + C^2 + \cdots + C^\text{depth})`, where
+        :math:`W = \lfloor (L - w) / s \rfloor + 1` is the number of windows.
+
+    .. warning::
+
+        As each window is found by removing increments from the previous one, rounding errors accumulate along the
+        length of the path. This is not typically significant with double precision, but may be with single
+        precision and very long paths.
+    """
+    # transpose to go from Python convention of (batch, stream, channel) to autograd/C++ convention of
+    # (stream, batch, channel)
+    # noinspection PyUnresolvedReferences
+    signature = _SignatureWindowFunction.apply(path.transpose(0, 1), depth, window, stride)
+
+    # We have to do the transpose outside of autograd.Function.apply to avoid PyTorch bug 24413
+    return signature.transpose(0, 1)
+
+
+class _SignaturePyramidFunction(autograd.Function):
+    @staticmethod
+    def forward(ctx, path, depth, scales):
+        pyramid = impl.signature_pyramid_forward(path, depth, scales)
+        ctx.save_for_backward(path, pyramid)
+        ctx.depth = depth
+        ctx.scales = scales
+        return pyramid
+
+    @staticmethod
+    @autograd_function.once_differentiable  # Our backward function uses in-place operations for memory efficiency
+    def backward(ctx, grad_pyramid):
+        path, pyramid = ctx.saved_tensors
+        grad_path = impl.signature_pyramid_backward(grad_pyramid, path, pyramid, ctx.depth, ctx.scales)
+        return grad_path, None, None
+
+
+def signature_pyramid(path, depth, scales):
+    # type: (torch.Tensor, int, int) -> List[torch.Tensor]
+    r"""Computes the signatures over the dyadic segments of a path, at several scales.
+
+    That is, the signature of the whole path, of each of its two halves, of each of its four quarters, and so on.
+    The signatures of the finest scale are computed first, all together, and every coarser scale is then found by
+    combining adjacent pairs of signatures from the scale beneath it, as with :func:`signatory.signature_combine`. This
+    is much faster than computing each scale separately.
+
+    Given a batch of paths :math:`(x_1, \ldots, x_L)`, as in :func:`signatory.signature`, the :math:`L - 1` increments
+    of the path are split as evenly as possible between the :math:`2^{\text{scales} - 1}` segments of the finest scale.
+    (So that if :math:`L - 1` is a multiple of this then every segment has the same length.) Adjacent segments share
+    their common endpoint.
+
+    Arguments:
+        path (:class:`torch.Tensor`): The batch of input paths, of shape :math:`(N, L, C)`.
+
+        depth (int): The depth to truncate the signature at.
+
+        scales (int): The number of scales. Must be at least one, and such that
+            :math:`2^{\text{scales} - 1} \leq L - 1`, so that every segment of the finest scale has at least one
+            increment.
+
+    Returns:
+        A list of :attr:`scales` many :class:`torch.Tensor`\ s. The :math:`k`-th of these (indexing from zero) is of
+        shape :math:`(N, 2^k, C + C^2 + \cdots + C^\text{depth})`, and contains the signatures of the :math:`2^k`
+        segments of that scale, in order along the path.
+    """
+    # transpose to go from Python convention of (batch, stream, channel) to autograd/C++ convention of
+    # (stream, batch, channel)
+    # noinspection PyUnresolvedReferences
+    pyramid = _SignaturePyramidFunction.apply(path.transpose(0, 1), depth, scales)
+
+    # We have to do the transpose outside of autograd.Function.apply to avoid PyTorch bug 24413
+    pyramid = pyramid.transpose(0, 1)
+    # The pyramid is stored as a binary heap, so scale k is the k-th block of 2^k signatures.
+    return [pyramid.narrow(dim=1, start=2 ** scale - 1, length=2 ** scale) for scale in range(scales)]
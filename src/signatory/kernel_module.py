@@ -0,0 +1,149 @@
+# Copyright 2019 Patrick Kidger. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# 
+#    http://www.apache.org/licenses/LICENSE-2.0
+# 
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# =========================================================================
+"""Provides operations computing signature kernels."""
+
+
+import torch
+from torch import autograd
+from torch.autograd import function as autograd_function
+
+from . import impl
+
+# noinspection PyUnreachableCode
+if False:
+    from typing import Union
+
+
+class _SignatureGramFunction(autograd.Function):
+    @staticmethod
+    def forward(ctx, x, y, depth):
+        symmetric = y is None
+        if symmetric:
+            y = torch.Tensor()
+        gram = impl.signature_gram_forward(x, y, depth, symmetric)
+        ctx.save_for_backward(x, y)
+        ctx.depth = depth
+        ctx.symmetric = symmetric
+        return gram
+
+    @staticmethod
+    @autograd_function.once_differentiable  # Our backward function uses in-place operations for memory efficiency
+    def backward(ctx, grad_gram):
+        x, y = ctx.saved_tensors
+        grad_x, grad_y = impl.signature_gram_backward(grad_gram, x, y, ctx.depth, ctx.symmetric)
+        if ctx.symmetric:
+            grad_y = None
+        return grad_x, grad_y, None
+
+
+def signature_gram(x, y, depth):
+    # type: (torch.Tensor, Union[None, torch.Tensor], int) -> torch.Tensor
+    r"""Computes the Gram matrix of the truncated signature kernel between two batches of paths, without ever computing
+    their signatures.
+
+    That is, given a batch of paths :attr:`x` of shape :math:`(N, L, C)` and a batch of paths :attr:`y` of shape
+    :math:`(M, K, C)`, this computes the :math:`(N, M)` matrix
+
+    .. code-block:: python
+
+        signatory.signature(x, depth) @ signatory.signature(y, depth).t()
+
+    but without ever holding the :math:`C + C^2 + \cdots + C^\text{depth}` channels of either signature in memory.
+    Instead, writing :math:`\mathrm{Sig}(x) = \exp(\Delta x_1) \otimes \cdots \otimes \exp(\Delta x_{L - 1})`, the
+    inner product of the signatures is expanded out into a sum over products of the inner products
+    :math:`\langle \Delta x_i, \Delta y_j \rangle` between the increments of the two paths, which is evaluated by
+    dynamic programming.
+
+    This costs :math:`\mathcal{O}(\text{depth}^3 L K)` operations for each pair of paths, independently of :math:`C`,
+    so it is the better choice when :math:`C^\text{depth}` is large. The Gram matrix is split into blocks, which are
+    computed in parallel.
+
+    Only supported on the CPU.
+
+    Arguments:
+        x (:class:`torch.Tensor`): A batch of paths, of shape :math:`(N, L, C)`.
+
+        y (None or :class:`torch.Tensor`): A batch of paths, of shape :math:`(M, K, C)`. If None then it is taken to be
+            :attr:`x`, in which case the result is symmetric and only half of it is actually computed.
+
+        depth (int): The depth to truncate the signatures at.
+
+    Returns:
+        A :class:`torch.Tensor` of shape :math:`(N, M)`.
+    """
+    # transpose to go from Python convention of (batch, stream, channel) to autograd/C++ convention of
+    # (stream, batch, channel)
+    # noinspection PyUnresolvedReferences
+    return _SignatureGramFunction.apply(x.transpose(0, 1), None if y is None else y.transpose(0, 1), depth)
+
+
+class _SignatureKernelFunction(autograd.Function):
+    @staticmethod
+    def forward(ctx, x, y, dyadic_order):
+        symmetric = y is None
+        if symmetric:
+            y = torch.Tensor()
+        kernel = impl.signature_kernel_forward(x, y, dyadic_order, symmetric)
+        ctx.save_for_backward(x, y)
+        ctx.dyadic_order = dyadic_order
+        ctx.symmetric = symmetric
+        return kernel
+
+    @staticmethod
+    @autograd_function.once_differentiable  # Our backward function uses in-place operations for memory efficiency
+    def backward(ctx, grad_kernel):
+        x, y = ctx.saved_tensors
+        grad_x, grad_y = impl.signature_kernel_backward(grad_kernel, x, y, ctx.dyadic_order, ctx.symmetric)
+        if ctx.symmetric:
+            grad_y = None
+        return grad_x, grad_y, None
+
+
+def signature_kernel(x, y, dyadic_order=0):
+    # type: (torch.Tensor, Union[None, torch.Tensor], int) -> torch.Tensor
+    r"""Computes the Gram matrix of the untruncated signature kernel between two batches of paths.
+
+    That is, given a batch of paths :attr:`x` of shape :math:`(N, L, C)` and a batch of paths :attr:`y` of shape
+    :math:`(M, K, C)`, this computes the :math:`(N, M)` matrix of inner products between their signatures, summed over
+    every depth. (Including the scalar term of depth zero, so the result is one more than the limit of
+    :func:`signatory.signature_gram` as its depth tends to infinity.)
+
+    This is computed by solving the Goursat PDE satisfied by the signature kernel, as in
+    `Salvi et al. 2021 <https://arxiv.org/abs/2006.14794>`__, with a second-order finite difference scheme. This costs
+    :math:`\mathcal{O}(4^\text{dyadic_order} L K)` operations for each pair of paths, independently of both :math:`C`
+    and the depth. If there are few enough pairs of paths then the solve for each pair is itself parallelised, over the
+    anti-diagonals of the grid.
+
+    Gradients are those of the discretised solution, so they are exactly consistent with the value returned.
+
+    Only supported on the CPU.
+
+    Arguments:
+        x (:class:`torch.Tensor`): A batch of paths, of shape :math:`(N, L, C)`.
+
+        y (None or :class:`torch.Tensor`): A batch of paths, of shape :math:`(M, K, C)`. If None then it is taken to be
+            :attr:`x`, in which case the result is symmetric and only half of it is actually computed.
+
+        dyadic_order (int, optional): Defaults to zero. Each increment of each path is split into
+            :math:`2^\text{dyadic_order}` pieces when solving the PDE. Increasing this increases accuracy, at a cost of
+            four times as much computation for each extra order.
+
+    Returns:
+        A :class:`torch.Tensor` of shape :math:`(N, M)`.
+    """
+    # transpose to go from Python convention of (batch, stream, channel) to autograd/C++ convention of
+    # (stream, batch, channel)
+    # noinspection PyUnresolvedReferences
+    return _SignatureKernelFunction.apply(x.transpose(0, 1), None if y is None else y.transpose(0, 1), dyadic_order)
@@ -15,6 +15,7 @@
 """Provides operations relating to the logsignature transform."""
 
 
+import collections
 import math
 import torch
 from torch import nn
@@ -24,11 +25,12 @@ import warnings
 import weakref
 
 from . import signature_module as smodule
+from . import tensor_algebra_module as tamodule
 from . import impl
 
 # noinspection PyUnreachableCode
 if False:
-    from typing import Any, Union
+    from typing import Any, List, Union
 
 
 def _interpret_mode(mode):
@@ -78,6 +80,46 @@ def _signature_to_logsignature(signature, channels, depth, stream, mode, lyndon_
     return logsignature_
 
 
+class _LogSignatureFunction(autograd.Function):
+    @staticmethod
+    def forward(ctx, path, depth, stream, basepoint, inverse, mode, lyndon_info, time_channel, lead_lag):
+        ctx.basepoint_is_tensor = isinstance(basepoint, torch.Tensor)
+
+        basepoint, basepoint_value = smodule.interpret_basepoint(basepoint, path.size(-2), path.size(-1), path.dtype,
+                                                                 path.device)
+        mode = _interpret_mode(mode)
+
+        logsignature_, signature_, path_increments = impl.logsignature_forward(path, depth, stream, basepoint,
+                                                                               basepoint_value, inverse, mode,
+                                                                               lyndon_info, time_channel, lead_lag)
+        ctx.save_for_backward(signature_, path_increments)
+        ctx.depth = depth
+        ctx.stream = stream
+        ctx.basepoint = basepoint
+        ctx.inverse = inverse
+        ctx.mode = mode
+        ctx.lyndon_info = lyndon_info
+        ctx.time_channel = time_channel
+        ctx.lead_lag = lead_lag
+
+        return logsignature_
+
+    @staticmethod
+    @autograd_function.once_differentiable  # Our backward function uses in-place operations for memory efficiency
+    def backward(ctx, grad_logsignature):
+        signature_, path_increments = ctx.saved_tensors
+
+        grad_path, grad_basepoint = impl.logsignature_backward(grad_logsignature, signature_, path_increments,
+                                                               ctx.depth, ctx.stream, ctx.basepoint, ctx.inverse,
+                                                               ctx.mode, ctx.lyndon_info, ctx.time_channel,
+                                                               ctx.lead_lag)
+
+        if not ctx.basepoint_is_tensor:
+            grad_basepoint = None
+
+        return grad_path, None, None, grad_basepoint, None, None, None, None, None
+
+
 def signature_to_logsignature(signature, channels, depth, stream=False, mode="words"):
     # type: (torch.Tensor, int, int, bool, str) -> torch.Tensor
     """Calculates the logsignature corresponding to a signature.
@@ -187,8 +229,9 @@ class SignatureToLogSignature(nn.Module):
 SignatureToLogsignature = SignatureToLogSignature
 
 
-def logsignature(path, depth, stream=False, basepoint=False, inverse=False, mode="words"):
-    # type: (torch.Tensor, int, bool, Union[bool, torch.Tensor], bool, str) -> torch.Tensor
+def logsignature(path, depth, stream=False, basepoint=False, inverse=False, mode="words", time_channel=False,
+                 lead_lag=False):
+    # type: (torch.Tensor, int, bool, Union[bool, torch.Tensor], bool, str, bool, bool) -> torch.Tensor
     """Applies the logsignature transform to a stream of data.
 
     The :attr:`modes` argument determines how the logsignature is represented.
@@ -214,6 +257,10 @@ def logsignature(path, depth, stream=False, basepoint=False, inverse=False, mode
             "Returns" section below. For machine learning applications, :code:`"words"` is the appropriate choice. The
             other two options are mostly only interesting for mathematicians.
 
+        time_channel (bool, optional): as :func:`signatory.signature`.
+
+        lead_lag (bool, optional): as :func:`signatory.signature`.
+
     Returns:
         A :class:`torch.Tensor`, of almost the same shape as the tensor returned from :func:`signatory.signature` called
         with the same arguments.
@@ -223,7 +270,8 @@ def logsignature(path, depth, stream=False, basepoint=False, inverse=False, mode
 
         If :code:`mode in ("brackets", "words")` then the channel dimension will instead be of size
         :code:`signatory.logsignature_channels(path.size(-1), depth)`. (Where :code:`path.size(-1)` is the number of
-        input channels.)
+        input channels.) If :attr:`time_channel` or :attr:`lead_lag` are set then this should instead be the number of
+        channels of the augmented path; see :func:`signatory.signature`.
 
         The different modes correspond to different mathematical representations of the logsignature.
 
@@ -250,7 +298,34 @@ def logsignature(path, depth, stream=False, basepoint=False, inverse=False, mode
         In all cases, the ordering corresponds to the ordering on words given by first ordering the words by length,
         and then ordering each length class lexicographically.
     """
-    return LogSignature(depth, stream=stream, inverse=inverse, mode=mode)(path, basepoint=basepoint)
+    return LogSignature(depth, stream=stream, inverse=inverse, mode=mode, time_channel=time_channel,
+                        lead_lag=lead_lag)(path, basepoint=basepoint)
+
+
+def logsignature_ragged(path, lengths, depth, stream=False, basepoint=False, mode="words"):
+    # type: (torch.Tensor, Union[List[int], torch.Tensor], int, bool, Union[bool, torch.Tensor], str) -> torch.Tensor
+    """Applies the logsignature transform to a batch of paths of different lengths, without padding them.
+
+    Arguments:
+        path (:class:`torch.Tensor`): as :func:`signatory.signature_ragged`.
+
+        lengths (list of int or :class:`torch.Tensor`): as :func:`signatory.signature_ragged`.
+
+        depth (int): as :func:`signatory.signature`.
+
+        stream (bool, optional): as :func:`signatory.signature_ragged`.
+
+        basepoint (bool or :class:`torch.Tensor`, optional): as :func:`signatory.signature_ragged`.
+
+        mode (str, optional): as :func:`signatory.logsignature`.
+
+    Returns:
+        A :class:`torch.Tensor`, of the same shape as the tensor returned from :func:`signatory.signature_ragged`
+        called with the same arguments, except that its final dimension is as :func:`signatory.logsignature`.
+    """
+    signature = smodule.signature_ragged(path, lengths, depth, stream=stream, basepoint=basepoint)
+    # The signatures are just a batch as far as the logarithm is concerned, whether or not stream==True.
+    return signature_to_logsignature(signature, path.size(-1), depth, mode=mode)
 
 
 class LogSignature(nn.Module):
@@ -271,15 +346,22 @@ class LogSignature(nn.Module):
         inverse (bool, optional): as :func:`signatory.logsignature`.
 
         mode (str, optional): as :func:`signatory.logsignature`.
+
+        time_channel (bool, optional): as :func:`signatory.logsignature`.
+
+        lead_lag (bool, optional): as :func:`signatory.logsignature`.
     """
 
-    def __init__(self, depth, stream=False, inverse=False, mode="words", **kwargs):
-        # type: (int, bool, bool, str, **Any) -> None
+    def __init__(self, depth, stream=False, inverse=False, mode="words", time_channel=False, lead_lag=False,
+                 **kwargs):
+        # type: (int, bool, bool, str, bool, bool, **Any) -> None
         super(LogSignature, self).__init__(**kwargs)
         self._depth = depth
         self._stream = stream
         self._inverse = inverse
         self._mode = mode
+        self._time_channel = time_channel
+        self._lead_lag = lead_lag
 
         self._signature_to_logsignature_instance = None
         self._last_channels = None
@@ -303,7 +385,8 @@ class LogSignature(nn.Module):
         """
 
         # In particular does not return anything
-        self._get_signature_to_logsignature_instance(in_channels)
+        self._get_signature_to_logsignature_instance(smodule._augmented_channels(in_channels, self._time_channel,
+                                                                                 self._lead_lag))
 
     # Deliberately no 'initial' argument. To support that for logsignatures we'd need to be able to expand a
     # (potentially compressed) logsignature into a signature first. (Which is possible in principle.)
@@ -320,19 +403,168 @@ class LogSignature(nn.Module):
             As :func:`signatory.logsignature`.
         """
 
+        channels = smodule._augmented_channels(path.size(-1), self._time_channel, self._lead_lag)
+        signature_to_logsignature_instance = self._get_signature_to_logsignature_instance(channels)
+
+        if self._stream and not path.is_cuda:
+            # Computing the logarithm of each signature as soon as it is computed, rather than computing the whole
+            # stream of signatures and then taking their logarithms, means that we never need to hold the stream of
+            # signatures in memory, and that each signature is still in cache when we take its logarithm.
+            lyndon_info = signature_to_logsignature_instance._lyndon_info_capsule.item
+            path = path.transpose(0, 1)  # (batch, stream, channel) to (stream, batch, channel)
+            result = _LogSignatureFunction.apply(path, self._depth, self._stream, basepoint, self._inverse, self._mode,
+                                                 lyndon_info, self._time_channel, self._lead_lag)
+            return result.transpose(0, 1)  # (stream, batch, channel) to (batch, stream, channel)
+
         signature = smodule.signature(path, self._depth, stream=self._stream, basepoint=basepoint,
-                                      inverse=self._inverse, initial=None)
-        return self._get_signature_to_logsignature_instance(path.size(-1))(signature)
+                                      inverse=self._inverse, initial=None, time_channel=self._time_channel,
+                                      lead_lag=self._lead_lag)
+        return signature_to_logsignature_instance(signature)
 
     def extra_repr(self):
-        return ('depth={depth}, stream={stream}, inverse={inverse}, mode{mode}'
-                .format(depth=self._depth, stream=self._stream, inverse=self._inverse, mode=self._mode))
+        return ('depth={depth}, stream={stream}, inverse={inverse}, mode{mode}, time_channel={time_channel}, '
+                'lead_lag={lead_lag}'.format(depth=self._depth, stream=self._stream, inverse=self._inverse,
+                                             mode=self._mode, time_channel=self._time_channel,
+                                             lead_lag=self._lead_lag))
 
 
 # Alias
 Logsignature = LogSignature
 
 
+# The most recently used expansions, with the most recent last. Bounded in size so that it doesn't grow without limit
+# when used with many different numbers of channels and depths.
+_words_basis_expansion_cache = collections.OrderedDict()
+_words_basis_expansion_cache_size = 16
+
+
+def _words_basis_expansion(channels, depth, dtype, device):
+    key = (channels, depth, dtype, device)
+    try:
+        expansion = _words_basis_expansion_cache.pop(key)
+    except KeyError:
+        indices, values = impl.words_basis_expansion_tensor(channels, depth)
+        expansion = (indices[0].to(device), indices[1].to(device), values.to(dtype=dtype, device=device))
+        if len(_words_basis_expansion_cache) >= _words_basis_expansion_cache_size:
+            _words_basis_expansion_cache.popitem(last=False)
+    _words_basis_expansion_cache[key] = expansion
+    return expansion
+
+
+def logsignature_to_signature(logsignature, channels, depth):
+    # type: (torch.Tensor, int, int) -> torch.Tensor
+    """Calculates the signature corresponding to a logsignature.
+
+    This is the inverse of :func:`signatory.signature_to_logsignature` with :code:`mode="words"`. The logsignature is
+    expanded into the tensor algebra, and then exponentiated with :func:`signatory.ta_exp`.
+
+    Arguments:
+        logsignature (:class:`torch.Tensor`): The result of a call to :func:`signatory.logsignature` with
+            :code:`mode="words"`, or any other tensor of the same shape. (For example the output of a neural network.)
+
+        channels (int): The number of input channels of the :attr:`path` that :func:`signatory.logsignature` was called
+            with.
+
+        depth (int): The value of :attr:`depth` that :func:`signatory.logsignature` was called with.
+
+    Returns:
+        A :class:`torch.Tensor`, of the same shape as would be returned by :func:`signatory.signature` called with the
+        same arguments as :func:`signatory.logsignature` was. Any number of leading (batch or stream) dimensions are
+        allowed.
+    """
+    if logsignature.size(-1) != logsignature_channels(channels, depth):
+        raise ValueError("Argument 'logsignature' does not have the correct number of channels.")
+    sources, targets, coefficients = _words_basis_expansion(channels, depth, logsignature.dtype, logsignature.device)
+    expanded_shape = logsignature.shape[:-1] + (smodule.signature_channels(channels, depth),)
+    expanded = logsignature.new_zeros(expanded_shape).index_add(-1, targets,
+                                                                logsignature.index_select(-1, sources) * coefficients)
+    return tamodule.ta_exp(expanded, channels, depth)
+
+
+class _LogSignatureBCHFunction(autograd.Function):
+    @staticmethod
+    def forward(ctx, path, stream, basepoint, inverse, bch_info):
+        ctx.basepoint_is_tensor = isinstance(basepoint, torch.Tensor)
+
+        basepoint, basepoint_value = smodule.interpret_basepoint(basepoint, path.size(-2), path.size(-1), path.dtype,
+                                                                 path.device)
+
+        logsignature_, path_increments = impl.logsignature_bch_forward(path, stream, basepoint, basepoint_value,
+                                                                       inverse, bch_info)
+        ctx.save_for_backward(logsignature_, path_increments)
+        ctx.stream = stream
+        ctx.basepoint = basepoint
+        ctx.inverse = inverse
+        ctx.bch_info = bch_info
+
+        return logsignature_
+
+    @staticmethod
+    @autograd_function.once_differentiable  # Our backward function uses in-place operations for memory efficiency
+    def backward(ctx, grad_logsignature):
+        logsignature_, path_increments = ctx.saved_tensors
+
+        grad_path, grad_basepoint = impl.logsignature_bch_backward(grad_logsignature, logsignature_, path_increments,
+                                                                   ctx.stream, ctx.basepoint, ctx.inverse,
+                                                                   ctx.bch_info)
+
+        if not ctx.basepoint_is_tensor:
+            grad_basepoint = None
+
+        return grad_path, None, grad_basepoint, None, None
+
+
+_bch_info_capsule_cache = weakref.WeakValueDictionary()
+
+
+def _get_bch_info(in_channels, depth):
+    try:
+        # Compiling the Baker-Campbell-Hausdorff formula is quite slow, so we reuse it wherever possible.
+        return _bch_info_capsule_cache[(in_channels, depth)]
+    except KeyError:
+        bch_info_capsule = SignatureToLogSignature._RefHolder(impl.make_bch_info(in_channels, depth))
+        _bch_info_capsule_cache[(in_channels, depth)] = bch_info_capsule
+        return bch_info_capsule
+
+
+def logsignature_bch(path, depth, stream=False, basepoint=False, inverse=False):
+    # type: (torch.Tensor, int, bool, Union[bool, torch.Tensor], bool) -> torch.Tensor
+    """Computes the logsignature of a stream of data directly, without computing its signature first.
+
+    The result is the same as :code:`signatory.logsignature(path, depth, stream, basepoint, inverse, mode="words")`.
+    However rather than computing the signature and then taking its logarithm, the logsignature is updated one
+    increment at a time, via a (precompiled) truncated Baker-Campbell-Hausdorff formula, so that it is only ever
+    represented in the compressed coordinates of the free Lie algebra.
+
+    This is typically faster and uses much less memory when :attr:`stream` is True, as no stream of signatures need be
+    computed. For large depths the Baker-Campbell-Hausdorff formula becomes very large, so that
+    :func:`signatory.logsignature` will be faster. The formula is compiled the first time that this function is called
+    for a particular number of channels and depth, which may take some time; it is then cached for later calls.
+
+    This is only supported on the CPU.
+
+    Arguments:
+        path (:class:`torch.Tensor`): as :func:`signatory.logsignature`.
+
+        depth (int): as :func:`signatory.logsignature`.
+
+        stream (bool, optional): as :func:`signatory.logsignature`.
+
+        basepoint (bool or :class:`torch.Tensor`, optional): as :func:`signatory.logsignature`.
+
+        inverse (bool, optional): as :func:`signatory.logsignature`.
+
+    Returns:
+        As :func:`signatory.logsignature` with :code:`mode="words"`.
+    """
+    bch_info = _get_bch_info(path.size(-1), depth)
+    path = path.transpose(0, 1)  # (batch, stream, channel) to (stream, batch, channel)
+    result = _LogSignatureBCHFunction.apply(path, stream, basepoint, inverse, bch_info.item)
+    if stream:
+        result = result.transpose(0, 1)  # (stream, batch, channel) to (batch, stream, channel)
+    return result
+
+
 # Computes the list of prime factors of x
 def _get_prime_factors(x):
     if x == 1:
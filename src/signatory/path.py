@@ -14,10 +14,10 @@
 # =========================================================================
 """Provides the Path class, a high-level object capable of giving signatures over intervals."""
 
-import bisect
 import torch
 from torch import autograd
 from torch.autograd import function as autograd_function
+import warnings
 
 from . import signature_module as smodule
 from . import logsignature_module as lmodule
@@ -28,80 +28,123 @@ if False:
     from typing import List, Union
 
 
-class _BackwardShortcut(autograd.Function):
+def _interpret_storage(storage):
+    if storage == "prefix":
+        return impl.PathStorage.Prefix
+    elif storage == "segment_tree":
+        return impl.PathStorage.SegmentTree
+    else:
+        raise ValueError("Invalid values for argument 'storage'. Valid values are 'prefix' or 'segment_tree'.")
+
+
+def _save_path_pieces(ctx, path_info, starts, ends, squeeze, edit_indices, first_piece_offset, num_path_pieces,
+                      path_pieces_and_edit_values):
+    ctx.path_info = path_info
+    ctx.version = impl.path_version(path_info)
+    ctx.save_for_backward(starts, ends)
+    ctx.squeeze = squeeze
+    ctx.edit_indices = edit_indices
+    ctx.first_piece_offset = first_piece_offset
+    ctx.lengths = [path_piece.size(-2) for path_piece in path_pieces_and_edit_values[:num_path_pieces]]
+
+
+def _check_version(ctx):
+    # The backward pass recomputes what it needs from the path held in C++, so this must not have changed since the
+    # forward pass, other than by having points appended.
+    if impl.path_version(ctx.path_info) != ctx.version:
+        raise RuntimeError("The Path has been modified since this signature or logsignature was computed, so it can no "
+                           "longer be backpropagated through.")
+
+
+def _path_pieces_grads(ctx, grad_path):
+    # Takes the gradient with respect to every retained point of the path, and splits it up into the gradients with
+    # respect to each path piece and each edit value.
+
+    # The gradient with respect to an edited point goes to the value it was most recently edited to, rather than to
+    # the original point, or to any values it was previously edited to.
+    grad_edit_values = []
+    edited = set()
+    for index in reversed(ctx.edit_indices):
+        if index in edited:
+            grad_edit_values.append(torch.zeros_like(grad_path[index]))
+        else:
+            grad_edit_values.append(grad_path[index].clone())
+            edited.add(index)
+    grad_edit_values.reverse()
+    for index in edited:
+        grad_path[index].zero_()
+
+    if ctx.first_piece_offset > 0:
+        # The first path piece has had some of its points discarded, which get zero gradient.
+        grad_path = torch.cat([grad_path.new_zeros(ctx.first_piece_offset, grad_path.size(-2), grad_path.size(-1)),
+                               grad_path], dim=0)
+
+    result = []
+    start = 0
+    for length in ctx.lengths:
+        end = start + length
+        result.append(grad_path[start:end].transpose(0, 1))  # (stream, batch, channel) to (batch, stream, channel)
+        start = end
+    result.extend(grad_edit_values)
+    return result
+
+
+class _PathSignatureFunction(autograd.Function):
     @staticmethod
-    def forward(ctx, signature, depth, *path_pieces):
-        if len(path_pieces) == 0:
-            raise ValueError('path_pieces must have nonzero length')
-
-        # Record the tensors upon which the backward calculation depends
-        save_for_backward = [signature]
-        save_for_backward.extend(path_pieces)
-        ctx.save_for_backward(*save_for_backward)
-        ctx.depth = depth
+    def forward(ctx, path_info, starts, ends, squeeze, edit_indices, first_piece_offset, num_path_pieces,
+                *path_pieces_and_edit_values):
+        _save_path_pieces(ctx, path_info, starts, ends, squeeze, edit_indices, first_piece_offset, num_path_pieces,
+                          path_pieces_and_edit_values)
 
-        return signature
+        result = impl.path_signature_forward(path_info, starts, ends)
+        if squeeze:
+            result = result[0]
+        return result
 
     @staticmethod
     @autograd_function.once_differentiable  # Our backward function uses in-place operations for memory efficiency
     def backward(ctx, grad_signature):
-        # Test for any in-place changes
-        # This isn't perfect. If any of the stored tensors do not own their own storage (which is possible, as we don't
-        # get to control these tensors) then this check will always pass, even if they've been modified in-place.
-        # (PyTorch bug 24413)
-        saved_tensors = ctx.saved_tensors
-        signature = saved_tensors[0]
-        path_pieces = saved_tensors[1:]
-
-        length = 0
-        for piece in path_pieces:
-            length += piece.size(-3)
-        p = path_pieces[0]
-        path_increments = torch.empty(length - 1, p.size(-2), p.size(-1), device=p.device, dtype=p.dtype)
-        torch.sub(p[1:], p[:-1], out=path_increments[:p.size(0) - 1])
-        prev_piece = p
-        next_path_increment = p.size(0) - 1
-        for piece in path_pieces[1:]:
-            torch.sub(piece[0], prev_piece[-1], out=path_increments[next_path_increment])
-            next_path_increment += 1
-            next_next_path_increment = next_path_increment + piece.size(0) - 1
-            torch.sub(piece[1:], piece[:-1], out=path_increments[next_path_increment:next_next_path_increment])
-            next_path_increment = next_next_path_increment
-            prev_piece = piece
-        # The above is basically the same as:
-        # path = torch.cat(path_pieces, dim=0)
-        # path_increments = path[1:] - path[:-1]
-        # Except it doesn't waste time copying values like torch.cat would
-
-        grad_path, _, _ = impl.signature_backward(grad_signature,
-                                                  signature,
-                                                  path_increments,
-                                                  ctx.depth,
-                                                  False,  # stream
-                                                  False,  # basepoint
-                                                  False,  # inverse
-                                                  False)  # initial
-
-        result = [None, None]
-        start = 0
-        end = 0
-        for elem in path_pieces:
-            end += elem.size(-3)  # stream dimension
-            result.append(grad_path[start:end])
-            start = end
-
-        return tuple(result)
-
-
-# This wires up a shortcut through the backward operation.
-# The already-computed signature is just returned during the forward operation.
-# And the backward operation through signature is not computed in favour of shortcutting through path_pieces. (Which
-# is assumed to be the path which has this signature!)
-def _backward_shortcut(signature, path_pieces, depth):
-    # (batch, stream, channel) to (stream, batch, channel)
-    path_pieces = [path_piece.transpose(0, 1) for path_piece in path_pieces]
-    # .detach() so that no gradients are taken through this argument
-    return _BackwardShortcut.apply(signature.detach(), depth, *path_pieces)
+        _check_version(ctx)
+        starts, ends = ctx.saved_tensors
+        if ctx.squeeze:
+            grad_signature = grad_signature.unsqueeze(0)
+
+        # The gradient with respect to every retained point of the path, including any which have been appended through
+        # Path.update since the forward pass. (Which is only possible if no points have been discarded or edited since
+        # then, as _check_version has just checked.)
+        grad_path = impl.path_signature_backward(grad_signature, ctx.path_info, starts, ends)
+
+        return (None, None, None, None, None, None, None) + tuple(_path_pieces_grads(ctx, grad_path))
+
+
+class _PathLogSignatureFunction(autograd.Function):
+    @staticmethod
+    def forward(ctx, path_info, starts, ends, squeeze, mode, lyndon_info, edit_indices, first_piece_offset,
+                num_path_pieces, *path_pieces_and_edit_values):
+        _save_path_pieces(ctx, path_info, starts, ends, squeeze, edit_indices, first_piece_offset, num_path_pieces,
+                          path_pieces_and_edit_values)
+        mode = lmodule._interpret_mode(mode)
+        ctx.mode = mode
+        ctx.lyndon_info = lyndon_info
+
+        result = impl.path_logsignature_forward(path_info, starts, ends, mode, lyndon_info)
+        if squeeze:
+            result = result[0]
+        return result
+
+    @staticmethod
+    @autograd_function.once_differentiable  # Our backward function uses in-place operations for memory efficiency
+    def backward(ctx, grad_logsignature):
+        _check_version(ctx)
+        starts, ends = ctx.saved_tensors
+        if ctx.squeeze:
+            grad_logsignature = grad_logsignature.unsqueeze(0)
+
+        # As _PathSignatureFunction
+        grad_path = impl.path_logsignature_backward(grad_logsignature, ctx.path_info, starts, ends, ctx.mode,
+                                                    ctx.lyndon_info)
+
+        return (None, None, None, None, None, None, None, None, None) + tuple(_path_pieces_grads(ctx, grad_path))
 
 
 class Path(object):
@@ -117,20 +160,54 @@ class Path(object):
         depth (int): As :func:`signatory.signature`.
 
         basepoint (bool or torch.Tensor, optional): As :func:`signatory.signature`.
+
+        storage (str, optional): Defaults to :code:`"prefix"`. How the signatures of the path are stored. Valid values
+            are :code:`"prefix"` or :code:`"segment_tree"`.
+
+            With :code:`"prefix"`, the signature of every prefix of the path is stored, and the signature on an
+            interval is computed by multiplying the inverse of one by another. This is the fastest option for
+            computing signatures.
+
+            With :code:`"segment_tree"`, the signatures of pieces of the path are stored in a segment tree, and the
+            signature on an interval is computed by multiplying together :code:`O(log(length))` of them. This is
+            slower to query, but doesn't suffer from the loss of precision that can come from multiplying by an
+            inverse, which may be noticeable for long paths. It also makes :meth:`signatory.Path.edit` fast.
+
+        checkpoint_interval (int, optional): Defaults to 1. Only supported with :code:`storage="prefix"`. Trades off
+            memory usage against speed. The signature of the path is only stored at every
+            :attr:`checkpoint_interval`-th point, and at most :code:`checkpoint_interval - 1` steps of the signature
+            computation are redone on each query to recover the signatures in between. The default of 1 stores the
+            signature at every point, and is the fastest. Larger values reduce the memory needed to store the
+            signatures by a factor of :attr:`checkpoint_interval`, which is particularly useful for very long paths.
+            (The path itself is always stored in full.)
+
+        max_length (int or None, optional): Defaults to None. If passed, then only the most recent :attr:`max_length`
+            many points of the path are retained: whenever :meth:`signatory.Path.update` makes the path longer than
+            this, then its oldest points are discarded. All indices passed to :meth:`signatory.Path.signature` etc. are
+            then with respect to the points that have been retained. This means that the memory used stays bounded
+            however many times the path is updated, which is useful for monitoring a stream of data that never ends.
+            Once points have been discarded, it is no longer possible to backpropagate through any signatures or
+            logsignatures that were computed before they were discarded.
     """
-    def __init__(self, path, depth, basepoint=False):
-        # type: (torch.Tensor, int, Union[bool, torch.Tensor]) -> None
+    def __init__(self, path, depth, basepoint=False, storage="prefix", checkpoint_interval=1, max_length=None):
+        # type: (torch.Tensor, int, Union[bool, torch.Tensor], str, int, Union[int, None]) -> None
+        if max_length is not None and max_length < 2:
+            raise ValueError("Argument 'max_length' must be an integer greater than or equal to two. (Need at least this "
+                             "many points to define a path.)")
         self._depth = depth
-
-        self._signature = []
-        self._inverse_signature = []
+        self._max_length = max_length
 
         self._path = []
+        # Edits are recorded by their index amongst every point there has ever been, including discarded ones.
+        self._edit_indices = []
+        self._edit_values = []
+
+        # The number of points that have been discarded because of max_length
+        self._num_discarded = 0
+        # The number of points of self._path[0] that have been discarded
+        self._first_piece_offset = 0
 
         self._length = 0
-        self._signature_length = 0
-        self._lengths = []
-        self._signature_lengths = []
 
         self._batch_size = path.size(-3)
         self._channels = path.size(-1)
@@ -141,12 +218,19 @@ class Path(object):
                                                                      path.device)
         if use_basepoint:
             self._length += 1
-            self._lengths.append(1)
             self._path.append(basepoint_value.unsqueeze(-2))  # unsqueeze a stream dimension
 
-        self._update(path, basepoint, None, None)
+        # Holds the path, and the signature of every prefix of it, in C++.
+        # (batch, stream, channel) to (stream, batch, channel)
+        self._path_info = impl.make_path_info(path.transpose(0, 1), depth, use_basepoint, basepoint_value,
+                                              _interpret_storage(storage), checkpoint_interval,
+                                              0 if max_length is None else max_length)
+        self._path.append(path)
+        self._length += path.size(-2)
+        self._discard()
+        self._signature_length = self._length - 1
 
-        self._signature_to_logsignature_instances = {}
+        self._lyndon_info_capsules = {}
 
     def signature(self, start=None, end=None):
         # type: (Union[int, None], Union[int, None]) -> torch.Tensor
@@ -172,6 +256,10 @@ class Path(object):
             :code:`signatory.signature(p[start:end], depth)`.
         """
 
+        starts, ends = self._interpret_interval(start, end)
+        return self._signature(starts, ends, squeeze=True)
+
+    def _interpret_interval(self, start, end):
         # Record for error messages if need be
         old_start = start
         old_end = end
@@ -205,55 +293,45 @@ class Path(object):
             raise ValueError("start={}, end={} is interpreted as {}, {} for path of length {}, which "
                              "does not describe a valid interval.".format(old_start, old_end, start, end, self._length))
 
-        # Find the signature on [:end]
-        sig_end = end - 2
-        index_sig_end, sig_end = self._locate(self._signature_lengths, sig_end)
-        signature = self._signature[index_sig_end][:, sig_end, :]
-
-        # If start takes its minimum value then we've got the correct signature
-        # Otherwise we need to apply the inverse signature of the preceding part of the path
-        if start != 0:
-            # Find the inverse signature on [:start]
-            sig_start = start - 1
-            index_sig_start, sig_start = self._locate(self._signature_lengths, sig_start)
-            inverse_sig_at_start = self._inverse_signature[index_sig_start][:, sig_start, :]
-
-            # Find the signature on [start:end]
-            signature = smodule.multi_signature_combine([inverse_sig_at_start, signature], self._channels, self.depth)
-
-        # Find path[start:end]
-        path_pieces = []
-        index_end, end = self._locate(self._lengths, end)
-        index_start, start = self._locate(self._lengths, start)
-        if index_start == index_end:
-            path_pieces.append(self.path[index_start][:, start:end, :])
-        else:
-            path_pieces.append(self.path[index_start][:, start:, :])
-            for path_piece in self.path[index_start + 1:index_end]:
-                path_pieces.append(path_piece)
-            if end != 0:
-                # self.path[index_end] is off-the-end if end == 0
-                # and the path we'd append here is of zero length
-                path_pieces.append(self.path[index_end][:, :end, :])
+        starts = torch.tensor([start], dtype=torch.int64)
+        ends = torch.tensor([end], dtype=torch.int64)
+        return starts, ends
+
+    def _path_args(self):
+        # The arguments describing the path pieces, as taken by _PathSignatureFunction and _PathLogSignatureFunction.
+        edit_indices = [index - self._num_discarded for index in self._edit_indices]
+        return [edit_indices, self._first_piece_offset, len(self._path)] + self._path + self._edit_values
 
+    def _signature(self, starts, ends, squeeze):
         # We know that we're only returning the signature on [start:end], and that there is no dependence on the region
-        # [0:start]. But if we were to compute the backwards operation naively then this information wouldn't be used.
-        #
-        # What's returned would be treated as inverse_sig[0:start] \otimes sig[0:end] and we'd backprop through the
-        # whole [0:start] region unnecessarily. We'd end up doing a whole lot of work to find that there's a zero
-        # gradient on path[0:start].
-        # (Or actually probably find that there's some very small gradient due to floating point errors...)
-        #
-        # This obviously isn't desirable if start takes a large value - lots of unnecessary work - so here we insert a
-        # custom backwards that shortcuts that whole procedure.
-        return _backward_shortcut(signature, path_pieces, self._depth)
+        # [0:start]. But if we were to compute the backwards operation naively then this information wouldn't be used:
+        # what's returned is computed as inverse_sig[0:start] \otimes sig[0:end] and we'd backprop through the whole
+        # [0:start] region unnecessarily. So the backward operation instead goes directly through path[start:end].
+        return _PathSignatureFunction.apply(self._path_info, starts, ends, squeeze, *self._path_args())
 
-    @staticmethod
-    def _locate(lengths, index):
-        lengths_index = bisect.bisect_right(lengths, index)
-        if lengths_index > 0:
-            index -= lengths[lengths_index - 1]
-        return lengths_index, index
+    def signatures(self, starts, ends):
+        # type: (torch.Tensor, torch.Tensor) -> torch.Tensor
+        """Returns the signature on many intervals at once.
+
+        This gives the same result as calling :meth:`signatory.Path.signature` once for each interval and stacking the
+        results, but is much faster when there are many intervals, as all of them are computed (and backpropagated
+        through) together.
+
+        Arguments:
+            starts (torch.Tensor): A one-dimensional tensor of dtype :attr:`torch.int64`, specifying the start point of
+                each interval. These are interpreted in the same way as the :attr:`start` argument of
+                :meth:`signatory.Path.signature`, except that they may not be None.
+
+            ends (torch.Tensor): A one-dimensional tensor of dtype :attr:`torch.int64`, of the same size as
+                :attr:`starts`, specifying the end point of each interval.
+
+        Returns:
+            A tensor of shape :code:`(batch, intervals, signature_channels)`, where :code:`intervals` is the size of
+            :attr:`starts` and :attr:`ends`. Its :code:`[:, i]`-th entry is equal to
+            :code:`self.signature(starts[i], ends[i])`.
+        """
+        result = self._signature(starts, ends, squeeze=False)
+        return result.transpose(0, 1)  # (interval, batch, channel) to (batch, interval, channel)
 
     def logsignature(self, start=None, end=None, mode="words"):
         # type: (Union[int, None], Union[int, None], str) -> torch.Tensor
@@ -270,16 +348,43 @@ class Path(object):
             The logsignature on the interval :attr:`[start, end]`. See the documentation for
             :meth:`signatory.Path.signature`.
         """
-        signature = self.signature(start, end)
+        starts, ends = self._interpret_interval(start, end)
+        return self._logsignature(starts, ends, mode, squeeze=True)
+
+    def _logsignature(self, starts, ends, mode, squeeze):
         try:
-            signature_to_logsignature_instance = self._signature_to_logsignature_instances[(self._channels,
-                                                                                            self._depth,
-                                                                                            mode)]
+            lyndon_info_capsule = self._lyndon_info_capsules[mode]
         except KeyError:
-            signature_to_logsignature_instance = lmodule.SignatureToLogSignature(self._channels, self._depth,
-                                                                                 stream=False, mode=mode)
-            self._signature_to_logsignature_instances[(self._channels, self._depth, mode)] = signature_to_logsignature_instance
-        return signature_to_logsignature_instance(signature)
+            lyndon_info_capsule = lmodule.SignatureToLogSignature._get_lyndon_info(self._channels, self._depth, mode)
+            self._lyndon_info_capsules[mode] = lyndon_info_capsule
+        if self._path[-1].is_cuda and mode == 'brackets':
+            warnings.warn("The logsignature with mode='brackets' has been requested on the GPU. This mode is quite "
+                          "slow to calculate, and the GPU offers no speedup. Consider mode='words' instead.")
+        return _PathLogSignatureFunction.apply(self._path_info, starts, ends, squeeze, mode, lyndon_info_capsule.item,
+                                               *self._path_args())
+
+    def logsignatures(self, starts, ends, mode="words"):
+        # type: (torch.Tensor, torch.Tensor, str) -> torch.Tensor
+        """Returns the logsignature on many intervals at once.
+
+        This gives the same result as calling :meth:`signatory.Path.logsignature` once for each interval and stacking
+        the results, but is much faster when there are many intervals, as all of them are computed (and backpropagated
+        through) together.
+
+        Arguments:
+            starts (torch.Tensor): As :meth:`signatory.Path.signatures`.
+
+            ends (torch.Tensor): As :meth:`signatory.Path.signatures`.
+
+            mode (str, optional): As :func:`signatory.logsignature`.
+
+        Returns:
+            A tensor of shape :code:`(batch, intervals, logsignature_channels)`, where :code:`intervals` is the size of
+            :attr:`starts` and :attr:`ends`. Its :code:`[:, i]`-th entry is equal to
+            :code:`self.logsignature(starts[i], ends[i], mode)`.
+        """
+        result = self._logsignature(starts, ends, mode, squeeze=False)
+        return result.transpose(0, 1)  # (interval, batch, channel) to (batch, interval, channel)
 
     def update(self, path):
         # type: (torch.Tensor) -> None
@@ -298,29 +403,71 @@ class Path(object):
                              "used.")
         if path.size(-1) != self._channels:
             raise ValueError("Cannot append a path with different number of channels to what has already been used.")
-        basepoint = self._path[-1][:, -1, :]
-        initial = self._signature[-1][:, -1, :]
-        inverse_initial = self._inverse_signature[-1][:, -1, :]
-        self._update(path, basepoint, initial, inverse_initial)
-
-    def _update(self, path, basepoint, initial, inverse_initial):
-        signature = smodule.signature(path, self._depth, stream=True, basepoint=basepoint, initial=initial)
-        inverse_signature = smodule.signature(path, self._depth, stream=True, basepoint=basepoint, inverse=True,
-                                              initial=inverse_initial)
-        self._signature.append(signature)
-        self._inverse_signature.append(inverse_signature)
-
+        impl.path_update(self._path_info, path.transpose(0, 1))  # (batch, stream, channel) to (stream, batch, channel)
         self._path.append(path)
 
         self._length += path.size(-2)
-        self._signature_length += signature.size(-2)
-        self._lengths.append(self._length)
-        self._signature_lengths.append(self._signature_length)
+        self._discard()
+        self._signature_length = self._length - 1
+
+    def _discard(self):
+        # Mirrors what happens in C++ when the path is longer than max_length: forgets about the oldest points of the
+        # path, so that we don't keep holding on to them.
+        if self._max_length is None or self._length <= self._max_length:
+            return
+        num_discard = self._length - self._max_length
+        self._length = self._max_length
+        self._num_discarded += num_discard
+
+        num_discard += self._first_piece_offset
+        while num_discard >= self._path[0].size(-2):
+            num_discard -= self._path.pop(0).size(-2)
+        self._first_piece_offset = num_discard
+
+        edit_indices = []
+        edit_values = []
+        for index, value in zip(self._edit_indices, self._edit_values):
+            if index >= self._num_discarded:
+                edit_indices.append(index)
+                edit_values.append(value)
+        self._edit_indices = edit_indices
+        self._edit_values = edit_values
+
+    def edit(self, index, value):
+        # type: (int, torch.Tensor) -> None
+        """Changes a single point of the path.
+
+        Every signature subsequently asked for is computed as if the path had always had :attr:`value` at this point.
+        Gradients with respect to this point will then flow to :attr:`value`, rather than to the original point. (The
+        tensors in :attr:`signatory.Path.path` are not modified.) It is no longer possible to backpropagate through any
+        signatures or logsignatures that were computed before the edit.
+
+        With :code:`storage="segment_tree"`, this only requires :code:`O(log(length))` work. With
+        :code:`storage="prefix"`, the signature of every prefix of the path after this point must be recomputed.
+
+        Arguments:
+            index (int): Which point of the path to change. This is interpreted in the same way as indexing, so it
+                may be negative. (In the same way as :meth:`signatory.Path.signature`, any :attr:`basepoint` counts
+                as the first point of the path.)
+
+            value (torch.Tensor): The new value of the point, of shape :code:`(batch, channel)`.
+        """
+        if not -self._length <= index < self._length:
+            raise ValueError("index={} is out of range for path of length {}.".format(index, self._length))
+        if index < 0:
+            index += self._length
+        impl.path_edit(self._path_info, index, value)
+        self._edit_indices.append(self._num_discarded + index)
+        self._edit_values.append(value)
 
     @property
     def path(self):
         # type: () -> List[torch.Tensor]
-        """The path(s) that this Path was created with."""
+        """The path(s) that this Path was created with.
+
+        If :attr:`max_length` was passed, then this only includes those paths which still have points that have been
+        retained. (The first of these may also include some points which have been discarded.)
+        """
         return self._path
 
     @property
@@ -26,7 +26,7 @@ from . import impl
 
 # noinspection PyUnreachableCode
 if False:
-    from typing import Any, List, Union
+    from typing import Any, List, Tuple, Union
 
 
 def interpret_basepoint(basepoint, batch_size, channel_size, dtype, device):
@@ -52,7 +52,7 @@ def interpret_initial(initial):
 
 class _SignatureFunction(autograd.Function):
     @staticmethod
-    def forward(ctx, path, depth, stream, basepoint, inverse, initial):
+    def forward(ctx, path, depth, stream, basepoint, inverse, initial, time_channel, lead_lag):
 
         ctx.basepoint_is_tensor = isinstance(basepoint, torch.Tensor)
         ctx.initial_is_tensor = isinstance(initial, torch.Tensor)
@@ -61,13 +61,15 @@ class _SignatureFunction(autograd.Function):
         initial, initial_value = interpret_initial(initial)
 
         signature_, path_increments = impl.signature_forward(path, depth, stream, basepoint, basepoint_value, inverse,
-                                                             initial, initial_value)
+                                                             initial, initial_value, time_channel, lead_lag)
         ctx.save_for_backward(signature_, path_increments)
         ctx.depth = depth
         ctx.stream = stream
         ctx.basepoint = basepoint
         ctx.inverse = inverse
         ctx.initial = initial
+        ctx.time_channel = time_channel
+        ctx.lead_lag = lead_lag
 
         return signature_
 
@@ -78,21 +80,89 @@ class _SignatureFunction(autograd.Function):
 
         grad_path, grad_basepoint, grad_initial = impl.signature_backward(grad_result, signature_, path_increments,
                                                                           ctx.depth, ctx.stream, ctx.basepoint,
-                                                                          ctx.inverse, ctx.initial)
+                                                                          ctx.inverse, ctx.initial, ctx.time_channel,
+                                                                          ctx.lead_lag)
 
         if not ctx.basepoint_is_tensor:
             grad_basepoint = None
         if not ctx.initial_is_tensor:
             grad_initial = None
 
-        return grad_path, None, None, grad_basepoint, None, grad_initial, None
+        return grad_path, None, None, grad_basepoint, None, grad_initial, None, None
 
 
-def _signature_checkargs(path, depth, basepoint, initial):
+class _SignatureIndicesFunction(autograd.Function):
+    @staticmethod
+    def forward(ctx, path, depth, indices, basepoint, inverse, initial, time_channel, lead_lag):
+
+        ctx.basepoint_is_tensor = isinstance(basepoint, torch.Tensor)
+        ctx.initial_is_tensor = isinstance(initial, torch.Tensor)
+        basepoint, basepoint_value = interpret_basepoint(basepoint, path.size(-2), path.size(-1), path.dtype,
+                                                         path.device)
+        initial, initial_value = interpret_initial(initial)
+
+        signature_, final_signature, path_increments = impl.signature_indices_forward(path, depth, indices, basepoint,
+                                                                                      basepoint_value, inverse,
+                                                                                      initial, initial_value,
+                                                                                      time_channel, lead_lag)
+        ctx.save_for_backward(final_signature, path_increments, indices)
+        ctx.depth = depth
+        ctx.basepoint = basepoint
+        ctx.inverse = inverse
+        ctx.initial = initial
+        ctx.time_channel = time_channel
+        ctx.lead_lag = lead_lag
+
+        return signature_
+
+    @staticmethod
+    @autograd_function.once_differentiable  # Our backward function uses in-place operations for memory efficiency
+    def backward(ctx, grad_result):
+        final_signature, path_increments, indices = ctx.saved_tensors
+
+        grad_path, grad_basepoint, grad_initial = impl.signature_indices_backward(grad_result, final_signature,
+                                                                                  path_increments, indices, ctx.depth,
+                                                                                  ctx.basepoint, ctx.inverse,
+                                                                                  ctx.initial, ctx.time_channel,
+                                                                                  ctx.lead_lag)
+
+        if not ctx.basepoint_is_tensor:
+            grad_basepoint = None
+        if not ctx.initial_is_tensor:
+            grad_initial = None
+
+        return grad_path, None, None, grad_basepoint, None, grad_initial, None, None
+
+
+def _augmented_channels(channels, time_channel, lead_lag):
+    # The number of channels of the path once it has been augmented with time and/or lead-lag. See signature.
+    return (2 * channels if lead_lag else channels) + (1 if time_channel else 0)
+
+
+def _stream_indices(path, stream, basepoint, lead_lag):
+    # Converts the 'stream' argument of signature, when it is a stride or a collection of indices, into a tensor of
+    # indices into the stream dimension of the output.
+    if isinstance(stream, int):
+        if stream < 1:
+            raise ValueError("Argument 'stream' must be a positive integer if it is used as a stride.")
+        output_stream_size = path.size(-2)
+        if not (basepoint is True or isinstance(basepoint, torch.Tensor)):
+            output_stream_size -= 1
+        if lead_lag:
+            output_stream_size *= 2
+        if stream > output_stream_size:
+            raise ValueError("Argument 'stream' is a stride of {}, which is longer than the {} entries of the stream "
+                             "dimension of the output, so no entries would be selected.".format(stream,
+                                                                                               output_stream_size))
+        return torch.arange(stream - 1, output_stream_size, stream, dtype=torch.int64)
+    return torch.as_tensor(stream, dtype=torch.int64, device='cpu')
+
+
+def _signature_checkargs(path, depth, basepoint, initial, time_channel=False, lead_lag=False):
     path = path.transpose(0, 1)  # (batch, stream, channel) to (stream, batch, channel)
     basepoint, basepoint_value = interpret_basepoint(basepoint, path.size(-2), path.size(-1), path.dtype, path.device)
     initial, initial_value = interpret_initial(initial)
-    impl.signature_checkargs(path, depth, basepoint, basepoint_value, initial, initial_value)
+    impl.signature_checkargs(path, depth, basepoint, basepoint_value, initial, initial_value, time_channel, lead_lag)
 
 
 def _signature_batch_trick(path, depth, stream, basepoint, inverse, initial):
@@ -155,7 +225,8 @@ def _signature_batch_trick(path, depth, stream, basepoint, inverse, initial):
     basepoint = ends.view(batch_size * mult, channel_size)
 
     # noinspection PyUnresolvedReferences
-    result_bulk = _SignatureFunction.apply(path_bulk.transpose(0, 1), depth, stream, basepoint, inverse, None)
+    result_bulk = _SignatureFunction.apply(path_bulk.transpose(0, 1), depth, stream, basepoint, inverse, None, False,
+                                           False)
     result_bulk = result_bulk.view(batch_size, mult, result_bulk.size(-1))
     chunks = []
     if isinstance(initial, torch.Tensor):
@@ -166,14 +237,15 @@ def _signature_batch_trick(path, depth, stream, basepoint, inverse, initial):
         # (stream, batch, channel)
         # noinspection PyUnresolvedReferences
         result_remainder = _SignatureFunction.apply(path_remainder.transpose(0, 1), depth, stream, basepoint_remainder,
-                                                    inverse, None)
+                                                    inverse, None, False, False)
         chunks.append(result_remainder)
 
     return multi_signature_combine(chunks, channel_size, depth, inverse)
 
 
-def signature(path, depth, stream=False, basepoint=False, inverse=False, initial=None):
-    # type: (torch.Tensor, int, bool, Union[bool, torch.Tensor], bool, Union[None, torch.Tensor]) -> torch.Tensor
+def signature(path, depth, stream=False, basepoint=False, inverse=False, initial=None, time_channel=False,
+              lead_lag=False):
+    # type: (torch.Tensor, int, Union[bool, int, List[int], torch.Tensor], Union[bool, torch.Tensor], bool, Union[None, torch.Tensor], bool, bool) -> torch.Tensor
 
     r"""Applies the signature transform to a stream of data.
 
@@ -199,9 +271,16 @@ def signature(path, depth, stream=False, basepoint=False, inverse=False, initial
 
         depth (int): The depth to truncate the signature at.
 
-        stream (bool, optional): Defaults to False. If False then the usual signature transform of the whole path is
-            computed. If True then the signatures of all paths :math:`(x_1, \ldots, x_j)`, for :math:`j=2, \ldots, L`,
-            are returned. (Or :math:`j=1, \ldots, L` is :attr:`basepoint` is passed, see below.)
+        stream (bool or int or list of int or :class:`torch.Tensor`, optional): Defaults to False. If False then the
+            usual signature transform of the whole path is computed. If True then the signatures of all paths
+            :math:`(x_1, \ldots, x_j)`, for :math:`j=2, \ldots, L`, are returned. (Or :math:`j=1, \ldots, L` is
+            :attr:`basepoint` is passed, see below.)
+            Alternatively it may be an integer stride :math:`k`, or a list or one-dimensional :class:`torch.Tensor` of
+            strictly increasing indices, in which case only the signatures at those positions of the stream are
+            returned. That is, the result is the same as :code:`signature(path, depth, stream=True)[:, k - 1::k]` or
+            :code:`signature(path, depth, stream=True)[:, indices]` respectively, but the signatures at every other
+            position are never stored, which saves on memory. A stride longer than the stream dimension of the output
+            is an error, as it would select nothing.
 
         basepoint (bool or :class:`torch.Tensor`, optional): Defaults to False. If :attr:`basepoint` is True then an
             additional point :math:`x_0 = 0 \in \mathbb{R}^C` is prepended to the path before the signature transform is
@@ -223,6 +302,25 @@ def signature(path, depth, stream=False, basepoint=False, inverse=False, initial
             Then this signature is pre-tensor-multiplied on to the signature of :attr:`path`. For a more thorough
             explanation, see :ref:`this example<examples-online>`.
             (The appropriate modifications are made if :attr:`inverse=True` or if :attr:`basepoint`.)
+            If :attr:`time_channel` or :attr:`lead_lag` are set then this should be the signature of a path with the
+            correspondingly augmented number of channels.
+
+        time_channel (bool, optional): Defaults to False. If True then the signature is instead computed of the path
+            augmented with an extra channel (placed first), corresponding to time increasing uniformly from :math:`0`
+            to :math:`1` along the path. This extra channel is never actually concatenated on to the path; it is
+            generated on the fly, one increment at a time, whilst computing the signature.
+
+        lead_lag (bool, optional): Defaults to False. If True then the signature is instead computed of the lead-lag
+            transform of the path. That is, the path :math:`(x_1, \ldots, x_L)` in :math:`\mathbb{R}^C` is replaced
+            with the path
+
+            .. math::
+                ((x_1, x_1), (x_2, x_1), (x_2, x_2), \ldots, (x_L, x_{L - 1}), (x_L, x_L))
+
+            in :math:`\mathbb{R}^{2C}`. As with :attr:`time_channel`, this transformed path (and its increments) is
+            never explicitly constructed, so no extra memory is needed to hold it. If both :attr:`time_channel`
+            and :attr:`lead_lag` are True then the time channel is applied after the lead-lag transform, so that the
+            augmented path has :math:`2C + 1` channels.
 
     Returns:
         A :class:`torch.Tensor`. Given an input :class:`torch.Tensor` of shape :math:`(N, L, C)`, and input arguments
@@ -240,6 +338,11 @@ def signature(path, depth, stream=False, basepoint=False, inverse=False, initial
 
         Note that the number of output channels may be calculated via the convenience function
         :func:`signatory.signature_channels`.
+
+        If :attr:`time_channel` or :attr:`lead_lag` are set then :math:`C` should be replaced by the number of channels
+        of the augmented path, that is, :math:`2C` with lead-lag and an additional :math:`1` with time. If
+        :attr:`lead_lag` and :attr:`stream` are both True then the stream dimension of the output is of size
+        :math:`2(L - 1)`, or :math:`2L` with a :attr:`basepoint`, corresponding to every point of the lead-lag path.
     """
 
     if initial is not None and basepoint is False:
@@ -249,11 +352,24 @@ def signature(path, depth, stream=False, basepoint=False, inverse=False, initial
                       "    https://signatory.readthedocs.io/en/latest/pages/examples/online.html\n"
                       "for more information.")
 
-    _signature_checkargs(path, depth, basepoint, initial)
+    _signature_checkargs(path, depth, basepoint, initial, time_channel, lead_lag)
 
-    result = _signature_batch_trick(path, depth, stream, basepoint, inverse, initial)
+    if not isinstance(stream, bool):
+        # Either a stride or a collection of indices
+        indices = _stream_indices(path, stream, basepoint, lead_lag)
+        # noinspection PyUnresolvedReferences
+        result = _SignatureIndicesFunction.apply(path.transpose(0, 1), depth, indices, basepoint, inverse, initial,
+                                                 time_channel, lead_lag)
+        # We have to do the transpose outside of autograd.Function.apply to avoid PyTorch bug 24413
+        return result.transpose(0, 1)
+
+    result = None
+    # The batch trick splits the path into pieces, which doesn't respect the augmentations
+    if not (time_channel or lead_lag):
+        result = _signature_batch_trick(path, depth, stream, basepoint, inverse, initial)
     if result is None:  # Either because we disabled use of the batch trick, or because the batch trick doesn't apply
-        result = _SignatureFunction.apply(path.transpose(0, 1), depth, stream, basepoint, inverse, initial)
+        result = _SignatureFunction.apply(path.transpose(0, 1), depth, stream, basepoint, inverse, initial,
+                                          time_channel, lead_lag)
 
     # We have to do the transpose outside of autograd.Function.apply to avoid PyTorch bug 24413
     if stream:
@@ -268,17 +384,23 @@ class Signature(nn.Module):
     Arguments:
         depth (int): as :func:`signatory.signature`.
 
-        stream (bool, optional): as :func:`signatory.signature`.
+        stream (bool or int or list of int or :class:`torch.Tensor`, optional): as :func:`signatory.signature`.
 
         inverse (bool, optional): as :func:`signatory.signature`.
+
+        time_channel (bool, optional): as :func:`signatory.signature`.
+
+        lead_lag (bool, optional): as :func:`signatory.signature`.
     """
 
-    def __init__(self, depth, stream=False, inverse=False, **kwargs):
-        # type: (int, bool, bool, **Any) -> None
+    def __init__(self, depth, stream=False, inverse=False, time_channel=False, lead_lag=False, **kwargs):
+        # type: (int, Union[bool, int, List[int], torch.Tensor], bool, bool, bool, **Any) -> None
         super(Signature, self).__init__(**kwargs)
         self.depth = depth
         self.stream = stream
         self.inverse = inverse
+        self.time_channel = time_channel
+        self.lead_lag = lead_lag
 
     def forward(self, path, basepoint=False, initial=None):
         # type: (torch.Tensor, Union[bool, torch.Tensor], Union[None, torch.Tensor]) -> torch.Tensor
@@ -295,11 +417,351 @@ class Signature(nn.Module):
             As :func:`signatory.signature`.
         """
         return signature(path, self.depth, stream=self.stream, basepoint=basepoint, inverse=self.inverse,
-                         initial=initial)
+                         initial=initial, time_channel=self.time_channel, lead_lag=self.lead_lag)
 
     def extra_repr(self):
-        return 'depth={depth}, stream={stream}, inverse={inverse}'.format(depth=self.depth, stream=self.stream,
-                                                                          inverse=self.inverse)
+        return ('depth={depth}, stream={stream}, inverse={inverse}, time_channel={time_channel}, lead_lag={lead_lag}'
+                .format(depth=self.depth, stream=self.stream, inverse=self.inverse, time_channel=self.time_channel,
+                        lead_lag=self.lead_lag))
+
+
+class _ExpectedSignatureFunction(autograd.Function):
+    @staticmethod
+    def forward(ctx, path, depth, stream, basepoint):
+        ctx.basepoint_is_tensor = isinstance(basepoint, torch.Tensor)
+        basepoint, basepoint_value = interpret_basepoint(basepoint, path.size(-2), path.size(-1), path.dtype,
+                                                         path.device)
+
+        expected_signature_ = impl.expected_signature_forward(path, depth, stream, basepoint, basepoint_value)
+        # We save the path rather than the signatures of each sample, which are recomputed in the backward pass.
+        ctx.save_for_backward(path, basepoint_value)
+        ctx.depth = depth
+        ctx.stream = stream
+        ctx.basepoint = basepoint
+
+        return expected_signature_
+
+    @staticmethod
+    @autograd_function.once_differentiable  # Our backward function uses in-place operations for memory efficiency
+    def backward(ctx, grad_result):
+        path, basepoint_value = ctx.saved_tensors
+
+        grad_path, grad_basepoint = impl.expected_signature_backward(grad_result, path, ctx.depth, ctx.stream,
+                                                                     ctx.basepoint, basepoint_value)
+
+        if not ctx.basepoint_is_tensor:
+            grad_basepoint = None
+
+        return grad_path, None, None, grad_basepoint
+
+
+def expected_signature(path, depth, stream=False, basepoint=False):
+    # type: (torch.Tensor, int, bool, Union[bool, torch.Tensor]) -> torch.Tensor
+    r"""Computes the expected signature of a batch of paths; that is, the mean of their signatures.
+
+    This is equivalent to :code:`signatory.signature(path, depth, stream, basepoint).mean(0)`, but without ever holding
+    the signatures of the whole batch in memory: each thread accumulates the sum of the signatures of its share of the
+    batch, and these partial sums are combined at the end. The backward pass likewise recomputes the signatures of
+    only a few samples at a time. This makes it suitable for computing Monte Carlo estimates of expected signatures
+    over very large numbers of sample paths.
+
+    Only supported on the CPU.
+
+    Arguments:
+        path (:class:`torch.Tensor`): As :func:`signatory.signature`. The batch dimension is the one averaged over.
+
+        depth (int): As :func:`signatory.signature`.
+
+        stream (bool, optional): As :func:`signatory.signature`.
+
+        basepoint (bool or :class:`torch.Tensor`, optional): As :func:`signatory.signature`.
+
+    Returns:
+        A :class:`torch.Tensor` of shape :math:`(C + C^2 + \cdots + C^\text{depth},)`. If :attr:`stream` is True then
+        instead it has an extra first dimension of size :math:`L` (or :math:`L - 1` if there is no basepoint), giving
+        the expected signatures of every prefix of the paths, as with :func:`signatory.signature`.
+    """
+    # transpose to go from Python convention of (batch, stream, channel) to autograd/C++ convention of
+    # (stream, batch, channel)
+    # The result has no batch dimension, so there is nothing to transpose back.
+    # noinspection PyUnresolvedReferences
+    return _ExpectedSignatureFunction.apply(path.transpose(0, 1), depth, stream, basepoint)
+
+
+class _SignatureWordsFunction(autograd.Function):
+    @staticmethod
+    def forward(ctx, path, words, stream, basepoint):
+        ctx.basepoint_is_tensor = isinstance(basepoint, torch.Tensor)
+        basepoint, basepoint_value = interpret_basepoint(basepoint, path.size(-2), path.size(-1), path.dtype,
+                                                         path.device)
+
+        signature_ = impl.signature_words_forward(path, words, stream, basepoint, basepoint_value)
+        ctx.save_for_backward(path, basepoint_value)
+        ctx.words = words
+        ctx.stream = stream
+        ctx.basepoint = basepoint
+
+        return signature_
+
+    @staticmethod
+    @autograd_function.once_differentiable  # Our backward function uses in-place operations for memory efficiency
+    def backward(ctx, grad_result):
+        path, basepoint_value = ctx.saved_tensors
+
+        grad_path, grad_basepoint = impl.signature_words_backward(grad_result, path, ctx.words, ctx.stream,
+                                                                  ctx.basepoint, basepoint_value)
+
+        if not ctx.basepoint_is_tensor:
+            grad_basepoint = None
+
+        return grad_path, None, None, grad_basepoint
+
+
+def signature_words(path, words=None, levels=None, stream=False, basepoint=False):
+    # type: (torch.Tensor, Union[None, List[List[int]]], Union[None, List[int]], bool, Union[bool, torch.Tensor]) -> torch.Tensor
+    r"""Computes just some of the coordinates of the signature transform, as specified by either a collection of words
+    or a collection of levels.
+
+    Each coordinate of the signature corresponds to a word in the alphabet of channels; see
+    :func:`signatory.all_words`. The coordinate corresponding to a word only depends upon the coordinates corresponding
+    to its prefixes, so only these are ever computed, in both the forward and backward passes. This makes it much
+    cheaper than :func:`signatory.signature` when only a small number of coordinates are of interest, and in
+    particular when :attr:`stream` is True, as only the requested coordinates are stored for every step of the stream.
+
+    Exactly one of :attr:`words` and :attr:`levels` should be passed.
+
+    Only supported on the CPU.
+
+    Arguments:
+        path (:class:`torch.Tensor`): As :func:`signatory.signature`.
+
+        words (None or list of list of int, optional): The words whose coordinates should be computed. Each letter is
+            represented by an integer :math:`i` in the range :math:`0 \leq i < C`, as with
+            :func:`signatory.all_words`.
+
+        levels (None or list of int, optional): The levels of the signature whose coordinates should be computed. For
+            example :attr:`levels=[3]` computes just the coordinates corresponding to words of length three. Note that
+            computing a level of the signature requires computing every level below it, so this only saves on memory,
+            not on computation.
+
+        stream (bool, optional): As :func:`signatory.signature`.
+
+        basepoint (bool or :class:`torch.Tensor`, optional): As :func:`signatory.signature`.
+
+    Returns:
+        A :class:`torch.Tensor`, with the requested coordinates in the last dimension. If :attr:`words` was passed then
+        they are in the same order as :attr:`words`. If :attr:`levels` was passed then they are in the order that they
+        would appear in :func:`signatory.signature`. The other dimensions are as with :func:`signatory.signature`.
+    """
+    if (words is None) == (levels is None):
+        raise ValueError("Exactly one of 'words' and 'levels' must be passed.")
+    if levels is not None:
+        levels = set(levels)
+        if len(levels) == 0 or min(levels) < 1:
+            raise ValueError("Argument 'levels' must be a nonempty collection of integers greater than or equal to "
+                             "one.")
+        words = [word for word in utility.all_words(path.size(-1), max(levels)) if len(word) in levels]
+    words = [list(word) for word in words]
+
+    # transpose to go from Python convention of (batch, stream, channel) to autograd/C++ convention of
+    # (stream, batch, channel)
+    # noinspection PyUnresolvedReferences
+    result = _SignatureWordsFunction.apply(path.transpose(0, 1), words, stream, basepoint)
+
+    # We have to do the transpose outside of autograd.Function.apply to avoid PyTorch bug 24413
+    if stream:
+        # NOT .transpose_ - the underlying TensorImpl (in C++) is used elsewhere and we don't want to change it.
+        result = result.transpose(0, 1)
+    return result
+
+
+def signature_jvp(path, path_tangent, depth, stream=False, basepoint=False, basepoint_tangent=None):
+    # type: (torch.Tensor, torch.Tensor, int, bool, Union[bool, torch.Tensor], Union[None, torch.Tensor]) -> Tuple[torch.Tensor, torch.Tensor]
+    r"""Computes the signature transform together with its Jacobian-vector product; that is, its derivative in the
+    direction of a perturbation of the path.
+
+    This is computed by forward-mode differentiation: the derivative is carried alongside the signature at every step of
+    its computation. This costs about twice as much as computing the signature alone, and gives the derivative of every
+    output at once; this is much cheaper than obtaining Jacobian-vector products via reverse-mode differentiation, which
+    would require a backward pass for every output.
+
+    The results do not themselves support autograd.
+
+    Only supported on the CPU.
+
+    Arguments:
+        path (:class:`torch.Tensor`): As :func:`signatory.signature`.
+
+        path_tangent (:class:`torch.Tensor`): The direction in which to perturb :attr:`path`. Must be of the same shape
+            as :attr:`path`. (If Jacobian-vector products in several directions are desired, then they can be computed
+            all at once by repeating :attr:`path` along its batch dimension.)
+
+        depth (int): As :func:`signatory.signature`.
+
+        stream (bool, optional): As :func:`signatory.signature`.
+
+        basepoint (bool or :class:`torch.Tensor`, optional): As :func:`signatory.signature`.
+
+        basepoint_tangent (None or :class:`torch.Tensor`, optional): The direction in which to perturb
+            :attr:`basepoint`, if it is a tensor. Must be of the same shape as :attr:`basepoint`. Defaults to None,
+            which corresponds to not perturbing the basepoint.
+
+    Returns:
+        A tuple of two :class:`torch.Tensor` s, both of the same shape as the result of :func:`signatory.signature`.
+        The first is the signature of :attr:`path`. The second is its derivative in the direction of
+        :attr:`path_tangent` (and :attr:`basepoint_tangent`).
+    """
+    if basepoint_tangent is not None and not isinstance(basepoint, torch.Tensor):
+        raise ValueError("Argument 'basepoint_tangent' can only be passed if 'basepoint' is a tensor.")
+
+    # transpose to go from Python convention of (batch, stream, channel) to C++ convention of (stream, batch, channel)
+    path = path.transpose(0, 1)
+    path_tangent = path_tangent.transpose(0, 1)
+
+    basepoint, basepoint_value = interpret_basepoint(basepoint, path.size(-2), path.size(-1), path.dtype, path.device)
+    if basepoint_tangent is None:
+        basepoint_tangent = torch.zeros_like(basepoint_value)
+
+    signature_, tangent = impl.signature_jvp(path, path_tangent, depth, stream, basepoint, basepoint_value,
+                                             basepoint_tangent)
+    if stream:
+        signature_ = signature_.transpose(0, 1)
+        tangent = tangent.transpose(0, 1)
+    return signature_, tangent
+
+
+class _SignatureTreeFunction(autograd.Function):
+    @staticmethod
+    def forward(ctx, increments, parents, depth):
+        signature_ = impl.signature_tree_forward(increments, parents, depth)
+        ctx.save_for_backward(signature_, increments, parents)
+        ctx.depth = depth
+
+        return signature_
+
+    @staticmethod
+    @autograd_function.once_differentiable  # Our backward function uses in-place operations for memory efficiency
+    def backward(ctx, grad_result):
+        signature_, increments, parents = ctx.saved_tensors
+
+        grad_increments = impl.signature_tree_backward(grad_result, signature_, increments, parents, ctx.depth)
+
+        return grad_increments, None, None
+
+
+def signature_tree(increments, parents, depth):
+    # type: (torch.Tensor, Union[List[int], torch.Tensor], int) -> torch.Tensor
+    r"""Computes the signatures of every path in a tree of paths, sharing the computation of their common prefixes.
+
+    The tree is specified by its nodes, each of which is a single increment added on to the end of the path of its
+    parent. The path corresponding to a node is then the concatenation of the increments along the route from the root
+    down to that node. (So that for example this is a natural way to describe the candidates in a beam search, or a
+    collection of scenarios branching off from one another.)
+
+    The signature of every node is computed from the signature of its parent by a single step, so the work for a shared
+    prefix is only ever done once, rather than once for every path that it is a prefix of. Every node at the same
+    distance from the root is computed at the same time, so the number of sequential steps is only the depth of the
+    tree.
+
+    This is equivalent to (but typically much faster than) calling :func:`signatory.signature` on every path
+    separately, with :attr:`basepoint=True` so that the increments are exactly those describing the tree.
+
+    Arguments:
+        increments (:class:`torch.Tensor`): The increments of the tree, of shape :math:`(N, M, C)`, corresponding to
+            batch, node and channel dimensions respectively. Every batch element uses the same tree.
+
+        parents (list of int or :class:`torch.Tensor`): Of length :math:`M`. Entry :math:`i` should be the index of the
+            parent of node :math:`i`, which must be less than :math:`i`, or :math:`-1` if node :math:`i` is the first
+            increment of a path.
+
+        depth (int): The depth of the signature to compute.
+
+    Returns:
+        A :class:`torch.Tensor` of shape :math:`(N, M, S)`, where :math:`S` is as :func:`signatory.signature`, whose
+        :math:`i`-th element along the node dimension is the signature of the path ending at node :math:`i`.
+    """
+    parents = torch.as_tensor(parents, dtype=torch.int64, device='cpu')
+
+    # transpose to go from Python convention of (batch, node, channel) to autograd/C++ convention of
+    # (node, batch, channel)
+    # noinspection PyUnresolvedReferences
+    result = _SignatureTreeFunction.apply(increments.transpose(0, 1), parents, depth)
+
+    # We have to do the transpose outside of autograd.Function.apply to avoid PyTorch bug 24413
+    # NOT .transpose_ - the underlying TensorImpl (in C++) is used elsewhere and we don't want to change it.
+    return result.transpose(0, 1)
+
+
+class _SignatureRaggedFunction(autograd.Function):
+    @staticmethod
+    def forward(ctx, path, lengths, depth, stream, basepoint):
+        ctx.basepoint_is_tensor = isinstance(basepoint, torch.Tensor)
+        basepoint, basepoint_value = interpret_basepoint(basepoint, lengths.size(0), path.size(-1), path.dtype,
+                                                         path.device)
+
+        signature_ = impl.signature_ragged_forward(path, lengths, depth, stream, basepoint, basepoint_value)
+        ctx.save_for_backward(signature_, path, lengths, basepoint_value)
+        ctx.depth = depth
+        ctx.stream = stream
+        ctx.basepoint = basepoint
+
+        return signature_
+
+    @staticmethod
+    @autograd_function.once_differentiable  # Our backward function uses in-place operations for memory efficiency
+    def backward(ctx, grad_result):
+        signature_, path, lengths, basepoint_value = ctx.saved_tensors
+
+        grad_path, grad_basepoint = impl.signature_ragged_backward(grad_result, signature_, path, lengths, ctx.depth,
+                                                                   ctx.stream, ctx.basepoint, basepoint_value)
+
+        if not ctx.basepoint_is_tensor:
+            grad_basepoint = None
+
+        return grad_path, None, None, None, grad_basepoint
+
+
+def signature_ragged(path, lengths, depth, stream=False, basepoint=False):
+    # type: (torch.Tensor, Union[List[int], torch.Tensor], int, bool, Union[bool, torch.Tensor]) -> torch.Tensor
+    r"""Applies the signature transform to a batch of paths of different lengths, without padding them.
+
+    The usual way to handle paths of different lengths with :func:`signatory.signature` is to pad them all to the
+    same length, by repeating their final points. This gives the right answer, but all of the work done on the padding
+    is wasted. Instead this function takes the paths packed one after another, and only ever does the work for the
+    points that are actually there.
+
+    On the CPU, the paths are distributed between threads so as to balance the total length handled by each thread, so
+    that a few long paths and many short paths may be handled efficiently together. On the GPU, each step is computed as
+    a single batch over every path that is at least that long.
+
+    Arguments:
+        path (:class:`torch.Tensor`): The paths, of shape :math:`(L_1 + \cdots + L_N, C)`, corresponding to the
+            points of each path placed one after another, and the channel dimension. (So for example this may be
+            obtained by calling :code:`torch.cat` on a list of paths of shape :math:`(L_i, C)`.)
+
+        lengths (list of int or :class:`torch.Tensor`): Of length :math:`N`, specifying the number of points
+            :math:`L_1, \ldots, L_N` of each path.
+
+        depth (int): as :func:`signatory.signature`.
+
+        stream (bool, optional): Defaults to False. If False then the signature of each path is returned. If True then
+            the signature of every prefix of each path is returned, as with :func:`signatory.signature`.
+
+        basepoint (bool or :class:`torch.Tensor`, optional): as :func:`signatory.signature`, except that if it is a
+            tensor then it should be of shape :math:`(N, C)`.
+
+    Returns:
+        If :attr:`stream` is False then a :class:`torch.Tensor` of shape :math:`(N, S)`, where :math:`S` is as
+        :func:`signatory.signature`, whose :math:`i`-th element is the signature of the :math:`i`-th path.
+
+        If :attr:`stream` is True then a :class:`torch.Tensor` of shape :math:`(L_1 + \cdots + L_N - N, S)` (or
+        :math:`(L_1 + \cdots + L_N, S)` if a basepoint is used), holding the signatures of the prefixes of each path
+        one after another, in the same manner as :attr:`path`. (So the signatures for the :math:`i`-th path are as
+        :code:`signatory.signature(path_i.unsqueeze(0), depth, stream=True).squeeze(0)`.)
+    """
+    lengths = torch.as_tensor(lengths, dtype=torch.int64, device='cpu')
+    # noinspection PyUnresolvedReferences
+    return _SignatureRaggedFunction.apply(path, lengths, depth, stream, basepoint)
 
 
 # A wrapper for the sake of consistent documentation
@@ -0,0 +1,173 @@
+# Copyright 2019 Patrick Kidger. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+# 
+#    http://www.apache.org/licenses/LICENSE-2.0
+# 
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# =========================================================================
+"""Provides operations computing random sketches of the signature."""
+
+
+import torch
+from torch import nn
+from torch import autograd
+from torch.autograd import function as autograd_function
+
+from . import impl
+from . import signature_module as smodule
+
+# noinspection PyUnreachableCode
+if False:
+    from typing import Any, Optional, Tuple, Union
+
+
+class _SignatureSketchFunction(autograd.Function):
+    @staticmethod
+    def forward(ctx, path, hashes, signs, sketch_channels, basepoint):
+        ctx.basepoint_is_tensor = isinstance(basepoint, torch.Tensor)
+        basepoint, basepoint_value = smodule.interpret_basepoint(basepoint, path.size(-2), path.size(-1), path.dtype,
+                                                                 path.device)
+
+        sketch, sketch_by_level = impl.signature_sketch_forward(path, hashes, signs, sketch_channels, basepoint,
+                                                                basepoint_value)
+        ctx.save_for_backward(sketch_by_level, path, hashes, signs, basepoint_value)
+        ctx.basepoint = basepoint
+
+        return sketch
+
+    @staticmethod
+    @autograd_function.once_differentiable  # Our backward function uses in-place operations for memory efficiency
+    def backward(ctx, grad_sketch):
+        sketch_by_level, path, hashes, signs, basepoint_value = ctx.saved_tensors
+
+        grad_path, grad_basepoint = impl.signature_sketch_backward(grad_sketch, sketch_by_level, path, hashes, signs,
+                                                                   ctx.basepoint, basepoint_value)
+
+        if not ctx.basepoint_is_tensor:
+            grad_basepoint = None
+
+        return grad_path, None, None, None, grad_basepoint
+
+
+def sketch_hashes(channels, depth, sketch_channels, generator=None, dtype=torch.float):
+    # type: (int, int, int, Optional[torch.Generator], torch.dtype) -> Tuple[torch.Tensor, torch.Tensor]
+    """Generates the random hashes and signs used by :func:`signatory.signature_sketch`.
+
+    Arguments:
+        channels (int): The number of channels of the paths that will be sketched.
+
+        depth (int): The depth of the signature to sketch.
+
+        sketch_channels (int): The number of channels of the sketch.
+
+        generator (None or :class:`torch.Generator`, optional): The random number generator to use. Defaults to the
+            global one.
+
+        dtype (:class:`torch.dtype`, optional): The dtype of the signs. Should be the same as that of the paths that
+            will be sketched. Defaults to :attr:`torch.float`.
+
+    Returns:
+        A tuple of two :class:`torch.Tensor`\\ s, both of shape :math:`(\\text{depth}, \\text{channels})`. The first
+        is of dtype :attr:`torch.int64`, with values in the range :math:`[0, \\text{sketch_channels})`. The second is of
+        dtype :attr:`dtype`, with values :math:`\\pm 1`.
+    """
+    if generator is None:
+        hashes = torch.randint(0, sketch_channels, (depth, channels), dtype=torch.int64)
+        signs = torch.randint(0, 2, (depth, channels), dtype=dtype)
+    else:
+        hashes = torch.randint(0, sketch_channels, (depth, channels), generator=generator, dtype=torch.int64)
+        signs = torch.randint(0, 2, (depth, channels), generator=generator, dtype=dtype)
+    return hashes, 2 * signs - 1
+
+
+def signature_sketch(path, hashes, signs, sketch_channels, basepoint=False):
+    # type: (torch.Tensor, torch.Tensor, torch.Tensor, int, Union[bool, torch.Tensor]) -> torch.Tensor
+    r"""Computes a random projection of the signature transform, of a fixed size independent of the depth, without ever
+    computing the signature itself.
+
+    Each level :math:`k` of the signature is projected down to :math:`D = \text{sketch_channels}` channels with a
+    `TensorSketch <https://doi.org/10.1145/2487575.2487591>`__: each position :math:`j` of the tensor product
+    :math:`(\mathbb{R}^C)^{\otimes k}` is hashed by a CountSketch, with hash :math:`h_j \colon \{0, \ldots, C - 1\}
+    \to \{0, \ldots, D - 1\}` and sign :math:`s_j \colon \{0, \ldots, C - 1\} \to \{-1, 1\}`, so that the basis
+    element :math:`e_{i_1} \otimes \cdots \otimes e_{i_k}` is mapped to
+    :math:`s_1(i_1) \cdots s_k(i_k) e_{(h_1(i_1) + \cdots + h_k(i_k)) \bmod D}`. The projections of every level are
+    then summed. Inner products between sketches are unbiased estimates of inner products between signatures.
+
+    The sketch is updated directly as the path is traversed, so the cost of each step is just
+    :math:`\mathcal{O}(\text{depth}^2 C D)`, rather than the :math:`\mathcal{O}(C^\text{depth})` of the signature.
+
+    Only supported on the CPU.
+
+    See also :class:`signatory.SignatureSketch`, which generates and keeps track of :attr:`hashes` and :attr:`signs`.
+
+    Arguments:
+        path (:class:`torch.Tensor`): As :func:`signatory.signature`.
+
+        hashes (:class:`torch.Tensor`): The hashes :math:`h_j`, as an int64 tensor of shape
+            :math:`(\text{depth}, C)`. This also determines the depth of the signature being sketched. See
+            :func:`signatory.sketch_hashes`.
+
+        signs (:class:`torch.Tensor`): The signs :math:`s_j`, as a tensor of shape :math:`(\text{depth}, C)`, of the
+            same dtype as :attr:`path`. See :func:`signatory.sketch_hashes`.
+
+        sketch_channels (int): The number of channels :math:`D` of the sketch.
+
+        basepoint (bool or :class:`torch.Tensor`, optional): As :func:`signatory.signature`.
+
+    Returns:
+        A :class:`torch.Tensor` of shape :math:`(N, D)`.
+    """
+    # transpose to go from Python convention of (batch, stream, channel) to autograd/C++ convention of
+    # (stream, batch, channel)
+    # noinspection PyUnresolvedReferences
+    return _SignatureSketchFunction.apply(path.transpose(0, 1), hashes, signs, sketch_channels, basepoint)
+
+
+class SignatureSketch(nn.Module):
+    """:class:`torch.nn.Module` wrapper around the :func:`signatory.signature_sketch` function, which generates the
+    random hashes and signs once, when it is created, and uses the same ones every time it is called.
+
+    Arguments:
+        channels (int): The number of channels of the paths that will be sketched.
+
+        depth (int): The depth of the signature to sketch.
+
+        sketch_channels (int): as :func:`signatory.signature_sketch`.
+
+        generator (None or :class:`torch.Generator`, optional): as :func:`signatory.sketch_hashes`.
+    """
+
+    def __init__(self, channels, depth, sketch_channels, generator=None, **kwargs):
+        # type: (int, int, int, Optional[torch.Generator], **Any) -> None
+        super(SignatureSketch, self).__init__(**kwargs)
+        self.channels = channels
+        self.depth = depth
+        self.sketch_channels = sketch_channels
+        hashes, signs = sketch_hashes(channels, depth, sketch_channels, generator)
+        self.register_buffer('hashes', hashes)
+        self.register_buffer('signs', signs)
+
+    def forward(self, path, basepoint=False):
+        # type: (torch.Tensor, Union[bool, torch.Tensor]) -> torch.Tensor
+        """The forward operation.
+
+        Arguments:
+            path (:class:`torch.Tensor`): As :func:`signatory.signature_sketch`.
+
+            basepoint (bool or :class:`torch.Tensor`, optional): As :func:`signatory.signature_sketch`.
+
+        Returns:
+            As :func:`signatory.signature_sketch`.
+        """
+        return signature_sketch(path, self.hashes, self.signs.to(path.dtype), self.sketch_channels, basepoint)
+
+    def extra_repr(self):
+        return ('channels={channels}, depth={depth}, sketch_channels={sketch_channels}'
+                .format(channels=self.channels, depth=self.depth, sketch_channels=self.sketch_channels))
@@ -0,0 +1,182 @@
+# Copyright 2019 Patrick Kidger. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# =========================================================================
+"""Provides operations in the tensor algebra."""
+
+
+from torch import autograd
+from torch.autograd import function as autograd_function
+
+from . import impl
+from . import signature_module as smodule
+
+# noinspection PyUnreachableCode
+if False:
+    import torch
+
+
+# All of the C++ operations work on tensors of shape (batch, signature_channels). We additionally allow any number of
+# leading dimensions, by flattening them into a single batch dimension.
+def _flatten(tensor):
+    return tensor.reshape(-1, tensor.size(-1))
+
+
+class _TensorAlgebraExpFunction(autograd.Function):
+    @staticmethod
+    def forward(ctx, tensor, input_channels, depth):
+        ctx.save_for_backward(tensor)
+        ctx.input_channels = input_channels
+        ctx.depth = depth
+        return impl.tensor_algebra_exp_forward(tensor, input_channels, depth)
+
+    @staticmethod
+    @autograd_function.once_differentiable  # Our backward function uses in-place operations for memory efficiency
+    def backward(ctx, grad):
+        tensor, = ctx.saved_tensors
+        return impl.tensor_algebra_exp_backward(grad, tensor, ctx.input_channels, ctx.depth), None, None
+
+
+class _TensorAlgebraLogFunction(autograd.Function):
+    @staticmethod
+    def forward(ctx, tensor, input_channels, depth):
+        ctx.save_for_backward(tensor)
+        ctx.input_channels = input_channels
+        ctx.depth = depth
+        return impl.tensor_algebra_log_forward(tensor, input_channels, depth)
+
+    @staticmethod
+    @autograd_function.once_differentiable  # Our backward function uses in-place operations for memory efficiency
+    def backward(ctx, grad):
+        tensor, = ctx.saved_tensors
+        return impl.tensor_algebra_log_backward(grad, tensor, ctx.input_channels, ctx.depth), None, None
+
+
+class _TensorAlgebraAntipodeFunction(autograd.Function):
+    @staticmethod
+    def forward(ctx, tensor, input_channels, depth):
+        ctx.input_channels = input_channels
+        ctx.depth = depth
+        return impl.tensor_algebra_antipode(tensor, input_channels, depth)
+
+    @staticmethod
+    def backward(ctx, grad):
+        # The antipode is linear and self-adjoint
+        return _TensorAlgebraAntipodeFunction.apply(grad, ctx.input_channels, ctx.depth), None, None
+
+
+def ta_mult(tensor1, tensor2, input_channels, depth):
+    # type: (torch.Tensor, torch.Tensor, int, int) -> torch.Tensor
+    r"""Multiplies two members of the tensor algebra.
+
+    Members of the tensor algebra are represented in the same way as signatures: as tensors with
+    :math:`C + C^2 + \cdots + C^d` channels, with an implicit scalar term of one. That is, a tensor :code:`x`
+    represents the member :math:`1 + x` of the (truncated) tensor algebra.
+
+    This is the same operation as :func:`signatory.signature_combine`, except that any number of leading (batch)
+    dimensions are allowed.
+
+    Arguments:
+        tensor1 (:class:`torch.Tensor`): The first member of the tensor algebra, of shape
+            :code:`(..., signature_channels(input_channels, depth))`.
+
+        tensor2 (:class:`torch.Tensor`): The second member of the tensor algebra, of the same shape as
+            :attr:`tensor1`.
+
+        input_channels (int): The size :math:`C` of the underlying vector space.
+
+        depth (int): The depth :math:`d` that the tensor algebra is truncated to.
+
+    Returns:
+        A :class:`torch.Tensor` of the same shape as :attr:`tensor1`, representing :math:`(1 + \text{tensor1}) \otimes
+        (1 + \text{tensor2})`, with the scalar term of one again left implicit.
+    """
+    if tensor1.shape != tensor2.shape:
+        raise ValueError("Arguments 'tensor1' and 'tensor2' must have the same shape.")
+    result = smodule.multi_signature_combine([_flatten(tensor1), _flatten(tensor2)], input_channels, depth)
+    return result.reshape(tensor1.shape)
+
+
+def ta_exp(tensor, input_channels, depth):
+    # type: (torch.Tensor, int, int) -> torch.Tensor
+    r"""Computes the exponential of a member of the tensor algebra.
+
+    This is the general exponential, so :attr:`tensor` may have nonzero coefficients at every depth, not just the
+    lowest one.
+
+    Arguments:
+        tensor (:class:`torch.Tensor`): A member :math:`x` of the tensor algebra with scalar term zero, of shape
+            :code:`(..., signature_channels(input_channels, depth))`.
+
+        input_channels (int): As :func:`signatory.ta_mult`.
+
+        depth (int): As :func:`signatory.ta_mult`.
+
+    Returns:
+        A :class:`torch.Tensor` of the same shape as :attr:`tensor`, representing :math:`\exp(x)`, with its scalar term
+        of one left implicit as with :func:`signatory.ta_mult`.
+    """
+    result = _TensorAlgebraExpFunction.apply(_flatten(tensor), input_channels, depth)
+    return result.reshape(tensor.shape)
+
+
+def ta_log(tensor, input_channels, depth):
+    # type: (torch.Tensor, int, int) -> torch.Tensor
+    r"""Computes the logarithm of a member of the tensor algebra.
+
+    This is the inverse of :func:`signatory.ta_exp`. When applied to a signature, this is the same as
+    :func:`signatory.signature_to_logsignature` with :code:`mode="expand"`.
+
+    Arguments:
+        tensor (:class:`torch.Tensor`): A member :math:`1 + x` of the tensor algebra, with its scalar term of one left
+            implicit as with :func:`signatory.ta_mult`. Should be of shape
+            :code:`(..., signature_channels(input_channels, depth))`.
+
+        input_channels (int): As :func:`signatory.ta_mult`.
+
+        depth (int): As :func:`signatory.ta_mult`.
+
+    Returns:
+        A :class:`torch.Tensor` of the same shape as :attr:`tensor`, representing :math:`\log(1 + x)`, which has scalar
+        term zero.
+    """
+    result = _TensorAlgebraLogFunction.apply(_flatten(tensor), input_channels, depth)
+    return result.reshape(tensor.shape)
+
+
+def ta_antipode(tensor, input_channels, depth):
+    # type: (torch.Tensor, int, int) -> torch.Tensor
+    r"""Computes the antipode of a member of the tensor algebra.
+
+    The antipode reverses every word, and multiplies the coefficient of every word of length :math:`k` by
+    :math:`(-1)^k`. The antipode of the signature of a path is the signature of the reversed path, which is also its
+    inverse in the tensor algebra. In particular
+
+    .. code-block:: python
+
+        signatory.ta_antipode(signatory.signature(path, depth), path.size(-1), depth)
+
+    is equal to :code:`signatory.signature(path, depth, inverse=True)`.
+
+    Arguments:
+        tensor (:class:`torch.Tensor`): A member of the tensor algebra, as :func:`signatory.ta_mult`.
+
+        input_channels (int): As :func:`signatory.ta_mult`.
+
+        depth (int): As :func:`signatory.ta_mult`.
+
+    Returns:
+        A :class:`torch.Tensor` of the same shape as :attr:`tensor`, representing its antipode.
+    """
+    result = _TensorAlgebraAntipodeFunction.apply(_flatten(tensor), input_channels, depth)
+    return result.reshape(tensor.shape)
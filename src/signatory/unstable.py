@@ -17,4 +17,6 @@ everything here is experimental and may change without notice.
 """
 
 
-from .impl import (lyndon_words_to_basis_transform,)
+from .impl import (lyndon_words_to_basis_transform,
+                   lyndon_words_to_basis_transform_tensor)
+from .logsignature_module import logsignature_bch
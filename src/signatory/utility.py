@@ -22,7 +22,8 @@ from . import impl
 
 # noinspection PyUnreachableCode
 if False:
-    from typing import List, Optional, Union
+    from typing import List, Optional, Tuple, Union
+    import torch
     # what we actually want, but can't make sense of in the auto-generated documentation
     # LyndonBracket = Union[int, List['LyndonBracket']]
     LyndonBracket = Union[int, List]
@@ -101,6 +102,65 @@ def all_words(channels, depth):
     return list(generator())
 
 
+def lyndon_words_tensor(channels, depth):
+    # type: (int, int) -> Tuple[torch.Tensor, torch.Tensor]
+    r"""As :func:`signatory.lyndon_words`, except that the words are returned packed into tensors rather than as a list
+    of lists. This is much quicker for large :attr:`channels` or :attr:`depth`, as no Python objects are created for
+    each individual word.
+
+    Arguments:
+        channels (int): The size of the alphabet.
+        depth (int): The maximum word length.
+
+    Returns:
+        A tuple of two :class:`torch.Tensor`\ s, both of dtype :attr:`torch.int64`. The first is of shape
+        :code:`(num_words, depth)`, with each row corresponding to one Lyndon word, padded on the right with
+        :code:`-1`. The second is of shape :code:`(num_words,)`, and gives the length of each word. The words are in
+        the same order as :func:`signatory.lyndon_words`.
+    """
+
+    return impl.lyndon_words_tensor(channels, depth)
+
+
+def lyndon_brackets_tensor(channels, depth):
+    # type: (int, int) -> Tuple[torch.Tensor, torch.Tensor, torch.Tensor]
+    r"""As :func:`signatory.lyndon_brackets`, except that the brackets are returned packed into tensors rather than as
+    nested lists. This is much quicker for large :attr:`channels` or :attr:`depth`, as no Python objects are created
+    for each individual bracket.
+
+    Arguments:
+        channels (int): The size of the alphabet.
+        depth (int): The maximum word length.
+
+    Returns:
+        A tuple of three :class:`torch.Tensor`\ s, all of dtype :attr:`torch.int64`. The first two are the words and
+        their lengths, exactly as returned by :func:`signatory.lyndon_words_tensor`. The third is of shape
+        :code:`(num_words, 2)`, and describes the standard bracketing of each word: its row gives the indices (into the
+        collection of all Lyndon words) of the two halves of the bracket, or :code:`-1` for words of length one.
+    """
+
+    return impl.lyndon_brackets_tensor(channels, depth)
+
+
+def all_words_tensor(channels, depth):
+    # type: (int, int) -> Tuple[torch.Tensor, torch.Tensor]
+    r"""As :func:`signatory.all_words`, except that the words are returned packed into tensors rather than as a list of
+    tuples.
+
+    Arguments:
+        channels (int): The size of the alphabet.
+        depth (int): The maximum word length.
+
+    Returns:
+        A tuple of two :class:`torch.Tensor`\ s, both of dtype :attr:`torch.int64`. The first is of shape
+        :code:`(num_words, depth)`, with each row corresponding to one word, padded on the right with :code:`-1`. The
+        second is of shape :code:`(num_words,)`, and gives the length of each word. The words are in the same order as
+        :func:`signatory.all_words`.
+    """
+
+    return impl.all_words_tensor(channels, depth)
+
+
 def max_parallelism(value=None):
     # type: (Optional[int]) -> int
     """Gets or sets the maximum amount of parallelism used in Signatory's computations. Higher values will typically
@@ -15,10 +15,11 @@
 
 
 #include <torch/extension.h>
-#include <algorithm>  // std::min
+#include <algorithm>  // std::fill, std::max, std::min
 #include <cstdint>    // int64_t
 #include <cmath>      // std::lround
 #include <omp.h>
+#include <stdexcept>  // std::invalid_argument
 #include <tuple>      // std::tie, std::tuple
 #include <vector>     // std::vector
 
@@ -29,6 +30,12 @@
 namespace signatory {
     namespace signature {
         namespace detail {
+            // Below this amount of work (batch size * stream size * signature channels) we don't use parallelism, as
+            // the problem is small.
+            // The magic number 1392640 was chosen as being roughly the point at which the small/large threshold is
+            // crossed. (1392640 = batch size 32 * stream size 128 * signature_channels(channels 4, depth 4))
+            constexpr int64_t parallelism_threshold = 1392640;
+
             // Takes the path and basepoint and returns the path increments
             torch::Tensor compute_path_increments(torch::Tensor path, bool basepoint, torch::Tensor basepoint_value,
                                                   bool inverse) {
@@ -124,22 +131,123 @@ namespace signatory {
                 }
             }
 
+            int64_t augmented_channels(int64_t input_channel_size, bool time_channel, bool lead_lag) {
+                return (lead_lag ? 2 * input_channel_size : input_channel_size) + (time_channel ? 1 : 0);
+            }
+
+            // The augmented path is never materialised, and nor are its increments: each increment of the augmented
+            // path is generated from the increments of the original path just when it is needed, and only the
+            // increments of the original path are saved for the backward pass.
+            // The channels of the augmented path are ordered as (time, lead, lag) if lead_lag, and as (time, original)
+            // otherwise. (With no time channel if time_channel==false.)
+            // Under the lead-lag transform each increment x of the original path becomes the two increments (x, 0) and
+            // (0, x). The time channel increases uniformly from 0 to 1 over the augmented path.
+            int64_t augmented_stream_size(torch::Tensor path_increments, bool lead_lag) {
+                return (lead_lag ? 2 : 1) * path_increments.size(stream_dim);
+            }
+
+            double augmented_time_increment(torch::Tensor path_increments, bool inverse, bool lead_lag) {
+                // The increments have already been negated by compute_path_increments if inverse==true, so we do the
+                // same for the time increments.
+                double time_increment = 1.0 / static_cast<double>(augmented_stream_size(path_increments, lead_lag));
+                return inverse ? -time_increment : time_increment;
+            }
+
+            torch::Tensor make_increment_scratch(torch::Tensor path_increments, int64_t rows, bool time_channel,
+                                                 bool lead_lag) {
+                int64_t channels = 0;
+                if (time_channel || lead_lag) {
+                    channels = augmented_channels(path_increments.size(channel_dim), time_channel, lead_lag);
+                }
+                return torch::empty({rows, channels}, misc::make_opts(path_increments));
+            }
+
+            torch::Tensor augmented_increment(torch::Tensor path_increments, int64_t stream_index, bool inverse,
+                                              bool time_channel, bool lead_lag, torch::Tensor scratch) {
+                if (!time_channel && !lead_lag) {
+                    return path_increments[stream_index];
+                }
+
+                int64_t input_channel_size {path_increments.size(channel_dim)};
+                int64_t time_channel_size {time_channel ? 1 : 0};
+                if (lead_lag) {
+                    int64_t lag {stream_index % 2};
+                    scratch.narrow(/*dim=*/channel_dim,
+                                   /*start=*/time_channel_size + lag * input_channel_size,
+                                   /*len=*/input_channel_size).copy_(path_increments[stream_index / 2]);
+                    scratch.narrow(/*dim=*/channel_dim,
+                                   /*start=*/time_channel_size + (1 - lag) * input_channel_size,
+                                   /*len=*/input_channel_size).zero_();
+                }
+                else {
+                    scratch.narrow(/*dim=*/channel_dim, /*start=*/1,
+                                   /*len=*/input_channel_size).copy_(path_increments[stream_index]);
+                }
+                if (time_channel) {
+                    scratch.narrow(/*dim=*/channel_dim, /*start=*/0, /*len=*/1).fill_(
+                            augmented_time_increment(path_increments, inverse, lead_lag));
+                }
+                return scratch;
+            }
+
+            torch::Tensor grad_augmented_increment(torch::Tensor grad_path_increments, int64_t stream_index,
+                                                   bool time_channel, bool lead_lag, torch::Tensor grad_scratch) {
+                if (!time_channel && !lead_lag) {
+                    return grad_path_increments[stream_index];
+                }
+                return grad_scratch;
+            }
+
+            void augmented_increment_backward(torch::Tensor grad_augmented_increment,
+                                              torch::Tensor grad_path_increments, int64_t stream_index,
+                                              bool time_channel, bool lead_lag) {
+                if (!time_channel && !lead_lag) {
+                    // grad_augmented_increment is already a view into grad_path_increments.
+                    return;
+                }
+
+                int64_t input_channel_size {grad_path_increments.size(channel_dim)};
+                int64_t time_channel_size {time_channel ? 1 : 0};
+                // The time channel is a constant, so no gradient flows through it.
+                if (lead_lag) {
+                    // Both the lead and the lag increments come from the same increment of the original path.
+                    int64_t lag {stream_index % 2};
+                    grad_path_increments[stream_index / 2] += grad_augmented_increment.narrow(
+                                                                /*dim=*/channel_dim,
+                                                                /*start=*/time_channel_size + lag * input_channel_size,
+                                                                /*len=*/input_channel_size);
+                }
+                else {
+                    grad_path_increments[stream_index].copy_(grad_augmented_increment.narrow(
+                                                                /*dim=*/channel_dim,
+                                                                /*start=*/1,
+                                                                /*len=*/input_channel_size));
+                }
+            }
+
             struct bool_wrapper { bool value; };
 
             void signature_forward_inner(torch::Tensor path_increments,
                                          torch::Tensor reciprocals,
                                          std::vector<torch::Tensor> signature_by_term_at_stream,
                                          bool inverse,
+                                         bool time_channel,
+                                         bool lead_lag,
                                          int64_t output_stream_size,
                                          bool stream,
                                          torch::Tensor signature,
                                          const std::vector<torch::Tensor> signature_by_term) {
+                torch::Tensor increment_scratch = make_increment_scratch(path_increments,
+                                                                         path_increments.size(batch_dim),
+                                                                         time_channel,
+                                                                         lead_lag);
                 for (int64_t stream_index = 1; stream_index < output_stream_size; ++stream_index) {
                     if (stream) {
                         signature[stream_index].copy_(signature[stream_index - 1]);
                         misc::slice_at_stream(signature_by_term, signature_by_term_at_stream, stream_index);
                     }
-                    ta_ops::mult_fused_restricted_exp(path_increments[stream_index],
+                    ta_ops::mult_fused_restricted_exp(augmented_increment(path_increments, stream_index, inverse,
+                                                                          time_channel, lead_lag, increment_scratch),
                                                       signature_by_term_at_stream,
                                                       inverse,
                                                       reciprocals);
@@ -151,6 +259,8 @@ namespace signatory {
                                                    torch::Tensor reciprocals,
                                                    std::vector<torch::Tensor> signature_by_term_at_stream,
                                                    bool inverse,
+                                                   bool time_channel,
+                                                   bool lead_lag,
                                                    int64_t batch_size,
                                                    int64_t start,
                                                    int64_t end,
@@ -163,6 +273,13 @@ namespace signatory {
                 auto path_increments_a = path_increments.accessor<scalar_t, 3>();
                 auto reciprocals_a = reciprocals.accessor<scalar_t, 1>();
 
+                // Every thread generates the increments of the augmented path (if any) in its own row of this.
+                torch::Tensor increment_scratch = make_increment_scratch(path_increments, batch_threads, time_channel,
+                                                                         lead_lag);
+                auto increment_scratch_a = increment_scratch.accessor<scalar_t, 2>();
+                auto time_increment = static_cast<scalar_t>(augmented_time_increment(path_increments, inverse,
+                                                                                      lead_lag));
+
                 std::vector<torch::TensorAccessor<scalar_t, 2>> signature_by_term_at_stream_a;
                 signature_by_term_at_stream_a.reserve(signature_by_term_at_stream.size());
                 if (!stream) {  // if stream then we'll handle this inside the stream loop
@@ -189,22 +306,31 @@ namespace signatory {
                                          if(batch_threads > 1) \
                                          num_threads(batch_threads) \
                                          shared(batch_size, path_increments_a, signature_by_term_at_stream_a, inverse, \
-                                                reciprocals_a, stream_index)
+                                                reciprocals_a, stream_index, increment_scratch_a, time_increment, \
+                                                time_channel, lead_lag)
                     for (int64_t batch_index = 0; batch_index < batch_size; ++batch_index) {
                         std::vector<torch::TensorAccessor<scalar_t, 1>> signature_by_term_at_stream_a_at_batch;
                         signature_by_term_at_stream_a_at_batch.reserve(signature_by_term_at_stream_a.size());
                         for (auto elem: signature_by_term_at_stream_a) {
                             signature_by_term_at_stream_a_at_batch.push_back(elem[batch_index]);
                         }
+                        torch::TensorAccessor<scalar_t, 1> next_a = augmented_increment_single_cpu<scalar_t>(
+                                                                            path_increments_a,
+                                                                            stream_index,
+                                                                            batch_index,
+                                                                            time_channel,
+                                                                            lead_lag,
+                                                                            time_increment,
+                                                                            increment_scratch_a[omp_get_thread_num()]);
                         if (inverse) {
                             ta_ops::mult_fused_restricted_exp_single_cpu<scalar_t, /*inverse=*/true>
-                                    (path_increments_a[stream_index][batch_index],
+                                    (next_a,
                                      signature_by_term_at_stream_a_at_batch,
                                      reciprocals_a);
                         }
                         else {
                             ta_ops::mult_fused_restricted_exp_single_cpu<scalar_t, /*inverse=*/false>
-                                    (path_increments_a[stream_index][batch_index],
+                                    (next_a,
                                      signature_by_term_at_stream_a_at_batch,
                                      reciprocals_a);
                         }
@@ -216,6 +342,8 @@ namespace signatory {
                                              torch::Tensor reciprocals,
                                              std::vector<torch::Tensor> signature_by_term_at_stream,
                                              bool inverse,
+                                             bool time_channel,
+                                             bool lead_lag,
                                              int64_t batch_size,
                                              int64_t start,
                                              int64_t end,
@@ -230,6 +358,8 @@ namespace signatory {
                                                                 reciprocals,
                                                                 signature_by_term_at_stream,
                                                                 inverse,
+                                                                time_channel,
+                                                                lead_lag,
                                                                 batch_size,
                                                                 start,
                                                                 end,
@@ -239,11 +369,164 @@ namespace signatory {
                                                                 signature_by_term);
                 }));
             }
+
+            // Checks the indices passed as the 'stream' argument of signatory.signature, and converts them to a list of
+            // (nonnegative, strictly increasing) positions in the stream.
+            std::vector<int64_t> stream_indices(torch::Tensor indices, int64_t output_stream_size) {
+                if (indices.ndimension() != 1 || indices.scalar_type() != torch::kLong || indices.is_cuda()) {
+                    throw std::invalid_argument("Argument 'stream' must be a bool, an integer stride, or a "
+                                                "one-dimensional collection of integer indices.");
+                }
+                if (indices.size(0) == 0) {
+                    throw std::invalid_argument("Argument 'stream' must select at least one position of the stream.");
+                }
+                std::vector<int64_t> out;
+                out.reserve(indices.size(0));
+                auto indices_a = indices.accessor<int64_t, 1>();
+                for (int64_t index = 0; index < indices.size(0); ++index) {
+                    // Negative indices count from the end, as with slicing
+                    int64_t stream_index = indices_a[index];
+                    if (stream_index < 0) {
+                        stream_index += output_stream_size;
+                    }
+                    if (stream_index < 0 || stream_index >= output_stream_size) {
+                        throw std::invalid_argument("Argument 'stream' has an index out of range.");
+                    }
+                    if (!out.empty() && stream_index <= out.back()) {
+                        throw std::invalid_argument("Argument 'stream' must have strictly increasing indices.");
+                    }
+                    out.push_back(stream_index);
+                }
+                return out;
+            }
+
+            // The number of samples whose signatures are held at once by each thread in the backward pass of
+            // expected_signature.
+            constexpr int64_t expected_signature_chunk_size = 64;
+
+            // The number of threads to parallelise the expected signature over, when working on 'work' independent
+            // pieces.
+            int64_t expected_signature_threads(int64_t work) {
+                int64_t num_threads = std::min({static_cast<int64_t>(omp_get_max_threads()), get_max_parallelism(),
+                                                work});
+                return std::max(num_threads, static_cast<int64_t>(1));
+            }
+
+            // Computes the sum of the signatures of every sample in the batch, and accumulates them into
+            // 'partial_sums', of shape (threads, 1, signature_channels), or (threads, stream, signature_channels) if
+            // stream==true. Each thread only ever holds the signature of the sample it's currently working on, rather
+            // than the signatures of the whole batch.
+            template <typename scalar_t>
+            void expected_signature_forward_cpu_inner(torch::Tensor path_increments, torch::Tensor reciprocals,
+                                                      s_size_type depth, bool stream, torch::Tensor partial_sums) {
+                int64_t output_stream_size = path_increments.size(stream_dim);
+                int64_t batch_size = path_increments.size(batch_dim);
+                int64_t input_channel_size = path_increments.size(channel_dim);
+                int64_t output_channel_size = partial_sums.size(-1);
+                int64_t num_threads = partial_sums.size(0);
+
+                auto path_increments_a = path_increments.accessor<scalar_t, 3>();
+                auto reciprocals_a = reciprocals.accessor<scalar_t, 1>();
+                scalar_t* partial_sums_data = partial_sums.data<scalar_t>();
+
+                // The signature of the sample that each thread is currently working on
+                torch::Tensor signature_by_thread = torch::empty({num_threads, output_channel_size},
+                                                                 misc::make_opts(partial_sums));
+                scalar_t* signature_by_thread_data = signature_by_thread.data<scalar_t>();
+                std::vector<std::vector<torch::TensorAccessor<scalar_t, 1>>> signature_by_term_by_thread_a(
+                        num_threads);
+                for (int64_t thread_index = 0; thread_index < num_threads; ++thread_index) {
+                    std::vector<torch::Tensor> signature_by_term;
+                    misc::slice_by_term(signature_by_thread[thread_index], signature_by_term, input_channel_size,
+                                        depth);
+                    for (auto elem : signature_by_term) {
+                        signature_by_term_by_thread_a[thread_index].push_back(elem.accessor<scalar_t, 1>());
+                    }
+                }
+
+                #pragma omp parallel for default(none) \
+                                         if(num_threads > 1) \
+                                         num_threads(num_threads) \
+                                         schedule(static) \
+                                         shared(batch_size, output_stream_size, output_channel_size, stream, \
+                                                path_increments_a, reciprocals_a, partial_sums_data, \
+                                                signature_by_thread_data, signature_by_term_by_thread_a)
+                for (int64_t batch_index = 0; batch_index < batch_size; ++batch_index) {
+                    int64_t thread_index = omp_get_thread_num();
+                    scalar_t* signature_data = signature_by_thread_data + thread_index * output_channel_size;
+                    scalar_t* partial_sum_data = partial_sums_data +
+                                                 thread_index * (stream ? output_stream_size : 1) * output_channel_size;
+
+                    // Multiplying the identity (all of whose nonscalar terms are zero) by exp(x) gives exp(x), so this
+                    // also handles the first increment.
+                    std::fill(signature_data, signature_data + output_channel_size, 0);
+                    for (int64_t stream_index = 0; stream_index < output_stream_size; ++stream_index) {
+                        ta_ops::mult_fused_restricted_exp_single_cpu<scalar_t, /*inverse=*/false>
+                                (path_increments_a[stream_index][batch_index],
+                                 signature_by_term_by_thread_a[thread_index],
+                                 reciprocals_a);
+                        if (stream) {
+                            scalar_t* partial_sum_at_stream = partial_sum_data + stream_index * output_channel_size;
+                            for (int64_t channel_index = 0; channel_index < output_channel_size; ++channel_index) {
+                                partial_sum_at_stream[channel_index] += signature_data[channel_index];
+                            }
+                        }
+                    }
+                    if (!stream) {
+                        for (int64_t channel_index = 0; channel_index < output_channel_size; ++channel_index) {
+                            partial_sum_data[channel_index] += signature_data[channel_index];
+                        }
+                    }
+                }
+            }
+
+            // Computes the gradient through the signatures of the samples of a chunk of the batch, and stores it in
+            // 'grad_path_increments', which should be the corresponding slice of the gradient with respect to the path
+            // increments. 'grad_expected_signature' should already have been divided by the batch size.
+            // This is the same computation as in the stream==false case of signature_backward: the signatures are
+            // recomputed backwards, and if stream==true then the gradients on the expected signatures of the partial
+            // paths are added on along the way.
+            void expected_signature_backward_chunk(torch::Tensor grad_expected_signature,
+                                                   torch::Tensor path_increments, torch::Tensor grad_path_increments,
+                                                   torch::Tensor reciprocals, s_size_type depth, bool stream) {
+                int64_t output_stream_size = path_increments.size(stream_dim);
+                int64_t chunk_size = path_increments.size(batch_dim);
+                int64_t input_channel_size = path_increments.size(channel_dim);
+                int64_t output_channel_size = grad_expected_signature.size(-1);
+                torch::TensorOptions opts = misc::make_opts(path_increments);
+
+                torch::Tensor signature = torch::empty({chunk_size, output_channel_size}, opts);
+                std::vector<torch::Tensor> signature_by_term;
+                misc::slice_by_term(signature, signature_by_term, input_channel_size, depth);
+                ta_ops::restricted_exp(path_increments[0], signature_by_term, reciprocals);
+                for (int64_t stream_index = 1; stream_index < output_stream_size; ++stream_index) {
+                    ta_ops::mult_fused_restricted_exp(path_increments[stream_index], signature_by_term,
+                                                      /*inverse=*/false, reciprocals);
+                }
+
+                torch::Tensor grad_signature = (stream ? grad_expected_signature[-1] : grad_expected_signature)
+                                               .expand({chunk_size, output_channel_size}).clone();
+                std::vector<torch::Tensor> grad_signature_by_term;
+                misc::slice_by_term(grad_signature, grad_signature_by_term, input_channel_size, depth);
+
+                for (int64_t stream_index = output_stream_size - 1; stream_index >= 1; --stream_index) {
+                    torch::Tensor next = path_increments[stream_index];
+                    ta_ops::mult_fused_restricted_exp(-next, signature_by_term, /*inverse=*/false, reciprocals);
+                    ta_ops::mult_fused_restricted_exp_backward(grad_path_increments[stream_index],
+                                                               grad_signature_by_term, next, signature_by_term,
+                                                               /*inverse=*/false, reciprocals);
+                    if (stream) {
+                        grad_signature += grad_expected_signature[stream_index - 1];
+                    }
+                }
+                ta_ops::restricted_exp_backward(grad_path_increments[0], grad_signature_by_term, path_increments[0],
+                                                signature_by_term, reciprocals);
+            }
         }  // namespace signatory::signature::detail
     }  // namespace signatory::signature
 
     void signature_checkargs(torch::Tensor path, s_size_type depth, bool basepoint, torch::Tensor basepoint_value,
-                             bool initial, torch::Tensor initial_value) {
+                             bool initial, torch::Tensor initial_value, bool time_channel, bool lead_lag) {
         if (path.ndimension() == 2) {
             // Friendlier help message for a common mess-up.
             throw std::invalid_argument("Argument 'path' must be a 3-dimensional tensor, with dimensions "
@@ -290,7 +573,9 @@ namespace signatory {
                 throw std::invalid_argument("Argument 'initial' must be a 2-dimensional tensor, corresponding to "
                                             "(batch, signature_channels) respectively.");
             }
-            if (initial_value.size(channel_dim) != signature_channels(path.size(channel_dim), depth) ||
+            int64_t input_channel_size = signature::detail::augmented_channels(path.size(channel_dim), time_channel,
+                                                                               lead_lag);
+            if (initial_value.size(channel_dim) != signature_channels(input_channel_size, depth) ||
                 initial_value.size(batch_dim) != path.size(batch_dim)) {
                 throw std::invalid_argument("Argument 'initial' must have correctly sized batch and channel "
                                             "dimensions.");
@@ -303,8 +588,8 @@ namespace signatory {
 
     std::tuple<torch::Tensor, torch::Tensor>
     signature_forward(torch::Tensor path, s_size_type depth, bool stream, bool basepoint, torch::Tensor basepoint_value,
-                      bool inverse, bool initial, torch::Tensor initial_value) {
-        signature_checkargs(path, depth, basepoint, basepoint_value, initial, initial_value);
+                      bool inverse, bool initial, torch::Tensor initial_value, bool time_channel, bool lead_lag) {
+        signature_checkargs(path, depth, basepoint, basepoint_value, initial, initial_value, time_channel, lead_lag);
 
         // No sense keeping track of gradients when we have a dedicated backwards function (and in-place operations mean
         // that in any case one cannot autograd through this function)
@@ -312,19 +597,23 @@ namespace signatory {
         basepoint_value = basepoint_value.detach();
         initial_value = initial_value.detach();
 
+        // Compute path increments. Obviously.
+        // (If time_channel or lead_lag is set then these are still the increments of the original path; the increments
+        // of the augmented path are generated from them one at a time, as they are needed.)
+        torch::Tensor path_increments = signature::detail::compute_path_increments(path, basepoint, basepoint_value,
+                                                                                   inverse);
+
         // Some constants to pass around
+        // (These describe the augmented path if time_channel or lead_lag is set.)
         int64_t batch_size = path.size(batch_dim);
         int64_t input_stream_size = path.size(stream_dim);
-        int64_t input_channel_size = path.size(channel_dim);
-        int64_t output_stream_size = path.size(stream_dim) - (basepoint ? 0 : 1);
+        int64_t input_channel_size = signature::detail::augmented_channels(path_increments.size(channel_dim),
+                                                                           time_channel, lead_lag);
+        int64_t output_stream_size = signature::detail::augmented_stream_size(path_increments, lead_lag);
         int64_t output_channel_size = signature_channels(input_channel_size, depth);
         torch::TensorOptions opts = misc::make_opts(path);
         torch::Tensor reciprocals = misc::make_reciprocals(depth, opts);
 
-        // Compute path increments. Obviously.
-        torch::Tensor path_increments = signature::detail::compute_path_increments(path, basepoint, basepoint_value,
-                                                                                   inverse);
-
         // Allocate memory for the computation.
         torch::Tensor first_term;
         torch::Tensor signature;
@@ -343,15 +632,19 @@ namespace signatory {
         misc::slice_by_term(first_term, signature_by_term_at_stream, input_channel_size, depth);
 
         // Compute the first term.
+        torch::Tensor first_increment = signature::detail::augmented_increment(
+                                            path_increments, 0, inverse, time_channel, lead_lag,
+                                            signature::detail::make_increment_scratch(path_increments, batch_size,
+                                                                                      time_channel, lead_lag));
         if (initial) {
             first_term.copy_(initial_value);
-            ta_ops::mult_fused_restricted_exp(path_increments[0],
+            ta_ops::mult_fused_restricted_exp(first_increment,
                                               signature_by_term_at_stream,
                                               inverse,
                                               reciprocals);
         }
         else {
-            ta_ops::restricted_exp(path_increments[0],
+            ta_ops::restricted_exp(first_increment,
                                    signature_by_term_at_stream,
                                    reciprocals);
         }
@@ -361,8 +654,8 @@ namespace signatory {
             // First of all, we don't/haven't tried writing custom GPU code. But if we did it would go here. Instead we
             // call a function specified in terms of the higher-level PyTorch Tensors.
             signature::detail::signature_forward_inner(path_increments, reciprocals, signature_by_term_at_stream,
-                                                       inverse, output_stream_size, stream, signature,
-                                                       signature_by_term);
+                                                       inverse, time_channel, lead_lag, output_stream_size, stream,
+                                                       signature, signature_by_term);
         }
         else {
             // If we're here then we're on the CPU.
@@ -370,10 +663,8 @@ namespace signatory {
 
             int64_t stream_threads;
             int64_t batch_threads;
-            if (batch_size * output_stream_size * output_channel_size < 1392640) {
+            if (batch_size * output_stream_size * output_channel_size < signature::detail::parallelism_threshold) {
                 // Don't use parallelism if the problem is small.
-                // The magic number 1392640 was chosen as being roughly the point at which the small/large threshold is
-                // crossed. (1392640 = batch size 32 * stream size 128 * signature_channels(channels 4, depth 4))
                 stream_threads = 1;
                 batch_threads = 1;
             }
@@ -399,8 +690,9 @@ namespace signatory {
                 // It's not that the OpenMP code below will be wrong with just one thread, but it will be needlessly
                 // inefficient, as it allocates extra memory.
                 signature::detail::signature_forward_inner_cpu(path_increments, reciprocals,
-                                                               signature_by_term_at_stream, inverse,
-                                                               batch_size, /*start=*/1, /*end=*/output_stream_size,
+                                                               signature_by_term_at_stream, inverse, time_channel,
+                                                               lead_lag, batch_size, /*start=*/1,
+                                                               /*end=*/output_stream_size,
                                                                batch_threads, stream, signature, signature_by_term);
             }
             else {
@@ -416,7 +708,7 @@ namespace signatory {
                                  num_threads(stream_threads) \
                                  shared(omp_results, omp_used, path_increments, inverse, reciprocals, \
                                         output_stream_size, batch_size, output_channel_size, input_channel_size, \
-                                        depth, opts, batch_threads)
+                                        depth, opts, batch_threads, time_channel, lead_lag)
                 {
                     // Split up the stream dimension into chunks
                     int64_t start = 1 + ((output_stream_size - 1) * omp_get_thread_num()) / omp_get_num_threads();
@@ -426,12 +718,20 @@ namespace signatory {
                         torch::Tensor omp_signature = torch::empty({batch_size, output_channel_size}, opts);
                         std::vector<torch::Tensor> omp_signature_by_term_at_stream;
                         misc::slice_by_term(omp_signature, omp_signature_by_term_at_stream, input_channel_size, depth);
-                        ta_ops::restricted_exp(path_increments[start], omp_signature_by_term_at_stream, reciprocals);
+                        torch::Tensor start_increment = signature::detail::augmented_increment(
+                                                            path_increments, start, inverse, time_channel, lead_lag,
+                                                            signature::detail::make_increment_scratch(path_increments,
+                                                                                                      batch_size,
+                                                                                                      time_channel,
+                                                                                                      lead_lag));
+                        ta_ops::restricted_exp(start_increment, omp_signature_by_term_at_stream, reciprocals);
 
                         signature::detail::signature_forward_inner_cpu(path_increments,
                                                                        reciprocals,
                                                                        omp_signature_by_term_at_stream,
                                                                        inverse,
+                                                                       time_channel,
+                                                                       lead_lag,
                                                                        batch_size,
                                                                        /*start=*/start + 1,
                                                                        /*end=*/end,
@@ -463,15 +763,19 @@ namespace signatory {
 
     std::tuple<torch::Tensor, torch::Tensor, torch::Tensor>
     signature_backward(torch::Tensor grad_signature, torch::Tensor signature, torch::Tensor path_increments,
-                       s_size_type depth, bool stream, bool basepoint, bool inverse, bool initial) {
+                       s_size_type depth, bool stream, bool basepoint, bool inverse, bool initial, bool time_channel,
+                       bool lead_lag) {
         grad_signature = grad_signature.detach();
         signature = signature.detach();
         path_increments = path_increments.detach();
 
         torch::TensorOptions opts = misc::make_opts(signature);
         torch::Tensor reciprocals = misc::make_reciprocals(depth, opts);
-        int64_t output_stream_size = path_increments.size(stream_dim);
-        int64_t input_channel_size = path_increments.size(channel_dim);
+        // 'path_increments' are the increments of the original path; these describe the augmented path.
+        int64_t batch_size = path_increments.size(batch_dim);
+        int64_t output_stream_size = signature::detail::augmented_stream_size(path_increments, lead_lag);
+        int64_t input_channel_size = signature::detail::augmented_channels(path_increments.size(channel_dim),
+                                                                           time_channel, lead_lag);
 
         std::vector<torch::Tensor> signature_by_term;
         misc::slice_by_term(signature, signature_by_term, input_channel_size, depth);
@@ -523,11 +827,22 @@ namespace signatory {
             misc::slice_by_term(signature.clone(), signature_by_term_at_stream, input_channel_size, depth);
         }
 
-        torch::Tensor grad_path_increments = torch::empty_like(path_increments);
+        // Each lead-lag increment of the original path receives gradients from two increments of the augmented path, so
+        // these have to be accumulated.
+        torch::Tensor grad_path_increments = lead_lag ? torch::zeros_like(path_increments)
+                                                      : torch::empty_like(path_increments);
+        // The increments of the augmented path, and the gradients with respect to them, are generated one at a time in
+        // here.
+        torch::Tensor increment_scratch = signature::detail::make_increment_scratch(path_increments, batch_size,
+                                                                                    time_channel, lead_lag);
+        torch::Tensor grad_increment_scratch = torch::empty_like(increment_scratch);
 
         for (int64_t stream_index = output_stream_size - 1; stream_index >= 1; --stream_index) {
-            torch::Tensor grad_next = grad_path_increments[stream_index];
-            torch::Tensor next = path_increments[stream_index];
+            torch::Tensor grad_next = signature::detail::grad_augmented_increment(grad_path_increments, stream_index,
+                                                                                  time_channel, lead_lag,
+                                                                                  grad_increment_scratch);
+            torch::Tensor next = signature::detail::augmented_increment(path_increments, stream_index, inverse,
+                                                                        time_channel, lead_lag, increment_scratch);
 
             if (stream) {
                 // Just look up signature_by_term_at_stream because we saved it for output
@@ -540,6 +855,8 @@ namespace signatory {
 
             ta_ops::mult_fused_restricted_exp_backward(grad_next, grad_signature_by_term_at_stream, next,
                                                        signature_by_term_at_stream, inverse, reciprocals);
+            signature::detail::augmented_increment_backward(grad_next, grad_path_increments, stream_index,
+                                                            time_channel, lead_lag);
 
             if (stream) {
                 // If stream then gradients may well have accumulated on the signatures of the partial paths, so
@@ -548,8 +865,10 @@ namespace signatory {
             }
         }
 
-        torch::Tensor grad_next = grad_path_increments[0];
-        torch::Tensor next = path_increments[0];
+        torch::Tensor grad_next = signature::detail::grad_augmented_increment(grad_path_increments, 0, time_channel,
+                                                                              lead_lag, grad_increment_scratch);
+        torch::Tensor next = signature::detail::augmented_increment(path_increments, 0, inverse, time_channel,
+                                                                    lead_lag, increment_scratch);
         if (initial) {
             if (stream) {
                 // We're using memory we own if stream==false, but we're using memory we don't own if stream==true. So
@@ -569,6 +888,7 @@ namespace signatory {
             ta_ops::restricted_exp_backward(grad_next, grad_signature_by_term_at_stream, next,
                                             signature_by_term_at_stream, reciprocals);
         }
+        signature::detail::augmented_increment_backward(grad_next, grad_path_increments, 0, time_channel, lead_lag);
 
         // Find the gradient on the path from the gradient on the path increments.
         torch::Tensor grad_path;
@@ -582,4 +902,244 @@ namespace signatory {
         return std::tuple<torch::Tensor, torch::Tensor, torch::Tensor>
                {grad_path, grad_basepoint_value, grad_signature_at_stream};
     }
+
+    std::tuple<torch::Tensor, torch::Tensor, torch::Tensor>
+    signature_indices_forward(torch::Tensor path, s_size_type depth, torch::Tensor indices, bool basepoint,
+                              torch::Tensor basepoint_value, bool inverse, bool initial, torch::Tensor initial_value,
+                              bool time_channel, bool lead_lag) {
+        signature_checkargs(path, depth, basepoint, basepoint_value, initial, initial_value, time_channel, lead_lag);
+
+        path = path.detach();
+        basepoint_value = basepoint_value.detach();
+        initial_value = initial_value.detach();
+
+        // As in signature_forward, the increments of the augmented path are generated one at a time from these.
+        torch::Tensor path_increments = signature::detail::compute_path_increments(path, basepoint, basepoint_value,
+                                                                                   inverse);
+
+        int64_t batch_size = path_increments.size(batch_dim);
+        int64_t input_channel_size = signature::detail::augmented_channels(path_increments.size(channel_dim),
+                                                                           time_channel, lead_lag);
+        int64_t output_stream_size = signature::detail::augmented_stream_size(path_increments, lead_lag);
+        int64_t output_channel_size = signature_channels(input_channel_size, depth);
+        std::vector<int64_t> stream_indices = signature::detail::stream_indices(indices, output_stream_size);
+        torch::TensorOptions opts = misc::make_opts(path);
+        torch::Tensor reciprocals = misc::make_reciprocals(depth, opts);
+
+        // We step through every increment, but only write out the signature at the requested indices. We always
+        // finish at the end of the path, as the signature of the whole path is needed in the backward pass.
+        torch::Tensor signature_at_indices = torch::empty({static_cast<int64_t>(stream_indices.size()), batch_size,
+                                                           output_channel_size}, opts);
+        torch::Tensor signature = torch::empty({batch_size, output_channel_size}, opts);
+        std::vector<torch::Tensor> signature_by_term;
+        misc::slice_by_term(signature, signature_by_term, input_channel_size, depth);
+
+        torch::Tensor increment_scratch = signature::detail::make_increment_scratch(path_increments, batch_size,
+                                                                                    time_channel, lead_lag);
+        torch::Tensor first_increment = signature::detail::augmented_increment(path_increments, 0, inverse,
+                                                                               time_channel, lead_lag,
+                                                                               increment_scratch);
+        if (initial) {
+            signature.copy_(initial_value);
+            ta_ops::mult_fused_restricted_exp(first_increment, signature_by_term, inverse, reciprocals);
+        }
+        else {
+            ta_ops::restricted_exp(first_increment, signature_by_term, reciprocals);
+        }
+
+        int64_t batch_threads = 1;
+        if (batch_size * output_stream_size * output_channel_size >= signature::detail::parallelism_threshold) {
+            batch_threads = std::min({batch_size, static_cast<int64_t>(omp_get_max_threads()),
+                                      get_max_parallelism()});
+        }
+        // Advances the signature so that it is of the path up to and including the increment at 'end - 1'.
+        auto advance = [&] (int64_t start, int64_t end) {
+            if (path.is_cuda()) {
+                for (int64_t stream_index = start; stream_index < end; ++stream_index) {
+                    ta_ops::mult_fused_restricted_exp(signature::detail::augmented_increment(path_increments,
+                                                                                             stream_index,
+                                                                                             inverse,
+                                                                                             time_channel,
+                                                                                             lead_lag,
+                                                                                             increment_scratch),
+                                                      signature_by_term, inverse, reciprocals);
+                }
+            }
+            else {
+                signature::detail::signature_forward_inner_cpu(path_increments, reciprocals, signature_by_term,
+                                                               inverse, time_channel, lead_lag, batch_size, start,
+                                                               end, batch_threads, /*stream=*/false, torch::Tensor{},
+                                                               std::vector<torch::Tensor> {});
+            }
+        };
+
+        int64_t current_index = 0;
+        for (int64_t output_index = 0; output_index < static_cast<int64_t>(stream_indices.size()); ++output_index) {
+            advance(current_index + 1, stream_indices[output_index] + 1);
+            current_index = stream_indices[output_index];
+            signature_at_indices[output_index].copy_(signature);
+        }
+        advance(current_index + 1, output_stream_size);
+
+        return std::tuple<torch::Tensor, torch::Tensor, torch::Tensor> {signature_at_indices, signature,
+                                                                        path_increments};
+    }
+
+    std::tuple<torch::Tensor, torch::Tensor, torch::Tensor>
+    signature_indices_backward(torch::Tensor grad_signature_at_indices, torch::Tensor signature,
+                               torch::Tensor path_increments, torch::Tensor indices, s_size_type depth, bool basepoint,
+                               bool inverse, bool initial, bool time_channel, bool lead_lag) {
+        grad_signature_at_indices = grad_signature_at_indices.detach();
+        signature = signature.detach();
+        path_increments = path_increments.detach();
+
+        torch::TensorOptions opts = misc::make_opts(signature);
+        torch::Tensor reciprocals = misc::make_reciprocals(depth, opts);
+        int64_t batch_size = path_increments.size(batch_dim);
+        int64_t output_stream_size = signature::detail::augmented_stream_size(path_increments, lead_lag);
+        int64_t input_channel_size = signature::detail::augmented_channels(path_increments.size(channel_dim),
+                                                                           time_channel, lead_lag);
+        std::vector<int64_t> stream_indices = signature::detail::stream_indices(indices, output_stream_size);
+
+        // This is the same as the stream==false case of signature_backward: we recompute the signature backwards,
+        // except that we also add on the gradients at the requested indices as we pass them.
+        std::vector<torch::Tensor> signature_by_term;
+        misc::slice_by_term(signature.clone(), signature_by_term, input_channel_size, depth);
+        torch::Tensor grad_signature = torch::zeros_like(signature);
+        std::vector<torch::Tensor> grad_signature_by_term;
+        misc::slice_by_term(grad_signature, grad_signature_by_term, input_channel_size, depth);
+
+        int64_t output_index = static_cast<int64_t>(stream_indices.size()) - 1;
+        auto add_grad_at = [&] (int64_t stream_index) {
+            if (output_index >= 0 && stream_indices[output_index] == stream_index) {
+                grad_signature += grad_signature_at_indices[output_index];
+                --output_index;
+            }
+        };
+
+        // As in signature_backward, the increments of the augmented path are regenerated one at a time.
+        torch::Tensor grad_path_increments = lead_lag ? torch::zeros_like(path_increments)
+                                                      : torch::empty_like(path_increments);
+        torch::Tensor increment_scratch = signature::detail::make_increment_scratch(path_increments, batch_size,
+                                                                                    time_channel, lead_lag);
+        torch::Tensor grad_increment_scratch = torch::empty_like(increment_scratch);
+
+        add_grad_at(output_stream_size - 1);
+        for (int64_t stream_index = output_stream_size - 1; stream_index >= 1; --stream_index) {
+            torch::Tensor grad_next = signature::detail::grad_augmented_increment(grad_path_increments, stream_index,
+                                                                                  time_channel, lead_lag,
+                                                                                  grad_increment_scratch);
+            torch::Tensor next = signature::detail::augmented_increment(path_increments, stream_index, inverse,
+                                                                        time_channel, lead_lag, increment_scratch);
+            ta_ops::mult_fused_restricted_exp(-next, signature_by_term, inverse, reciprocals);
+            ta_ops::mult_fused_restricted_exp_backward(grad_next, grad_signature_by_term, next, signature_by_term,
+                                                       inverse, reciprocals);
+            signature::detail::augmented_increment_backward(grad_next, grad_path_increments, stream_index,
+                                                            time_channel, lead_lag);
+            add_grad_at(stream_index - 1);
+        }
+
+        torch::Tensor grad_next = signature::detail::grad_augmented_increment(grad_path_increments, 0, time_channel,
+                                                                              lead_lag, grad_increment_scratch);
+        torch::Tensor next = signature::detail::augmented_increment(path_increments, 0, inverse, time_channel,
+                                                                    lead_lag, increment_scratch);
+        if (initial) {
+            // Recover initial_value in signature_by_term
+            ta_ops::mult_fused_restricted_exp(-next, signature_by_term, inverse, reciprocals);
+            // grad_signature_by_term is using the same memory as grad_signature, which represents the gradient through
+            // initial_value.
+            ta_ops::mult_fused_restricted_exp_backward(grad_next, grad_signature_by_term, next, signature_by_term,
+                                                       inverse, reciprocals);
+        }
+        else {
+            ta_ops::restricted_exp_backward(grad_next, grad_signature_by_term, next, signature_by_term, reciprocals);
+        }
+        signature::detail::augmented_increment_backward(grad_next, grad_path_increments, 0, time_channel, lead_lag);
+
+        torch::Tensor grad_path;
+        torch::Tensor grad_basepoint_value;
+        std::tie(grad_path, grad_basepoint_value) = signature::detail::compute_path_increments_backward(
+                                                                                                   grad_path_increments,
+                                                                                                   basepoint,
+                                                                                                   inverse,
+                                                                                                   opts);
+
+        return std::tuple<torch::Tensor, torch::Tensor, torch::Tensor> {grad_path, grad_basepoint_value,
+                                                                        grad_signature};
+    }
+
+    torch::Tensor expected_signature_forward(torch::Tensor path, s_size_type depth, bool stream, bool basepoint,
+                                             torch::Tensor basepoint_value) {
+        signature_checkargs(path, depth, basepoint, basepoint_value, /*initial=*/false, torch::Tensor{},
+                            /*time_channel=*/false, /*lead_lag=*/false);
+        if (path.is_cuda()) {
+            throw std::invalid_argument("expected_signature is only supported on the CPU.");
+        }
+
+        path = path.detach();
+        basepoint_value = basepoint_value.detach();
+
+        torch::Tensor path_increments = signature::detail::compute_path_increments(path, basepoint, basepoint_value,
+                                                                                   /*inverse=*/false);
+        int64_t batch_size = path_increments.size(batch_dim);
+        int64_t input_channel_size = path_increments.size(channel_dim);
+        int64_t output_stream_size = path_increments.size(stream_dim);
+        int64_t output_channel_size = signature_channels(input_channel_size, depth);
+        torch::TensorOptions opts = misc::make_opts(path);
+        torch::Tensor reciprocals = misc::make_reciprocals(depth, opts);
+
+        // Every thread sums the signatures of its share of the batch; these partial sums are then combined at the end.
+        int64_t num_threads = signature::detail::expected_signature_threads(batch_size);
+        torch::Tensor partial_sums = torch::zeros({num_threads, stream ? output_stream_size : 1, output_channel_size},
+                                                  opts);
+        AT_DISPATCH_FLOATING_TYPES(path.type(), "expected_signature_forward", ([&] {
+            signature::detail::expected_signature_forward_cpu_inner<scalar_t>(path_increments, reciprocals, depth,
+                                                                              stream, partial_sums);
+        }));
+
+        torch::Tensor expected_signature = partial_sums.sum(0) / batch_size;
+        if (!stream) {
+            expected_signature = expected_signature.squeeze(0);
+        }
+        return expected_signature;
+    }
+
+    std::tuple<torch::Tensor, torch::Tensor>
+    expected_signature_backward(torch::Tensor grad_expected_signature, torch::Tensor path, s_size_type depth,
+                                bool stream, bool basepoint, torch::Tensor basepoint_value) {
+        path = path.detach();
+        basepoint_value = basepoint_value.detach();
+
+        torch::Tensor path_increments = signature::detail::compute_path_increments(path, basepoint, basepoint_value,
+                                                                                   /*inverse=*/false);
+        int64_t batch_size = path_increments.size(batch_dim);
+        torch::TensorOptions opts = misc::make_opts(path);
+        torch::Tensor reciprocals = misc::make_reciprocals(depth, opts);
+        // Every sample contributes equally to the mean
+        grad_expected_signature = grad_expected_signature.detach() / batch_size;
+
+        torch::Tensor grad_path_increments = torch::empty_like(path_increments);
+        // Rather than holding the signatures of the whole batch at once, we handle it in chunks, each of which is a
+        // batch of signatures of its own.
+        int64_t num_chunks = (batch_size + signature::detail::expected_signature_chunk_size - 1) /
+                             signature::detail::expected_signature_chunk_size;
+        int64_t num_threads = signature::detail::expected_signature_threads(num_chunks);
+        #pragma omp parallel for default(none) \
+                                 if(num_threads > 1) \
+                                 num_threads(num_threads) \
+                                 schedule(dynamic, 1) \
+                                 shared(num_chunks, batch_size, grad_expected_signature, path_increments, \
+                                        grad_path_increments, reciprocals, depth, stream)
+        for (int64_t chunk_index = 0; chunk_index < num_chunks; ++chunk_index) {
+            int64_t start = chunk_index * signature::detail::expected_signature_chunk_size;
+            int64_t length = std::min(signature::detail::expected_signature_chunk_size, batch_size - start);
+            signature::detail::expected_signature_backward_chunk(grad_expected_signature,
+                                                                 path_increments.narrow(batch_dim, start, length),
+                                                                 grad_path_increments.narrow(batch_dim, start, length),
+                                                                 reciprocals, depth, stream);
+        }
+
+        return signature::detail::compute_path_increments_backward(grad_path_increments, basepoint,
+                                                                    /*inverse=*/false, opts);
+    }
 }  // namespace signatory
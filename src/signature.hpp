@@ -19,19 +19,107 @@
 #define SIGNATORY_SIGNATURE_HPP
 
 namespace signatory {
+    namespace signature {
+        namespace detail {
+            // Takes the path and basepoint and returns the path increments
+            torch::Tensor compute_path_increments(torch::Tensor path, bool basepoint, torch::Tensor basepoint_value,
+                                                  bool inverse);
+
+            // Computes the backward pass through the path increments operation.
+            // Returns the gradients for the original path, and for the basepoint.
+            std::tuple<torch::Tensor, torch::Tensor>
+            compute_path_increments_backward(torch::Tensor grad_path_increments, bool basepoint, bool inverse,
+                                             torch::TensorOptions opts);
+
+            // The number of channels of the path once it has been augmented with a time channel and/or lead-lag.
+            int64_t augmented_channels(int64_t input_channel_size, bool time_channel, bool lead_lag);
+
+            // The number of increments of the path once it has been augmented with lead-lag, given the increments of
+            // the original path.
+            int64_t augmented_stream_size(torch::Tensor path_increments, bool lead_lag);
+
+            // The increment of the time channel of the augmented path.
+            double augmented_time_increment(torch::Tensor path_increments, bool inverse, bool lead_lag);
+
+            // Allocates the scratch space that augmented_increment (or augmented_increment_single_cpu, with one row
+            // per thread) writes each increment of the augmented path into. It is of shape (rows, channel), and
+            // has no channels if there is no augmentation, as then the increments of the original path are used
+            // directly.
+            torch::Tensor make_increment_scratch(torch::Tensor path_increments, int64_t rows, bool time_channel,
+                                                 bool lead_lag);
+
+            // Takes the path increments, as returned by compute_path_increments, and returns the increment of the
+            // augmented path at 'stream_index'. See signatory.signature.
+            // This is written into 'scratch' (as returned by make_increment_scratch) and returned, so that the
+            // increments of the augmented path are only ever generated one at a time.
+            torch::Tensor augmented_increment(torch::Tensor path_increments, int64_t stream_index, bool inverse,
+                                              bool time_channel, bool lead_lag, torch::Tensor scratch);
+
+            // Returns the tensor that the gradient with respect to augmented_increment(..., stream_index, ...) should
+            // be written into. Once it has been, augmented_increment_backward should be called to propagate it on to
+            // 'grad_path_increments', which should have been zero-initialised if lead_lag==true.
+            torch::Tensor grad_augmented_increment(torch::Tensor grad_path_increments, int64_t stream_index,
+                                                   bool time_channel, bool lead_lag, torch::Tensor grad_scratch);
+
+            // Computes the backward pass through augmented_increment.
+            void augmented_increment_backward(torch::Tensor grad_augmented_increment,
+                                              torch::Tensor grad_path_increments, int64_t stream_index,
+                                              bool time_channel, bool lead_lag);
+
+            // Performs the same computation as augmented_increment, but handles the special case of being on the cpu,
+            // with a particular scalar type, and for a single batch element.
+            template <typename scalar_t>
+            torch::TensorAccessor<scalar_t, 1>
+            augmented_increment_single_cpu(torch::TensorAccessor<scalar_t, 3> path_increments_a, int64_t stream_index,
+                                           int64_t batch_index, bool time_channel, bool lead_lag,
+                                           scalar_t time_increment, torch::TensorAccessor<scalar_t, 1> scratch_a);
+        }  // namespace signatory::signature::detail
+    }  // namespace signatory::signature
+
     // Checks the arguments for the signature_forward function.
     void signature_checkargs(torch::Tensor path, s_size_type depth, bool basepoint, torch::Tensor basepoint_value,
-                             bool initial, torch::Tensor initial_value);
+                             bool initial, torch::Tensor initial_value, bool time_channel, bool lead_lag);
 
     // See signatory.signature for documentation
     std::tuple<torch::Tensor, torch::Tensor>
     signature_forward(torch::Tensor path, s_size_type depth, bool stream, bool basepoint, torch::Tensor basepoint_value,
-                      bool inverse, bool initial, torch::Tensor initial_value);
+                      bool inverse, bool initial, torch::Tensor initial_value, bool time_channel, bool lead_lag);
 
     // See signatory.signature for documentation
     std::tuple<torch::Tensor, torch::Tensor, torch::Tensor>
     signature_backward(torch::Tensor grad_signature, torch::Tensor signature, torch::Tensor path_increments,
-                       s_size_type depth, bool stream, bool basepoint, bool inverse, bool initial);
+                       s_size_type depth, bool stream, bool basepoint, bool inverse, bool initial, bool time_channel,
+                       bool lead_lag);
+
+    // See signatory.signature for documentation; this handles the case that 'stream' is a stride or a collection of
+    // indices, which should be passed as a one-dimensional int64 tensor of strictly increasing positions in the stream.
+    // (Negative positions count from the end.)
+    // Returns the signature at the requested positions, of shape (indices, batch, signature_channels), the signature of
+    // the whole path, and the path increments.
+    std::tuple<torch::Tensor, torch::Tensor, torch::Tensor>
+    signature_indices_forward(torch::Tensor path, s_size_type depth, torch::Tensor indices, bool basepoint,
+                              torch::Tensor basepoint_value, bool inverse, bool initial, torch::Tensor initial_value,
+                              bool time_channel, bool lead_lag);
+
+    // See signatory.signature for documentation
+    // 'signature' should be the signature of the whole path, as returned by signature_indices_forward.
+    std::tuple<torch::Tensor, torch::Tensor, torch::Tensor>
+    signature_indices_backward(torch::Tensor grad_signature_at_indices, torch::Tensor signature,
+                               torch::Tensor path_increments, torch::Tensor indices, s_size_type depth, bool basepoint,
+                               bool inverse, bool initial, bool time_channel, bool lead_lag);
+
+    // See signatory.expected_signature for documentation. Only supported on the CPU.
+    // Returns a tensor of shape (signature_channels), or (stream, signature_channels) if stream==true.
+    torch::Tensor expected_signature_forward(torch::Tensor path, s_size_type depth, bool stream, bool basepoint,
+                                             torch::Tensor basepoint_value);
+
+    // See signatory.expected_signature for documentation
+    // Returns the gradients with respect to the path and the basepoint.
+    std::tuple<torch::Tensor, torch::Tensor>
+    expected_signature_backward(torch::Tensor grad_expected_signature, torch::Tensor path, s_size_type depth,
+                                bool stream, bool basepoint, torch::Tensor basepoint_value);
 }  // namespace signatory
 
+#include "signature.inl"
+
 #endif //SIGNATORY_SIGNATURE_HPP
@@ -0,0 +1,57 @@
+/* Copyright 2019 Patrick Kidger. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ========================================================================= */
+
+#include <torch/extension.h>
+#include <cstdint>    // int64_t
+
+
+namespace signatory {
+    namespace signature {
+        namespace detail {
+            template <typename scalar_t>
+            torch::TensorAccessor<scalar_t, 1>
+            augmented_increment_single_cpu(torch::TensorAccessor<scalar_t, 3> path_increments_a, int64_t stream_index,
+                                           int64_t batch_index, bool time_channel, bool lead_lag,
+                                           scalar_t time_increment, torch::TensorAccessor<scalar_t, 1> scratch_a) {
+                if (!time_channel && !lead_lag) {
+                    return path_increments_a[stream_index][batch_index];
+                }
+
+                int64_t input_channel_size = path_increments_a.size(2);
+                int64_t offset = 0;
+                if (time_channel) {
+                    scratch_a[0] = time_increment;
+                    offset = 1;
+                }
+                if (lead_lag) {
+                    // Each increment x of the original path becomes (x, 0) and then (0, x).
+                    torch::TensorAccessor<scalar_t, 1> increment_a = path_increments_a[stream_index / 2][batch_index];
+                    bool lag = stream_index % 2 == 1;
+                    for (int64_t channel_index = 0; channel_index < input_channel_size; ++channel_index) {
+                        scratch_a[offset + channel_index] = lag ? 0 : increment_a[channel_index];
+                        scratch_a[offset + input_channel_size + channel_index] = lag ? increment_a[channel_index] : 0;
+                    }
+                }
+                else {
+                    torch::TensorAccessor<scalar_t, 1> increment_a = path_increments_a[stream_index][batch_index];
+                    for (int64_t channel_index = 0; channel_index < input_channel_size; ++channel_index) {
+                        scratch_a[offset + channel_index] = increment_a[channel_index];
+                    }
+                }
+                return scratch_a;
+            }
+        }  // namespace signatory::signature::detail
+    }  // namespace signatory::signature
+}  // namespace signatory
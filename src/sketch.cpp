@@ -0,0 +1,370 @@
+/* Copyright 2019 Patrick Kidger. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ========================================================================= */
+ // Here we handle computing sketches of the signature: random projections of each level of the signature down to a
+ // fixed number of channels, computed without ever computing the signature itself.
+
+
+#include <torch/extension.h>
+#include <algorithm>  // std::copy, std::fill, std::max, std::min
+#include <cstdint>    // int64_t
+#include <omp.h>
+#include <stdexcept>  // std::invalid_argument
+#include <tuple>      // std::tuple
+#include <vector>     // std::vector
+
+#include "misc.hpp"
+#include "signature.hpp"
+#include "sketch.hpp"
+
+
+namespace signatory {
+    namespace sketch {
+        namespace detail {
+            // The level k term of the signature lives in (R^C)^{\otimes k}. We sketch it with a TensorSketch: position
+            // j of the tensor product is hashed by a CountSketch with hash h_j : {0, ..., C - 1} -> {0, ..., D - 1}
+            // and sign s_j : {0, ..., C - 1} -> {-1, 1}, so that the sketch of a basis element
+            // e_{i_1} \otimes ... \otimes e_{i_k} is s_1(i_1) ... s_k(i_k) e_{(h_1(i_1) + ... + h_k(i_k)) mod D}.
+            // Using the same CountSketch at the same position for every level means that the sketch of A \otimes B,
+            // with A in level i and B in level k - i, is the circular convolution of the sketch of A with the sketch of
+            // B computed using the CountSketches for positions i + 1, ..., k.
+            // As such the Horner-style update of mult_fused_restricted_exp may be performed directly on the sketches,
+            // and each convolution against the sketch of a single increment costs just O(CD), as it has at most C
+            // nonzero entries.
+            // The sketches of every level are then summed; as the CountSketches are independent for each position, the
+            // sketches of different levels are uncorrelated, so this approximately preserves inner products between
+            // (untruncated up to the depth) signatures.
+
+            void sketch_checkargs(torch::Tensor path, torch::Tensor hashes, torch::Tensor signs,
+                                  int64_t sketch_channels, bool basepoint, torch::Tensor basepoint_value) {
+                if (hashes.ndimension() != 2 || signs.ndimension() != 2) {
+                    throw std::invalid_argument("Arguments 'hashes' and 'signs' must be 2-dimensional tensors, with "
+                                                "dimensions corresponding to (depth, channel) respectively.");
+                }
+                s_size_type depth = hashes.size(0);
+                signature_checkargs(path, depth, basepoint, basepoint_value, /*initial=*/false, torch::Tensor{},
+                                    /*time_channel=*/false, /*lead_lag=*/false);
+                if (path.is_cuda()) {
+                    throw std::invalid_argument("signature_sketch is only supported on the CPU.");
+                }
+                if (sketch_channels < 1) {
+                    throw std::invalid_argument("Argument 'sketch_channels' must be an integer greater than or equal "
+                                                "to one.");
+                }
+                if (hashes.size(0) != signs.size(0) || hashes.size(1) != path.size(channel_dim) ||
+                    signs.size(1) != path.size(channel_dim)) {
+                    throw std::invalid_argument("Arguments 'hashes' and 'signs' must both be of shape "
+                                                "(depth, channel).");
+                }
+                if (hashes.scalar_type() != torch::kLong || hashes.is_cuda()) {
+                    throw std::invalid_argument("Argument 'hashes' must be an int64 tensor on the CPU.");
+                }
+                if (misc::make_opts(signs) != misc::make_opts(path)) {
+                    throw std::invalid_argument("Argument 'signs' does not have the same dtype or device as 'path'.");
+                }
+                if (hashes.min().item<int64_t>() < 0 || hashes.max().item<int64_t>() >= sketch_channels) {
+                    throw std::invalid_argument("Argument 'hashes' must have values in the range "
+                                                "[0, sketch_channels).");
+                }
+            }
+
+            int64_t sketch_threads(int64_t batch_size) {
+                int64_t num_threads = std::min({static_cast<int64_t>(omp_get_max_threads()), get_max_parallelism(),
+                                                batch_size});
+                return std::max(num_threads, static_cast<int64_t>(1));
+            }
+
+            // The hashes and signs of the CountSketches, plus some sizes.
+            // 'hashes_' and 'signs_' should be contiguous.
+            template <typename scalar_t>
+            struct SketchInfo {
+                SketchInfo(torch::Tensor hashes_, torch::Tensor signs_, int64_t sketch_channels_) :
+                    depth{hashes_.size(0)},
+                    input_channel_size{hashes_.size(1)},
+                    sketch_channels{sketch_channels_},
+                    hashes(hashes_.data<int64_t>(), hashes_.data<int64_t>() + depth * input_channel_size),
+                    signs(signs_.data<scalar_t>(), signs_.data<scalar_t>() + depth * input_channel_size)
+                {}
+
+                int64_t depth;
+                int64_t input_channel_size;
+                int64_t sketch_channels;
+                // Both of shape (depth, channel)
+                std::vector<int64_t> hashes;
+                std::vector<scalar_t> signs;
+            };
+
+            // out = in \circledast CountSketch_position(increment) * scale
+            template <typename scalar_t>
+            void sketch_convolve(const SketchInfo<scalar_t>& info, int64_t position, const scalar_t* increment,
+                                 scalar_t scale, const scalar_t* in, scalar_t* out) {
+                std::fill(out, out + info.sketch_channels, 0);
+                for (int64_t channel_index = 0; channel_index < info.input_channel_size; ++channel_index) {
+                    int64_t hash = info.hashes[position * info.input_channel_size + channel_index];
+                    scalar_t value = info.signs[position * info.input_channel_size + channel_index] *
+                                     increment[channel_index] * scale;
+                    for (int64_t sketch_index = 0; sketch_index < info.sketch_channels; ++sketch_index) {
+                        int64_t target = sketch_index + hash;
+                        if (target >= info.sketch_channels) {
+                            target -= info.sketch_channels;
+                        }
+                        out[target] += in[sketch_index] * value;
+                    }
+                }
+            }
+
+            // Computes the Horner scheme for the level 'level' (in the range [1, depth]) term of
+            // state \otimes exp(sign * increment), where 'state' is of shape (depth, sketch_channels), holding the
+            // sketch of each level. 'horner' should be of shape (depth, sketch_channels); the result is placed in
+            // horner[level - 1], and the intermediate values of the Horner scheme in the rows before it.
+            template <typename scalar_t>
+            void sketch_horner(const SketchInfo<scalar_t>& info, int64_t level, const scalar_t* increment,
+                               scalar_t sign, const scalar_t* state, scalar_t* horner) {
+                int64_t sketch_channels = info.sketch_channels;
+                // The first position: CountSketch_0(increment) / level + state[0]
+                std::copy(state, state + sketch_channels, horner);
+                for (int64_t channel_index = 0; channel_index < info.input_channel_size; ++channel_index) {
+                    horner[info.hashes[channel_index]] += sign * info.signs[channel_index] * increment[channel_index] /
+                                                          level;
+                }
+                for (int64_t position = 1; position < level; ++position) {
+                    scalar_t* horner_at_position = horner + position * sketch_channels;
+                    sketch_convolve(info, position, increment, sign / (level - position),
+                                    horner + (position - 1) * sketch_channels, horner_at_position);
+                    const scalar_t* state_at_position = state + position * sketch_channels;
+                    for (int64_t sketch_index = 0; sketch_index < sketch_channels; ++sketch_index) {
+                        horner_at_position[sketch_index] += state_at_position[sketch_index];
+                    }
+                }
+            }
+
+            // Multiplies 'state' by exp(sign * increment), in-place. 'horner' is scratch space.
+            template <typename scalar_t>
+            void sketch_step_forward(const SketchInfo<scalar_t>& info, const scalar_t* increment, scalar_t sign,
+                                     scalar_t* state, scalar_t* horner) {
+                int64_t sketch_channels = info.sketch_channels;
+                // Iterating downwards means that the lower levels have not yet been updated.
+                for (int64_t level = info.depth; level >= 1; --level) {
+                    sketch_horner(info, level, increment, sign, state, horner);
+                    std::copy(horner + (level - 1) * sketch_channels, horner + level * sketch_channels,
+                              state + (level - 1) * sketch_channels);
+                }
+            }
+
+            // The backward pass through sketch_step_forward (with sign == 1). 'state' should be the state before the
+            // step. Writes the gradient with respect to the state before the step into 'grad_prev_state', and
+            // accumulates the gradient with respect to the increment into 'grad_increment'. 'horner' is scratch space
+            // of shape (depth, sketch_channels), and 'grad_horner' and 'grad_scratch' are scratch space of shape
+            // (sketch_channels,).
+            template <typename scalar_t>
+            void sketch_step_backward(const SketchInfo<scalar_t>& info, const scalar_t* increment,
+                                      const scalar_t* state, const scalar_t* grad_state, scalar_t* grad_prev_state,
+                                      scalar_t* grad_increment, scalar_t* horner, scalar_t* grad_horner,
+                                      scalar_t* grad_scratch) {
+                int64_t sketch_channels = info.sketch_channels;
+                int64_t input_channel_size = info.input_channel_size;
+                std::fill(grad_prev_state, grad_prev_state + info.depth * sketch_channels, 0);
+                for (int64_t level = 1; level <= info.depth; ++level) {
+                    sketch_horner(info, level, increment, static_cast<scalar_t>(1), state, horner);
+                    std::copy(grad_state + (level - 1) * sketch_channels, grad_state + level * sketch_channels,
+                              grad_horner);
+                    for (int64_t position = level - 1; position >= 0; --position) {
+                        // horner[position] = horner[position - 1] \circledast CountSketch_position(increment)
+                        //                    / (level - position) + state[position]
+                        // (where horner[-1] is the identity)
+                        scalar_t* grad_state_at_position = grad_prev_state + position * sketch_channels;
+                        for (int64_t sketch_index = 0; sketch_index < sketch_channels; ++sketch_index) {
+                            grad_state_at_position[sketch_index] += grad_horner[sketch_index];
+                        }
+                        scalar_t scale = static_cast<scalar_t>(1) / (level - position);
+                        if (position == 0) {
+                            for (int64_t channel_index = 0; channel_index < input_channel_size; ++channel_index) {
+                                grad_increment[channel_index] += grad_horner[info.hashes[channel_index]] *
+                                                                 info.signs[channel_index] * scale;
+                            }
+                            break;
+                        }
+                        const scalar_t* prev_horner = horner + (position - 1) * sketch_channels;
+                        std::fill(grad_scratch, grad_scratch + sketch_channels, 0);
+                        for (int64_t channel_index = 0; channel_index < input_channel_size; ++channel_index) {
+                            int64_t hash = info.hashes[position * input_channel_size + channel_index];
+                            scalar_t sign = info.signs[position * input_channel_size + channel_index];
+                            scalar_t value = sign * increment[channel_index] * scale;
+                            scalar_t grad_value = 0;
+                            for (int64_t sketch_index = 0; sketch_index < sketch_channels; ++sketch_index) {
+                                int64_t target = sketch_index + hash;
+                                if (target >= sketch_channels) {
+                                    target -= sketch_channels;
+                                }
+                                grad_scratch[sketch_index] += grad_horner[target] * value;
+                                grad_value += grad_horner[target] * prev_horner[sketch_index];
+                            }
+                            grad_increment[channel_index] += grad_value * sign * scale;
+                        }
+                        std::copy(grad_scratch, grad_scratch + sketch_channels, grad_horner);
+                    }
+                }
+            }
+
+            template <typename scalar_t>
+            void sketch_forward_cpu(torch::Tensor path_increments, const SketchInfo<scalar_t>& info,
+                                    torch::Tensor sketch_by_level) {
+                int64_t output_stream_size = path_increments.size(stream_dim);
+                int64_t batch_size = path_increments.size(batch_dim);
+                int64_t state_size = info.depth * info.sketch_channels;
+                const scalar_t* path_increments_data = path_increments.data<scalar_t>();
+                scalar_t* sketch_by_level_data = sketch_by_level.data<scalar_t>();
+
+                int64_t num_threads = sketch_threads(batch_size);
+                std::vector<std::vector<scalar_t>> horner_by_thread(num_threads, std::vector<scalar_t>(state_size));
+
+                #pragma omp parallel for default(none) \
+                                         if(num_threads > 1) \
+                                         num_threads(num_threads) \
+                                         schedule(static) \
+                                         shared(output_stream_size, batch_size, state_size, path_increments_data, \
+                                                sketch_by_level_data, horner_by_thread, info)
+                for (int64_t batch_index = 0; batch_index < batch_size; ++batch_index) {
+                    scalar_t* state = sketch_by_level_data + batch_index * state_size;
+                    std::fill(state, state + state_size, 0);
+                    for (int64_t stream_index = 0; stream_index < output_stream_size; ++stream_index) {
+                        sketch_step_forward<scalar_t>(info, path_increments_data +
+                                                            (stream_index * batch_size + batch_index) *
+                                                            info.input_channel_size,
+                                                      1, state, horner_by_thread[omp_get_thread_num()].data());
+                    }
+                }
+            }
+
+            template <typename scalar_t>
+            void sketch_backward_cpu(torch::Tensor grad_sketch, torch::Tensor sketch_by_level,
+                                     torch::Tensor path_increments, const SketchInfo<scalar_t>& info,
+                                     torch::Tensor grad_path_increments) {
+                int64_t output_stream_size = path_increments.size(stream_dim);
+                int64_t batch_size = path_increments.size(batch_dim);
+                int64_t sketch_channels = info.sketch_channels;
+                int64_t state_size = info.depth * sketch_channels;
+                const scalar_t* grad_sketch_data = grad_sketch.data<scalar_t>();
+                const scalar_t* sketch_by_level_data = sketch_by_level.data<scalar_t>();
+                const scalar_t* path_increments_data = path_increments.data<scalar_t>();
+                scalar_t* grad_path_increments_data = grad_path_increments.data<scalar_t>();
+
+                int64_t num_threads = sketch_threads(batch_size);
+                std::vector<std::vector<scalar_t>> state_by_thread(num_threads, std::vector<scalar_t>(state_size));
+                std::vector<std::vector<scalar_t>> grad_state_by_thread(num_threads,
+                                                                        std::vector<scalar_t>(state_size));
+                std::vector<std::vector<scalar_t>> grad_prev_state_by_thread(num_threads,
+                                                                             std::vector<scalar_t>(state_size));
+                std::vector<std::vector<scalar_t>> horner_by_thread(num_threads, std::vector<scalar_t>(state_size));
+                std::vector<std::vector<scalar_t>> grad_horner_by_thread(num_threads,
+                                                                         std::vector<scalar_t>(2 * sketch_channels));
+
+                #pragma omp parallel for default(none) \
+                                         if(num_threads > 1) \
+                                         num_threads(num_threads) \
+                                         schedule(static) \
+                                         shared(output_stream_size, batch_size, sketch_channels, state_size, \
+                                                grad_sketch_data, sketch_by_level_data, path_increments_data, \
+                                                grad_path_increments_data, state_by_thread, grad_state_by_thread, \
+                                                grad_prev_state_by_thread, horner_by_thread, grad_horner_by_thread, \
+                                                info)
+                for (int64_t batch_index = 0; batch_index < batch_size; ++batch_index) {
+                    int64_t thread_index = omp_get_thread_num();
+                    std::vector<scalar_t>& state = state_by_thread[thread_index];
+                    std::vector<scalar_t>& grad_state = grad_state_by_thread[thread_index];
+                    std::vector<scalar_t>& grad_prev_state = grad_prev_state_by_thread[thread_index];
+                    scalar_t* grad_horner = grad_horner_by_thread[thread_index].data();
+
+                    // The sketch is the sum of the sketches of every level.
+                    std::copy(sketch_by_level_data + batch_index * state_size,
+                              sketch_by_level_data + (batch_index + 1) * state_size, state.begin());
+                    for (int64_t level_index = 0; level_index < info.depth; ++level_index) {
+                        std::copy(grad_sketch_data + batch_index * sketch_channels,
+                                  grad_sketch_data + (batch_index + 1) * sketch_channels,
+                                  grad_state.begin() + level_index * sketch_channels);
+                    }
+
+                    for (int64_t stream_index = output_stream_size - 1; stream_index >= 0; --stream_index) {
+                        const scalar_t* increment = path_increments_data +
+                                                    (stream_index * batch_size + batch_index) *
+                                                    info.input_channel_size;
+                        // Recover the previous state via the reversibility property of the signature, which the sketch
+                        // inherits. (Except for the very first increment, where we know that it is the identity.)
+                        if (stream_index == 0) {
+                            std::fill(state.begin(), state.end(), 0);
+                        }
+                        else {
+                            sketch_step_forward<scalar_t>(info, increment, -1, state.data(),
+                                                          horner_by_thread[thread_index].data());
+                        }
+                        sketch_step_backward<scalar_t>(info, increment, state.data(), grad_state.data(),
+                                                       grad_prev_state.data(),
+                                                       grad_path_increments_data +
+                                                       (stream_index * batch_size + batch_index) *
+                                                       info.input_channel_size,
+                                                       horner_by_thread[thread_index].data(), grad_horner,
+                                                       grad_horner + sketch_channels);
+                        grad_state.swap(grad_prev_state);
+                    }
+                }
+            }
+        }  // namespace signatory::sketch::detail
+    }  // namespace signatory::sketch
+
+    std::tuple<torch::Tensor, torch::Tensor>
+    signature_sketch_forward(torch::Tensor path, torch::Tensor hashes, torch::Tensor signs, int64_t sketch_channels,
+                             bool basepoint, torch::Tensor basepoint_value) {
+        sketch::detail::sketch_checkargs(path, hashes, signs, sketch_channels, basepoint, basepoint_value);
+
+        path = path.detach();
+        basepoint_value = basepoint_value.detach();
+        hashes = hashes.contiguous();
+        signs = signs.detach().contiguous();
+
+        torch::Tensor path_increments = signature::detail::compute_path_increments(path, basepoint, basepoint_value,
+                                                                                   /*inverse=*/false).contiguous();
+        int64_t batch_size = path_increments.size(batch_dim);
+        torch::Tensor sketch_by_level = torch::empty({batch_size, hashes.size(0), sketch_channels},
+                                                     misc::make_opts(path));
+        AT_DISPATCH_FLOATING_TYPES(path.type(), "signature_sketch_forward", ([&] {
+            sketch::detail::SketchInfo<scalar_t> info(hashes, signs, sketch_channels);
+            sketch::detail::sketch_forward_cpu<scalar_t>(path_increments, info, sketch_by_level);
+        }));
+        return std::tuple<torch::Tensor, torch::Tensor> {sketch_by_level.sum(/*dim=*/1), sketch_by_level};
+    }
+
+    std::tuple<torch::Tensor, torch::Tensor>
+    signature_sketch_backward(torch::Tensor grad_sketch, torch::Tensor sketch_by_level, torch::Tensor path,
+                              torch::Tensor hashes, torch::Tensor signs, bool basepoint,
+                              torch::Tensor basepoint_value) {
+        grad_sketch = grad_sketch.detach().contiguous();
+        sketch_by_level = sketch_by_level.detach().contiguous();
+        path = path.detach();
+        basepoint_value = basepoint_value.detach();
+        hashes = hashes.contiguous();
+        signs = signs.detach().contiguous();
+
+        torch::Tensor path_increments = signature::detail::compute_path_increments(path, basepoint, basepoint_value,
+                                                                                   /*inverse=*/false).contiguous();
+        torch::Tensor grad_path_increments = torch::zeros_like(path_increments);
+        AT_DISPATCH_FLOATING_TYPES(path.type(), "signature_sketch_backward", ([&] {
+            sketch::detail::SketchInfo<scalar_t> info(hashes, signs, sketch_by_level.size(-1));
+            sketch::detail::sketch_backward_cpu<scalar_t>(grad_sketch, sketch_by_level, path_increments, info,
+                                                          grad_path_increments);
+        }));
+
+        return signature::detail::compute_path_increments_backward(grad_path_increments, basepoint,
+                                                                    /*inverse=*/false, misc::make_opts(path));
+    }
+}  // namespace signatory
@@ -0,0 +1,46 @@
+/* Copyright 2019 Patrick Kidger. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ========================================================================= */
+ // Here we handle computing sketches of the signature: random projections of each level of the signature down to a
+ // fixed number of channels, computed without ever computing the signature itself.
+
+
+#ifndef SIGNATORY_SKETCH_HPP
+#define SIGNATORY_SKETCH_HPP
+
+#include <torch/extension.h>
+#include <cstdint>    // int64_t
+#include <tuple>      // std::tuple
+
+namespace signatory {
+    // See signatory.signature_sketch for documentation. Only supported on the CPU.
+    // 'path' should be of shape (stream, batch, channel). 'hashes' and 'signs' should both be of shape
+    // (depth, channel), giving the CountSketch used at each position of the tensor product; 'hashes' should be an int64
+    // tensor with values in the range [0, sketch_channels), and 'signs' should have the same dtype as the path.
+    // Returns the sketch, of shape (batch, sketch_channels), and the sketch of each level of the signature separately,
+    // of shape (batch, depth, sketch_channels), which is needed for the backward pass.
+    std::tuple<torch::Tensor, torch::Tensor>
+    signature_sketch_forward(torch::Tensor path, torch::Tensor hashes, torch::Tensor signs, int64_t sketch_channels,
+                             bool basepoint, torch::Tensor basepoint_value);
+
+    // See signatory.signature_sketch for documentation.
+    // 'sketch_by_level' should be as returned by signature_sketch_forward.
+    // Returns the gradients with respect to the path and the basepoint.
+    std::tuple<torch::Tensor, torch::Tensor>
+    signature_sketch_backward(torch::Tensor grad_sketch, torch::Tensor sketch_by_level, torch::Tensor path,
+                              torch::Tensor hashes, torch::Tensor signs, bool basepoint,
+                              torch::Tensor basepoint_value);
+}  // namespace signatory
+
+#endif //SIGNATORY_SKETCH_HPP
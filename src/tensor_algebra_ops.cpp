@@ -70,6 +70,32 @@ namespace signatory {
                 return ((is_even(depth_index) ? -1 : 1) * reciprocals[depth_index]).item();
             }
 
+            // The power series we compute are all of the form
+            // x(1 + x(c_0 + x(c_1 + x(c_2 + ...)))),
+            // and these functions give the c_i.
+            // For log(1 + x) they are c_i = (-1)^(i + 1) / (i + 2).
+            std::vector<torch::Scalar> log_coefficients(s_size_type depth, torch::Tensor reciprocals) {
+                std::vector<torch::Scalar> coefficients;
+                coefficients.reserve(depth - 1);
+                for (s_size_type depth_index = 0; depth_index < depth - 1; ++depth_index) {
+                    coefficients.push_back(log_coefficient_at_depth(depth_index, reciprocals));
+                }
+                return coefficients;
+            }
+
+            // For exp(x) - 1 they are c_i = 1 / (i + 2)!
+            std::vector<torch::Scalar> exp_coefficients(s_size_type depth, torch::Tensor reciprocals) {
+                std::vector<torch::Scalar> coefficients;
+                coefficients.reserve(depth - 1);
+                if (depth > 1) {
+                    torch::Tensor factorial_reciprocals = reciprocals.cumprod(0);
+                    for (s_size_type depth_index = 0; depth_index < depth - 1; ++depth_index) {
+                        coefficients.push_back(factorial_reciprocals[depth_index].item());
+                    }
+                }
+                return coefficients;
+            }
+
             // Computes (sort of) multiplication in the tensor algebra.
             // 'arg1' is assumed to be a member of the tensor algebra, with assumed scalar value 'scalar_term_value'.
             // 'arg2' is assumed to be a member of the tensor algebra, with assumed scalar value zero.
@@ -113,6 +139,110 @@ namespace signatory {
                     grad_tensor_at_depth.zero_();
                 }
             }
+
+            // Computes a power series in the tensor algebra.
+            // 'output_vector' and 'input_vector' are both members of the tensor algebra, with assumed scalar values 0.
+            // They are assumed to have equal values to each other when passed.
+            // Then 'output_vector' is modified to be x(1 + x(c_0 + x(c_1 + ...))), where x is 'input_vector' and the
+            // c_i are 'coefficients', which should be of length one less than the depth. (The result also has scalar
+            // value 0; the caller may choose to interpret it as having some other scalar value, e.g. for exp.)
+            void power_series(std::vector<torch::Tensor>& output_vector, const std::vector<torch::Tensor>& input_vector,
+                              const std::vector<torch::Scalar>& coefficients) {
+                s_size_type depth = input_vector.size();
+                if (depth == 1) {
+                    output_vector[0].copy_(input_vector[0]);
+                    return;
+                }
+                output_vector[0].copy_(input_vector[0] * coefficients[depth - 2]);
+                for (s_size_type depth_index = depth - 3; depth_index >= 0; --depth_index) {
+                    detail::mult_partial(output_vector,
+                                         input_vector,
+                                         /*scalar_value_term=*/coefficients[depth_index],
+                                         /*top_terms_to_skip=*/depth_index + 1);
+                }
+                detail::mult_partial(output_vector, input_vector, /*scalar_value_term=*/1, /*top_terms_to_skip=*/0);
+            }
+
+            // Computes the backwards pass through power_series
+            // 'input_vector' and 'coefficients' are as passed to power_series.
+            // 'grad_output_vector' is the input gradient, and will be modified in-place.
+            // 'grad_input_vector' is the output gradient, and will have the result of this operation added on to it.
+            void power_series_backward(std::vector<torch::Tensor>& grad_output_vector,
+                                       std::vector<torch::Tensor>& grad_input_vector,
+                                       const std::vector<torch::Tensor>& input_vector,
+                                       const std::vector<torch::Scalar>& coefficients) {
+                s_size_type depth = input_vector.size();
+                if (depth == 1) {
+                    grad_input_vector[0].add_(grad_output_vector[0]);
+                    return;
+                }
+
+                // Will have the power series progressively computed in it
+                std::vector<torch::Tensor> scratch_vector;
+                scratch_vector.reserve(input_vector.size());
+                for (const auto& elem : input_vector) {
+                    scratch_vector.push_back(elem.clone());
+                }
+
+                // Used as extra scratch space prior to pushing into...
+                std::vector<torch::Tensor> copy_vector;
+                copy_vector.reserve(scratch_vector.size());
+
+                // ...this, which records all the partially-computed power series
+                std::vector<std::vector<torch::Tensor>> record_vector;
+                record_vector.reserve(depth - 1);
+
+                // Compute the power series forwards and remember every intermediate tensor
+                scratch_vector[0] *= coefficients[depth - 2];
+                for (s_size_type depth_index = depth - 3; depth_index >= 0; --depth_index) {
+                    copy_vector.clear();
+                    for (const auto& elem : scratch_vector) {
+                        copy_vector.push_back(elem.clone());
+                    }
+                    record_vector.push_back(copy_vector);
+                    detail::mult_partial(scratch_vector,
+                                         input_vector,
+                                         /*scalar_value_term=*/coefficients[depth_index],
+                                         /*top_terms_to_skip=*/depth_index + 1);
+                }
+                record_vector.push_back(scratch_vector);
+
+                // Now actually perform the backwards operation
+                s_size_type backward_index = record_vector.size() - 1;
+                detail::mult_partial_backward(grad_output_vector,
+                                              grad_input_vector,
+                                              record_vector[backward_index],
+                                              input_vector,
+                                              /*scalar_value_term=*/1,
+                                              /*top_terms_to_skip=*/0);
+
+                for (s_size_type depth_index = 0; depth_index < depth - 2; ++depth_index) {
+                    --backward_index;
+                    detail::mult_partial_backward(grad_output_vector,
+                                                  grad_input_vector,
+                                                  record_vector[backward_index],
+                                                  input_vector,
+                                                  /*scalar_value_term=*/coefficients[depth_index],
+                                                  /*top_terms_to_skip=*/depth_index + 1);
+                }
+
+                grad_input_vector[0].add_(grad_output_vector[0], coefficients[depth - 2]);
+            }
+
+            // Checks the arguments for the tensor_algebra_* functions
+            void tensor_algebra_checkargs(torch::Tensor tensor, int64_t input_channels, s_size_type depth) {
+                misc::checkargs_channels_depth(input_channels, depth);
+                if (tensor.ndimension() != 2) {
+                    throw std::invalid_argument("Argument 'tensor' must be two-dimensional, corresponding to "
+                                                "(batch, signature_channels(input_channels, depth)).");
+                }
+                if (tensor.size(channel_dim) != signature_channels(input_channels, depth)) {
+                    throw std::invalid_argument("Argument 'tensor' did not have the right number of channels.");
+                }
+                if (!tensor.is_floating_point()) {
+                    throw std::invalid_argument("Argument 'tensor' must be of floating point type.");
+                }
+            }
         }  // namespace signatory::ta_ops::detail
 
         void mult(std::vector<torch::Tensor>& arg1, const std::vector<torch::Tensor>& arg2, bool inverse) {
@@ -421,84 +551,49 @@ namespace signatory {
 
         void log(std::vector<torch::Tensor>& output_vector, const std::vector<torch::Tensor>& input_vector,
                  torch::Tensor reciprocals) {
-            s_size_type depth = input_vector.size();
-            if (depth == 1) {
-                output_vector[0].copy_(input_vector[0]);
-                return;
-            }
-            output_vector[0].copy_(input_vector[0] * detail::log_coefficient_at_depth(depth - 2, reciprocals));
-            for (s_size_type depth_index = depth - 3; depth_index >= 0; --depth_index) {
-                detail::mult_partial(output_vector,
-                                     input_vector,
-                                     /*scalar_value_term=*/detail::log_coefficient_at_depth(depth_index,
-                                                                                            reciprocals),
-                                     /*top_terms_to_skip=*/depth_index + 1);
-            }
-            detail::mult_partial(output_vector, input_vector, /*scalar_value_term=*/1, /*top_terms_to_skip=*/0);
+            detail::power_series(output_vector, input_vector,
+                                 detail::log_coefficients(input_vector.size(), reciprocals));
         }
 
         void log_backward(std::vector<torch::Tensor>& grad_output_vector,
                           std::vector<torch::Tensor>& grad_input_vector,
                           const std::vector<torch::Tensor>& input_vector,
                           torch::Tensor reciprocals) {
-            s_size_type depth = input_vector.size();
-            if (depth == 1) {
-                grad_input_vector[0].copy_(grad_output_vector[0]);
-                return;
-            }
-
-            // Will have the logarithm progressively computed in it
-            std::vector<torch::Tensor> scratch_vector;
-            scratch_vector.reserve(input_vector.size());
-            for (const auto& elem : input_vector) {
-                scratch_vector.push_back(elem.clone());
-            }
+            detail::power_series_backward(grad_output_vector, grad_input_vector, input_vector,
+                                          detail::log_coefficients(input_vector.size(), reciprocals));
+        }
 
-            // Used as extra scratch space prior to pushing into...
-            std::vector<torch::Tensor> copy_vector;
-            copy_vector.reserve(scratch_vector.size());
+        void exp(std::vector<torch::Tensor>& output_vector, const std::vector<torch::Tensor>& input_vector,
+                 torch::Tensor reciprocals) {
+            detail::power_series(output_vector, input_vector,
+                                 detail::exp_coefficients(input_vector.size(), reciprocals));
+        }
 
-            // ...this, which records all the partially-computed logarithms
-            std::vector<std::vector<torch::Tensor>> record_vector;
-            record_vector.reserve(depth - 1);
+        void exp_backward(std::vector<torch::Tensor>& grad_output_vector,
+                          std::vector<torch::Tensor>& grad_input_vector,
+                          const std::vector<torch::Tensor>& input_vector,
+                          torch::Tensor reciprocals) {
+            detail::power_series_backward(grad_output_vector, grad_input_vector, input_vector,
+                                          detail::exp_coefficients(input_vector.size(), reciprocals));
+        }
 
-            // Compute the logarithm forwards and remember every intermediate tensor
-            scratch_vector[0] *= detail::log_coefficient_at_depth(depth - 2, reciprocals);
-            for (s_size_type depth_index = depth - 3; depth_index >= 0; --depth_index) {
-                copy_vector.clear();
-                for (const auto& elem : scratch_vector) {
-                    copy_vector.push_back(elem.clone());
+        void antipode(std::vector<torch::Tensor>& output_vector, const std::vector<torch::Tensor>& input_vector) {
+            s_size_type depth = input_vector.size();
+            int64_t batch_size = input_vector[0].size(batch_dim);
+            int64_t input_channel_size = input_vector[0].size(channel_dim);
+            std::vector<int64_t> shape {batch_size};
+            std::vector<int64_t> permutation {0};
+            for (s_size_type depth_index = 0; depth_index < depth; ++depth_index) {
+                // The term at depth_index is of shape (batch, channel, ..., channel), with depth_index + 1 channel
+                // dimensions. Reversing every word corresponds to reversing the order of the channel dimensions.
+                shape.push_back(input_channel_size);
+                permutation.insert(permutation.begin() + 1, depth_index + 1);
+                output_vector[depth_index].view(shape).copy_(input_vector[depth_index].view(shape).permute(permutation));
+                if (detail::is_even(depth_index)) {
+                    // Words of odd length
+                    output_vector[depth_index].neg_();
                 }
-                record_vector.push_back(copy_vector);
-                detail::mult_partial(scratch_vector,
-                                     input_vector,
-                                     /*scalar_value_term=*/detail::log_coefficient_at_depth(depth_index, reciprocals),
-                                     /*top_terms_to_skip=*/depth_index + 1);
-            }
-            record_vector.push_back(scratch_vector);
-
-            // Now actually perform the backwards operation
-            s_size_type backward_index = record_vector.size() - 1;
-            detail::mult_partial_backward(grad_output_vector,
-                                          grad_input_vector,
-                                          record_vector[backward_index],
-                                          input_vector,
-                                          /*scalar_value_term=*/1,
-                                          /*top_terms_to_skip=*/0);
-
-            for (s_size_type depth_index = 0; depth_index < depth - 2; ++depth_index) {
-                --backward_index;
-                detail::mult_partial_backward(grad_output_vector,
-                                              grad_input_vector,
-                                              record_vector[backward_index],
-                                              input_vector,
-                                              /*scalar_value_term=*/detail::log_coefficient_at_depth(depth_index,
-                                                                                                     reciprocals),
-                                              /*top_terms_to_skip=*/depth_index + 1);
             }
-
-            grad_input_vector[0].add_(grad_output_vector[0],
-                                      detail::log_coefficient_at_depth(depth - 2, reciprocals));
         }
     }  // namespace signatory::ta_ops
 
@@ -625,4 +720,86 @@ namespace signatory {
 
         return grad_sigtensors;
     }
-}  // namespace signatory
\ No newline at end of file
+
+    torch::Tensor tensor_algebra_exp_forward(torch::Tensor tensor, int64_t input_channels, s_size_type depth) {
+        // No sense keeping track of gradients when we have a custom backwards (and we're doing inplace operations)
+        tensor = tensor.detach();
+        ta_ops::detail::tensor_algebra_checkargs(tensor, input_channels, depth);
+        torch::Tensor reciprocals = misc::make_reciprocals(depth, misc::make_opts(tensor));
+
+        torch::Tensor out = tensor.clone();
+        std::vector<torch::Tensor> out_vector;
+        misc::slice_by_term(out, out_vector, input_channels, depth);
+        std::vector<torch::Tensor> tensor_vector;
+        misc::slice_by_term(tensor, tensor_vector, input_channels, depth);
+        ta_ops::exp(out_vector, tensor_vector, reciprocals);
+        return out;
+    }
+
+    torch::Tensor tensor_algebra_exp_backward(torch::Tensor grad_out, torch::Tensor tensor, int64_t input_channels,
+                                              s_size_type depth) {
+        grad_out = grad_out.detach();
+        tensor = tensor.detach();
+        torch::Tensor reciprocals = misc::make_reciprocals(depth, misc::make_opts(tensor));
+
+        // Modified in-place by exp_backward
+        torch::Tensor grad_scratch = grad_out.clone();
+        std::vector<torch::Tensor> grad_scratch_vector;
+        misc::slice_by_term(grad_scratch, grad_scratch_vector, input_channels, depth);
+        torch::Tensor grad_tensor = torch::zeros_like(tensor);
+        std::vector<torch::Tensor> grad_tensor_vector;
+        misc::slice_by_term(grad_tensor, grad_tensor_vector, input_channels, depth);
+        std::vector<torch::Tensor> tensor_vector;
+        misc::slice_by_term(tensor, tensor_vector, input_channels, depth);
+        ta_ops::exp_backward(grad_scratch_vector, grad_tensor_vector, tensor_vector, reciprocals);
+        return grad_tensor;
+    }
+
+    torch::Tensor tensor_algebra_log_forward(torch::Tensor tensor, int64_t input_channels, s_size_type depth) {
+        // No sense keeping track of gradients when we have a custom backwards (and we're doing inplace operations)
+        tensor = tensor.detach();
+        ta_ops::detail::tensor_algebra_checkargs(tensor, input_channels, depth);
+        torch::Tensor reciprocals = misc::make_reciprocals(depth, misc::make_opts(tensor));
+
+        torch::Tensor out = tensor.clone();
+        std::vector<torch::Tensor> out_vector;
+        misc::slice_by_term(out, out_vector, input_channels, depth);
+        std::vector<torch::Tensor> tensor_vector;
+        misc::slice_by_term(tensor, tensor_vector, input_channels, depth);
+        ta_ops::log(out_vector, tensor_vector, reciprocals);
+        return out;
+    }
+
+    torch::Tensor tensor_algebra_log_backward(torch::Tensor grad_out, torch::Tensor tensor, int64_t input_channels,
+                                              s_size_type depth) {
+        grad_out = grad_out.detach();
+        tensor = tensor.detach();
+        torch::Tensor reciprocals = misc::make_reciprocals(depth, misc::make_opts(tensor));
+
+        // Modified in-place by log_backward
+        torch::Tensor grad_scratch = grad_out.clone();
+        std::vector<torch::Tensor> grad_scratch_vector;
+        misc::slice_by_term(grad_scratch, grad_scratch_vector, input_channels, depth);
+        torch::Tensor grad_tensor = torch::zeros_like(tensor);
+        std::vector<torch::Tensor> grad_tensor_vector;
+        misc::slice_by_term(grad_tensor, grad_tensor_vector, input_channels, depth);
+        std::vector<torch::Tensor> tensor_vector;
+        misc::slice_by_term(tensor, tensor_vector, input_channels, depth);
+        ta_ops::log_backward(grad_scratch_vector, grad_tensor_vector, tensor_vector, reciprocals);
+        return grad_tensor;
+    }
+
+    torch::Tensor tensor_algebra_antipode(torch::Tensor tensor, int64_t input_channels, s_size_type depth) {
+        // contiguous so that we can view each term as a (batch, channel, ..., channel) tensor
+        tensor = tensor.detach().contiguous();
+        ta_ops::detail::tensor_algebra_checkargs(tensor, input_channels, depth);
+
+        torch::Tensor out = torch::empty({tensor.size(batch_dim), tensor.size(channel_dim)}, misc::make_opts(tensor));
+        std::vector<torch::Tensor> out_vector;
+        misc::slice_by_term(out, out_vector, input_channels, depth);
+        std::vector<torch::Tensor> tensor_vector;
+        misc::slice_by_term(tensor, tensor_vector, input_channels, depth);
+        ta_ops::antipode(out_vector, tensor_vector);
+        return out;
+    }
+}  // namespace signatory
@@ -103,6 +103,14 @@ namespace signatory {
                                                   std::vector<torch::TensorAccessor<scalar_t, 1>>& prev_a,
                                                   torch::TensorAccessor<scalar_t, 1> reciprocals_a);
 
+        // Performs the same computation as log, but handles the very special case of being on the cpu, with a
+        // particular scalar type, and does not have a batch dimension. The same warning as for
+        // mult_fused_restricted_exp_single_cpu applies.
+        template <typename scalar_t>
+        void log_single_cpu(std::vector<torch::TensorAccessor<scalar_t, 1>>& output_a,
+                            const std::vector<torch::TensorAccessor<scalar_t, 1>>& input_a,
+                            torch::TensorAccessor<scalar_t, 1> reciprocals_a);
+
         // Computes the logarithm in the tensor algebra
         // 'output_vector' and 'input_vector' are both members of the tensor algebra, with assumed scalar values 1.
         // They are assumed to have equal values to each other when passed.
@@ -118,6 +126,29 @@ namespace signatory {
                           std::vector<torch::Tensor>& grad_input_vector,
                           const std::vector<torch::Tensor>& input_vector,
                           torch::Tensor reciprocals);
+
+        // Computes the (general, not restricted) exponential in the tensor algebra
+        // 'input_vector' is a member of the tensor algebra with assumed scalar value 0.
+        // 'output_vector' is a member of the tensor algebra with assumed scalar value 1.
+        // They are assumed to have equal values to each other when passed.
+        // Then 'output_vector' is modified to be exp(input_vector).
+        void exp(std::vector<torch::Tensor>& output_vector, const std::vector<torch::Tensor>& input_vector,
+                 torch::Tensor reciprocals);
+
+        // Computes the backwards pass through exp
+        // 'input_vector' is as passed to exp.
+        // 'grad_output_vector' is the input gradient, and will be modified in-place.
+        // 'grad_input_vector' is the output gradient, and will have the result of this operation added on to it.
+        void exp_backward(std::vector<torch::Tensor>& grad_output_vector,
+                          std::vector<torch::Tensor>& grad_input_vector,
+                          const std::vector<torch::Tensor>& input_vector,
+                          torch::Tensor reciprocals);
+
+        // Computes the antipode in the tensor algebra: every word is reversed, and the terms of odd depth are negated.
+        // The antipode of the signature of a path is the signature of the reversed path. (i.e. its inverse.)
+        // 'output_vector' will have the result copied into it. It should not alias 'input_vector'.
+        // As the antipode is linear and self-adjoint, this is also its own backwards pass.
+        void antipode(std::vector<torch::Tensor>& output_vector, const std::vector<torch::Tensor>& input_vector);
     }  // namespace signatory::ta_ops
 
     // See signatory.signature_combine
@@ -129,6 +160,24 @@ namespace signatory {
                                                           std::vector<torch::Tensor> sigtensors,
                                                           int64_t input_channels,
                                                           s_size_type depth);
+
+    // See signatory.ta_exp
+    torch::Tensor tensor_algebra_exp_forward(torch::Tensor tensor, int64_t input_channels, s_size_type depth);
+
+    // See signatory.ta_exp
+    torch::Tensor tensor_algebra_exp_backward(torch::Tensor grad_out, torch::Tensor tensor, int64_t input_channels,
+                                              s_size_type depth);
+
+    // See signatory.ta_log
+    torch::Tensor tensor_algebra_log_forward(torch::Tensor tensor, int64_t input_channels, s_size_type depth);
+
+    // See signatory.ta_log
+    torch::Tensor tensor_algebra_log_backward(torch::Tensor grad_out, torch::Tensor tensor, int64_t input_channels,
+                                              s_size_type depth);
+
+    // See signatory.ta_antipode
+    // This is also the backward operation through itself.
+    torch::Tensor tensor_algebra_antipode(torch::Tensor tensor, int64_t input_channels, s_size_type depth);
 }  // namespace signatory
 
 #include "tensor_algebra_ops.inl"
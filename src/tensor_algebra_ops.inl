@@ -23,6 +23,36 @@
 
 namespace signatory {
     namespace ta_ops {
+        namespace detail {
+            // A rewriting of mult_partial in normal C++. See log_single_cpu.
+            template <typename scalar_t>
+            void mult_partial_single_cpu(std::vector<torch::TensorAccessor<scalar_t, 1>>& arg1_a,
+                                         const std::vector<torch::TensorAccessor<scalar_t, 1>>& arg2_a,
+                                         scalar_t scalar_term_value,
+                                         s_size_type top_terms_to_skip) {
+                s_size_type depth = arg1_a.size();
+                for (s_size_type depth_index = depth - top_terms_to_skip - 1; depth_index >= 0; --depth_index) {
+                    torch::TensorAccessor<scalar_t, 1> tensor_at_depth_a = arg1_a[depth_index];
+
+                    for (int64_t index = 0; index < tensor_at_depth_a.size(0); ++index) {
+                        tensor_at_depth_a[index] = scalar_term_value * arg2_a[depth_index][index];
+                    }
+
+                    for (s_size_type j = 0, k = depth_index - 1; j < depth_index; ++j, --k) {
+                        /* loop invariant: j + k = depth_index - 1 */
+                        int64_t arg2_size = arg2_a[k].size(0);
+                        for (int64_t arg1_index = 0; arg1_index < arg1_a[j].size(0); ++arg1_index) {
+                            scalar_t arg1_value = arg1_a[j][arg1_index];
+                            for (int64_t arg2_index = 0; arg2_index < arg2_size; ++arg2_index) {
+                                tensor_at_depth_a[arg1_index * arg2_size + arg2_index] += arg1_value *
+                                                                                          arg2_a[k][arg2_index];
+                            }
+                        }
+                    }
+                }
+            }
+        }  // namespace signatory::ta_ops::detail
+
         template <typename scalar_t, bool inverse>
         void mult_fused_restricted_exp_single_cpu(torch::TensorAccessor<scalar_t, 1> next_a,
                                                   std::vector<torch::TensorAccessor<scalar_t, 1>>& prev_a,
@@ -105,5 +135,39 @@ namespace signatory {
                 prev_a[0][channel_index] += next_a[channel_index];
             }
         }
+
+        template <typename scalar_t>
+        void log_single_cpu(std::vector<torch::TensorAccessor<scalar_t, 1>>& output_a,
+                            const std::vector<torch::TensorAccessor<scalar_t, 1>>& input_a,
+                            torch::TensorAccessor<scalar_t, 1> reciprocals_a) {
+            // This is just a rewriting of log in normal C++. Unlike log, 'output_a' need not be equal to 'input_a' when
+            // passed.
+
+            s_size_type depth = input_a.size();
+            int64_t input_channel_size = input_a[0].size(0);
+
+            // The coefficient of a term in the power series of the logarithm
+            auto log_coefficient_at_depth = [&reciprocals_a] (s_size_type depth_index) -> scalar_t {
+                return (((depth_index % 2) == 0) ? -1 : 1) * reciprocals_a[depth_index];
+            };
+
+            if (depth == 1) {
+                for (int64_t channel_index = 0; channel_index < input_channel_size; ++channel_index) {
+                    output_a[0][channel_index] = input_a[0][channel_index];
+                }
+                return;
+            }
+            for (int64_t channel_index = 0; channel_index < input_channel_size; ++channel_index) {
+                output_a[0][channel_index] = input_a[0][channel_index] * log_coefficient_at_depth(depth - 2);
+            }
+            for (s_size_type depth_index = depth - 3; depth_index >= 0; --depth_index) {
+                detail::mult_partial_single_cpu<scalar_t>(output_a,
+                                                          input_a,
+                                                          /*scalar_value_term=*/log_coefficient_at_depth(depth_index),
+                                                          /*top_terms_to_skip=*/depth_index + 1);
+            }
+            detail::mult_partial_single_cpu<scalar_t>(output_a, input_a, /*scalar_value_term=*/1,
+                                                      /*top_terms_to_skip=*/0);
+        }
     }  // namespace signatory::ta_ops
 }  // namespace signatory
\ No newline at end of file
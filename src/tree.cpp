@@ -0,0 +1,199 @@
+/* Copyright 2019 Patrick Kidger. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ========================================================================= */
+ // Here we handle computing the signatures of every node of a tree of paths, where each path shares its prefix with
+ // its parent.
+
+
+#include <torch/extension.h>
+#include <algorithm>  // std::copy
+#include <cstdint>    // int64_t
+#include <stdexcept>  // std::invalid_argument
+#include <vector>     // std::vector
+
+#include "misc.hpp"
+#include "tensor_algebra_ops.hpp"
+#include "tree.hpp"
+
+
+namespace signatory {
+    namespace tree {
+        namespace detail {
+            void tree_checkargs(torch::Tensor increments, torch::Tensor parents, s_size_type depth) {
+                if (increments.ndimension() != 3) {
+                    throw std::invalid_argument("Argument 'increments' must be a 3-dimensional tensor, with "
+                                                "dimensions corresponding to (batch, node, channel) respectively.");
+                }
+                if (increments.size(batch_dim) == 0 || increments.size(stream_dim) == 0 ||
+                    increments.size(channel_dim) == 0) {
+                    throw std::invalid_argument("Argument 'increments' cannot have dimensions of size zero.");
+                }
+                if (!increments.is_floating_point()) {
+                    throw std::invalid_argument("Argument 'increments' must be of floating point type.");
+                }
+                misc::checkargs_channels_depth(increments.size(channel_dim), depth);
+                if (parents.ndimension() != 1 || parents.scalar_type() != torch::kLong || parents.is_cuda()) {
+                    throw std::invalid_argument("Argument 'parents' must be a one-dimensional collection of "
+                                                "integers.");
+                }
+                if (parents.size(0) != increments.size(stream_dim)) {
+                    throw std::invalid_argument("Argument 'parents' must have one entry for every node of "
+                                                "'increments'.");
+                }
+                auto parents_a = parents.accessor<int64_t, 1>();
+                for (int64_t node_index = 0; node_index < parents.size(0); ++node_index) {
+                    if (parents_a[node_index] < -1 || parents_a[node_index] >= node_index) {
+                        throw std::invalid_argument("Argument 'parents' must have every entry either equal to -1, "
+                                                    "or equal to the index of an earlier node.");
+                    }
+                }
+            }
+
+            // Groups the nodes of the tree by their distance from the root. Every node in a level has its parent in
+            // the previous level, so all of the nodes in a level may be computed at once, as a single batch.
+            struct TreeLevels {
+                TreeLevels(torch::Tensor parents, torch::Device device) {
+                    auto parents_a = parents.accessor<int64_t, 1>();
+                    std::vector<int64_t> node_levels(parents.size(0));
+                    std::vector<std::vector<int64_t>> level_nodes;
+                    std::vector<std::vector<int64_t>> level_parents;
+                    for (int64_t node_index = 0; node_index < parents.size(0); ++node_index) {
+                        int64_t parent_index = parents_a[node_index];
+                        int64_t level = (parent_index == -1) ? 0 : node_levels[parent_index] + 1;
+                        node_levels[node_index] = level;
+                        if (static_cast<int64_t>(level_nodes.size()) == level) {
+                            level_nodes.emplace_back();
+                            level_parents.emplace_back();
+                        }
+                        level_nodes[level].push_back(node_index);
+                        level_parents[level].push_back(parent_index);
+                    }
+
+                    nodes.reserve(level_nodes.size());
+                    parents_by_level.reserve(level_nodes.size());
+                    for (s_size_type level = 0; level < static_cast<s_size_type>(level_nodes.size()); ++level) {
+                        nodes.push_back(to_tensor(level_nodes[level], device));
+                        parents_by_level.push_back(to_tensor(level_parents[level], device));
+                    }
+                }
+
+                // nodes[level] is the indices of the nodes at that level.
+                std::vector<torch::Tensor> nodes;
+                // parents_by_level[level] is the indices of the parents of those nodes. (Which are all -1 at level 0.)
+                std::vector<torch::Tensor> parents_by_level;
+            private:
+                static torch::Tensor to_tensor(const std::vector<int64_t>& indices, torch::Device device) {
+                    torch::Tensor out = torch::empty({static_cast<int64_t>(indices.size())},
+                                                     torch::TensorOptions().dtype(torch::kLong));
+                    std::copy(indices.begin(), indices.end(), out.data<int64_t>());
+                    return out.to(device);
+                }
+            };
+        }  // namespace signatory::tree::detail
+    }  // namespace signatory::tree
+
+    torch::Tensor signature_tree_forward(torch::Tensor increments, torch::Tensor parents, s_size_type depth) {
+        tree::detail::tree_checkargs(increments, parents, depth);
+
+        increments = increments.detach();
+        tree::detail::TreeLevels levels(parents, increments.device());
+
+        int64_t num_nodes = increments.size(stream_dim);
+        int64_t batch_size = increments.size(batch_dim);
+        int64_t input_channel_size = increments.size(channel_dim);
+        int64_t output_channel_size = signature_channels(input_channel_size, depth);
+        torch::TensorOptions opts = misc::make_opts(increments);
+        torch::Tensor reciprocals = misc::make_reciprocals(depth, opts);
+
+        torch::Tensor signature = torch::empty({num_nodes, batch_size, output_channel_size}, opts);
+        for (s_size_type level = 0; level < static_cast<s_size_type>(levels.nodes.size()); ++level) {
+            torch::Tensor nodes = levels.nodes[level];
+            int64_t level_size = nodes.size(0);
+            torch::Tensor next = increments.index_select(/*dim=*/0, nodes).view({level_size * batch_size,
+                                                                                 input_channel_size});
+            torch::Tensor signature_at_level;
+            std::vector<torch::Tensor> signature_at_level_by_term;
+            if (level == 0) {
+                signature_at_level = torch::empty({level_size * batch_size, output_channel_size}, opts);
+                misc::slice_by_term(signature_at_level, signature_at_level_by_term, input_channel_size, depth);
+                ta_ops::restricted_exp(next, signature_at_level_by_term, reciprocals);
+            }
+            else {
+                // Each node is a single step on from its parent, which has already been computed at the previous
+                // level.
+                signature_at_level = signature.index_select(/*dim=*/0, levels.parents_by_level[level]).view(
+                        {level_size * batch_size, output_channel_size});
+                misc::slice_by_term(signature_at_level, signature_at_level_by_term, input_channel_size, depth);
+                ta_ops::mult_fused_restricted_exp(next, signature_at_level_by_term, /*inverse=*/false, reciprocals);
+            }
+            signature.index_copy_(/*dim=*/0, nodes, signature_at_level.view({level_size, batch_size,
+                                                                             output_channel_size}));
+        }
+        return signature;
+    }
+
+    torch::Tensor signature_tree_backward(torch::Tensor grad_signature, torch::Tensor signature,
+                                          torch::Tensor increments, torch::Tensor parents, s_size_type depth) {
+        // Cloned as the gradients through each node are accumulated onto its parent as we go.
+        grad_signature = grad_signature.detach().clone();
+        signature = signature.detach();
+        increments = increments.detach();
+        tree::detail::TreeLevels levels(parents, increments.device());
+
+        int64_t batch_size = increments.size(batch_dim);
+        int64_t input_channel_size = increments.size(channel_dim);
+        int64_t output_channel_size = signature.size(channel_dim);
+        torch::TensorOptions opts = misc::make_opts(increments);
+        torch::Tensor reciprocals = misc::make_reciprocals(depth, opts);
+
+        torch::Tensor grad_increments = torch::empty_like(increments);
+        for (s_size_type level = static_cast<s_size_type>(levels.nodes.size()) - 1; level >= 0; --level) {
+            torch::Tensor nodes = levels.nodes[level];
+            int64_t level_size = nodes.size(0);
+            torch::Tensor next = increments.index_select(/*dim=*/0, nodes).view({level_size * batch_size,
+                                                                                 input_channel_size});
+            torch::Tensor grad_next = torch::empty({level_size * batch_size, input_channel_size}, opts);
+            // By now every child of these nodes has had its gradient accumulated on to them.
+            torch::Tensor grad_signature_at_level = grad_signature.index_select(/*dim=*/0, nodes).view(
+                    {level_size * batch_size, output_channel_size});
+            std::vector<torch::Tensor> grad_signature_at_level_by_term;
+            misc::slice_by_term(grad_signature_at_level, grad_signature_at_level_by_term, input_channel_size, depth);
+            if (level == 0) {
+                torch::Tensor signature_at_level = signature.index_select(/*dim=*/0, nodes).view(
+                        {level_size * batch_size, output_channel_size});
+                std::vector<torch::Tensor> signature_at_level_by_term;
+                misc::slice_by_term(signature_at_level, signature_at_level_by_term, input_channel_size, depth);
+                ta_ops::restricted_exp_backward(grad_next, grad_signature_at_level_by_term, next,
+                                                signature_at_level_by_term, reciprocals);
+            }
+            else {
+                torch::Tensor level_parents = levels.parents_by_level[level];
+                torch::Tensor prev = signature.index_select(/*dim=*/0, level_parents).view(
+                        {level_size * batch_size, output_channel_size});
+                std::vector<torch::Tensor> prev_by_term;
+                misc::slice_by_term(prev, prev_by_term, input_channel_size, depth);
+                ta_ops::mult_fused_restricted_exp_backward(grad_next, grad_signature_at_level_by_term, next,
+                                                           prev_by_term, /*inverse=*/false, reciprocals);
+                // grad_signature_at_level now holds the gradient with respect to the parents. Several nodes may share
+                // a parent, which index_add_ correctly accumulates.
+                grad_signature.index_add_(/*dim=*/0, level_parents,
+                                          grad_signature_at_level.view({level_size, batch_size,
+                                                                        output_channel_size}));
+            }
+            grad_increments.index_copy_(/*dim=*/0, nodes, grad_next.view({level_size, batch_size,
+                                                                          input_channel_size}));
+        }
+        return grad_increments;
+    }
+}  // namespace signatory
@@ -0,0 +1,39 @@
+/* Copyright 2019 Patrick Kidger. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ========================================================================= */
+ // Here we handle computing the signatures of every node of a tree of paths, where each path shares its prefix with
+ // its parent.
+
+
+#ifndef SIGNATORY_TREE_HPP
+#define SIGNATORY_TREE_HPP
+
+#include <torch/extension.h>
+
+#include "misc.hpp"
+
+namespace signatory {
+    // See signatory.signature_tree for documentation.
+    // 'increments' should be of shape (nodes, batch, channel). 'parents' should be a one-dimensional int64 tensor on
+    // the CPU, with one entry per node, each of which is either -1 or the index of an earlier node.
+    // Returns a tensor of shape (nodes, batch, signature_channels).
+    torch::Tensor signature_tree_forward(torch::Tensor increments, torch::Tensor parents, s_size_type depth);
+
+    // See signatory.signature_tree for documentation.
+    // 'signature' should be as returned by signature_tree_forward. Returns the gradient with respect to 'increments'.
+    torch::Tensor signature_tree_backward(torch::Tensor grad_signature, torch::Tensor signature,
+                                          torch::Tensor increments, torch::Tensor parents, s_size_type depth);
+}  // namespace signatory
+
+#endif //SIGNATORY_TREE_HPP
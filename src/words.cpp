@@ -0,0 +1,345 @@
+/* Copyright 2019 Patrick Kidger. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ========================================================================= */
+ // Here we handle computing just some of the coordinates of the signature, as specified by a collection of words.
+
+
+#include <torch/extension.h>
+#include <algorithm>  // std::fill, std::max, std::min
+#include <cstdint>    // int64_t
+#include <map>        // std::map
+#include <omp.h>
+#include <stdexcept>  // std::invalid_argument
+#include <tuple>      // std::tuple
+#include <utility>    // std::pair
+#include <vector>     // std::vector
+
+#include "misc.hpp"
+#include "signature.hpp"
+#include "words.hpp"
+
+
+namespace signatory {
+    namespace words {
+        namespace detail {
+            // The coordinate of the signature corresponding to a word w = a_1 ... a_n only depends upon the
+            // coordinates corresponding to the prefixes of w. In particular multiplying by the exponential of an
+            // increment x gives
+            // S(w) -> \sum_{j = 0}^n S(a_1 ... a_j) x_{a_{j + 1}} ... x_{a_n} / (n - j)!
+            // (where the coordinate of the empty word is one). So we only have to keep track of the coordinates
+            // corresponding to the set of all prefixes of the requested words, which we store as a trie.
+            // The sum above is then evaluated by Horner's method:
+            // h_0 = 1, h_j = h_{j - 1} x_{a_j} / (n - j + 1) + S(a_1 ... a_j), and S(w) -> h_n.
+            struct WordTrie {
+                WordTrie(const std::vector<std::vector<int64_t>>& words) {
+                    std::map<std::pair<int64_t, int64_t>, int64_t> children;
+                    max_length = 0;
+                    for (const auto& word : words) {
+                        int64_t node = -1;  // the empty word
+                        std::vector<int64_t> chain;
+                        for (auto letter : word) {
+                            auto found = children.find({node, letter});
+                            if (found == children.end()) {
+                                // Note that this means that every node comes after its prefixes.
+                                int64_t new_node = letters.size();
+                                letters.push_back(letter);
+                                chains.push_back(chain);
+                                chains.back().push_back(new_node);
+                                children[{node, letter}] = new_node;
+                                node = new_node;
+                            }
+                            else {
+                                node = found->second;
+                            }
+                            chain.push_back(node);
+                        }
+                        outputs.push_back(node);
+                        max_length = std::max(max_length, static_cast<int64_t>(word.size()));
+                    }
+                }
+
+                int64_t size() const { return letters.size(); }
+
+                // The last letter of the word corresponding to each node.
+                std::vector<int64_t> letters;
+                // The nodes corresponding to every nonempty prefix of the word corresponding to each node, in order of
+                // increasing length. (So the last element is the node itself.)
+                std::vector<std::vector<int64_t>> chains;
+                // The node corresponding to each requested word.
+                std::vector<int64_t> outputs;
+                int64_t max_length;
+            };
+
+            void words_checkargs(torch::Tensor path, const std::vector<std::vector<int64_t>>& words, bool basepoint,
+                                 torch::Tensor basepoint_value) {
+                if (words.empty()) {
+                    throw std::invalid_argument("Argument 'words' must contain at least one word.");
+                }
+                s_size_type max_length = 0;
+                for (const auto& word : words) {
+                    if (word.empty()) {
+                        throw std::invalid_argument("Argument 'words' cannot contain the empty word.");
+                    }
+                    max_length = std::max(max_length, static_cast<s_size_type>(word.size()));
+                }
+                signature_checkargs(path, max_length, basepoint, basepoint_value, /*initial=*/false, torch::Tensor{},
+                                    /*time_channel=*/false, /*lead_lag=*/false);
+                if (path.is_cuda()) {
+                    throw std::invalid_argument("signature_words is only supported on the CPU.");
+                }
+                int64_t input_channel_size = path.size(channel_dim);
+                for (const auto& word : words) {
+                    for (auto letter : word) {
+                        if (letter < 0 || letter >= input_channel_size) {
+                            throw std::invalid_argument("Every letter of every word in argument 'words' must be in the "
+                                                        "range [0, channels).");
+                        }
+                    }
+                }
+            }
+
+            int64_t words_threads(int64_t batch_size) {
+                int64_t num_threads = std::min({static_cast<int64_t>(omp_get_max_threads()), get_max_parallelism(),
+                                                batch_size});
+                return std::max(num_threads, static_cast<int64_t>(1));
+            }
+
+            // Multiplies the (pruned) signature 'state' by exp(sign * increment), in-place.
+            template <typename scalar_t>
+            void words_step_forward(const WordTrie& trie, const scalar_t* increment, scalar_t sign,
+                                    const std::vector<scalar_t>& reciprocals, std::vector<scalar_t>& state) {
+                // Iterating backwards means that the prefixes of each word have not yet been updated.
+                for (int64_t node = trie.size() - 1; node >= 0; --node) {
+                    const std::vector<int64_t>& chain = trie.chains[node];
+                    int64_t length = chain.size();
+                    scalar_t horner = 1;
+                    for (int64_t j = 0; j < length; ++j) {
+                        horner = horner * sign * increment[trie.letters[chain[j]]] * reciprocals[length - j] +
+                                 state[chain[j]];
+                    }
+                    state[node] = horner;
+                }
+            }
+
+            // The backward pass through words_step_forward (with sign == 1). 'state' should be the state before the
+            // step. Writes the gradient with respect to the state before the step into 'grad_prev_state', which
+            // should be zeroed before calling, and accumulates the gradient with respect to the increment into
+            // 'grad_increment'. 'scratch' is used to hold the intermediate values of Horner's method.
+            template <typename scalar_t>
+            void words_step_backward(const WordTrie& trie, const scalar_t* increment,
+                                     const std::vector<scalar_t>& reciprocals, const std::vector<scalar_t>& state,
+                                     const std::vector<scalar_t>& grad_state, std::vector<scalar_t>& grad_prev_state,
+                                     scalar_t* grad_increment, std::vector<scalar_t>& scratch) {
+                for (int64_t node = 0; node < trie.size(); ++node) {
+                    scalar_t grad = grad_state[node];
+                    if (grad == 0) {
+                        continue;
+                    }
+                    const std::vector<int64_t>& chain = trie.chains[node];
+                    int64_t length = chain.size();
+                    // Recompute Horner's method
+                    scalar_t horner = 1;
+                    for (int64_t j = 0; j < length; ++j) {
+                        scratch[j] = horner;
+                        horner = horner * increment[trie.letters[chain[j]]] * reciprocals[length - j] +
+                                 state[chain[j]];
+                    }
+                    // And go backwards through it
+                    for (int64_t j = length - 1; j >= 0; --j) {
+                        int64_t letter = trie.letters[chain[j]];
+                        grad_prev_state[chain[j]] += grad;
+                        grad_increment[letter] += grad * scratch[j] * reciprocals[length - j];
+                        grad *= increment[letter] * reciprocals[length - j];
+                    }
+                }
+            }
+
+            template <typename scalar_t>
+            std::vector<scalar_t> words_reciprocals(const WordTrie& trie) {
+                std::vector<scalar_t> reciprocals(trie.max_length + 1);
+                for (int64_t index = 1; index <= trie.max_length; ++index) {
+                    reciprocals[index] = static_cast<scalar_t>(1) / index;
+                }
+                return reciprocals;
+            }
+
+            template <typename scalar_t>
+            void words_forward_cpu(torch::Tensor path_increments, const WordTrie& trie, bool stream,
+                                   torch::Tensor signature) {
+                int64_t output_stream_size = path_increments.size(stream_dim);
+                int64_t batch_size = path_increments.size(batch_dim);
+                int64_t input_channel_size = path_increments.size(channel_dim);
+                int64_t num_words = trie.outputs.size();
+                const scalar_t* path_increments_data = path_increments.data<scalar_t>();
+                scalar_t* signature_data = signature.data<scalar_t>();
+                std::vector<scalar_t> reciprocals = words_reciprocals<scalar_t>(trie);
+
+                int64_t num_threads = words_threads(batch_size);
+                std::vector<std::vector<scalar_t>> state_by_thread(num_threads, std::vector<scalar_t>(trie.size()));
+
+                #pragma omp parallel for default(none) \
+                                         if(num_threads > 1) \
+                                         num_threads(num_threads) \
+                                         schedule(static) \
+                                         shared(output_stream_size, batch_size, input_channel_size, num_words, \
+                                                path_increments_data, signature_data, reciprocals, state_by_thread, \
+                                                trie, stream)
+                for (int64_t batch_index = 0; batch_index < batch_size; ++batch_index) {
+                    std::vector<scalar_t>& state = state_by_thread[omp_get_thread_num()];
+                    std::fill(state.begin(), state.end(), 0);
+                    for (int64_t stream_index = 0; stream_index < output_stream_size; ++stream_index) {
+                        words_step_forward<scalar_t>(trie, path_increments_data +
+                                                           (stream_index * batch_size + batch_index) *
+                                                           input_channel_size,
+                                                     1, reciprocals, state);
+                        if (stream || stream_index == output_stream_size - 1) {
+                            scalar_t* signature_at_index = signature_data +
+                                                           ((stream ? stream_index * batch_size : 0) + batch_index) *
+                                                           num_words;
+                            for (int64_t word_index = 0; word_index < num_words; ++word_index) {
+                                signature_at_index[word_index] = state[trie.outputs[word_index]];
+                            }
+                        }
+                    }
+                }
+            }
+
+            template <typename scalar_t>
+            void words_backward_cpu(torch::Tensor grad_signature, torch::Tensor path_increments, const WordTrie& trie,
+                                    bool stream, torch::Tensor grad_path_increments) {
+                int64_t output_stream_size = path_increments.size(stream_dim);
+                int64_t batch_size = path_increments.size(batch_dim);
+                int64_t input_channel_size = path_increments.size(channel_dim);
+                int64_t num_words = trie.outputs.size();
+                const scalar_t* path_increments_data = path_increments.data<scalar_t>();
+                const scalar_t* grad_signature_data = grad_signature.data<scalar_t>();
+                scalar_t* grad_path_increments_data = grad_path_increments.data<scalar_t>();
+                std::vector<scalar_t> reciprocals = words_reciprocals<scalar_t>(trie);
+
+                int64_t num_threads = words_threads(batch_size);
+                std::vector<std::vector<scalar_t>> state_by_thread(num_threads, std::vector<scalar_t>(trie.size()));
+                std::vector<std::vector<scalar_t>> grad_state_by_thread(num_threads,
+                                                                        std::vector<scalar_t>(trie.size()));
+                std::vector<std::vector<scalar_t>> grad_prev_state_by_thread(num_threads,
+                                                                             std::vector<scalar_t>(trie.size()));
+                std::vector<std::vector<scalar_t>> scratch_by_thread(num_threads,
+                                                                     std::vector<scalar_t>(trie.max_length));
+
+                #pragma omp parallel for default(none) \
+                                         if(num_threads > 1) \
+                                         num_threads(num_threads) \
+                                         schedule(static) \
+                                         shared(output_stream_size, batch_size, input_channel_size, num_words, \
+                                                path_increments_data, grad_signature_data, grad_path_increments_data, \
+                                                reciprocals, state_by_thread, grad_state_by_thread, \
+                                                grad_prev_state_by_thread, scratch_by_thread, trie, stream)
+                for (int64_t batch_index = 0; batch_index < batch_size; ++batch_index) {
+                    int64_t thread_index = omp_get_thread_num();
+                    std::vector<scalar_t>& state = state_by_thread[thread_index];
+                    std::vector<scalar_t>& grad_state = grad_state_by_thread[thread_index];
+                    std::vector<scalar_t>& grad_prev_state = grad_prev_state_by_thread[thread_index];
+
+                    auto increment_at = [&] (int64_t stream_index) {
+                        return path_increments_data + (stream_index * batch_size + batch_index) * input_channel_size;
+                    };
+                    auto add_grad_signature = [&] (int64_t stream_index) {
+                        const scalar_t* grad_signature_at_index = grad_signature_data +
+                                                                  ((stream ? stream_index * batch_size : 0) +
+                                                                   batch_index) * num_words;
+                        for (int64_t word_index = 0; word_index < num_words; ++word_index) {
+                            grad_state[trie.outputs[word_index]] += grad_signature_at_index[word_index];
+                        }
+                    };
+
+                    // Recompute the signature of the whole path
+                    std::fill(state.begin(), state.end(), 0);
+                    for (int64_t stream_index = 0; stream_index < output_stream_size; ++stream_index) {
+                        words_step_forward<scalar_t>(trie, increment_at(stream_index), 1, reciprocals, state);
+                    }
+
+                    std::fill(grad_state.begin(), grad_state.end(), 0);
+                    add_grad_signature(output_stream_size - 1);
+                    for (int64_t stream_index = output_stream_size - 1; stream_index >= 0; --stream_index) {
+                        // Recover the signature of the path up to this increment, via the reversibility property of the
+                        // signature. (Except for the very first increment, where we know that it is the identity.)
+                        if (stream_index == 0) {
+                            std::fill(state.begin(), state.end(), 0);
+                        }
+                        else {
+                            words_step_forward<scalar_t>(trie, increment_at(stream_index), -1, reciprocals, state);
+                        }
+                        std::fill(grad_prev_state.begin(), grad_prev_state.end(), 0);
+                        words_step_backward<scalar_t>(trie, increment_at(stream_index), reciprocals, state,
+                                                      grad_state, grad_prev_state,
+                                                      grad_path_increments_data +
+                                                      (stream_index * batch_size + batch_index) * input_channel_size,
+                                                      scratch_by_thread[thread_index]);
+                        grad_state.swap(grad_prev_state);
+                        if (stream && stream_index > 0) {
+                            add_grad_signature(stream_index - 1);
+                        }
+                    }
+                }
+            }
+        }  // namespace signatory::words::detail
+    }  // namespace signatory::words
+
+    torch::Tensor signature_words_forward(torch::Tensor path, std::vector<std::vector<int64_t>> words, bool stream,
+                                          bool basepoint, torch::Tensor basepoint_value) {
+        words::detail::words_checkargs(path, words, basepoint, basepoint_value);
+
+        path = path.detach();
+        basepoint_value = basepoint_value.detach();
+
+        torch::Tensor path_increments = signature::detail::compute_path_increments(path, basepoint, basepoint_value,
+                                                                                   /*inverse=*/false).contiguous();
+        words::detail::WordTrie trie(words);
+        int64_t batch_size = path_increments.size(batch_dim);
+        int64_t output_stream_size = path_increments.size(stream_dim);
+        int64_t num_words = words.size();
+
+        torch::Tensor signature;
+        if (stream) {
+            signature = torch::empty({output_stream_size, batch_size, num_words}, misc::make_opts(path));
+        }
+        else {
+            signature = torch::empty({batch_size, num_words}, misc::make_opts(path));
+        }
+        AT_DISPATCH_FLOATING_TYPES(path.type(), "signature_words_forward", ([&] {
+            words::detail::words_forward_cpu<scalar_t>(path_increments, trie, stream, signature);
+        }));
+        return signature;
+    }
+
+    std::tuple<torch::Tensor, torch::Tensor>
+    signature_words_backward(torch::Tensor grad_signature, torch::Tensor path, std::vector<std::vector<int64_t>> words,
+                             bool stream, bool basepoint, torch::Tensor basepoint_value) {
+        grad_signature = grad_signature.detach().contiguous();
+        path = path.detach();
+        basepoint_value = basepoint_value.detach();
+
+        torch::Tensor path_increments = signature::detail::compute_path_increments(path, basepoint, basepoint_value,
+                                                                                   /*inverse=*/false).contiguous();
+        words::detail::WordTrie trie(words);
+
+        torch::Tensor grad_path_increments = torch::zeros_like(path_increments);
+        AT_DISPATCH_FLOATING_TYPES(path.type(), "signature_words_backward", ([&] {
+            words::detail::words_backward_cpu<scalar_t>(grad_signature, path_increments, trie, stream,
+                                                        grad_path_increments);
+        }));
+
+        return signature::detail::compute_path_increments_backward(grad_path_increments, basepoint,
+                                                                    /*inverse=*/false, misc::make_opts(path));
+    }
+}  // namespace signatory
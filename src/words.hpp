@@ -0,0 +1,40 @@
+/* Copyright 2019 Patrick Kidger. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ * ========================================================================= */
+ // Here we handle computing just some of the coordinates of the signature, as specified by a collection of words.
+
+
+#ifndef SIGNATORY_WORDS_HPP
+#define SIGNATORY_WORDS_HPP
+
+#include <torch/extension.h>
+#include <cstdint>    // int64_t
+#include <tuple>      // std::tuple
+#include <vector>     // std::vector
+
+namespace signatory {
+    // See signatory.signature_words for documentation. Only supported on the CPU.
+    // 'path' should be of shape (stream, batch, channel). Each of 'words' should be a nonempty list of integers in the
+    // range [0, channel). Returns a tensor of shape (batch, words), or (stream, batch, words) if stream==true.
+    torch::Tensor signature_words_forward(torch::Tensor path, std::vector<std::vector<int64_t>> words, bool stream,
+                                          bool basepoint, torch::Tensor basepoint_value);
+
+    // See signatory.signature_words for documentation.
+    // Returns the gradients with respect to the path and the basepoint.
+    std::tuple<torch::Tensor, torch::Tensor>
+    signature_words_backward(torch::Tensor grad_signature, torch::Tensor path, std::vector<std::vector<int64_t>> words,
+                             bool stream, bool basepoint, torch::Tensor basepoint_value);
+}  // namespace signatory
+
+#endif //SIGNATORY_WORDS_HPP
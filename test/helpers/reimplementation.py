@@ -71,3 +71,26 @@ def iisignature_signature_or_logsignature(fn, path, depth, stream, basepoint, in
         result = fn(iisignature_path, depth)
 
     return result
+
+
+def augment(path, basepoint, time_channel, lead_lag):
+    """Explicitly constructs the path whose signature is computed by signatory.signature(..., time_channel=...,
+    lead_lag=...). The basepoint (if any) is included as the first point of the returned path."""
+
+    batch_size, input_stream, input_channels = path.shape
+
+    if basepoint is True:
+        path = torch.cat([torch.zeros(batch_size, 1, input_channels, device=path.device, dtype=path.dtype), path],
+                         dim=1)
+    elif isinstance(basepoint, torch.Tensor):
+        path = torch.cat([basepoint.unsqueeze(1), path], dim=1)
+
+    if lead_lag:
+        repeated = path.repeat_interleave(2, dim=1)
+        path = torch.cat([repeated[:, 1:], repeated[:, :-1]], dim=2)
+
+    if time_channel:
+        time = torch.linspace(0, 1, path.size(1), device=path.device, dtype=path.dtype)
+        path = torch.cat([time.unsqueeze(0).unsqueeze(2).expand(batch_size, path.size(1), 1), path], dim=2)
+
+    return path
@@ -113,7 +113,8 @@ def validate_tests(tests, depends):
         last = len(split_string) - 1
         for i, string_elem in enumerate(split_string):
             obj = getattr(obj, string_elem)
-            obj_mock_new = argparse.Namespace()
+            # Reuse the mock namespace if we've already created one, e.g. for 'unstable.x' and 'unstable.y'
+            obj_mock_new = getattr(obj_mock, string_elem, argparse.Namespace())
             setattr(obj_mock, string_elem, obj if i == last else obj_mock_new)
             obj_mock = obj_mock_new
     return signatory_mock
@@ -0,0 +1,84 @@
+# Copyright 2019 Patrick Kidger. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# =========================================================================
+"""Tests the SignatureAccumulator class."""
+
+
+import pytest
+import random
+import torch
+
+from helpers import helpers as h
+from helpers import validation as v
+
+
+tests = ['SignatureAccumulator']
+depends = ['signature', 'logsignature']
+signatory = v.validate_tests(tests, depends)
+
+
+def test_accumulator():
+    """Tests that the accumulator agrees with computing the signature of the whole stream so far."""
+    for device in h.get_devices():
+        for dtype in (torch.float, torch.double):
+            for batch_size, input_channels in ((1, 1), (2, 3), (5, 2)):
+                for depth in (1, 2, 4):
+                    path = torch.rand(batch_size, 12, input_channels, device=device, dtype=dtype)
+                    accumulator = signatory.SignatureAccumulator(path[:, 0], depth)
+                    assert accumulator.depth == depth
+                    assert accumulator.channels() == input_channels
+                    length = 1
+                    while length < path.size(1):
+                        # Alternate between pushing single points and several points at once
+                        if random.choice([False, True]):
+                            accumulator.push(path[:, length])
+                            length += 1
+                        else:
+                            num_points = random.randint(1, path.size(1) - length)
+                            accumulator.push(path[:, length:length + num_points])
+                            length += num_points
+
+                        atol = 1e-8 if dtype == torch.double else 1e-5
+                        signature = accumulator.signature()
+                        true_signature = signatory.signature(path[:, :length], depth)
+                        assert signature.shape == (batch_size, accumulator.signature_channels())
+                        h.diff(signature, true_signature, atol=atol)
+                        for mode in h.all_modes:
+                            logsignature = accumulator.logsignature(mode=mode)
+                            true_logsignature = signatory.logsignature(path[:, :length], depth, mode=mode)
+                            h.diff(logsignature, true_logsignature, atol=atol)
+
+
+def test_signature_not_aliased():
+    """Tests that the returned signature is not modified by later pushes."""
+    path = torch.rand(2, 3, 2, dtype=torch.double)
+    accumulator = signatory.SignatureAccumulator(path[:, 0], 3)
+    accumulator.push(path[:, 1])
+    signature = accumulator.signature()
+    signature_copy = signature.clone()
+    accumulator.push(path[:, 2])
+    h.diff(signature, signature_copy)
+
+
+def test_errors():
+    """Tests that invalid arguments are caught."""
+    point = torch.rand(2, 3)
+    with pytest.raises(ValueError):
+        signatory.SignatureAccumulator(torch.rand(2, 4, 3), 3)
+    with pytest.raises(ValueError):
+        signatory.SignatureAccumulator(point, 0)
+    accumulator = signatory.SignatureAccumulator(point, 3)
+    for points in (torch.rand(3, 3), torch.rand(2, 4), torch.rand(2, 3, dtype=torch.double), torch.rand(3)):
+        with pytest.raises(ValueError):
+            accumulator.push(points)
@@ -0,0 +1,113 @@
+# Copyright 2019 Patrick Kidger. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# =========================================================================
+"""Tests the expected_signature function."""
+
+
+import gc
+import pytest
+import torch
+from torch import autograd
+import weakref
+
+from helpers import helpers as h
+from helpers import validation as v
+
+
+tests = ['expected_signature']
+depends = ['signature']
+signatory = v.validate_tests(tests, depends)
+
+
+def test_forward():
+    """Tests that the expected signature agrees with the mean of the signatures."""
+    for dtype in (torch.float, torch.double):
+        for batch_size in (1, 5, 150):
+            for stream_size in (2, 6):
+                for channels in (1, 3):
+                    for depth in (1, 2, 4):
+                        for stream in (False, True):
+                            for basepoint in (False, True, h.without_grad):
+                                path = torch.rand(batch_size, stream_size, channels, dtype=dtype)
+                                basepoint_value = h.get_basepoint(batch_size, channels, 'cpu', basepoint)
+                                if isinstance(basepoint_value, torch.Tensor):
+                                    basepoint_value = basepoint_value.to(dtype)
+                                expected_signature = signatory.expected_signature(path, depth, stream,
+                                                                                  basepoint_value)
+                                true_expected_signature = signatory.signature(path, depth, stream,
+                                                                              basepoint_value).mean(0)
+                                assert expected_signature.shape == true_expected_signature.shape
+                                atol = 1e-8 if dtype == torch.double else 1e-4
+                                h.diff(expected_signature, true_expected_signature, atol=atol)
+
+
+def test_backward():
+    """Tests that the gradients agree with those through the mean of the signatures."""
+    for batch_size in (1, 4, 150):
+        for stream_size in (2, 5):
+            for channels in (1, 3):
+                for depth in (1, 2, 4):
+                    for stream in (False, True):
+                        for basepoint in (False, True, h.with_grad):
+                            path = torch.rand(batch_size, stream_size, channels, dtype=torch.double,
+                                              requires_grad=True)
+                            basepoint_value = h.get_basepoint(batch_size, channels, 'cpu', basepoint)
+                            expected_signature = signatory.expected_signature(path, depth, stream, basepoint_value)
+                            grad = torch.rand_like(expected_signature)
+                            expected_signature.backward(grad)
+                            path_grad = path.grad.clone()
+                            path.grad.zero_()
+                            if basepoint is h.with_grad:
+                                basepoint_grad = basepoint_value.grad.clone()
+                                basepoint_value.grad.zero_()
+
+                            signatory.signature(path, depth, stream, basepoint_value).mean(0).backward(grad)
+                            h.diff(path_grad, path.grad)
+                            if basepoint is h.with_grad:
+                                h.diff(basepoint_grad, basepoint_value.grad)
+
+
+def test_gradcheck():
+    """Tests the gradients with finite differences."""
+    for stream in (False, True):
+        path = torch.rand(3, 4, 2, dtype=torch.double, requires_grad=True)
+        try:
+            autograd.gradcheck(lambda x: signatory.expected_signature(x, 3, stream), (path,))
+        except RuntimeError:
+            pytest.fail()
+
+
+def test_memory_leaks():
+    """Tests that the saved tensors are freed along with the graph."""
+    path = torch.rand(4, 5, 2, requires_grad=True)
+    expected_signature = signatory.expected_signature(path, 3)
+    ref = weakref.ref(expected_signature.grad_fn)
+    del expected_signature
+    gc.collect()
+    assert ref() is None
+
+
+def test_errors():
+    """Tests that invalid arguments are caught."""
+    with pytest.raises(ValueError):
+        signatory.expected_signature(torch.rand(4, 5, 2), 0)
+    with pytest.raises(ValueError):
+        signatory.expected_signature(torch.rand(4, 1, 2), 2)
+    with pytest.raises(ValueError):
+        signatory.expected_signature(torch.rand(5, 2), 2)
+    with pytest.raises(ValueError):
+        signatory.expected_signature(torch.rand(4, 5, 2), 2, basepoint=torch.rand(3, 2))
+    if torch.cuda.is_available():
+        with pytest.raises(ValueError):
+            signatory.expected_signature(torch.rand(4, 5, 2).cuda(), 2)
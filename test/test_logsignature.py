@@ -210,7 +210,11 @@ def _test_forward(class_, device, path_grad, batch_size, input_stream, input_cha
         ctx = logsignature.grad_fn
         if stream:
             ctx = ctx.next_functions[0][0]
-        assert type(ctx).__name__ == '_SignatureToLogsignatureFunctionBackward'
+        if stream and device == 'cpu':
+            # Computed by the fused signature+logarithm operation
+            assert type(ctx).__name__ == '_LogSignatureFunctionBackward'
+        else:
+            assert type(ctx).__name__ == '_SignatureToLogsignatureFunctionBackward'
         ref = weakref.ref(ctx)
         del ctx
         del logsignature
@@ -307,6 +311,83 @@ def _test_backward(class_, device, batch_size, input_stream, input_channels, dep
         h.diff(basepoint.grad, basepoint_grad, atol=1e-6)
 
 
+def test_fused():
+    """Tests that the logsignature computed by the fused signature+logarithm operation (used when stream=True on the
+    CPU) agrees with the logsignature computed via the whole signature (used when stream=False)."""
+    for batch_size, input_stream, input_channels, basepoint in h.random_sizes_and_basepoint():
+        for depth in (1, 2, 4):
+            for mode in h.all_modes:
+                inverse = random.choice([False, True])
+                path = h.get_path(batch_size, input_stream, input_channels, 'cpu', path_grad=True)
+                basepoint = h.get_basepoint(batch_size, input_channels, 'cpu', basepoint)
+                basepoint_grad = isinstance(basepoint, torch.Tensor) and basepoint.requires_grad
+
+                logsignature = signatory.logsignature(path, depth, stream=True, basepoint=basepoint, inverse=inverse,
+                                                      mode=mode)[:, -1]
+                grad = torch.rand_like(logsignature)
+                logsignature.backward(grad)
+                path_grad = path.grad.clone()
+                path.grad.zero_()
+                if basepoint_grad:
+                    fused_basepoint_grad = basepoint.grad.clone()
+                    basepoint.grad.zero_()
+
+                true_logsignature = signatory.logsignature(path, depth, stream=False, basepoint=basepoint,
+                                                           inverse=inverse, mode=mode)
+                h.diff(logsignature, true_logsignature)
+                true_logsignature.backward(grad)
+                h.diff(path_grad, path.grad)
+                if basepoint_grad:
+                    h.diff(fused_basepoint_grad, basepoint.grad)
+
+
+def test_augmentation():
+    """Tests that the time_channel and lead_lag arguments give the logsignature of the augmented path, and the correct
+    gradients through it. (With stream=True this exercises the fused computation on the CPU.)"""
+    for class_ in (False, True):
+        for device in h.get_devices():
+            for batch_size, input_stream, input_channels, basepoint in h.random_sizes_and_basepoint():
+                for depth in (1, 2, 4):
+                    for mode in (h.expand_mode, h.words_mode):
+                        for stream in (False, True):
+                            for time_channel, lead_lag in ((True, False), (False, True), (True, True)):
+                                inverse = random.choice([False, True])
+                                _test_augmentation(class_, device, batch_size, input_stream, input_channels, depth,
+                                                   stream, basepoint, inverse, mode, time_channel, lead_lag)
+
+
+def _test_augmentation(class_, device, batch_size, input_stream, input_channels, depth, stream, basepoint, inverse,
+                       mode, time_channel, lead_lag):
+    path = h.get_path(batch_size, input_stream, input_channels, device, path_grad=True)
+    basepoint = h.get_basepoint(batch_size, input_channels, device, basepoint)
+
+    if class_:
+        logsignature = signatory.LogSignature(depth, stream=stream, inverse=inverse, mode=mode,
+                                              time_channel=time_channel, lead_lag=lead_lag)(path, basepoint=basepoint)
+    else:
+        logsignature = signatory.logsignature(path, depth, stream=stream, basepoint=basepoint, inverse=inverse,
+                                              mode=mode, time_channel=time_channel, lead_lag=lead_lag)
+
+    augmented_path = r.augment(path, basepoint, time_channel, lead_lag)
+    iisignature_logsignature_result = iisignature_logsignature(augmented_path, depth, stream, False, inverse, mode)
+    h.diff(logsignature, iisignature_logsignature_result)
+
+    grad = torch.rand_like(logsignature)
+    logsignature.backward(grad)
+    path_grad = path.grad.clone()
+    path.grad.zero_()
+    if isinstance(basepoint, torch.Tensor) and basepoint.requires_grad:
+        basepoint_grad = basepoint.grad.clone()
+        basepoint.grad.zero_()
+
+    iisignature_logsignature_result.backward(grad)
+
+    # iisignature uses float32 for this calculation so we need a lower tolerance
+    h.diff(path.grad, path_grad, atol=1e-6)
+    if isinstance(basepoint, torch.Tensor) and basepoint.requires_grad:
+        h.diff(basepoint.grad, basepoint_grad, atol=1e-6)
+
+
 def test_no_adjustments():
     """Tests that the logsignature computations don't modify any memory that they're not supposed to."""
     for class_ in (False, True):
@@ -0,0 +1,99 @@
+# Copyright 2019 Patrick Kidger. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# =========================================================================
+"""Tests the unstable.logsignature_bch function."""
+
+
+import pytest
+import random
+import torch
+
+from helpers import helpers as h
+from helpers import validation as v
+
+
+tests = ['unstable.logsignature_bch']
+depends = ['logsignature']
+signatory = v.validate_tests(tests, depends)
+
+
+def test_forward():
+    """Tests that the BCH-based logsignature agrees with the signature-based logsignature."""
+    for batch_size, input_stream, input_channels, basepoint in h.random_sizes_and_basepoint():
+        for depth in (1, 2, 3):
+            for stream in (False, True):
+                inverse = random.choice([False, True])
+                path = h.get_path(batch_size, input_stream, input_channels, 'cpu', path_grad=False)
+                basepoint = h.get_basepoint(batch_size, input_channels, 'cpu', basepoint)
+                logsignature = signatory.unstable.logsignature_bch(path, depth, stream=stream, basepoint=basepoint,
+                                                                   inverse=inverse)
+                true_logsignature = signatory.logsignature(path, depth, stream=stream, basepoint=basepoint,
+                                                           inverse=inverse, mode='words')
+                assert logsignature.shape == true_logsignature.shape
+                h.diff(logsignature, true_logsignature)
+
+
+def test_backward():
+    """Tests that the backwards operation through the BCH-based logsignature gives the correct values."""
+    for batch_size, input_stream, input_channels, basepoint in h.random_sizes_and_basepoint():
+        for depth in (1, 2, 3):
+            stream = random.choice([False, True])
+            inverse = random.choice([False, True])
+            path = h.get_path(batch_size, input_stream, input_channels, 'cpu', path_grad=True)
+            basepoint = h.get_basepoint(batch_size, input_channels, 'cpu', basepoint)
+            basepoint_grad = isinstance(basepoint, torch.Tensor) and basepoint.requires_grad
+
+            logsignature = signatory.unstable.logsignature_bch(path, depth, stream=stream, basepoint=basepoint,
+                                                               inverse=inverse)
+            grad = torch.rand_like(logsignature)
+            logsignature.backward(grad)
+            path_grad = path.grad.clone()
+            path.grad.zero_()
+            if basepoint_grad:
+                bch_basepoint_grad = basepoint.grad.clone()
+                basepoint.grad.zero_()
+
+            true_logsignature = signatory.logsignature(path, depth, stream=stream, basepoint=basepoint,
+                                                       inverse=inverse, mode='words')
+            true_logsignature.backward(grad)
+            h.diff(path_grad, path.grad)
+            if basepoint_grad:
+                h.diff(bch_basepoint_grad, basepoint.grad)
+
+
+def test_gradcheck():
+    """Tests the backwards operation against finite differences."""
+    for depth in (1, 2, 4):
+        for stream in (False, True):
+            for inverse in (False, True):
+                path = h.get_path(2, 4, 3, 'cpu', path_grad=True)
+                basepoint = h.get_basepoint(2, 3, 'cpu', h.with_grad)
+
+                def check_fn(path, basepoint):
+                    return signatory.unstable.logsignature_bch(path, depth, stream=stream, basepoint=basepoint,
+                                                               inverse=inverse)
+                assert torch.autograd.gradcheck(check_fn, (path, basepoint))
+
+
+def test_errors():
+    """Tests that invalid inputs raise errors."""
+    path = h.get_path(2, 1, 3, 'cpu', path_grad=False)
+    with pytest.raises(ValueError):
+        signatory.unstable.logsignature_bch(path, 2)
+    path = h.get_path(2, 4, 3, 'cpu', path_grad=False)
+    with pytest.raises(ValueError):
+        signatory.unstable.logsignature_bch(path, 0)
+    if torch.cuda.is_available():
+        with pytest.raises(ValueError):
+            signatory.unstable.logsignature_bch(path.cuda(), 2)
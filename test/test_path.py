@@ -53,8 +53,10 @@ def test_path():
                         path_grad = random.choice([False, True])
                         basepoint = random.choice(basepoints)
                         update_lengths, update_grads = _update_lengths_update_grads(3)
+                        storage = random.choice(['prefix', 'segment_tree'])
                         _test_path(device, path_grad, batch_size, input_stream, input_channels, depth,
-                                   basepoint, update_lengths, update_grads, extrarandom=False)
+                                   basepoint, update_lengths, update_grads, storage, checkpoint_interval=1,
+                                   extrarandom=False)
 
     # Randomly test larger cases
     for _ in range(50):
@@ -66,20 +68,33 @@ def test_path():
         basepoint = random.choice([False, True, h.without_grad, h.with_grad])
         path_grad = random.choice([False, True])
         update_lengths, update_grads = _update_lengths_update_grads(10)
+        storage = random.choice(['prefix', 'segment_tree'])
+        if storage == 'prefix':
+            checkpoint_interval = random.choice([1, 1, 2, 3, 7])
+        else:
+            checkpoint_interval = 1
         _test_path(device, path_grad, batch_size, input_stream, input_channels, depth,
-                   basepoint, update_lengths, update_grads, extrarandom=True)
+                   basepoint, update_lengths, update_grads, storage, checkpoint_interval, extrarandom=True)
 
     # Do at least one large test
     for device in h.get_devices():
-        _test_path(device, path_grad=True, batch_size=5, input_stream=10, input_channels=6, depth=6,
-                   basepoint=True, update_lengths=[5, 6], update_grads=[False, True], extrarandom=False)
+        for storage, checkpoint_interval in (('prefix', 1), ('prefix', 4), ('segment_tree', 1)):
+            _test_path(device, path_grad=True, batch_size=5, input_stream=10, input_channels=6, depth=6,
+                       basepoint=True, update_lengths=[5, 6], update_grads=[False, True], storage=storage,
+                       checkpoint_interval=checkpoint_interval, extrarandom=False)
+
+    with pytest.raises(ValueError):
+        signatory.Path(torch.rand(1, 4, 2), 2, storage='segment_tree', checkpoint_interval=2)
+    with pytest.raises(ValueError):
+        signatory.Path(torch.rand(1, 4, 2), 2, storage='not_a_storage')
 
 
 def _test_path(device, path_grad, batch_size, input_stream, input_channels, depth, basepoint, update_lengths,
-               update_grads, extrarandom):
+               update_grads, storage, checkpoint_interval, extrarandom):
     path = h.get_path(batch_size, input_stream, input_channels, device, path_grad)
     basepoint = h.get_basepoint(batch_size, input_channels, device, basepoint)
-    path_obj = signatory.Path(path, depth, basepoint=basepoint)
+    path_obj = signatory.Path(path, depth, basepoint=basepoint, storage=storage,
+                              checkpoint_interval=checkpoint_interval)
 
     if isinstance(basepoint, torch.Tensor):
         full_path = torch.cat([basepoint.unsqueeze(1), path], dim=1)
@@ -107,6 +122,239 @@ def _test_path(device, path_grad, batch_size, input_stream, input_channels, dept
         assert path_obj.depth == depth
 
 
+def test_signatures():
+    """Tests that Path.signatures agrees with Path.signature, in both the forward and backward passes."""
+    for device in h.get_devices():
+        for batch_size, input_stream, input_channels, basepoint in h.random_sizes_and_basepoint():
+            for depth in (1, 2, 4):
+                path = h.get_path(batch_size, input_stream, input_channels, device, path_grad=True)
+                basepoint = h.get_basepoint(batch_size, input_channels, device, basepoint)
+                path_obj = signatory.Path(path, depth, basepoint=basepoint)
+                length = path_obj.size(1)
+                if length < 2:
+                    continue
+
+                starts = []
+                ends = []
+                for _ in range(10):
+                    start = int(torch.randint(low=0, high=length - 1, size=(1,)))
+                    end = int(torch.randint(low=start + 2, high=length + 1, size=(1,)))
+                    # Test negative indices as well
+                    starts.append(random.choice([start, start - length]))
+                    ends.append(end)
+
+                signatures = path_obj.signatures(torch.tensor(starts), torch.tensor(ends))
+                grad = torch.rand_like(signatures)
+                signatures.backward(grad)
+                path_grad = path.grad.clone()
+                path.grad.zero_()
+
+                for i, (start, end) in enumerate(zip(starts, ends)):
+                    signature = path_obj.signature(start, end)
+                    h.diff(signatures[:, i], signature)
+                    signature.backward(grad[:, i])
+                h.diff(path_grad, path.grad)
+
+                with pytest.raises(ValueError):
+                    path_obj.signatures(torch.tensor([0]), torch.tensor([1]))
+
+
+def test_logsignatures():
+    """Tests that Path.logsignatures agrees with Path.logsignature, in both the forward and backward passes."""
+    for device in h.get_devices():
+        for batch_size, input_stream, input_channels, basepoint in h.random_sizes_and_basepoint():
+            for depth in (1, 2, 4):
+                for mode in h.all_modes:
+                    path = h.get_path(batch_size, input_stream, input_channels, device, path_grad=True)
+                    basepoint = h.get_basepoint(batch_size, input_channels, device, basepoint)
+                    path_obj = signatory.Path(path, depth, basepoint=basepoint)
+                    length = path_obj.size(1)
+                    if length < 2:
+                        continue
+
+                    starts = []
+                    ends = []
+                    for _ in range(10):
+                        start = int(torch.randint(low=0, high=length - 1, size=(1,)))
+                        end = int(torch.randint(low=start + 2, high=length + 1, size=(1,)))
+                        starts.append(random.choice([start, start - length]))
+                        ends.append(end)
+
+                    with warnings.catch_warnings():
+                        warnings.filterwarnings('ignore', message="The logsignature with mode='brackets' has been "
+                                                                  "requested on the GPU.", category=UserWarning)
+                        logsignatures = path_obj.logsignatures(torch.tensor(starts), torch.tensor(ends), mode=mode)
+                        grad = torch.rand_like(logsignatures)
+                        logsignatures.backward(grad)
+                        path_grad = path.grad.clone()
+                        path.grad.zero_()
+
+                        for i, (start, end) in enumerate(zip(starts, ends)):
+                            logsignature = path_obj.logsignature(start, end, mode=mode)
+                            h.diff(logsignatures[:, i], logsignature)
+                            logsignature.backward(grad[:, i])
+                        h.diff(path_grad, path.grad)
+
+
+def test_edit():
+    """Tests that Path.edit behaves correctly, in both the forward and backward passes."""
+    for device in h.get_devices():
+        for storage in ('prefix', 'segment_tree'):
+            for batch_size, input_stream, input_channels, _ in h.random_sizes_and_basepoint():
+                if input_stream < 2:
+                    continue
+                for depth in (1, 2, 4):
+                    path = h.get_path(batch_size, input_stream, input_channels, device, path_grad=True)
+                    path_obj = signatory.Path(path, depth, storage=storage)
+
+                    full_path = path
+                    values = []
+                    for _ in range(3):
+                        index = int(torch.randint(low=-input_stream, high=input_stream, size=(1,)))
+                        value = torch.rand(batch_size, input_channels, device=device, dtype=torch.double,
+                                           requires_grad=True)
+                        path_obj.edit(index, value)
+                        full_path = torch.cat([full_path[:, :index % input_stream], value.unsqueeze(1),
+                                               full_path[:, index % input_stream + 1:]], dim=1)
+                        values.append(value)
+
+                    for start in range(input_stream - 1):
+                        for end in range(start + 2, input_stream + 1):
+                            signature = path_obj.signature(start, end)
+                            true_signature = signatory.signature(full_path[:, start:end], depth)
+                            h.diff(signature, true_signature)
+
+                            grad = torch.rand_like(signature)
+                            signature.backward(grad)
+                            grads = [tensor.grad.clone() if tensor.grad is not None else None
+                                     for tensor in [path] + values]
+                            for tensor in [path] + values:
+                                if tensor.grad is not None:
+                                    tensor.grad.zero_()
+                            true_signature.backward(grad)
+                            for tensor, tensor_grad in zip([path] + values, grads):
+                                if tensor_grad is None:
+                                    assert (tensor.grad is None) or (tensor.grad.nonzero().numel() == 0)
+                                else:
+                                    h.diff(tensor.grad, tensor_grad)
+                                    tensor.grad.zero_()
+
+                    with pytest.raises(ValueError):
+                        path_obj.edit(input_stream, values[0].detach())
+
+
+def test_edit_between_forward_and_backward():
+    """Tests that Path doesn't allow backpropagating through a signature after editing the path."""
+    for device in h.get_devices():
+        for storage in ('prefix', 'segment_tree'):
+            for depth in (1, 2):
+                path = h.get_path(2, 4, 3, device, path_grad=True)
+                path_obj = signatory.Path(path, depth, storage=storage)
+                signature = path_obj.signature()
+                logsignature = path_obj.logsignature()
+                path_obj.edit(1, torch.rand(2, 3, device=device, dtype=torch.double))
+                with pytest.raises(RuntimeError):
+                    signature.backward(torch.rand_like(signature))
+                with pytest.raises(RuntimeError):
+                    logsignature.backward(torch.rand_like(logsignature))
+
+                # Signatures computed after the edit are unaffected.
+                signature = path_obj.signature()
+                signature.backward(torch.rand_like(signature))
+
+
+def test_max_length():
+    """Tests that Path behaves correctly when discarding old points, in both the forward and backward passes."""
+    for device in h.get_devices():
+        for storage, checkpoint_interval in (('prefix', 1), ('prefix', 3), ('segment_tree', 1)):
+            for max_length in (2, 3, 7):
+                for _ in range(5):
+                    batch_size = int(torch.randint(low=1, high=4, size=(1,)))
+                    input_channels = int(torch.randint(low=1, high=4, size=(1,)))
+                    depth = int(torch.randint(low=1, high=4, size=(1,)))
+                    path = h.get_path(batch_size, int(torch.randint(low=2, high=10, size=(1,))), input_channels,
+                                      device, path_grad=True)
+                    path_obj = signatory.Path(path, depth, storage=storage, checkpoint_interval=checkpoint_interval,
+                                              max_length=max_length)
+                    paths = [path]
+                    for _ in range(int(torch.randint(low=0, high=6, size=(1,)))):
+                        new_path = h.get_path(batch_size, int(torch.randint(low=1, high=10, size=(1,))),
+                                              input_channels, device, path_grad=True)
+                        path_obj.update(new_path)
+                        paths.append(new_path)
+                    full_path = torch.cat(paths, dim=1)[:, -max_length:]
+                    assert path_obj.shape == full_path.shape
+
+                    for start in range(full_path.size(1) - 1):
+                        for end in range(start + 2, full_path.size(1) + 1):
+                            signature = path_obj.signature(start, end)
+                            true_signature = signatory.signature(full_path[:, start:end], depth)
+                            h.diff(signature, true_signature)
+
+                            grad = torch.rand_like(signature)
+                            signature.backward(grad)
+                            grads = [tensor.grad.clone() if tensor.grad is not None else None for tensor in paths]
+                            for tensor in paths:
+                                if tensor.grad is not None:
+                                    tensor.grad.zero_()
+                            true_signature.backward(grad)
+                            for tensor, tensor_grad in zip(paths, grads):
+                                # Discarded paths get no gradient
+                                if tensor_grad is None:
+                                    assert (tensor.grad is None) or (tensor.grad.nonzero().numel() == 0)
+                                else:
+                                    h.diff(tensor.grad, tensor_grad)
+                                    tensor.grad.zero_()
+
+    with pytest.raises(ValueError):
+        signatory.Path(torch.rand(1, 4, 2), 2, max_length=1)
+
+
+def test_update_between_forward_and_backward():
+    """Tests that Path only allows backpropagating through a signature after updating the path, if no points have been
+    discarded in doing so."""
+    for device in h.get_devices():
+        for storage in ('prefix', 'segment_tree'):
+            for depth in (1, 2):
+                # Appending points doesn't affect the backward pass.
+                path = h.get_path(2, 4, 3, device, path_grad=True)
+                path_obj = signatory.Path(path, depth, storage=storage)
+                signature = path_obj.signature(1, 4)
+                logsignature = path_obj.logsignature(1, 4)
+                path_obj.update(h.get_path(2, 5, 3, device, path_grad=False))
+                true_signature = signatory.signature(path[:, 1:4], depth)
+                h.diff(signature, true_signature)
+                grad = torch.rand_like(signature)
+                signature.backward(grad)
+                path_grad = path.grad.clone()
+                path.grad.zero_()
+                true_signature.backward(grad)
+                h.diff(path_grad, path.grad)
+                path.grad.zero_()
+                logsignature.backward(torch.rand_like(logsignature))
+
+                # Discarding points moves the retained points within the buffers.
+                path = h.get_path(2, 4, 3, device, path_grad=True)
+                path_obj = signatory.Path(path, depth, storage=storage, max_length=4)
+                signature = path_obj.signature()
+                logsignature = path_obj.logsignature()
+                path_obj.update(h.get_path(2, 2, 3, device, path_grad=False))
+                with pytest.raises(RuntimeError):
+                    signature.backward(torch.rand_like(signature))
+                with pytest.raises(RuntimeError):
+                    logsignature.backward(torch.rand_like(logsignature))
+
+                # As does compacting the buffers, which happens now as there are more than 2 * max_length points.
+                signature = path_obj.signature()
+                path_obj.update(h.get_path(2, 3, 3, device, path_grad=False))
+                with pytest.raises(RuntimeError):
+                    signature.backward(torch.rand_like(signature))
+
+                # Signatures computed after the update are unaffected.
+                signature = path_obj.signature()
+                signature.backward(torch.rand_like(signature))
+
+
 def _test_signature(path_obj, full_path, depth, extrarandom):
     def candidate(start=None, end=None):
         return path_obj.signature(start, end)
@@ -120,7 +368,7 @@ def _test_signature(path_obj, full_path, depth, extrarandom):
         assert path_obj.shape == full_path.shape
         assert path_obj.channels() == full_path.size(-1)
 
-    _test_signature_or_logsignature(path_obj, candidate, true, extra, '_BackwardShortcutBackward', extrarandom)
+    _test_signature_or_logsignature(path_obj, candidate, true, extra, '_PathSignatureFunctionBackward', extrarandom)
 
 
 def _test_logsignature(path_obj, full_path, depth, extrarandom):
@@ -152,7 +400,7 @@ def _test_logsignature(path_obj, full_path, depth, extrarandom):
                         path_obj.logsignature_size(-1)) == true_logsignature.shape
                 assert path_obj.logsignature_channels() == true_logsignature.size(-1)
 
-        _test_signature_or_logsignature(path_obj, candidate, true, extra, '_SignatureToLogsignatureFunctionBackward',
+        _test_signature_or_logsignature(path_obj, candidate, true, extra, '_PathLogSignatureFunctionBackward',
                                         extrarandom)
 
 
@@ -294,6 +294,162 @@ def _test_backward(class_, device, batch_size, input_stream, input_channels, dep
         h.diff(initial.grad, initial_grad, atol=1e-4)
 
 
+def test_augmentation():
+    """Tests that the time_channel and lead_lag arguments give the signature of the augmented path, and the correct
+    gradients through it."""
+    for class_ in (False, True):
+        for device in h.get_devices():
+            for batch_size, input_stream, input_channels, basepoint in h.random_sizes_and_basepoint():
+                for depth in (1, 2, 4):
+                    for stream in (False, True):
+                        for inverse in (False, True):
+                            for time_channel, lead_lag in ((True, False), (False, True), (True, True)):
+                                _test_augmentation(class_, device, batch_size, input_stream, input_channels, depth,
+                                                   stream, basepoint, inverse, time_channel, lead_lag)
+
+
+def _test_augmentation(class_, device, batch_size, input_stream, input_channels, depth, stream, basepoint, inverse,
+                       time_channel, lead_lag):
+    path = h.get_path(batch_size, input_stream, input_channels, device, path_grad=True)
+    basepoint = h.get_basepoint(batch_size, input_channels, device, basepoint)
+
+    if class_:
+        signature = signatory.Signature(depth, stream=stream, inverse=inverse, time_channel=time_channel,
+                                        lead_lag=lead_lag)(path, basepoint=basepoint)
+    else:
+        signature = signatory.signature(path, depth, stream=stream, basepoint=basepoint, inverse=inverse,
+                                        time_channel=time_channel, lead_lag=lead_lag)
+    augmented_channels = (2 * input_channels if lead_lag else input_channels) + (1 if time_channel else 0)
+    augmented_path = r.augment(path, basepoint, time_channel, lead_lag)
+    if stream:
+        assert signature.shape == (batch_size, augmented_path.size(1) - 1,
+                                   signatory.signature_channels(augmented_channels, depth))
+    else:
+        assert signature.shape == (batch_size, signatory.signature_channels(augmented_channels, depth))
+
+    iisignature_signature_result = iisignature_signature(augmented_path, depth, stream, False, inverse, None)
+    h.diff(signature, iisignature_signature_result)
+
+    grad = torch.rand_like(signature)
+    signature.backward(grad)
+    path_grad = path.grad.clone()
+    path.grad.zero_()
+    if isinstance(basepoint, torch.Tensor) and basepoint.requires_grad:
+        basepoint_grad = basepoint.grad.clone()
+        basepoint.grad.zero_()
+
+    iisignature_signature_result.backward(grad)
+
+    # iisignature uses float32 for this calculation so we need a lower tolerance
+    h.diff(path.grad, path_grad, atol=1e-4)
+    if isinstance(basepoint, torch.Tensor) and basepoint.requires_grad:
+        h.diff(basepoint.grad, basepoint_grad, atol=1e-4)
+
+
+def test_augmentation_large():
+    """Tests the time_channel and lead_lag arguments on problems large enough to be parallelised, and that only the
+    increments of the original path are saved for the backward pass."""
+    for device in h.get_devices():
+        for stream in (False, True, 7):
+            for inverse in (False, True):
+                path = h.get_path(32, 128, 2, device, path_grad=True)
+                signature = signatory.signature(path, 4, stream=stream, inverse=inverse, time_channel=True,
+                                                lead_lag=True)
+                grad_fn = signature.grad_fn
+                if stream is not False:
+                    # Skip over the transpose back to (batch, stream, channel)
+                    grad_fn = grad_fn.next_functions[0][0]
+                saved_shapes = [tuple(tensor.shape) for tensor in grad_fn.saved_tensors]
+                assert (127, 32, 2) in saved_shapes
+                assert (254, 32, 5) not in saved_shapes
+
+                augmented_path = r.augment(path, False, True, True)
+                true_signature = signatory.signature(augmented_path, 4, stream=stream, inverse=inverse)
+                h.diff(signature, true_signature)
+
+                grad = torch.rand_like(signature)
+                signature.backward(grad)
+                path_grad = path.grad.clone()
+                path.grad.zero_()
+                true_signature.backward(grad)
+                h.diff(path.grad, path_grad)
+
+
+def test_stream_indices():
+    """Tests that passing a stride or indices as the stream argument gives the corresponding positions of
+    stream=True, and the correct gradients through them."""
+    for device in h.get_devices():
+        for batch_size, input_stream, input_channels, basepoint in h.random_sizes_and_basepoint():
+            for depth in (1, 3):
+                for inverse in (False, True):
+                    for initial in (None, h.with_grad):
+                        for lead_lag in (False, True):
+                            output_stream = input_stream if basepoint is not False else input_stream - 1
+                            if lead_lag:
+                                output_stream *= 2
+                            strides = [stride for stride in (1, 2, 3) if stride <= output_stream]
+                            indices = [[0], [-1], sorted({0, output_stream - 1}), list(range(0, output_stream, 2)),
+                                       torch.tensor([output_stream - 1])]
+                            for stream in strides + indices:
+                                _test_stream_indices(device, batch_size, input_stream, input_channels, depth, stream,
+                                                     basepoint, inverse, initial, lead_lag)
+
+
+def _test_stream_indices(device, batch_size, input_stream, input_channels, depth, stream, basepoint, inverse, initial,
+                         lead_lag):
+    path = h.get_path(batch_size, input_stream, input_channels, device, path_grad=True)
+    basepoint = h.get_basepoint(batch_size, input_channels, device, basepoint)
+    augmented_channels = 2 * input_channels if lead_lag else input_channels
+    initial = h.get_initial(batch_size, augmented_channels, device, depth, initial)
+
+    signature = signatory.signature(path, depth, stream=stream, basepoint=basepoint, inverse=inverse, initial=initial,
+                                    lead_lag=lead_lag)
+    true_signature = signatory.signature(path, depth, stream=True, basepoint=basepoint, inverse=inverse,
+                                         initial=initial, lead_lag=lead_lag)
+    if isinstance(stream, int):
+        true_signature = true_signature[:, stream - 1::stream]
+    else:
+        true_signature = true_signature[:, torch.as_tensor(stream, device=device)]
+    h.diff(signature, true_signature)
+
+    grad = torch.rand_like(signature)
+    signature.backward(grad)
+    path_grad = path.grad.clone()
+    path.grad.zero_()
+    if isinstance(basepoint, torch.Tensor) and basepoint.requires_grad:
+        basepoint_grad = basepoint.grad.clone()
+        basepoint.grad.zero_()
+    if isinstance(initial, torch.Tensor) and initial.requires_grad:
+        initial_grad = initial.grad.clone()
+        initial.grad.zero_()
+
+    true_signature.backward(grad)
+    h.diff(path.grad, path_grad)
+    if isinstance(basepoint, torch.Tensor) and basepoint.requires_grad:
+        h.diff(basepoint.grad, basepoint_grad)
+    if isinstance(initial, torch.Tensor) and initial.requires_grad:
+        h.diff(initial.grad, initial_grad)
+
+
+def test_stream_indices_errors():
+    """Tests that invalid strides or indices passed as the stream argument are caught."""
+    path = torch.rand(2, 5, 3)
+    for stream in (0, -1, 5, [], [1, 1], [2, 1], [4], [-5], [[0, 1]]):
+        with pytest.raises(ValueError):
+            signatory.signature(path, 2, stream=stream)
+
+
+def test_stream_stride_too_long():
+    """Tests that a stride longer than the stream is caught, whilst a stride equal to it selects the final entry."""
+    path = torch.rand(2, 5, 3, dtype=torch.double)
+    for basepoint, lead_lag, output_stream_size in ((False, False, 4), (True, False, 5), (False, True, 8)):
+        signature = signatory.signature(path, 2, stream=output_stream_size, basepoint=basepoint, lead_lag=lead_lag)
+        true_signature = signatory.signature(path, 2, basepoint=basepoint, lead_lag=lead_lag)
+        h.diff(signature, true_signature.unsqueeze(1))
+        with pytest.raises(ValueError):
+            signatory.signature(path, 2, stream=output_stream_size + 1, basepoint=basepoint, lead_lag=lead_lag)
+
+
 def test_no_adjustments():
     """Tests that the signature computations don't modify any memory that they're not supposed to."""
 
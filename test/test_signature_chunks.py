@@ -0,0 +1,129 @@
+# Copyright 2019 Patrick Kidger. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# =========================================================================
+"""Tests the signature_chunks and signature_file functions."""
+
+
+import numpy as np
+import os
+import pytest
+import random
+import torch
+
+from helpers import helpers as h
+from helpers import validation as v
+
+
+tests = ['signature_chunks', 'signature_file']
+depends = ['signature']
+signatory = v.validate_tests(tests, depends)
+
+
+def _random_split(path, num_chunks):
+    boundaries = sorted(random.sample(range(1, path.size(-2)), num_chunks - 1))
+    return [path[:, start:end] for start, end in zip([0] + boundaries, boundaries + [path.size(-2)])]
+
+
+def test_chunks():
+    """Tests that signature_chunks agrees with computing the signature of the whole path at once."""
+    for device in h.get_devices():
+        for batch_size in (1, 3):
+            for stream_size in (2, 5, 10):
+                for num_chunks in range(1, stream_size + 1):
+                    for depth in (1, 3):
+                        for stream in (False, True):
+                            for basepoint in (False, True, h.without_grad):
+                                path = torch.rand(batch_size, stream_size, 2, dtype=torch.double, device=device)
+                                basepoint_value = h.get_basepoint(batch_size, 2, device, basepoint)
+                                chunks = _random_split(path, num_chunks)
+                                results = list(signatory.signature_chunks(chunks, depth, stream, basepoint_value))
+                                true_signature = signatory.signature(path, depth, stream, basepoint_value)
+                                if stream:
+                                    h.diff(torch.cat(results, dim=1), true_signature)
+                                else:
+                                    h.diff(results[-1], true_signature)
+                                    # Every intermediate result is the signature of the path so far
+                                    end = 0
+                                    for chunk, result in zip(reversed(chunks), reversed(results)):
+                                        h.diff(result, signatory.signature(path[:, :path.size(-2) - end], depth,
+                                                                           basepoint=basepoint_value))
+                                        end += chunk.size(-2)
+
+                                # Empty chunks are skipped, wherever they appear
+                                empty_chunk = path[:, :0]
+                                for index in (0, len(chunks) // 2, len(chunks)):
+                                    empty_chunks = chunks[:index] + [empty_chunk] + chunks[index:]
+                                    results = list(signatory.signature_chunks(empty_chunks, depth, stream,
+                                                                              basepoint_value))
+                                    if stream:
+                                        h.diff(torch.cat(results, dim=1), true_signature)
+                                    else:
+                                        h.diff(results[-1], true_signature)
+
+
+def test_file(tmpdir):
+    """Tests that signature_file agrees with computing the signature of the whole path at once."""
+    filename = os.path.join(str(tmpdir), 'path.bin')
+    stream_filename = os.path.join(str(tmpdir), 'stream.bin')
+    for dtype in (torch.float, torch.double):
+        for stream_size in (1, 2, 7, 50):
+            for chunk_length in (1, 3, 16, 100):
+                for depth in (1, 3):
+                    for basepoint in (False, True, h.without_grad):
+                        if stream_size == 1 and basepoint is False:
+                            continue
+                        path = torch.rand(stream_size, 3, dtype=dtype)
+                        path.numpy().tofile(filename)
+                        basepoint_value = h.get_basepoint(1, 3, 'cpu', basepoint)
+                        if isinstance(basepoint_value, torch.Tensor):
+                            basepoint_value = basepoint_value.to(dtype)
+                            file_basepoint = basepoint_value.squeeze(0)
+                        else:
+                            file_basepoint = basepoint_value
+                        atol = 1e-8 if dtype == torch.double else 1e-5
+
+                        signature = signatory.signature_file(filename, 3, depth, dtype, file_basepoint, chunk_length)
+                        true_signature = signatory.signature(path.unsqueeze(0), depth, basepoint=basepoint_value)
+                        h.diff(signature, true_signature.squeeze(0), atol=atol)
+
+                        # Write something larger first, to check that it is overwritten
+                        with open(stream_filename, 'wb') as f:
+                            f.write(b'\0' * 100000)
+                        signature = signatory.signature_file(filename, 3, depth, dtype, file_basepoint, chunk_length,
+                                                             stream_filename)
+                        h.diff(signature, true_signature.squeeze(0), atol=atol)
+                        true_stream = signatory.signature(path.unsqueeze(0), depth, stream=True,
+                                                          basepoint=basepoint_value).squeeze(0)
+                        stream_signature = torch.from_numpy(np.fromfile(stream_filename, dtype=path.numpy().dtype))
+                        stream_signature = stream_signature.view_as(true_stream)
+                        assert os.path.getsize(stream_filename) == true_stream.numel() * true_stream.element_size()
+                        h.diff(stream_signature, true_stream, atol=atol)
+
+
+def test_file_errors(tmpdir):
+    """Tests that invalid arguments are caught."""
+    filename = os.path.join(str(tmpdir), 'path.bin')
+    torch.rand(10, 3).numpy().tofile(filename)
+    with pytest.raises(ValueError):
+        signatory.signature_file(filename, 4, 2)
+    with pytest.raises(ValueError):
+        signatory.signature_file(filename, 0, 2)
+    with pytest.raises(ValueError):
+        signatory.signature_file(filename, 3, 2, dtype=torch.long)
+    with pytest.raises(ValueError):
+        signatory.signature_file(filename, 3, 2, chunk_length=0)
+    with pytest.raises(ValueError):
+        signatory.signature_file(filename, 30, 2)
+    with pytest.raises(ValueError):
+        signatory.signature_file(filename, 3, 0)
@@ -0,0 +1,127 @@
+# Copyright 2019 Patrick Kidger. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# =========================================================================
+"""Tests the signature_gram function."""
+
+
+import gc
+import pytest
+import torch
+from torch import autograd
+import weakref
+
+from helpers import helpers as h
+from helpers import validation as v
+
+
+tests = ['signature_gram']
+depends = ['signature']
+signatory = v.validate_tests(tests, depends)
+
+
+def _true_gram(x, y, depth):
+    if y is None:
+        y = x
+    return signatory.signature(x, depth) @ signatory.signature(y, depth).t()
+
+
+def test_forward():
+    """Tests that the Gram matrix agrees with the inner products of the signatures."""
+    for dtype in (torch.float, torch.double):
+        for batch_x, batch_y in ((1, 1), (2, 3), (20, 17)):
+            for stream_x, stream_y in ((2, 2), (3, 6), (8, 5)):
+                for channels in (1, 2, 4):
+                    for depth in (1, 2, 3, 5):
+                        x = torch.rand(batch_x, stream_x, channels, dtype=dtype)
+                        y = torch.rand(batch_y, stream_y, channels, dtype=dtype)
+                        gram = signatory.signature_gram(x, y, depth)
+                        assert gram.shape == (batch_x, batch_y)
+                        atol = 1e-8 if dtype == torch.double else 1e-4
+                        h.diff(gram, _true_gram(x, y, depth), atol=atol)
+
+                        symmetric_gram = signatory.signature_gram(x, None, depth)
+                        assert symmetric_gram.shape == (batch_x, batch_x)
+                        h.diff(symmetric_gram, _true_gram(x, None, depth), atol=atol)
+
+
+def test_backward():
+    """Tests that the gradients agree with those through the inner products of the signatures."""
+    for batch_x, batch_y in ((1, 1), (3, 2), (18, 19)):
+        for stream_x, stream_y in ((2, 2), (4, 3)):
+            for channels in (1, 3):
+                for depth in (1, 2, 4):
+                    for symmetric in (False, True):
+                        x = torch.rand(batch_x, stream_x, channels, dtype=torch.double, requires_grad=True)
+                        y = None if symmetric else torch.rand(batch_y, stream_y, channels, dtype=torch.double,
+                                                              requires_grad=True)
+                        gram = signatory.signature_gram(x, y, depth)
+                        grad = torch.rand_like(gram)
+                        gram.backward(grad)
+                        x_grad = x.grad.clone()
+                        x.grad.zero_()
+                        if not symmetric:
+                            y_grad = y.grad.clone()
+                            y.grad.zero_()
+
+                        _true_gram(x, y, depth).backward(grad)
+                        h.diff(x_grad, x.grad)
+                        if not symmetric:
+                            h.diff(y_grad, y.grad)
+
+
+def test_gradcheck():
+    """Tests the gradients with finite differences."""
+    for symmetric in (False, True):
+        x = torch.rand(2, 4, 2, dtype=torch.double, requires_grad=True)
+        if symmetric:
+            def check_fn(x):
+                return signatory.signature_gram(x, None, 3)
+            inputs = (x,)
+        else:
+            y = torch.rand(3, 3, 2, dtype=torch.double, requires_grad=True)
+
+            def check_fn(x, y):
+                return signatory.signature_gram(x, y, 3)
+            inputs = (x, y)
+        try:
+            autograd.gradcheck(check_fn, inputs)
+        except RuntimeError:
+            pytest.fail()
+
+
+def test_memory_leaks():
+    """Tests that the saved tensors are freed along with the graph."""
+    x = torch.rand(2, 4, 2, requires_grad=True)
+    y = torch.rand(3, 4, 2)
+    gram = signatory.signature_gram(x, y, 3)
+    ref = weakref.ref(gram.grad_fn)
+    del gram
+    gc.collect()
+    assert ref() is None
+
+
+def test_errors():
+    """Tests that invalid arguments are caught."""
+    x = torch.rand(2, 4, 3)
+    with pytest.raises(ValueError):
+        signatory.signature_gram(x, x, 0)
+    for y in (torch.rand(2, 4, 2), torch.rand(2, 1, 3), torch.rand(2, 4, 3, dtype=torch.double),
+              torch.randint(0, 5, (2, 4, 3))):
+        with pytest.raises(ValueError):
+            signatory.signature_gram(x, y, 2)
+    with pytest.raises(ValueError):
+        signatory.signature_gram(torch.rand(2, 1, 3), None, 2)
+    if torch.cuda.is_available():
+        with pytest.raises(ValueError):
+            signatory.signature_gram(x.cuda(), None, 2)
@@ -0,0 +1,120 @@
+# Copyright 2019 Patrick Kidger. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# =========================================================================
+"""Tests the signature_jvp function."""
+
+
+import pytest
+import torch
+
+from helpers import helpers as h
+from helpers import validation as v
+
+
+tests = ['signature_jvp']
+depends = ['signature']
+signatory = v.validate_tests(tests, depends)
+
+
+def test_forward():
+    """Tests that the signature computed alongside the Jacobian-vector product is correct."""
+    for dtype in (torch.float, torch.double):
+        for batch_size in (1, 4):
+            for stream_size in (2, 5):
+                for channels in (1, 3):
+                    for depth in (1, 2, 4):
+                        for stream in (False, True):
+                            for basepoint in (False, True, h.without_grad):
+                                path = torch.rand(batch_size, stream_size, channels, dtype=dtype)
+                                path_tangent = torch.rand_like(path)
+                                basepoint_value = h.get_basepoint(batch_size, channels, 'cpu', basepoint)
+                                if isinstance(basepoint_value, torch.Tensor):
+                                    basepoint_value = basepoint_value.to(dtype)
+                                signature, _ = signatory.signature_jvp(path, path_tangent, depth, stream,
+                                                                       basepoint_value)
+                                true_signature = signatory.signature(path, depth, stream, basepoint_value)
+                                atol = 1e-8 if dtype == torch.double else 1e-5
+                                h.diff(signature, true_signature, atol=atol)
+
+
+def test_adjoint():
+    """Tests that the Jacobian-vector product agrees with the vector-Jacobian product computed by autograd, via
+    <v, J t> = <J^T v, t>."""
+    for batch_size in (1, 4):
+        for stream_size in (2, 5):
+            for channels in (1, 3):
+                for depth in (1, 2, 4):
+                    for stream in (False, True):
+                        for basepoint in (False, True, h.with_grad):
+                            path = torch.rand(batch_size, stream_size, channels, dtype=torch.double,
+                                              requires_grad=True)
+                            path_tangent = torch.rand_like(path)
+                            basepoint_value = h.get_basepoint(batch_size, channels, 'cpu', basepoint)
+                            basepoint_tangent = None
+                            if basepoint is h.with_grad:
+                                basepoint_tangent = torch.rand_like(basepoint_value)
+                            _, tangent = signatory.signature_jvp(path, path_tangent, depth, stream, basepoint_value,
+                                                                 basepoint_tangent)
+
+                            signature = signatory.signature(path, depth, stream, basepoint_value)
+                            grad = torch.rand_like(signature)
+                            signature.backward(grad)
+                            true_inner_product = (path.grad * path_tangent).sum()
+                            if basepoint is h.with_grad:
+                                true_inner_product = true_inner_product + (basepoint_value.grad *
+                                                                           basepoint_tangent).sum()
+                            h.diff((grad * tangent).sum(), true_inner_product)
+
+
+def test_finite_differences():
+    """Tests the Jacobian-vector product against finite differences."""
+    path = torch.rand(3, 6, 2, dtype=torch.double)
+    path_tangent = torch.rand_like(path)
+    eps = 1e-6
+    _, tangent = signatory.signature_jvp(path, path_tangent, 4)
+    finite_difference = (signatory.signature(path + eps * path_tangent, 4) -
+                         signatory.signature(path - eps * path_tangent, 4)) / (2 * eps)
+    h.diff(tangent, finite_difference, atol=1e-6)
+
+
+def test_linear():
+    """Tests that the Jacobian-vector product is linear in the tangent, and zero for a zero tangent."""
+    path = torch.rand(2, 5, 3, dtype=torch.double)
+    tangent1 = torch.rand_like(path)
+    tangent2 = torch.rand_like(path)
+    _, result1 = signatory.signature_jvp(path, tangent1, 3)
+    _, result2 = signatory.signature_jvp(path, tangent2, 3)
+    _, result = signatory.signature_jvp(path, 2 * tangent1 - tangent2, 3)
+    h.diff(result, 2 * result1 - result2)
+    _, result = signatory.signature_jvp(path, torch.zeros_like(path), 3)
+    h.diff(result, torch.zeros_like(result))
+
+
+def test_errors():
+    """Tests that invalid arguments are caught."""
+    path = torch.rand(2, 5, 3)
+    with pytest.raises(ValueError):
+        signatory.signature_jvp(path, torch.rand(2, 4, 3), 3)
+    with pytest.raises(ValueError):
+        signatory.signature_jvp(path, torch.rand(2, 5, 3, dtype=torch.double), 3)
+    with pytest.raises(ValueError):
+        signatory.signature_jvp(path, torch.rand_like(path), 0)
+    with pytest.raises(ValueError):
+        signatory.signature_jvp(path, torch.rand_like(path), 3, basepoint=True, basepoint_tangent=torch.rand(2, 3))
+    with pytest.raises(ValueError):
+        signatory.signature_jvp(path, torch.rand_like(path), 3, basepoint=torch.rand(2, 3),
+                                basepoint_tangent=torch.rand(2, 2))
+    if torch.cuda.is_available():
+        with pytest.raises(ValueError):
+            signatory.signature_jvp(path.cuda(), torch.rand_like(path).cuda(), 3)
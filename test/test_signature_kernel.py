@@ -0,0 +1,172 @@
+# Copyright 2019 Patrick Kidger. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# =========================================================================
+"""Tests the signature_kernel function."""
+
+
+import gc
+import pytest
+import torch
+from torch import autograd
+import weakref
+
+from helpers import helpers as h
+from helpers import validation as v
+
+
+tests = ['signature_kernel']
+depends = ['signature_gram']
+signatory = v.validate_tests(tests, depends)
+
+
+def _reference_kernel(x, y, dyadic_order):
+    # A straightforward reimplementation of the finite difference scheme, through which we can autograd.
+    if y is None:
+        y = x
+    x_increments = x[:, 1:] - x[:, :-1]
+    y_increments = y[:, 1:] - y[:, :-1]
+    result = []
+    for x_increments_at_index in x_increments:
+        row = []
+        for y_increments_at_index in y_increments:
+            refined_gram = x_increments_at_index @ y_increments_at_index.t()
+            refined_gram = refined_gram.repeat_interleave(2 ** dyadic_order, dim=0)
+            refined_gram = refined_gram.repeat_interleave(2 ** dyadic_order, dim=1) / 4 ** dyadic_order
+            rows, columns = refined_gram.shape
+            solution = [[x.new_ones(()) for _ in range(columns + 1)] for _ in range(rows + 1)]
+            for p in range(1, rows + 1):
+                for q in range(1, columns + 1):
+                    inner_product = refined_gram[p - 1, q - 1]
+                    inner_product_squared = inner_product ** 2 / 12
+                    solution[p][q] = ((solution[p][q - 1] + solution[p - 1][q]) *
+                                      (1 + inner_product / 2 + inner_product_squared) -
+                                      solution[p - 1][q - 1] * (1 - inner_product_squared))
+            row.append(solution[rows][columns])
+        result.append(torch.stack(row))
+    return torch.stack(result)
+
+
+def test_forward():
+    """Tests that the kernel agrees with a reimplementation of the same finite difference scheme."""
+    for dtype in (torch.float, torch.double):
+        for batch_x, batch_y in ((1, 1), (2, 3)):
+            for stream_x, stream_y in ((2, 2), (3, 5)):
+                for channels in (1, 3):
+                    for dyadic_order in (0, 1, 2):
+                        x = torch.rand(batch_x, stream_x, channels, dtype=dtype)
+                        y = torch.rand(batch_y, stream_y, channels, dtype=dtype)
+                        kernel = signatory.signature_kernel(x, y, dyadic_order)
+                        assert kernel.shape == (batch_x, batch_y)
+                        atol = 1e-8 if dtype == torch.double else 1e-4
+                        h.diff(kernel, _reference_kernel(x, y, dyadic_order), atol=atol)
+
+                        symmetric_kernel = signatory.signature_kernel(x, None, dyadic_order)
+                        assert symmetric_kernel.shape == (batch_x, batch_x)
+                        h.diff(symmetric_kernel, _reference_kernel(x, None, dyadic_order), atol=atol)
+
+
+def test_convergence():
+    """Tests that the kernel converges to the inner product of the untruncated signatures as the grid is refined."""
+    x = torch.rand(4, 5, 3, dtype=torch.double) / 2
+    y = torch.rand(3, 4, 3, dtype=torch.double) / 2
+    true_kernel = 1 + signatory.signature_gram(x, y, 10)
+    errors = [(signatory.signature_kernel(x, y, dyadic_order) - true_kernel).abs().max().item()
+              for dyadic_order in range(4)]
+    assert errors[-1] < 1e-5
+    for error, refined_error in zip(errors[:-1], errors[1:]):
+        assert refined_error < error
+
+
+def test_large_batch():
+    """Tests that parallelising over pairs of paths agrees with parallelising within each pair."""
+    x = torch.rand(40, 6, 2, dtype=torch.double)
+    y = torch.rand(30, 5, 2, dtype=torch.double)
+    kernel = signatory.signature_kernel(x, y, 1)
+    for x_index in (0, 17, 39):
+        for y_index in (0, 29):
+            h.diff(kernel[x_index, y_index], signatory.signature_kernel(x[x_index:x_index + 1],
+                                                                        y[y_index:y_index + 1], 1)[0, 0])
+    h.diff(signatory.signature_kernel(x, None, 1), signatory.signature_kernel(x, x, 1))
+
+
+def test_backward():
+    """Tests that the gradients agree with those through a reimplementation of the same finite difference scheme."""
+    for batch_x, batch_y in ((1, 1), (3, 2)):
+        for stream_x, stream_y in ((2, 2), (4, 3)):
+            for channels in (1, 3):
+                for dyadic_order in (0, 1):
+                    for symmetric in (False, True):
+                        x = torch.rand(batch_x, stream_x, channels, dtype=torch.double, requires_grad=True)
+                        y = None if symmetric else torch.rand(batch_y, stream_y, channels, dtype=torch.double,
+                                                              requires_grad=True)
+                        kernel = signatory.signature_kernel(x, y, dyadic_order)
+                        grad = torch.rand_like(kernel)
+                        kernel.backward(grad)
+                        x_grad = x.grad.clone()
+                        x.grad.zero_()
+                        if not symmetric:
+                            y_grad = y.grad.clone()
+                            y.grad.zero_()
+
+                        _reference_kernel(x, y, dyadic_order).backward(grad)
+                        h.diff(x_grad, x.grad)
+                        if not symmetric:
+                            h.diff(y_grad, y.grad)
+
+
+def test_gradcheck():
+    """Tests the gradients with finite differences."""
+    for symmetric in (False, True):
+        x = torch.rand(2, 4, 2, dtype=torch.double, requires_grad=True)
+        if symmetric:
+            def check_fn(x):
+                return signatory.signature_kernel(x, None, 1)
+            inputs = (x,)
+        else:
+            y = torch.rand(3, 3, 2, dtype=torch.double, requires_grad=True)
+
+            def check_fn(x, y):
+                return signatory.signature_kernel(x, y, 1)
+            inputs = (x, y)
+        try:
+            autograd.gradcheck(check_fn, inputs)
+        except RuntimeError:
+            pytest.fail()
+
+
+def test_memory_leaks():
+    """Tests that the saved tensors are freed along with the graph."""
+    x = torch.rand(2, 4, 2, requires_grad=True)
+    y = torch.rand(3, 4, 2)
+    kernel = signatory.signature_kernel(x, y)
+    ref = weakref.ref(kernel.grad_fn)
+    del kernel
+    gc.collect()
+    assert ref() is None
+
+
+def test_errors():
+    """Tests that invalid arguments are caught."""
+    x = torch.rand(2, 4, 3)
+    with pytest.raises(ValueError):
+        signatory.signature_kernel(x, x, -1)
+    for y in (torch.rand(2, 4, 2), torch.rand(2, 1, 3), torch.rand(2, 4, 3, dtype=torch.double),
+              torch.randint(0, 5, (2, 4, 3))):
+        with pytest.raises(ValueError):
+            signatory.signature_kernel(x, y)
+    with pytest.raises(ValueError):
+        signatory.signature_kernel(torch.rand(2, 1, 3), None)
+    if torch.cuda.is_available():
+        with pytest.raises(ValueError):
+            signatory.signature_kernel(x.cuda(), None)
@@ -0,0 +1,118 @@
+# Copyright 2019 Patrick Kidger. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# =========================================================================
+"""Tests the signature_pyramid function."""
+
+
+import gc
+import pytest
+import torch
+import weakref
+
+from helpers import helpers as h
+from helpers import validation as v
+
+
+tests = ['signature_pyramid']
+depends = ['signature']
+signatory = v.validate_tests(tests, depends)
+
+
+def _true_signature_pyramid(path, depth, scales):
+    num_increments = path.size(1) - 1
+    pyramid = []
+    for scale in range(scales):
+        num_segments = 2 ** scale
+        # Matches the boundaries of the finest scale, of which every coarser scale uses every other one
+        finest = 2 ** (scales - 1)
+        step = finest // num_segments
+        signatures = []
+        for segment in range(num_segments):
+            start = (segment * step * num_increments) // finest
+            end = ((segment + 1) * step * num_increments) // finest
+            signatures.append(signatory.signature(path[:, start:end + 1], depth))
+        pyramid.append(torch.stack(signatures, dim=1))
+    return pyramid
+
+
+def _pyramid_params():
+    for input_stream in (2, 3, 5, 8, 9, 17):
+        for scales in (1, 2, 3, 4, 5):
+            if 2 ** (scales - 1) <= input_stream - 1:
+                yield input_stream, scales
+
+
+def test_forward():
+    """Tests that each scale of the pyramid agrees with computing the signature of every segment separately."""
+    for device in h.get_devices():
+        for batch_size, input_channels in ((1, 1), (2, 3), (4, 2)):
+            for depth in (1, 2, 4):
+                for input_stream, scales in _pyramid_params():
+                    path = h.get_path(batch_size, input_stream, input_channels, device, path_grad=False)
+                    pyramid = signatory.signature_pyramid(path, depth, scales)
+                    true_pyramid = _true_signature_pyramid(path, depth, scales)
+                    assert len(pyramid) == scales
+                    for signature, true_signature in zip(pyramid, true_pyramid):
+                        assert signature.shape == true_signature.shape
+                        h.diff(signature, true_signature)
+                        assert signature.grad_fn is None
+
+
+def test_backward():
+    """Tests that the backwards operation through the pyramid gives the correct values."""
+    for device in h.get_devices():
+        for batch_size, input_channels in ((1, 1), (2, 3), (4, 2)):
+            for depth in (1, 2, 4):
+                for input_stream, scales in _pyramid_params():
+                    path = h.get_path(batch_size, input_stream, input_channels, device, path_grad=True)
+                    pyramid = signatory.signature_pyramid(path, depth, scales)
+                    grads = [torch.rand_like(signature) for signature in pyramid]
+                    torch.autograd.backward(pyramid, grads)
+                    path_grad = path.grad.clone()
+                    path.grad.zero_()
+
+                    true_pyramid = _true_signature_pyramid(path, depth, scales)
+                    torch.autograd.backward(true_pyramid, grads)
+                    h.diff(path_grad, path.grad)
+
+
+def test_gradcheck():
+    """Tests the backwards operation through the pyramid with gradcheck."""
+    for input_stream, scales in ((5, 3), (7, 2)):
+        path = torch.rand(2, input_stream, 2, dtype=torch.double, requires_grad=True)
+        assert torch.autograd.gradcheck(lambda x: tuple(signatory.signature_pyramid(x, 3, scales)), (path,))
+
+
+def test_memory_leaks():
+    """Tests that the pyramid doesn't leak memory through its autograd graph."""
+    path = torch.rand(2, 9, 3, dtype=torch.double, requires_grad=True)
+    pyramid = signatory.signature_pyramid(path, 3, 3)
+    # narrow then transpose
+    ctx = pyramid[0].grad_fn.next_functions[0][0].next_functions[0][0]
+    assert type(ctx).__name__ == '_SignaturePyramidFunctionBackward'
+    ref = weakref.ref(ctx)
+    del ctx
+    del pyramid
+    gc.collect()
+    assert ref() is None
+
+
+def test_errors():
+    """Tests that invalid arguments are caught."""
+    path = torch.rand(2, 5, 3)
+    for scales in (0, 4):
+        with pytest.raises(ValueError):
+            signatory.signature_pyramid(path, 3, scales)
+    with pytest.raises(ValueError):
+        signatory.signature_pyramid(path, 0, 2)
@@ -0,0 +1,156 @@
+# Copyright 2019 Patrick Kidger. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# =========================================================================
+"""Tests the signature_ragged and logsignature_ragged functions."""
+
+
+import gc
+import pytest
+import random
+import torch
+from torch import autograd
+import weakref
+
+from helpers import helpers as h
+from helpers import validation as v
+
+
+tests = ['signature_ragged', 'logsignature_ragged']
+depends = ['signature', 'logsignature']
+signatory = v.validate_tests(tests, depends)
+
+
+def _random_paths(num_paths, channels, basepoint, dtype, device, requires_grad=False):
+    lengths = [random.randint(1 if basepoint else 2, 8) for _ in range(num_paths)]
+    path = torch.rand(sum(lengths), channels, dtype=dtype, device=device, requires_grad=requires_grad)
+    return path, lengths
+
+
+def _true_signature_ragged(path, lengths, depth, stream, basepoint, fn):
+    results = []
+    for index, path_i in enumerate(path.split(lengths)):
+        basepoint_i = basepoint[index].unsqueeze(0) if isinstance(basepoint, torch.Tensor) else basepoint
+        result = fn(path_i.unsqueeze(0), depth, stream=stream, basepoint=basepoint_i).squeeze(0)
+        results.append(result if stream else result.unsqueeze(0))
+    return torch.cat(results)
+
+
+def test_forward():
+    """Tests that signature_ragged agrees with computing the signature of every path separately."""
+    for device in h.get_devices():
+        for dtype in (torch.float, torch.double):
+            for num_paths in (1, 2, 5):
+                for channels in (1, 3):
+                    for depth in (1, 2, 4):
+                        for stream in (False, True):
+                            for basepoint in (False, True, h.without_grad):
+                                path, lengths = _random_paths(num_paths, channels, basepoint, dtype, device)
+                                basepoint_value = h.get_basepoint(num_paths, channels, device, basepoint)
+                                if isinstance(basepoint_value, torch.Tensor):
+                                    basepoint_value = basepoint_value.to(dtype)
+                                signature = signatory.signature_ragged(path, lengths, depth, stream, basepoint_value)
+                                true_signature = _true_signature_ragged(path, lengths, depth, stream,
+                                                                        basepoint_value, signatory.signature)
+                                atol = 1e-8 if dtype == torch.double else 1e-5
+                                h.diff(signature, true_signature, atol=atol)
+
+
+def test_backward():
+    """Tests that the gradients agree with those through computing the signature of every path separately."""
+    for device in h.get_devices():
+        for num_paths in (1, 2, 5):
+            for channels in (1, 3):
+                for depth in (1, 2, 4):
+                    for stream in (False, True):
+                        for basepoint in (False, True, h.with_grad):
+                            path, lengths = _random_paths(num_paths, channels, basepoint, torch.double, device,
+                                                          requires_grad=True)
+                            basepoint_value = h.get_basepoint(num_paths, channels, device, basepoint)
+                            signature = signatory.signature_ragged(path, lengths, depth, stream, basepoint_value)
+                            grad = torch.rand_like(signature)
+                            signature.backward(grad)
+                            path_grad = path.grad.clone()
+                            path.grad.zero_()
+                            if basepoint is h.with_grad:
+                                basepoint_grad = basepoint_value.grad.clone()
+                                basepoint_value.grad.zero_()
+
+                            true_signature = _true_signature_ragged(path, lengths, depth, stream, basepoint_value,
+                                                                    signatory.signature)
+                            true_signature.backward(grad)
+                            h.diff(path_grad, path.grad)
+                            if basepoint is h.with_grad:
+                                h.diff(basepoint_grad, basepoint_value.grad)
+
+
+def test_gradcheck():
+    """Tests the gradients with finite differences."""
+    for stream in (False, True):
+        path = torch.rand(12, 2, dtype=torch.double, requires_grad=True)
+        try:
+            autograd.gradcheck(lambda x: signatory.signature_ragged(x, [2, 6, 4], 3, stream), (path,))
+        except RuntimeError:
+            pytest.fail()
+
+
+def test_logsignature():
+    """Tests that logsignature_ragged agrees with computing the logsignature of every path separately."""
+    for stream in (False, True):
+        for mode in ('words', 'brackets', 'expand'):
+            path, lengths = _random_paths(4, 3, False, torch.double, 'cpu', requires_grad=True)
+            logsignature = signatory.logsignature_ragged(path, lengths, 3, stream=stream, mode=mode)
+            true_logsignature = _true_signature_ragged(path, lengths, 3, stream, False,
+                                                       lambda *args, **kwargs: signatory.logsignature(*args, mode=mode,
+                                                                                                      **kwargs))
+            h.diff(logsignature, true_logsignature)
+
+            grad = torch.rand_like(logsignature)
+            logsignature.backward(grad)
+            path_grad = path.grad.clone()
+            path.grad.zero_()
+            true_logsignature.backward(grad)
+            h.diff(path_grad, path.grad)
+
+
+def test_memory_leaks():
+    """Tests that the saved tensors are freed along with the graph."""
+    path = torch.rand(9, 2, requires_grad=True)
+    signature = signatory.signature_ragged(path, [4, 5], 3)
+    ref = weakref.ref(signature.grad_fn)
+    del signature
+    gc.collect()
+    assert ref() is None
+
+
+def test_errors():
+    """Tests that invalid arguments are caught."""
+    path = torch.rand(9, 3)
+    with pytest.raises(ValueError):
+        signatory.signature_ragged(path, [4, 5], 0)
+    with pytest.raises(ValueError):
+        signatory.signature_ragged(path, [4, 4], 2)
+    with pytest.raises(ValueError):
+        signatory.signature_ragged(path, [8, 1], 2)
+    with pytest.raises(ValueError):
+        signatory.signature_ragged(path, [], 2)
+    with pytest.raises(ValueError):
+        signatory.signature_ragged(path.unsqueeze(0), [4, 5], 2)
+    with pytest.raises(ValueError):
+        signatory.signature_ragged(path.long(), [4, 5], 2)
+    with pytest.raises(ValueError):
+        signatory.signature_ragged(path, [4, 5], 2, basepoint=torch.rand(3, 3))
+    with pytest.raises(ValueError):
+        signatory.signature_ragged(path, [4, 5], 2, basepoint=torch.rand(2, 3, dtype=torch.double))
+    # A single point is fine with a basepoint
+    signatory.signature_ragged(path, [8, 1], 2, basepoint=True)
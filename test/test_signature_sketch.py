@@ -0,0 +1,161 @@
+# Copyright 2019 Patrick Kidger. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# =========================================================================
+"""Tests the signature_sketch function and the SignatureSketch class."""
+
+
+import gc
+import itertools as it
+import pytest
+import torch
+from torch import autograd
+import weakref
+
+from helpers import helpers as h
+from helpers import validation as v
+
+
+tests = ['signature_sketch', 'sketch_hashes', 'SignatureSketch']
+depends = ['signature']
+signatory = v.validate_tests(tests, depends)
+
+
+def _sketch_matrix(hashes, signs, sketch_channels):
+    # The TensorSketch as an explicit matrix of shape (signature_channels, sketch_channels)
+    depth, channels = hashes.shape
+    rows = []
+    for level in range(1, depth + 1):
+        for word in it.product(range(channels), repeat=level):
+            row = torch.zeros(sketch_channels, dtype=signs.dtype)
+            index = sum(hashes[position, letter].item() for position, letter in enumerate(word)) % sketch_channels
+            row[index] = torch.prod(torch.stack([signs[position, letter] for position, letter in enumerate(word)]))
+            rows.append(row)
+    return torch.stack(rows)
+
+
+def test_forward():
+    """Tests that the sketch agrees with explicitly projecting the signature."""
+    for dtype in (torch.float, torch.double):
+        for batch_size in (1, 4):
+            for stream_size in (2, 5):
+                for channels in (1, 3):
+                    for depth in (1, 2, 4):
+                        for sketch_channels in (1, 7):
+                            for basepoint in (False, True):
+                                path = torch.rand(batch_size, stream_size, channels, dtype=dtype)
+                                hashes, signs = signatory.sketch_hashes(channels, depth, sketch_channels, dtype=dtype)
+                                sketch = signatory.signature_sketch(path, hashes, signs, sketch_channels, basepoint)
+                                assert sketch.shape == (batch_size, sketch_channels)
+                                true_sketch = (signatory.signature(path, depth, basepoint=basepoint) @
+                                               _sketch_matrix(hashes, signs, sketch_channels))
+                                atol = 1e-8 if dtype == torch.double else 1e-4
+                                h.diff(sketch, true_sketch, atol=atol)
+
+
+def test_backward():
+    """Tests that the gradients agree with those through explicitly projecting the signature."""
+    for batch_size in (1, 3):
+        for stream_size in (2, 5):
+            for channels in (1, 3):
+                for depth in (1, 3):
+                    for basepoint in (False, True, h.with_grad):
+                        path = torch.rand(batch_size, stream_size, channels, dtype=torch.double, requires_grad=True)
+                        basepoint_value = h.get_basepoint(batch_size, channels, 'cpu', basepoint)
+                        hashes, signs = signatory.sketch_hashes(channels, depth, 5, dtype=torch.double)
+                        sketch = signatory.signature_sketch(path, hashes, signs, 5, basepoint_value)
+                        grad = torch.rand_like(sketch)
+                        sketch.backward(grad)
+                        path_grad = path.grad.clone()
+                        path.grad.zero_()
+                        if basepoint is h.with_grad:
+                            basepoint_grad = basepoint_value.grad.clone()
+                            basepoint_value.grad.zero_()
+
+                        true_sketch = (signatory.signature(path, depth, basepoint=basepoint_value) @
+                                       _sketch_matrix(hashes, signs, 5))
+                        true_sketch.backward(grad)
+                        h.diff(path_grad, path.grad)
+                        if basepoint is h.with_grad:
+                            h.diff(basepoint_grad, basepoint_value.grad)
+
+
+def test_gradcheck():
+    """Tests the gradients with finite differences."""
+    path = torch.rand(2, 4, 3, dtype=torch.double, requires_grad=True)
+    hashes, signs = signatory.sketch_hashes(3, 4, 6, dtype=torch.double)
+    try:
+        autograd.gradcheck(lambda x: signatory.signature_sketch(x, hashes, signs, 6), (path,))
+    except RuntimeError:
+        pytest.fail()
+
+
+def test_inner_product():
+    """Tests that inner products between sketches approximate inner products between signatures."""
+    generator = torch.Generator()
+    generator.manual_seed(0)
+    x = torch.rand(1, 5, 3, dtype=torch.double)
+    y = torch.rand(1, 5, 3, dtype=torch.double)
+    true_inner_product = (signatory.signature(x, 3) * signatory.signature(y, 3)).sum()
+    inner_products = []
+    for _ in range(200):
+        sketch = signatory.SignatureSketch(3, 3, 32, generator=generator)
+        inner_products.append((sketch(x) * sketch(y)).sum())
+    assert abs(torch.stack(inner_products).mean() - true_inner_product) < 0.1 * true_inner_product
+
+
+def test_module():
+    """Tests that SignatureSketch uses the same hashes every time it is called."""
+    sketch = signatory.SignatureSketch(3, 4, 10)
+    assert sketch.hashes.shape == (4, 3)
+    assert sketch.signs.shape == (4, 3)
+    path = torch.rand(2, 5, 3)
+    h.diff(sketch(path), sketch(path))
+    h.diff(sketch(path), signatory.signature_sketch(path, sketch.hashes, sketch.signs, 10))
+    h.diff(sketch(path.double()), signatory.signature_sketch(path.double(), sketch.hashes, sketch.signs.double(), 10))
+
+
+def test_memory_leaks():
+    """Tests that the saved tensors are freed along with the graph."""
+    path = torch.rand(2, 4, 2, requires_grad=True)
+    hashes, signs = signatory.sketch_hashes(2, 3, 5)
+    sketch = signatory.signature_sketch(path, hashes, signs, 5)
+    ref = weakref.ref(sketch.grad_fn)
+    del sketch
+    gc.collect()
+    assert ref() is None
+
+
+def test_errors():
+    """Tests that invalid arguments are caught."""
+    path = torch.rand(2, 4, 3)
+    hashes, signs = signatory.sketch_hashes(3, 2, 5)
+    with pytest.raises(ValueError):
+        signatory.signature_sketch(path, hashes, signs, 0)
+    with pytest.raises(ValueError):
+        signatory.signature_sketch(path, hashes + 5, signs, 5)
+    with pytest.raises(ValueError):
+        signatory.signature_sketch(path, hashes - 5, signs, 5)
+    with pytest.raises(ValueError):
+        signatory.signature_sketch(path, hashes.float(), signs, 5)
+    with pytest.raises(ValueError):
+        signatory.signature_sketch(path, hashes, signs.double(), 5)
+    with pytest.raises(ValueError):
+        signatory.signature_sketch(path, hashes[:, :2], signs[:, :2], 5)
+    with pytest.raises(ValueError):
+        signatory.signature_sketch(path, hashes[0], signs[0], 5)
+    with pytest.raises(ValueError):
+        signatory.signature_sketch(path, hashes[:0], signs[:0], 5)
+    if torch.cuda.is_available():
+        with pytest.raises(ValueError):
+            signatory.signature_sketch(path.cuda(), hashes, signs.cuda(), 5)
@@ -0,0 +1,141 @@
+# Copyright 2019 Patrick Kidger. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# =========================================================================
+"""Tests the signature_table function."""
+
+
+import gc
+import pytest
+import random
+import torch
+import weakref
+
+from helpers import helpers as h
+from helpers import validation as v
+
+
+tests = ['signature_table']
+depends = ['signature', 'signature_channels']
+signatory = v.validate_tests(tests, depends)
+
+
+def _select_levels(signature, input_channels, levels):
+    if levels is None:
+        return signature
+    pieces = []
+    for level in levels:
+        start = signatory.signature_channels(input_channels, level - 1) if level > 1 else 0
+        pieces.append(signature.narrow(dim=-1, start=start, length=input_channels ** level))
+    return torch.cat(pieces, dim=-1)
+
+
+def _random_levels(depth):
+    if random.choice([False, True]):
+        return None
+    levels = sorted(random.sample(range(1, depth + 1), random.randint(1, depth)))
+    return levels
+
+
+def _true_table(path, depth):
+    stream_size = path.size(1)
+    rows = []
+    for i in range(stream_size - 1):
+        rows.append(signatory.signature(path[:, i:], depth, stream=True))
+    return rows
+
+
+def test_forward():
+    """Tests that the table agrees with computing the signature of every interval separately."""
+    for device in h.get_devices():
+        for batch_size, input_stream, input_channels in h.random_sizes():
+            for depth in (1, 2, 3):
+                for packed in (False, True):
+                    levels = _random_levels(depth)
+                    path = h.get_path(batch_size, input_stream, input_channels, device, path_grad=False)
+                    table = signatory.signature_table(path, depth, packed=packed, levels=levels)
+                    rows = _true_table(path, depth)
+                    channels = _select_levels(signatory.signature(path, depth), input_channels, levels).size(-1)
+                    if packed:
+                        assert table.shape == (batch_size, (input_stream * (input_stream - 1)) // 2, channels)
+                        true_table = torch.cat(rows, dim=1)
+                        h.diff(table, _select_levels(true_table, input_channels, levels))
+                    else:
+                        assert table.shape == (batch_size, input_stream, input_stream, channels)
+                        for i in range(input_stream):
+                            for j in range(input_stream):
+                                if i < j:
+                                    true_signature = _select_levels(rows[i][:, j - i - 1], input_channels, levels)
+                                    h.diff(table[:, i, j], true_signature)
+                                else:
+                                    h.diff(table[:, i, j], torch.zeros_like(table[:, i, j]))
+                    assert table.grad_fn is None
+
+
+def test_backward():
+    """Tests that the backwards operation through the table gives the correct values."""
+    for device in h.get_devices():
+        for batch_size, input_stream, input_channels in h.random_sizes():
+            for depth in (1, 2, 3):
+                packed = random.choice([False, True])
+                levels = _random_levels(depth)
+                path = h.get_path(batch_size, input_stream, input_channels, device, path_grad=True)
+                table = signatory.signature_table(path, depth, packed=packed, levels=levels)
+                grad = torch.rand_like(table)
+                table.backward(grad)
+                path_grad = path.grad.clone()
+                path.grad.zero_()
+
+                rows = _true_table(path, depth)
+                if packed:
+                    true_table = _select_levels(torch.cat(rows, dim=1), input_channels, levels)
+                    true_table.backward(grad)
+                else:
+                    for i, row in enumerate(rows):
+                        _select_levels(row, input_channels, levels).backward(grad[:, i, i + 1:])
+                h.diff(path_grad, path.grad)
+
+
+def test_gradcheck():
+    """Tests the backwards operation through the table with gradcheck."""
+    for packed in (False, True):
+        for levels in (None, [2], [1, 3]):
+            path = torch.rand(2, 4, 2, dtype=torch.double, requires_grad=True)
+            assert torch.autograd.gradcheck(lambda x: signatory.signature_table(x, 3, packed=packed, levels=levels),
+                                            (path,))
+
+
+def test_memory_leaks():
+    """Tests that the table doesn't leak memory through its autograd graph."""
+    path = torch.rand(2, 5, 3, dtype=torch.double, requires_grad=True)
+    table = signatory.signature_table(path, 3)
+    ctx = table.grad_fn
+    while type(ctx).__name__ != '_SignatureTableFunctionBackward':
+        ctx = ctx.next_functions[0][0]
+    ref = weakref.ref(ctx)
+    del ctx
+    del table
+    gc.collect()
+    assert ref() is None
+
+
+def test_errors():
+    """Tests that invalid arguments are caught."""
+    path = torch.rand(2, 4, 3)
+    for levels in ([0], [4], [2, 1], [1, 1]):
+        with pytest.raises(ValueError):
+            signatory.signature_table(path, 3, levels=levels)
+    with pytest.raises(ValueError):
+        signatory.signature_table(torch.rand(2, 1, 3), 3)
+    with pytest.raises(ValueError):
+        signatory.signature_table(path, 0)
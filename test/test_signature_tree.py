@@ -0,0 +1,144 @@
+# Copyright 2019 Patrick Kidger. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# =========================================================================
+"""Tests the signature_tree function."""
+
+
+import gc
+import pytest
+import random
+import torch
+from torch import autograd
+import weakref
+
+from helpers import helpers as h
+from helpers import validation as v
+
+
+tests = ['signature_tree']
+depends = ['signature']
+signatory = v.validate_tests(tests, depends)
+
+
+def _random_parents(num_nodes):
+    return [random.randint(-1, node_index - 1) for node_index in range(num_nodes)]
+
+
+def _paths(increments, parents):
+    # The path ending at each node, as its sequence of increments
+    paths = []
+    for node_index in range(len(parents)):
+        route = []
+        while node_index != -1:
+            route.append(node_index)
+            node_index = parents[node_index]
+        paths.append(increments[:, list(reversed(route))])
+    return paths
+
+
+def _true_signature_tree(increments, parents, depth):
+    return torch.stack([signatory.signature(path.cumsum(dim=1), depth, basepoint=True)
+                        for path in _paths(increments, parents)], dim=1)
+
+
+def test_forward():
+    """Tests that signature_tree agrees with computing the signature of every path separately."""
+    for device in h.get_devices():
+        for dtype in (torch.float, torch.double):
+            for batch_size in (1, 3):
+                for num_nodes in (1, 2, 10):
+                    for channels in (1, 3):
+                        for depth in (1, 2, 4):
+                            increments = torch.rand(batch_size, num_nodes, channels, dtype=dtype, device=device)
+                            parents = _random_parents(num_nodes)
+                            signature = signatory.signature_tree(increments, parents, depth)
+                            true_signature = _true_signature_tree(increments, parents, depth)
+                            atol = 1e-8 if dtype == torch.double else 1e-5
+                            h.diff(signature, true_signature, atol=atol)
+
+
+def test_special_trees():
+    """Tests a single path, a collection of disjoint paths, and a tree with a shared trunk."""
+    increments = torch.rand(2, 6, 3, dtype=torch.double)
+    for parents in ([-1, 0, 1, 2, 3, 4], [-1] * 6, [-1, 0, 1, 1, 2, 2]):
+        h.diff(signatory.signature_tree(increments, parents, 3), _true_signature_tree(increments, parents, 3))
+
+    # The last node of a single path has the signature of the whole path
+    path = torch.rand(2, 7, 3, dtype=torch.double)
+    increments = path[:, 1:] - path[:, :-1]
+    signature = signatory.signature_tree(increments, torch.arange(-1, 5), 3)
+    h.diff(signature[:, -1], signatory.signature(path, 3))
+    h.diff(signature, signatory.signature(path, 3, stream=True))
+
+
+def test_backward():
+    """Tests that the gradients agree with those through computing the signature of every path separately."""
+    for device in h.get_devices():
+        for batch_size in (1, 3):
+            for num_nodes in (1, 2, 10):
+                for channels in (1, 3):
+                    for depth in (1, 2, 4):
+                        increments = torch.rand(batch_size, num_nodes, channels, dtype=torch.double, device=device,
+                                                requires_grad=True)
+                        parents = _random_parents(num_nodes)
+                        signature = signatory.signature_tree(increments, parents, depth)
+                        grad = torch.rand_like(signature)
+                        signature.backward(grad)
+                        increments_grad = increments.grad.clone()
+                        increments.grad.zero_()
+
+                        true_signature = _true_signature_tree(increments, parents, depth)
+                        true_signature.backward(grad)
+                        h.diff(increments_grad, increments.grad)
+
+
+def test_gradcheck():
+    """Tests the gradients with finite differences."""
+    increments = torch.rand(2, 6, 2, dtype=torch.double, requires_grad=True)
+    parents = [-1, 0, 0, 1, -1, 3]
+    try:
+        autograd.gradcheck(lambda x: signatory.signature_tree(x, parents, 3), (increments,))
+    except RuntimeError:
+        pytest.fail()
+
+
+def test_memory_leaks():
+    """Tests that the saved tensors are freed along with the graph."""
+    increments = torch.rand(2, 4, 2, requires_grad=True)
+    signature = signatory.signature_tree(increments, [-1, 0, 0, 1], 3)
+    ref = weakref.ref(signature.grad_fn)
+    del signature
+    gc.collect()
+    assert ref() is None
+
+
+def test_errors():
+    """Tests that invalid arguments are caught."""
+    increments = torch.rand(2, 4, 3)
+    with pytest.raises(ValueError):
+        signatory.signature_tree(increments, [-1, 0, 0, 1], 0)
+    with pytest.raises(ValueError):
+        signatory.signature_tree(increments, [-1, 0, 0], 2)
+    with pytest.raises(ValueError):
+        signatory.signature_tree(increments, [-1, 0, 0, 3], 2)
+    with pytest.raises(ValueError):
+        signatory.signature_tree(increments, [0, 0, 0, 1], 2)
+    with pytest.raises(ValueError):
+        signatory.signature_tree(increments, [-2, 0, 0, 1], 2)
+    with pytest.raises(ValueError):
+        signatory.signature_tree(increments[0], [-1, 0, 0, 1], 2)
+    with pytest.raises(ValueError):
+        signatory.signature_tree(increments.long(), [-1, 0, 0, 1], 2)
+    with pytest.raises(ValueError):
+        signatory.signature_tree(increments[:, :0], [], 2)
@@ -0,0 +1,111 @@
+# Copyright 2019 Patrick Kidger. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# =========================================================================
+"""Tests the signature_window function."""
+
+
+import gc
+import pytest
+import torch
+import weakref
+
+from helpers import helpers as h
+from helpers import validation as v
+
+
+tests = ['signature_window']
+depends = ['signature']
+signatory = v.validate_tests(tests, depends)
+
+
+def _window_params(input_stream):
+    # Includes both the case in which the recurrence is used (long windows, short strides) and the case in which every
+    # window is computed separately.
+    params = []
+    for window in (2, 3, input_stream // 2, input_stream):
+        for stride in (1, 2, 3, window):
+            if 2 <= window <= input_stream:
+                params.append((window, stride))
+    return params
+
+
+def _true_signature_window(path, depth, window, stride):
+    signatures = []
+    for start in range(0, path.size(1) - window + 1, stride):
+        signatures.append(signatory.signature(path[:, start:start + window], depth))
+    return torch.stack(signatures, dim=1)
+
+
+def test_forward():
+    """Tests that the sliding window signatures agree with computing the signature of every window separately."""
+    for device in h.get_devices():
+        for batch_size, input_channels in ((1, 1), (2, 3), (4, 2)):
+            for input_stream in (2, 5, 12):
+                for depth in (1, 2, 4):
+                    for window, stride in _window_params(input_stream):
+                        path = h.get_path(batch_size, input_stream, input_channels, device, path_grad=False)
+                        signature = signatory.signature_window(path, depth, window, stride)
+                        true_signature = _true_signature_window(path, depth, window, stride)
+                        assert signature.shape == true_signature.shape
+                        h.diff(signature, true_signature)
+                        assert signature.grad_fn is None
+
+
+def test_backward():
+    """Tests that the backwards operation through the sliding window signatures gives the correct values."""
+    for device in h.get_devices():
+        for batch_size, input_channels in ((1, 1), (2, 3), (4, 2)):
+            for input_stream in (2, 5, 12):
+                for depth in (1, 2, 4):
+                    for window, stride in _window_params(input_stream):
+                        path = h.get_path(batch_size, input_stream, input_channels, device, path_grad=True)
+                        signature = signatory.signature_window(path, depth, window, stride)
+                        grad = torch.rand_like(signature)
+                        signature.backward(grad)
+                        path_grad = path.grad.clone()
+                        path.grad.zero_()
+
+                        true_signature = _true_signature_window(path, depth, window, stride)
+                        true_signature.backward(grad)
+                        h.diff(path_grad, path.grad)
+
+
+def test_gradcheck():
+    """Tests the backwards operation through the sliding window signatures with gradcheck."""
+    for window, stride in ((5, 1), (4, 2), (2, 3)):
+        path = torch.rand(2, 8, 2, dtype=torch.double, requires_grad=True)
+        assert torch.autograd.gradcheck(lambda x: signatory.signature_window(x, 3, window, stride), (path,))
+
+
+def test_memory_leaks():
+    """Tests that the sliding window signatures don't leak memory through their autograd graph."""
+    path = torch.rand(2, 10, 3, dtype=torch.double, requires_grad=True)
+    signature = signatory.signature_window(path, 3, 6)
+    ctx = signature.grad_fn.next_functions[0][0]
+    assert type(ctx).__name__ == '_SignatureWindowFunctionBackward'
+    ref = weakref.ref(ctx)
+    del ctx
+    del signature
+    gc.collect()
+    assert ref() is None
+
+
+def test_errors():
+    """Tests that invalid arguments are caught."""
+    path = torch.rand(2, 6, 3)
+    for window, stride in ((1, 1), (7, 1), (3, 0)):
+        with pytest.raises(ValueError):
+            signatory.signature_window(path, 3, window, stride)
+    with pytest.raises(ValueError):
+        signatory.signature_window(path, 0, 3)
@@ -0,0 +1,134 @@
+# Copyright 2019 Patrick Kidger. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# =========================================================================
+"""Tests the signature_words function."""
+
+
+import gc
+import pytest
+import torch
+from torch import autograd
+import weakref
+
+from helpers import helpers as h
+from helpers import validation as v
+
+
+tests = ['signature_words']
+depends = ['signature']
+signatory = v.validate_tests(tests, depends)
+
+
+def _true_signature_words(path, words, stream, basepoint):
+    depth = max(len(word) for word in words)
+    signature = signatory.signature(path, depth, stream, basepoint)
+    all_words = [tuple(word) for word in signatory.all_words(path.size(-1), depth)]
+    indices = [all_words.index(tuple(word)) for word in words]
+    return signature[..., indices]
+
+
+def test_forward():
+    """Tests that the requested coordinates agree with those of the full signature."""
+    words = [[0], [2, 1, 0], [1, 1], [2, 1], [0, 2, 2, 1], [2, 1, 0]]
+    for dtype in (torch.float, torch.double):
+        for batch_size in (1, 5):
+            for stream_size in (2, 6):
+                for stream in (False, True):
+                    for basepoint in (False, True, h.without_grad):
+                        path = torch.rand(batch_size, stream_size, 3, dtype=dtype)
+                        basepoint_value = h.get_basepoint(batch_size, 3, 'cpu', basepoint)
+                        if isinstance(basepoint_value, torch.Tensor):
+                            basepoint_value = basepoint_value.to(dtype)
+                        signature_words = signatory.signature_words(path, words, stream=stream,
+                                                                    basepoint=basepoint_value)
+                        true_signature_words = _true_signature_words(path, words, stream, basepoint_value)
+                        assert signature_words.shape == true_signature_words.shape
+                        atol = 1e-8 if dtype == torch.double else 1e-4
+                        h.diff(signature_words, true_signature_words, atol=atol)
+
+
+def test_levels():
+    """Tests that requesting levels agrees with the corresponding levels of the full signature."""
+    for channels in (1, 2, 3):
+        for levels in ([1], [3], [1, 3], [2, 3, 4]):
+            for stream in (False, True):
+                path = torch.rand(4, 5, channels, dtype=torch.double)
+                signature = signatory.signature(path, max(levels), stream)
+                true_signature_levels = torch.cat([signatory.extract_signature_term(signature, channels, level)
+                                                   for level in levels], dim=-1)
+                h.diff(signatory.signature_words(path, levels=levels, stream=stream), true_signature_levels)
+
+
+def test_backward():
+    """Tests that the gradients agree with those through the full signature."""
+    words = [[1], [0, 1], [1, 0, 0], [0, 1, 1, 0], [1]]
+    for batch_size in (1, 4):
+        for stream_size in (2, 5):
+            for stream in (False, True):
+                for basepoint in (False, True, h.with_grad):
+                    path = torch.rand(batch_size, stream_size, 2, dtype=torch.double, requires_grad=True)
+                    basepoint_value = h.get_basepoint(batch_size, 2, 'cpu', basepoint)
+                    signature_words = signatory.signature_words(path, words, stream=stream, basepoint=basepoint_value)
+                    grad = torch.rand_like(signature_words)
+                    signature_words.backward(grad)
+                    path_grad = path.grad.clone()
+                    path.grad.zero_()
+                    if basepoint is h.with_grad:
+                        basepoint_grad = basepoint_value.grad.clone()
+                        basepoint_value.grad.zero_()
+
+                    _true_signature_words(path, words, stream, basepoint_value).backward(grad)
+                    h.diff(path_grad, path.grad)
+                    if basepoint is h.with_grad:
+                        h.diff(basepoint_grad, basepoint_value.grad)
+
+
+def test_gradcheck():
+    """Tests the gradients with finite differences."""
+    for stream in (False, True):
+        path = torch.rand(2, 4, 3, dtype=torch.double, requires_grad=True)
+        try:
+            autograd.gradcheck(lambda x: signatory.signature_words(x, [[0, 2], [1, 1, 2]], stream=stream), (path,))
+        except RuntimeError:
+            pytest.fail()
+
+
+def test_memory_leaks():
+    """Tests that the saved tensors are freed along with the graph."""
+    path = torch.rand(2, 4, 2, requires_grad=True)
+    signature_words = signatory.signature_words(path, [[0, 1]])
+    ref = weakref.ref(signature_words.grad_fn)
+    del signature_words
+    gc.collect()
+    assert ref() is None
+
+
+def test_errors():
+    """Tests that invalid arguments are caught."""
+    path = torch.rand(2, 4, 3)
+    for words in ([], [[]], [[0, 3]], [[-1]]):
+        with pytest.raises(ValueError):
+            signatory.signature_words(path, words)
+    for levels in ([], [0]):
+        with pytest.raises(ValueError):
+            signatory.signature_words(path, levels=levels)
+    with pytest.raises(ValueError):
+        signatory.signature_words(path)
+    with pytest.raises(ValueError):
+        signatory.signature_words(path, [[0]], levels=[1])
+    with pytest.raises(ValueError):
+        signatory.signature_words(torch.rand(2, 1, 3), [[0]])
+    if torch.cuda.is_available():
+        with pytest.raises(ValueError):
+            signatory.signature_words(path.cuda(), [[0]])
@@ -0,0 +1,149 @@
+# Copyright 2019 Patrick Kidger. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# =========================================================================
+"""Tests the tensor algebra operations, and logsignature_to_signature."""
+
+
+import pytest
+import torch
+from torch import autograd
+
+from helpers import helpers as h
+from helpers import validation as v
+
+
+tests = ['ta_mult', 'ta_exp', 'ta_log', 'ta_antipode', 'logsignature_to_signature']
+depends = ['signature', 'signature_channels', 'signature_combine', 'signature_to_logsignature', 'logsignature',
+           'logsignature_channels']
+signatory = v.validate_tests(tests, depends)
+
+
+def _tensor(batch_size, input_channels, depth, device, requires_grad=False):
+    return torch.rand(batch_size, signatory.signature_channels(input_channels, depth), dtype=torch.double,
+                      device=device, requires_grad=requires_grad)
+
+
+def test_mult():
+    """Tests that ta_mult agrees with signature_combine, including with extra batch dimensions."""
+    for device in h.get_devices():
+        for batch_size, input_stream, input_channels in h.random_sizes():
+            for depth in (1, 2, 4):
+                path1 = h.get_path(batch_size, input_stream, input_channels, device, path_grad=False)
+                path2 = h.get_path(batch_size, input_stream, input_channels, device, path_grad=False)
+                signature1 = signatory.signature(path1, depth)
+                signature2 = signatory.signature(path2, depth, basepoint=path1[:, -1])
+                combined = signatory.ta_mult(signature1, signature2, input_channels, depth)
+                h.diff(combined, signatory.signature_combine(signature1, signature2, input_channels, depth))
+                combined_extra = signatory.ta_mult(signature1.unsqueeze(0), signature2.unsqueeze(0), input_channels,
+                                                   depth)
+                h.diff(combined_extra, combined.unsqueeze(0))
+
+
+def test_exp_log():
+    """Tests that ta_exp and ta_log are inverse to each other, and that ta_log agrees with
+    signature_to_logsignature."""
+    for device in h.get_devices():
+        for batch_size, input_stream, input_channels in h.random_sizes():
+            for depth in (1, 2, 4):
+                path = h.get_path(batch_size, input_stream, input_channels, device, path_grad=False)
+                signature = signatory.signature(path, depth)
+                logsignature = signatory.ta_log(signature, input_channels, depth)
+                h.diff(logsignature, signatory.signature_to_logsignature(signature, input_channels, depth,
+                                                                         mode='expand'))
+                h.diff(signatory.ta_exp(logsignature, input_channels, depth), signature)
+
+                tensor = _tensor(batch_size, input_channels, depth, device)
+                h.diff(signatory.ta_log(signatory.ta_exp(tensor, input_channels, depth), input_channels, depth),
+                       tensor)
+
+
+def test_exp_restricted():
+    """Tests that ta_exp agrees with the signature of a single straight line."""
+    for device in h.get_devices():
+        for depth in (1, 2, 3, 5):
+            path = h.get_path(3, 2, 3, device, path_grad=False)
+            increment = path[:, 1] - path[:, 0]
+            tensor = torch.zeros(3, signatory.signature_channels(3, depth), dtype=torch.double, device=device)
+            tensor[:, :3] = increment
+            h.diff(signatory.ta_exp(tensor, 3, depth), signatory.signature(path, depth))
+
+
+def test_antipode():
+    """Tests that ta_antipode gives the inverse signature."""
+    for device in h.get_devices():
+        for batch_size, input_stream, input_channels in h.random_sizes():
+            for depth in (1, 2, 4):
+                path = h.get_path(batch_size, input_stream, input_channels, device, path_grad=False)
+                signature = signatory.signature(path, depth)
+                antipode = signatory.ta_antipode(signature, input_channels, depth)
+                h.diff(antipode, signatory.signature(path, depth, inverse=True))
+                h.diff(signatory.ta_antipode(antipode, input_channels, depth), signature)
+
+
+def test_logsignature_to_signature():
+    """Tests that logsignature_to_signature inverts logsignature."""
+    for device in h.get_devices():
+        for batch_size, input_stream, input_channels in h.random_sizes():
+            for depth in (1, 2, 4):
+                for stream in (False, True):
+                    path = h.get_path(batch_size, input_stream, input_channels, device, path_grad=False)
+                    logsignature = signatory.logsignature(path, depth, stream=stream)
+                    signature = signatory.logsignature_to_signature(logsignature, input_channels, depth)
+                    h.diff(signature, signatory.signature(path, depth, stream=stream))
+
+
+def test_logsignature_to_signature_cache():
+    """Tests that the cache of basis expansions used by logsignature_to_signature stays bounded, and still gives the
+    right answer after entries have been evicted."""
+    from signatory import logsignature_module
+    path = torch.rand(2, 4, 2, dtype=torch.double)
+    logsignature = signatory.logsignature(path, 3)
+    for channels in range(1, 2 * logsignature_module._words_basis_expansion_cache_size + 1):
+        signatory.logsignature_to_signature(torch.rand(1, signatory.logsignature_channels(channels, 2)), channels, 2)
+        assert len(logsignature_module._words_basis_expansion_cache) <= \
+            logsignature_module._words_basis_expansion_cache_size
+    h.diff(signatory.logsignature_to_signature(logsignature, 2, 3), signatory.signature(path, 3))
+
+
+def test_gradcheck():
+    """Tests the backward operations against finite differences."""
+    for device in h.get_devices():
+        for depth in (1, 2, 3):
+            for input_channels in (1, 3):
+                tensor1 = _tensor(2, input_channels, depth, device, requires_grad=True)
+                tensor2 = _tensor(2, input_channels, depth, device, requires_grad=True)
+                logsignature = torch.rand(2, signatory.logsignature_channels(input_channels, depth),
+                                          dtype=torch.double, device=device, requires_grad=True)
+                assert autograd.gradcheck(lambda x, y: signatory.ta_mult(x, y, input_channels, depth),
+                                          (tensor1, tensor2))
+                assert autograd.gradcheck(lambda x: signatory.ta_exp(x, input_channels, depth), (tensor1,))
+                assert autograd.gradcheck(lambda x: signatory.ta_log(x, input_channels, depth), (tensor1,))
+                assert autograd.gradcheck(lambda x: signatory.ta_antipode(x, input_channels, depth), (tensor1,))
+                assert autograd.gradcheck(lambda x: signatory.logsignature_to_signature(x, input_channels, depth),
+                                          (logsignature,))
+
+
+def test_errors():
+    """Tests that invalid inputs raise errors."""
+    tensor = _tensor(2, 3, 2, 'cpu')
+    with pytest.raises(ValueError):
+        signatory.ta_exp(tensor, 3, 3)
+    with pytest.raises(ValueError):
+        signatory.ta_log(tensor, 2, 2)
+    with pytest.raises(ValueError):
+        signatory.ta_antipode(tensor, 3, 0)
+    with pytest.raises(ValueError):
+        signatory.ta_mult(tensor, tensor[:1], 3, 2)
+    with pytest.raises(ValueError):
+        signatory.logsignature_to_signature(tensor, 3, 2)
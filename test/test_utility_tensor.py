@@ -0,0 +1,96 @@
+# Copyright 2019 Patrick Kidger. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#    http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# =========================================================================
+"""Tests the tensor-returning versions of the utility-style functions within the package."""
+
+
+import torch
+
+from helpers import validation as v
+
+
+tests = ['lyndon_words_tensor', 'lyndon_brackets_tensor', 'all_words_tensor',
+         'unstable.lyndon_words_to_basis_transform_tensor']
+depends = ['lyndon_words', 'lyndon_brackets', 'all_words', 'unstable.lyndon_words_to_basis_transform']
+signatory = v.validate_tests(tests, depends)
+
+
+def _unpack(words, lengths):
+    return [tuple(word[:length].tolist()) for word, length in zip(words, lengths)]
+
+
+def test_lyndon_words_tensor():
+    """Tests the lyndon_words_tensor function"""
+    for channels in range(1, 6):
+        for depth in range(1, 6):
+            words, lengths = signatory.lyndon_words_tensor(channels, depth)
+            print('channels=' + str(channels))
+            print('depth=' + str(depth))
+            assert words.dtype == torch.int64
+            assert lengths.dtype == torch.int64
+            assert words.shape == (lengths.size(0), depth)
+            assert (words.masked_select(words < 0) == -1).all()
+            true_words = [tuple(word) for word in signatory.lyndon_words(channels, depth)]
+            assert _unpack(words, lengths) == true_words
+
+
+def test_lyndon_brackets_tensor():
+    """Tests the lyndon_brackets_tensor function"""
+    for channels in range(1, 6):
+        for depth in range(1, 6):
+            words, lengths, children = signatory.lyndon_brackets_tensor(channels, depth)
+            print('channels=' + str(channels))
+            print('depth=' + str(depth))
+            assert children.dtype == torch.int64
+            assert children.shape == (lengths.size(0), 2)
+            true_words = [tuple(word) for word in signatory.lyndon_words(channels, depth)]
+            assert _unpack(words, lengths) == true_words
+
+            brackets = []
+            for word, length, (first, second) in zip(words, lengths, children.tolist()):
+                if length == 1:
+                    assert first == -1 and second == -1
+                    brackets.append(word[0].item())
+                else:
+                    brackets.append([brackets[first], brackets[second]])
+            assert brackets == signatory.lyndon_brackets(channels, depth)
+
+
+def test_all_words_tensor():
+    """Tests the all_words_tensor function"""
+    for channels in range(1, 6):
+        for depth in range(1, 6):
+            words, lengths = signatory.all_words_tensor(channels, depth)
+            print('channels=' + str(channels))
+            print('depth=' + str(depth))
+            assert words.shape == (lengths.size(0), depth)
+            assert _unpack(words, lengths) == [tuple(word) for word in signatory.all_words(channels, depth)]
+
+
+def test_lyndon_words_to_basis_transform_tensor():
+    """Tests the lyndon_words_to_basis_transform_tensor function"""
+    for channels in range(1, 6):
+        for depth in range(1, 6):
+            indices, values, offsets = signatory.unstable.lyndon_words_to_basis_transform_tensor(channels, depth)
+            print('channels=' + str(channels))
+            print('depth=' + str(depth))
+            assert indices.shape == (2, values.size(0))
+            assert offsets[0] == 0
+            assert offsets[-1] == values.size(0)
+            transforms = signatory.unstable.lyndon_words_to_basis_transform(channels, depth)
+            assert len(transforms) == offsets.size(0) - 1
+            for transform_class, start, end in zip(transforms, offsets[:-1].tolist(), offsets[1:].tolist()):
+                tensor_class = list(zip(indices[0, start:end].tolist(), indices[1, start:end].tolist(),
+                                        values[start:end].tolist()))
+                assert [tuple(transform) for transform in transform_class] == tensor_class